@@ -315,6 +315,9 @@ class GPCatalog():
         # pg_database: datfrozenxid and datminmxid are vacuum related
         self._tables['pg_database']._setKnownDifferences("datfrozenxid datminmxid")
 
+        # pg_appendonly: analyzemodcount is only maintained by ANALYZE on the coordinator
+        self._tables['pg_appendonly']._setKnownDifferences("analyzemodcount")
+
         # -------------
         # Issues still present in the product
         # -------------
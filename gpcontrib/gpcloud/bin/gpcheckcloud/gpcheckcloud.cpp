@@ -149,6 +149,7 @@ static void printTemplate() {
         "proxy = \"\"\n"
         "autocompress = true\n"
         "verifycert = true\n"
+        "prefetch = true\n"
         "server_side_encryption = \"\"\n"
         "# gpcheckcloud config\n"
         "gpcheckcloud_newline = \"\\n\"\n");
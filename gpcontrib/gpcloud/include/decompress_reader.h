@@ -1,15 +1,105 @@
 #ifndef INCLUDE_DECOMPRESS_READER_H_
 #define INCLUDE_DECOMPRESS_READER_H_
 
+// USE_ZSTD comes from the server's configuration, unit tests are built without it.
+#if !defined(S3_STANDALONE) || defined(S3_STANDALONE_CHECKCLOUD)
+#include "pg_config.h"
+#endif
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
 #include "reader.h"
 #include "s3common_headers.h"
 #include "s3exception.h"
+#include "s3interface.h"
 #include "s3macros.h"
 #include "s3params.h"
 
 // 2MB by default
 extern uint64_t S3_ZIP_DECOMPRESS_CHUNKSIZE;
 
+// xxHash32 over data that arrives in pieces.
+class XXH32Stream {
+   public:
+    void reset(uint32_t seed);
+    void update(const char *data, uint64_t len);
+    uint32_t digest() const;
+
+   private:
+    uint32_t seed;
+    uint32_t acc[4];
+    uint64_t totalLen;
+    char pending[16];  // input not yet consumed by a round
+    uint64_t pendingLen;
+};
+
+// Streaming decoder of the LZ4 frame format (lz4_Frame_format.md in the lz4 sources), so that .lz4
+// objects can be read without linking liblz4. Concatenated and skippable frames are supported.
+// The header, block and content checksums are verified, and so is the content size.
+class LZ4FrameDecoder {
+   public:
+    LZ4FrameDecoder();
+
+    void reset();
+
+    // Decode input from in[0, inLen) into out[0, outLen). Set consumed to the number of input
+    // bytes used, and return the number of bytes written to out.
+    uint64_t decode(const char *in, uint64_t inLen, uint64_t &consumed, char *out, uint64_t outLen);
+
+    // Whether all input so far made up complete frames.
+    bool isFinished() const {
+        return this->stage == LZ4_STAGE_MAGIC && this->stagingLen == 0;
+    }
+
+   private:
+    enum Stage {
+        LZ4_STAGE_MAGIC,
+        LZ4_STAGE_HEADER,
+        LZ4_STAGE_BLOCK_SIZE,
+        LZ4_STAGE_BLOCK,
+        LZ4_STAGE_OUTPUT,
+        LZ4_STAGE_CONTENT_CHECKSUM,
+        LZ4_STAGE_SKIP_SIZE,
+        LZ4_STAGE_SKIP,
+    };
+
+    // Collect input into staging until it holds need bytes, return whether it does.
+    bool fillStaging(const char *&in, const char *inEnd, uint64_t need);
+
+    void parseHeader();
+    void decodeBlock(const char *src);
+
+    Stage stage;
+
+    // Input of the current header or block, which may arrive in pieces.
+    vector<char> staging;
+    uint64_t stagingLen;
+
+    uint64_t headerLen;
+    uint64_t blockMaxSize;
+    bool blockIndependent;
+    bool blockChecksum;
+    bool contentChecksum;
+    bool hasContentSize;
+    uint64_t contentSize;  // from the header, if hasContentSize
+
+    uint64_t contentLen;      // bytes decoded so far in the current frame
+    XXH32Stream contentHash;  // of those bytes, if contentChecksum
+
+    uint64_t blockSize;      // compressed size of the current block
+    bool blockUncompressed;  // the current block is stored as is
+
+    uint64_t skipLen;  // bytes left of a skippable frame
+
+    // Decoded data, preceded by up to 64KB of the previous block for linked blocks.
+    vector<char> window;
+    uint64_t windowStart;  // start of the current block in window
+    uint64_t windowEnd;    // end of the current block in window
+    uint64_t windowPos;    // next byte of the current block to output
+};
+
 class DecompressReader : public Reader {
    public:
     DecompressReader();
@@ -26,22 +116,46 @@ class DecompressReader : public Reader {
 
     void setReader(Reader *reader);
 
+    // S3_COMPRESSION_GZIP by default, which also decodes deflate.
+    void setCompressionType(S3CompressionType type);
+
+    S3CompressionType getCompressionType() const {
+        return compressionType;
+    }
+
     void resizeDecompressReaderBuffer(uint64_t size);
 
    private:
     void decompress();
+    void decompressGzip();
+    void decompressZstd();
+    void decompressLZ4();
+    uint64_t fillInBuffer();
 
     uint64_t getDecompressedBytesNum() {
-        return S3_ZIP_DECOMPRESS_CHUNKSIZE - this->zstream.avail_out;
+        return this->outLen;
     }
 
     Reader *reader;
 
+    S3CompressionType compressionType;
+
     // zlib related variables.
     z_stream zstream;
+
+#ifdef USE_ZSTD
+    ZSTD_DStream *zstdStream;
+    size_t zstdResult;  // 0 when the last frame is complete
+#endif
+
+    LZ4FrameDecoder lz4Decoder;
+
     char *in;            // Input buffer for decompression.
+    uint64_t inOffset;   // Next position to decompress in in buffer.
+    uint64_t inLen;      // Bytes of data in in buffer.
     char *out;           // Output buffer for decompression.
     uint64_t outOffset;  // Next position to read in out buffer.
+    uint64_t outLen;     // Bytes of data in out buffer.
 
     bool isClosed;
 };
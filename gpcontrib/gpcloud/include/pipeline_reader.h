@@ -0,0 +1,68 @@
+#ifndef INCLUDE_PIPELINE_READER_H_
+#define INCLUDE_PIPELINE_READER_H_
+
+#include "reader.h"
+#include "s3common_headers.h"
+#include "s3exception.h"
+#include "s3macros.h"
+#include "s3params.h"
+
+// Number of buffers PipelineReader reads ahead.
+#define S3_PIPELINE_BUFFER_NUM 4
+
+// PipelineReader reads from its upstream reader on a thread of its own, up to
+// S3_PIPELINE_BUFFER_NUM buffers ahead of the caller. It lets the upstream reader's work, e.g.
+// decompression, run concurrently with the caller's, e.g. parsing, instead of in turns.
+class PipelineReader : public Reader {
+   public:
+    PipelineReader();
+    virtual ~PipelineReader();
+
+    virtual void open(const S3Params &params);
+
+    // read() attempts to read up to count bytes into the buffer.
+    // Return 0 if EOF. Throw exception if encounters errors.
+    virtual uint64_t read(char *buf, uint64_t count);
+
+    // This should be reentrant, has no side effects when called multiple times.
+    virtual void close();
+
+    void setReader(Reader *reader);
+
+    Reader *getReader() const {
+        return reader;
+    }
+
+    // Fill buffers from the upstream reader until EOF or close(), runs in the pipeline thread.
+    void fillBuffers();
+
+   private:
+    struct Buffer {
+        vector<char> data;
+        uint64_t len;
+    };
+
+    // Read from upstream until buf is full or EOF. Return false if stopped by close().
+    bool fillBuffer(Buffer &buf, bool &atEOF);
+
+    Reader *reader;
+
+    vector<Buffer> buffers;  // used as a ring
+    uint64_t numOfFilled;    // buffers filled so far, the next one to fill is at this index
+    uint64_t numOfConsumed;  // buffers consumed so far, the next one to read is at this index
+    uint64_t readOffset;     // next position to read in the current buffer
+
+    // The following are protected by mutex.
+    bool eof;
+    bool stopping;
+    std::exception_ptr exception;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    pthread_t thread;
+    bool threadStarted;
+
+    bool isClosed;
+};
+
+#endif /* INCLUDE_PIPELINE_READER_H_ */
@@ -5,8 +5,13 @@
 #include "s3common_headers.h"
 #include "s3exception.h"
 #include "s3interface.h"
+#include "s3key_reader.h"
 
 // S3BucketReader read multiple files in a bucket.
+//
+// While a key is being read, the compression type and the first range of the next key of the
+// segment are fetched in the background, so that the download threads don't all sit idle
+// between two keys.
 class S3BucketReader : public Reader {
    public:
     S3BucketReader();
@@ -28,6 +33,13 @@ class S3BucketReader : public Reader {
         return keyList;
     }
 
+    const S3ReadStats &getReadStats() const {
+        return *readStats;
+    }
+
+    // Fetch the head of the key at prefetchKeyIndex, runs in prefetchThread.
+    void prefetchKeyHead();
+
    private:
     S3Params params;
 
@@ -50,6 +62,19 @@ class S3BucketReader : public Reader {
 
     BucketContent &getNextKey();
     S3Params constructReaderParams(BucketContent &key);
+
+    // Prefetching of the next key.
+    pthread_t prefetchThread;
+    bool prefetching;             // prefetchThread is running or not joined yet
+    uint64_t prefetchKeyIndex;    // index of the key being prefetched
+    S3Params prefetchParams;      // reader params of the key being prefetched
+    std::shared_ptr<S3KeyHead> prefetchedHead;  // NULL if prefetching failed
+
+    void startPrefetch();
+    std::shared_ptr<S3KeyHead> finishPrefetch();
+
+    std::shared_ptr<S3ReadStats> readStats;
+    uint64_t openUsec;  // when the bucket was opened
 };
 
 #endif
@@ -2,6 +2,7 @@
 #define INCLUDE_S3COMMON_READER_H_
 
 #include "decompress_reader.h"
+#include "pipeline_reader.h"
 #include "s3common_headers.h"
 #include "s3exception.h"
 #include "s3key_reader.h"
@@ -34,6 +35,7 @@ class S3CommonReader : public Reader {
     S3Interface* s3InterfaceService;
     S3KeyReader keyReader;
     DecompressReader decompressReader;
+    PipelineReader pipelineReader;
 };
 
 #endif /* INCLUDE_S3COMMON_READER_H_ */
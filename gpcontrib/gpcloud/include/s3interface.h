@@ -19,6 +19,18 @@ enum S3CompressionType {
     S3_COMPRESSION_GZIP,
     S3_COMPRESSION_PLAIN,
     S3_COMPRESSION_DEFLATE,
+    S3_COMPRESSION_ZSTD,
+    S3_COMPRESSION_LZ4,
+};
+
+// The beginning of a key, fetched while the previous key of the segment is still being read.
+struct S3KeyHead {
+    explicit S3KeyHead(const S3MemoryContext& context)
+        : compressionType(S3_COMPRESSION_PLAIN), data(context) {
+    }
+
+    S3CompressionType compressionType;
+    S3VectorUInt8 data;  // the first range of the key
 };
 
 struct BucketContent {
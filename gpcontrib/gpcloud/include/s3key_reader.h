@@ -6,6 +6,14 @@
 #include "s3exception.h"
 #include "s3interface.h"
 
+// Keys are never split into ranges smaller than this, so that small keys don't turn into many
+// small requests.
+#define S3_MIN_RANGE_SIZE (8 * 1024 * 1024)
+
+// Size of the ranges a key is downloaded in: the key is spread over all the download threads,
+// but a range is never smaller than S3_MIN_RANGE_SIZE or larger than chunkSize.
+uint64_t AdaptiveRangeSize(uint64_t keySize, uint64_t chunkSize, uint64_t numOfChunks);
+
 struct Range {
     uint64_t offset;
     uint64_t length;
@@ -73,6 +81,7 @@ class S3KeyReader : public Reader {
           numOfChunks(0),
           curReadingChunk(0),
           transferredKeyLen(0),
+          usedKeyHead(false),
           s3Interface(NULL),
           hasEol(false),
           eolAppended(false) {
@@ -140,6 +149,11 @@ class S3KeyReader : public Reader {
         return region;
     }
 
+    // Whether the first range came from the prefetched head of the key.
+    bool isUsedKeyHead() const {
+        return usedKeyHead;
+    }
+
    private:
     pthread_mutex_t mutexErrorMessage;
 
@@ -152,9 +166,12 @@ class S3KeyReader : public Reader {
     uint64_t numOfChunks;
     uint64_t curReadingChunk;
     uint64_t transferredKeyLen;
+    bool usedKeyHead;
     string region;
     OffsetMgr offsetMgr;
 
+    std::shared_ptr<S3ReadStats> readStats;
+
     vector<ChunkBuffer> chunkBuffers;
     vector<pthread_t> threads;
 
@@ -189,6 +206,9 @@ class ChunkBuffer {
     uint64_t read(char* buf, uint64_t len);
     uint64_t fill();
 
+    // Take over data that is already downloaded for the range of this buffer.
+    bool adoptData(S3VectorUInt8& data);
+
     void setS3InterfaceService(S3Interface* s3) {
         this->s3Interface = s3;
     }
@@ -218,6 +238,14 @@ class ChunkBuffer {
         this->sharedKeyReader.setSharedError(sharedError, e);
     }
 
+    uint64_t getFetchUsec() const {
+        return fetchUsec;
+    }
+
+    uint64_t getWaitUsec() const {
+        return waitUsec;
+    }
+
    protected:
     S3Url s3Url;
 
@@ -233,6 +261,9 @@ class ChunkBuffer {
     uint64_t curChunkOffset;
     uint64_t chunkDataSize;
 
+    uint64_t fetchUsec;  // time spent in fetchData(), by the download thread
+    uint64_t waitUsec;   // time read() waited for data, by the reader
+
     S3VectorUInt8 chunkData;
     OffsetMgr& offsetMgr;
     S3Interface* s3Interface;
@@ -8,13 +8,18 @@
 void* S3Alloc(size_t);
 void S3Free(void*);
 
+extern bool S3QueryIsAbortInProgress(void);
+
+// A bounded pool of chunk buffers. When all of them are in use, Allocate() waits for one to be
+// returned, so that readers sharing the pool (e.g. the download threads of a key and the prefetch
+// of the next key) never use more memory than was preallocated.
 class PreAllocatedMemory {
    public:
-    PreAllocatedMemory(size_t chunkSize, size_t numOfChunk) {
+    PreAllocatedMemory(size_t chunkSize, size_t numOfChunk) : numOfUsed(0), peakUsed(0), numOfWaits(0) {
         maxSize = chunkSize * numOfChunk;
-        // we will have no more than 9 chunks, 8 for thread thunk, one for main buffer.
-        // Each chunk is limited to 128MB.
-        const uint64_t memoryLimit = 9 * 128 * 1024 * 1024;
+        // we will have no more than 10 chunks, 8 for thread thunk, one for main buffer, and one
+        // to prefetch the next key. Each chunk is limited to 128MB.
+        const uint64_t memoryLimit = 10 * 128 * 1024 * 1024ULL;
         S3_CHECK_OR_DIE(maxSize <= memoryLimit, S3MemoryOverLimit, memoryLimit, maxSize);
 
         used.resize(numOfChunk);
@@ -31,6 +36,7 @@ class PreAllocatedMemory {
         }
 
         pthread_mutex_init(&memLock, NULL);
+        pthread_cond_init(&memCond, NULL);
     }
 
     ~PreAllocatedMemory() {
@@ -41,6 +47,7 @@ class PreAllocatedMemory {
             }
         }
 
+        pthread_cond_destroy(&memCond);
         pthread_mutex_destroy(&memLock);
     }
 
@@ -50,14 +57,33 @@ class PreAllocatedMemory {
 
     void* Allocate() {
         UniqueLock lock(&memLock);
-        for (size_t i = 0; i < used.size(); i++) {
-            if (!used[i]) {
-                used[i] = true;
-                return chunks[i];
+
+        while (true) {
+            for (size_t i = 0; i < used.size(); i++) {
+                if (!used[i]) {
+                    used[i] = true;
+                    numOfUsed++;
+                    peakUsed = std::max(peakUsed, numOfUsed);
+                    return chunks[i];
+                }
             }
-        }
 
-        S3_DIE(S3RuntimeError, "Requested more than preallocated memory");
+            S3_CHECK_OR_DIE(!used.empty(), S3RuntimeError, "Requested more than preallocated memory");
+
+            // Wait for a chunk to come back, checking now and then whether the query is canceled.
+            numOfWaits++;
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += 100 * 1000 * 1000;
+            if (deadline.tv_nsec >= 1000 * 1000 * 1000) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000 * 1000 * 1000;
+            }
+            pthread_cond_timedwait(&memCond, &memLock, &deadline);
+
+            S3_CHECK_OR_DIE(!S3QueryIsAbortInProgress(), S3QueryAbort,
+                            "Query is aborted while waiting for memory");
+        }
     }
 
     void Deallocate(void* p) {
@@ -65,6 +91,8 @@ class PreAllocatedMemory {
         for (size_t i = 0; i < used.size(); i++) {
             if (chunks[i] == p) {
                 used[i] = false;
+                numOfUsed--;
+                pthread_cond_signal(&memCond);
                 return;
             }
         }
@@ -73,6 +101,22 @@ class PreAllocatedMemory {
         S3_DIE(S3RuntimeError, ss.str());
     }
 
+    size_t getNumOfChunks() const {
+        return chunks.size();
+    }
+
+    // The most chunks that were in use at once.
+    size_t getPeakUsed() {
+        UniqueLock lock(&memLock);
+        return peakUsed;
+    }
+
+    // How many times Allocate() had to wait for a chunk.
+    uint64_t getNumOfWaits() {
+        UniqueLock lock(&memLock);
+        return numOfWaits;
+    }
+
    private:
     PreAllocatedMemory(const PreAllocatedMemory&);
     PreAllocatedMemory& operator=(const PreAllocatedMemory&);
@@ -80,7 +124,11 @@ class PreAllocatedMemory {
     size_t maxSize;
     vector<bool> used;
     vector<void*> chunks;
+    size_t numOfUsed;
+    size_t peakUsed;
+    uint64_t numOfWaits;
     pthread_mutex_t memLock;
+    pthread_cond_t memCond;
 };
 
 template <class T>
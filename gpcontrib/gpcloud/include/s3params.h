@@ -7,6 +7,20 @@
 
 enum S3SSEType { SSE_NONE, SSE_S3 };
 
+struct S3KeyHead;
+
+// Throughput counters of the keys read by a segment, logged by S3BucketReader::close().
+struct S3ReadStats {
+    S3ReadStats() : bytes(0), keys(0), prefetchedKeys(0), fetchUsec(0), waitUsec(0) {
+    }
+
+    uint64_t bytes;           // bytes of all keys
+    uint64_t keys;            // number of keys
+    uint64_t prefetchedKeys;  // keys whose first range was fetched ahead of time
+    uint64_t fetchUsec;       // time the download threads spent fetching ranges
+    uint64_t waitUsec;        // time the reader waited for a range to be downloaded
+};
+
 class S3Params {
    public:
     S3Params(const string& sourceUrl = "", bool useHttps = true, const string& version = "",
@@ -21,6 +35,7 @@ class S3Params {
           debugCurl(false),
           autoCompress(false),
           verifyCert(false),
+          prefetch(false),
           sseType(SSE_NONE),
           gpcheckcloud_newline("") {
     }
@@ -111,6 +126,30 @@ class S3Params {
         this->autoCompress = autoCompress;
     }
 
+    bool isPrefetch() const {
+        return prefetch;
+    }
+
+    void setPrefetch(bool prefetch) {
+        this->prefetch = prefetch;
+    }
+
+    const std::shared_ptr<S3KeyHead>& getKeyHead() const {
+        return keyHead;
+    }
+
+    void setKeyHead(const std::shared_ptr<S3KeyHead>& keyHead) {
+        this->keyHead = keyHead;
+    }
+
+    const std::shared_ptr<S3ReadStats>& getReadStats() const {
+        return readStats;
+    }
+
+    void setReadStats(const std::shared_ptr<S3ReadStats>& readStats) {
+        this->readStats = readStats;
+    }
+
     const S3MemoryContext& getMemoryContext() const {
         return memoryContext;
     }
@@ -166,6 +205,10 @@ class S3Params {
     bool autoCompress;  // whether to compress data before uploading
     bool verifyCert;  // This option determines whether curl verifies the authenticity of the peer's
                       // certificate.
+    bool prefetch;    // whether to fetch the beginning of the next key while reading a key
+
+    std::shared_ptr<S3KeyHead> keyHead;       // beginning of the key, if it was prefetched
+    std::shared_ptr<S3ReadStats> readStats;  // where readers add their throughput counters
 
     S3SSEType sseType;
 
@@ -174,11 +217,12 @@ class S3Params {
     string gpcheckcloud_newline;  // newline LF, CRLF, CR
 };
 
-inline void PrepareS3MemContext(const S3Params& params) {
+inline void PrepareS3MemContext(const S3Params& params, uint64_t extraChunks = 1) {
     S3MemoryContext& memoryContext = const_cast<S3MemoryContext&>(params.getMemoryContext());
 
-    // We need one more chunk of memory for writer to prepare data to upload.
-    memoryContext.prepare(params.getChunkSize(), params.getNumOfChunks() + 1);
+    // We need one more chunk of memory for writer to prepare data to upload, and for reader to
+    // check the compression type. Reader needs another one to prefetch the next key.
+    memoryContext.prepare(params.getChunkSize(), params.getNumOfChunks() + extraChunks);
 }
 
 #endif
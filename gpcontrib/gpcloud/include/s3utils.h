@@ -83,4 +83,11 @@ string TruncateOptions(const string& url_with_options);
 
 string ReplaceNewlineWithSpace(const string &urlWithOptions);
 
+// Microseconds from an arbitrary starting point, for measuring elapsed time.
+inline uint64_t GetMonotonicUsec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 #endif  // __S3_UTILS_H__
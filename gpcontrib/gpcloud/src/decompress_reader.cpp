@@ -2,50 +2,551 @@
 
 uint64_t S3_ZIP_DECOMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
 
-DecompressReader::DecompressReader() : isClosed(true) {
+#define LZ4_FRAME_MAGIC 0x184D2204U
+#define LZ4_SKIPPABLE_MAGIC 0x184D2A50U
+#define LZ4_SKIPPABLE_MAGIC_MASK 0xFFFFFFF0U
+
+// Matches of linked blocks reach back at most this far.
+#define LZ4_HISTORY_SIZE (64 * 1024)
+
+static inline uint32_t ReadLE32(const char *p) {
+    const uint8_t *u = (const uint8_t *)p;
+    return (uint32_t)u[0] | ((uint32_t)u[1] << 8) | ((uint32_t)u[2] << 16) |
+           ((uint32_t)u[3] << 24);
+}
+
+static inline uint32_t RotL32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+// xxHash32, which LZ4 frames use for their checksums.
+#define XXH_P1 2654435761U
+#define XXH_P2 2246822519U
+#define XXH_P3 3266489917U
+#define XXH_P4 668265263U
+#define XXH_P5 374761393U
+
+static inline uint32_t XXH32Round(uint32_t acc, const char *p) {
+    return RotL32(acc + ReadLE32(p) * XXH_P2, 13) * XXH_P1;
+}
+
+static inline void XXH32Init(uint32_t acc[4], uint32_t seed) {
+    acc[0] = seed + XXH_P1 + XXH_P2;
+    acc[1] = seed + XXH_P2;
+    acc[2] = seed;
+    acc[3] = seed - XXH_P1;
+}
+
+// Mix the last len (< 16) bytes at p and the total length into h.
+static uint32_t XXH32Finish(uint32_t h, const char *p, uint64_t len, uint64_t totalLen) {
+    const char *end = p + len;
+
+    h += (uint32_t)totalLen;
+
+    while (end - p >= 4) {
+        h += ReadLE32(p) * XXH_P3;
+        h = RotL32(h, 17) * XXH_P4;
+        p += 4;
+    }
+
+    while (p < end) {
+        h += (uint8_t)*p * XXH_P5;
+        h = RotL32(h, 11) * XXH_P1;
+        p++;
+    }
+
+    h ^= h >> 15;
+    h *= XXH_P2;
+    h ^= h >> 13;
+    h *= XXH_P3;
+    h ^= h >> 16;
+
+    return h;
+}
+
+static uint32_t XXH32(const char *data, uint64_t len, uint32_t seed) {
+    const char *p = data;
+    const char *end = data + len;
+    uint32_t h;
+
+    if (len >= 16) {
+        uint32_t acc[4];
+        XXH32Init(acc, seed);
+
+        do {
+            acc[0] = XXH32Round(acc[0], p);
+            acc[1] = XXH32Round(acc[1], p + 4);
+            acc[2] = XXH32Round(acc[2], p + 8);
+            acc[3] = XXH32Round(acc[3], p + 12);
+            p += 16;
+        } while (end - p >= 16);
+
+        h = RotL32(acc[0], 1) + RotL32(acc[1], 7) + RotL32(acc[2], 12) + RotL32(acc[3], 18);
+    } else {
+        h = seed + XXH_P5;
+    }
+
+    return XXH32Finish(h, p, end - p, len);
+}
+
+void XXH32Stream::reset(uint32_t seed) {
+    this->seed = seed;
+    XXH32Init(this->acc, seed);
+    this->totalLen = 0;
+    this->pendingLen = 0;
+}
+
+void XXH32Stream::update(const char *data, uint64_t len) {
+    const char *p = data;
+    const char *end = data + len;
+
+    this->totalLen += len;
+
+    if (this->pendingLen > 0) {
+        uint64_t count = std::min(16 - this->pendingLen, len);
+        memcpy(this->pending + this->pendingLen, p, count);
+        this->pendingLen += count;
+        p += count;
+
+        if (this->pendingLen < 16) {
+            return;
+        }
+
+        for (int i = 0; i < 4; i++) {
+            this->acc[i] = XXH32Round(this->acc[i], this->pending + 4 * i);
+        }
+        this->pendingLen = 0;
+    }
+
+    while (end - p >= 16) {
+        for (int i = 0; i < 4; i++) {
+            this->acc[i] = XXH32Round(this->acc[i], p + 4 * i);
+        }
+        p += 16;
+    }
+
+    memcpy(this->pending, p, end - p);
+    this->pendingLen = end - p;
+}
+
+uint32_t XXH32Stream::digest() const {
+    uint32_t h;
+
+    if (this->totalLen >= 16) {
+        h = RotL32(this->acc[0], 1) + RotL32(this->acc[1], 7) + RotL32(this->acc[2], 12) +
+            RotL32(this->acc[3], 18);
+    } else {
+        h = this->seed + XXH_P5;
+    }
+
+    return XXH32Finish(h, this->pending, this->pendingLen, this->totalLen);
+}
+
+#define LZ4_CHECK_BLOCK(cond) \
+    S3_CHECK_OR_DIE(cond, S3RuntimeError, "Failed to decompress data: corrupted lz4 block")
+
+// Decode an LZ4 block from src into base[start, start + capacity), matches may refer to data in
+// base before start. Return the decoded size.
+static uint64_t LZ4DecodeBlock(const char *src, uint64_t srcLen, char *base, uint64_t start,
+                               uint64_t capacity) {
+    const uint8_t *ip = (const uint8_t *)src;
+    const uint8_t *iend = ip + srcLen;
+    char *op = base + start;
+    char *oend = op + capacity;
+
+    while (ip < iend) {
+        unsigned int token = *ip++;
+
+        uint64_t litLen = token >> 4;
+        if (litLen == 15) {
+            uint8_t b;
+            do {
+                LZ4_CHECK_BLOCK(ip < iend);
+                b = *ip++;
+                litLen += b;
+            } while (b == 255);
+        }
+
+        LZ4_CHECK_BLOCK(litLen <= (uint64_t)(iend - ip) && litLen <= (uint64_t)(oend - op));
+        memcpy(op, ip, litLen);
+        op += litLen;
+        ip += litLen;
+
+        // The last sequence has literals only.
+        if (ip == iend) {
+            break;
+        }
+
+        LZ4_CHECK_BLOCK(iend - ip >= 2);
+        uint64_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        LZ4_CHECK_BLOCK(offset != 0 && offset <= (uint64_t)(op - base));
+
+        uint64_t matchLen = token & 15;
+        if (matchLen == 15) {
+            uint8_t b;
+            do {
+                LZ4_CHECK_BLOCK(ip < iend);
+                b = *ip++;
+                matchLen += b;
+            } while (b == 255);
+        }
+        matchLen += 4;
+
+        LZ4_CHECK_BLOCK(matchLen <= (uint64_t)(oend - op));
+
+        // Matches may overlap the bytes they produce.
+        const char *match = op - offset;
+        if (offset >= matchLen) {
+            memcpy(op, match, matchLen);
+        } else {
+            for (uint64_t i = 0; i < matchLen; i++) {
+                op[i] = match[i];
+            }
+        }
+        op += matchLen;
+    }
+
+    return op - (base + start);
+}
+
+LZ4FrameDecoder::LZ4FrameDecoder() {
+    this->reset();
+}
+
+void LZ4FrameDecoder::reset() {
+    this->stage = LZ4_STAGE_MAGIC;
+    this->stagingLen = 0;
+    this->headerLen = 0;
+    this->blockMaxSize = 0;
+    this->blockIndependent = true;
+    this->blockChecksum = false;
+    this->contentChecksum = false;
+    this->hasContentSize = false;
+    this->contentSize = 0;
+    this->contentLen = 0;
+    this->blockSize = 0;
+    this->blockUncompressed = false;
+    this->skipLen = 0;
+    this->windowStart = 0;
+    this->windowEnd = 0;
+    this->windowPos = 0;
+}
+
+bool LZ4FrameDecoder::fillStaging(const char *&in, const char *inEnd, uint64_t need) {
+    if (this->stagingLen >= need) {
+        return true;
+    }
+
+    if (this->staging.size() < need) {
+        this->staging.resize(need);
+    }
+
+    uint64_t count = std::min(need - this->stagingLen, (uint64_t)(inEnd - in));
+    memcpy(this->staging.data() + this->stagingLen, in, count);
+    in += count;
+    this->stagingLen += count;
+
+    return this->stagingLen == need;
+}
+
+void LZ4FrameDecoder::parseHeader() {
+    uint8_t flg = this->staging[0];
+    uint8_t bd = this->staging[1];
+
+    S3_CHECK_OR_DIE((flg >> 6) == 1, S3RuntimeError,
+                    "Failed to decompress data: unsupported lz4 frame version");
+
+    this->blockIndependent = (flg & 0x20) != 0;
+    this->blockChecksum = (flg & 0x10) != 0;
+    this->contentChecksum = (flg & 0x04) != 0;
+    this->hasContentSize = (flg & 0x08) != 0;
+
+    uint32_t blockMaxSizeId = (bd >> 4) & 0x07;
+    S3_CHECK_OR_DIE(blockMaxSizeId >= 4, S3RuntimeError,
+                    "Failed to decompress data: invalid lz4 block size");
+
+    // 64KB, 256KB, 1MB or 4MB
+    this->blockMaxSize = (uint64_t)1 << (8 + 2 * blockMaxSizeId);
+
+    uint8_t headerChecksum = this->staging[this->headerLen - 1];
+    S3_CHECK_OR_DIE(
+        headerChecksum == ((XXH32(this->staging.data(), this->headerLen - 1, 0) >> 8) & 0xFF),
+        S3RuntimeError, "Failed to decompress data: lz4 frame header checksum mismatch");
+
+    if (this->hasContentSize) {
+        this->contentSize = (uint64_t)ReadLE32(this->staging.data() + 2) |
+                            ((uint64_t)ReadLE32(this->staging.data() + 6) << 32);
+    }
+    this->contentLen = 0;
+    if (this->contentChecksum) {
+        this->contentHash.reset(0);
+    }
+
+    if (this->window.size() < LZ4_HISTORY_SIZE + this->blockMaxSize) {
+        this->window.resize(LZ4_HISTORY_SIZE + this->blockMaxSize);
+    }
+
+    this->windowStart = 0;
+    this->windowEnd = 0;
+    this->windowPos = 0;
+}
+
+void LZ4FrameDecoder::decodeBlock(const char *src) {
+    if (this->blockChecksum) {
+        S3_CHECK_OR_DIE(XXH32(src, this->blockSize, 0) == ReadLE32(src + this->blockSize),
+                        S3RuntimeError, "Failed to decompress data: lz4 block checksum mismatch");
+    }
+
+    // Keep the end of what is decoded so far, linked blocks may refer to it.
+    uint64_t history = 0;
+    if (!this->blockIndependent && this->windowEnd > 0) {
+        history = std::min(this->windowEnd, (uint64_t)LZ4_HISTORY_SIZE);
+        memmove(this->window.data(), this->window.data() + this->windowEnd - history, history);
+    }
+
+    uint64_t decoded;
+    if (this->blockUncompressed) {
+        memcpy(this->window.data() + history, src, this->blockSize);
+        decoded = this->blockSize;
+    } else {
+        decoded = LZ4DecodeBlock(src, this->blockSize, this->window.data(), history,
+                                 this->blockMaxSize);
+    }
+
+    this->windowStart = history;
+    this->windowPos = history;
+    this->windowEnd = history + decoded;
+
+    this->contentLen += decoded;
+    if (this->contentChecksum) {
+        this->contentHash.update(this->window.data() + history, decoded);
+    }
+}
+
+uint64_t LZ4FrameDecoder::decode(const char *in, uint64_t inLen, uint64_t &consumed, char *out,
+                                 uint64_t outLen) {
+    const char *p = in;
+    const char *pEnd = in + inLen;
+    uint64_t produced = 0;
+    bool needInput = false;
+
+    while (produced < outLen && !needInput) {
+        switch (this->stage) {
+            case LZ4_STAGE_MAGIC: {
+                if (!this->fillStaging(p, pEnd, 4)) {
+                    needInput = true;
+                    break;
+                }
+                this->stagingLen = 0;
+
+                uint32_t magic = ReadLE32(this->staging.data());
+                if (magic == LZ4_FRAME_MAGIC) {
+                    this->stage = LZ4_STAGE_HEADER;
+                } else if ((magic & LZ4_SKIPPABLE_MAGIC_MASK) == LZ4_SKIPPABLE_MAGIC) {
+                    this->stage = LZ4_STAGE_SKIP_SIZE;
+                } else {
+                    S3_DIE(S3RuntimeError, "Failed to decompress data: invalid lz4 frame magic");
+                }
+                break;
+            }
+            case LZ4_STAGE_HEADER: {
+                // FLG and BD tell how long the rest of the header is.
+                if (!this->fillStaging(p, pEnd, 2)) {
+                    needInput = true;
+                    break;
+                }
+                uint8_t flg = this->staging[0];
+                this->headerLen = 3 + ((flg & 0x08) ? 8 : 0) + ((flg & 0x01) ? 4 : 0);
+
+                if (!this->fillStaging(p, pEnd, this->headerLen)) {
+                    needInput = true;
+                    break;
+                }
+                this->parseHeader();
+                this->stagingLen = 0;
+                this->stage = LZ4_STAGE_BLOCK_SIZE;
+                break;
+            }
+            case LZ4_STAGE_BLOCK_SIZE: {
+                if (!this->fillStaging(p, pEnd, 4)) {
+                    needInput = true;
+                    break;
+                }
+                this->stagingLen = 0;
+
+                uint32_t value = ReadLE32(this->staging.data());
+                if (value == 0) {
+                    // EndMark, the next frame doesn't refer to this one.
+                    S3_CHECK_OR_DIE(
+                        !this->hasContentSize || this->contentLen == this->contentSize,
+                        S3RuntimeError, "Failed to decompress data: lz4 content size mismatch");
+                    this->windowEnd = 0;
+                    this->stage =
+                        this->contentChecksum ? LZ4_STAGE_CONTENT_CHECKSUM : LZ4_STAGE_MAGIC;
+                    break;
+                }
+
+                this->blockUncompressed = (value & 0x80000000U) != 0;
+                this->blockSize = value & 0x7FFFFFFFU;
+                S3_CHECK_OR_DIE(this->blockSize <= this->blockMaxSize, S3RuntimeError,
+                                "Failed to decompress data: lz4 block is too large");
+                this->stage = LZ4_STAGE_BLOCK;
+                break;
+            }
+            case LZ4_STAGE_BLOCK: {
+                uint64_t need = this->blockSize + (this->blockChecksum ? 4 : 0);
+
+                // Decode straight from input if the whole block is there.
+                const char *src;
+                if (this->stagingLen == 0 && (uint64_t)(pEnd - p) >= need) {
+                    src = p;
+                    p += need;
+                } else {
+                    if (!this->fillStaging(p, pEnd, need)) {
+                        needInput = true;
+                        break;
+                    }
+                    src = this->staging.data();
+                }
+                this->stagingLen = 0;
+
+                this->decodeBlock(src);
+                this->stage = LZ4_STAGE_OUTPUT;
+                break;
+            }
+            case LZ4_STAGE_OUTPUT: {
+                uint64_t count = std::min(this->windowEnd - this->windowPos, outLen - produced);
+                memcpy(out + produced, this->window.data() + this->windowPos, count);
+                this->windowPos += count;
+                produced += count;
+
+                if (this->windowPos == this->windowEnd) {
+                    this->stage = LZ4_STAGE_BLOCK_SIZE;
+                }
+                break;
+            }
+            case LZ4_STAGE_CONTENT_CHECKSUM: {
+                if (!this->fillStaging(p, pEnd, 4)) {
+                    needInput = true;
+                    break;
+                }
+                this->stagingLen = 0;
+                S3_CHECK_OR_DIE(this->contentHash.digest() == ReadLE32(this->staging.data()),
+                                S3RuntimeError,
+                                "Failed to decompress data: lz4 content checksum mismatch");
+                this->stage = LZ4_STAGE_MAGIC;
+                break;
+            }
+            case LZ4_STAGE_SKIP_SIZE: {
+                if (!this->fillStaging(p, pEnd, 4)) {
+                    needInput = true;
+                    break;
+                }
+                this->stagingLen = 0;
+                this->skipLen = ReadLE32(this->staging.data());
+                this->stage = LZ4_STAGE_SKIP;
+                break;
+            }
+            case LZ4_STAGE_SKIP: {
+                uint64_t count = std::min(this->skipLen, (uint64_t)(pEnd - p));
+                p += count;
+                this->skipLen -= count;
+
+                if (this->skipLen == 0) {
+                    this->stage = LZ4_STAGE_MAGIC;
+                } else {
+                    needInput = true;
+                }
+                break;
+            }
+        }
+    }
+
+    consumed = p - in;
+    return produced;
+}
+
+DecompressReader::DecompressReader() : compressionType(S3_COMPRESSION_GZIP), isClosed(true) {
     this->reader = NULL;
+#ifdef USE_ZSTD
+    this->zstdStream = NULL;
+    this->zstdResult = 0;
+#endif
     this->in = new char[S3_ZIP_DECOMPRESS_CHUNKSIZE];
     this->out = new char[S3_ZIP_DECOMPRESS_CHUNKSIZE];
+    this->inOffset = 0;
+    this->inLen = 0;
     this->outOffset = 0;
+    this->outLen = 0;
 }
 
 DecompressReader::~DecompressReader() {
     this->close();
 
-    delete this->in;
-    delete this->out;
+    delete[] this->in;
+    delete[] this->out;
 }
 
 // Used for unit test to adjust buffer size
 void DecompressReader::resizeDecompressReaderBuffer(uint64_t size) {
-    delete this->in;
-    delete this->out;
+    delete[] this->in;
+    delete[] this->out;
     this->in = new char[size];
     this->out = new char[size];
+    this->inOffset = 0;
+    this->inLen = 0;
     this->outOffset = 0;
-    this->zstream.avail_out = size;
+    this->outLen = 0;
 }
 
 void DecompressReader::setReader(Reader *reader) {
     this->reader = reader;
 }
 
+void DecompressReader::setCompressionType(S3CompressionType type) {
+    this->compressionType = type;
+}
+
 void DecompressReader::open(const S3Params &params) {
-    // allocate inflate state for zlib
-    zstream.zalloc = Z_NULL;
-    zstream.zfree = Z_NULL;
-    zstream.opaque = Z_NULL;
-    zstream.next_in = Z_NULL;
-    zstream.next_out = (Byte *)this->out;
+    this->inOffset = 0;
+    this->inLen = 0;
+    this->outOffset = 0;
+    this->outLen = 0;
 
-    zstream.avail_in = 0;
-    zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
+    switch (this->compressionType) {
+        case S3_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+            this->zstdStream = ZSTD_createDStream();
+            S3_CHECK_OR_DIE(this->zstdStream != NULL, S3RuntimeError,
+                            "failed to initialize zstd library");
+            ZSTD_initDStream(this->zstdStream);
+            this->zstdResult = 0;
+            break;
+#else
+            S3_DIE(S3RuntimeError, "zstd compressed data is not supported by this build");
+#endif
+        case S3_COMPRESSION_LZ4:
+            this->lz4Decoder.reset();
+            break;
+        default: {
+            // allocate inflate state for zlib
+            zstream.zalloc = Z_NULL;
+            zstream.zfree = Z_NULL;
+            zstream.opaque = Z_NULL;
+            zstream.next_in = Z_NULL;
+            zstream.next_out = (Byte *)this->out;
 
-    this->outOffset = 0;
+            zstream.avail_in = 0;
+            zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
 
-    // with S3_INFLATE_WINDOWSBITS, it could recognize and decode both zlib and gzip stream.
-    int ret = inflateInit2(&zstream, S3_INFLATE_WINDOWSBITS);
-    S3_CHECK_OR_DIE(ret == Z_OK, S3RuntimeError, "failed to initialize zlib library");
+            // with S3_INFLATE_WINDOWSBITS, it could recognize and decode both zlib and gzip
+            // stream.
+            int ret = inflateInit2(&zstream, S3_INFLATE_WINDOWSBITS);
+            S3_CHECK_OR_DIE(ret == Z_OK, S3RuntimeError, "failed to initialize zlib library");
+            break;
+        }
+    }
 
     this->isClosed = false;
 
@@ -69,20 +570,55 @@ uint64_t DecompressReader::read(char *buf, uint64_t bufSize) {
     return count;
 }
 
-// Read compressed data from underlying reader and decompress to this->out buffer.
-// If no more data to consume, this->zstream.avail_out == S3_ZIP_DECOMPRESS_CHUNKSIZE;
+// Read S3_ZIP_DECOMPRESS_CHUNKSIZE data from underlying reader and put into this->in buffer.
+// Return 0 if EOF.
+uint64_t DecompressReader::fillInBuffer() {
+    // read() might happen more than once when reaching EOF, make sure every time read() will
+    // return 0.
+    uint64_t hasRead = this->reader->read(this->in, S3_ZIP_DECOMPRESS_CHUNKSIZE);
+
+    // Fill this->in as possible as it could, otherwise data in this->in might not be able to be
+    // inflated.
+    while (hasRead != 0 && hasRead < S3_ZIP_DECOMPRESS_CHUNKSIZE) {
+        uint64_t count =
+            this->reader->read(this->in + hasRead, S3_ZIP_DECOMPRESS_CHUNKSIZE - hasRead);
+
+        if (count == 0) {
+            break;
+        }
+
+        hasRead += count;
+    }
+
+    this->inOffset = 0;
+    this->inLen = hasRead;
+
+    return hasRead;
+}
+
+// Decompress the next piece of data to this->out buffer.
+// If no more data to consume, this->outLen == 0.
 void DecompressReader::decompress() {
-    if (this->zstream.avail_in == 0) {
-        this->zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
-        this->zstream.next_out = (Byte *)this->out;
+    switch (this->compressionType) {
+        case S3_COMPRESSION_ZSTD:
+            this->decompressZstd();
+            break;
+        case S3_COMPRESSION_LZ4:
+            this->decompressLZ4();
+            break;
+        default:
+            this->decompressGzip();
+            break;
+    }
+}
 
-        // read S3_ZIP_DECOMPRESS_CHUNKSIZE data from underlying reader and put into this->in
-        // buffer. read() might happen more than once when reaching EOF, make sure every time read()
-        // will return 0.
-        uint64_t hasRead = this->reader->read(this->in, S3_ZIP_DECOMPRESS_CHUNKSIZE);
+// Read compressed data from underlying reader and decompress to this->out buffer.
+void DecompressReader::decompressGzip() {
+    if (this->inOffset == this->inLen) {
+        this->outLen = 0;
 
         // EOF, no more data to decompress.
-        if (hasRead == 0) {
+        if (this->fillInBuffer() == 0) {
             S3DEBUG(
                 "No more data to decompress: avail_in = %u, avail_out = %u, total_in = %u, "
                 "total_out = %u",
@@ -90,29 +626,19 @@ void DecompressReader::decompress() {
 		(unsigned int) zstream.total_in, (unsigned int) zstream.total_out);
             return;
         }
+    }
 
-        // Fill this->in as possible as it could, otherwise data in this->in might not be able to be
-        // inflated.
-        while (hasRead < S3_ZIP_DECOMPRESS_CHUNKSIZE) {
-            uint64_t count =
-                this->reader->read(this->in + hasRead, S3_ZIP_DECOMPRESS_CHUNKSIZE - hasRead);
-
-            if (count == 0) {
-                break;
-            }
+    // Still have more data in 'in' buffer to decode.
+    this->zstream.next_in = (Byte *)this->in + this->inOffset;
+    this->zstream.avail_in = this->inLen - this->inOffset;
+    this->zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
+    this->zstream.next_out = (Byte *)this->out;
 
-            hasRead += count;
-        }
+    int status = inflate(&this->zstream, Z_NO_FLUSH);
 
-        this->zstream.next_in = (Byte *)this->in;
-        this->zstream.avail_in = hasRead;
-    } else {
-        // Still have more data in 'in' buffer to decode.
-        this->zstream.avail_out = S3_ZIP_DECOMPRESS_CHUNKSIZE;
-        this->zstream.next_out = (Byte *)this->out;
-    }
+    this->inOffset = this->inLen - this->zstream.avail_in;
+    this->outLen = S3_ZIP_DECOMPRESS_CHUNKSIZE - this->zstream.avail_out;
 
-    int status = inflate(&this->zstream, Z_NO_FLUSH);
     if (status == Z_STREAM_END) {
         S3DEBUG("Decompression finished: Z_STREAM_END.");
     } else if (status < 0 || status == Z_NEED_DICT) {
@@ -123,9 +649,88 @@ void DecompressReader::decompress() {
     }
 }
 
+// Unlike inflate(), the zstd and lz4 decoders may consume input without producing any output, so
+// they keep going until there is some output or the input is exhausted.
+void DecompressReader::decompressZstd() {
+#ifdef USE_ZSTD
+    // A full out buffer means the decoder may hold more output, even with no input left, unless
+    // the frame is complete. Calling it on a complete frame would start another one.
+    bool mayHaveOutput = (this->outLen == S3_ZIP_DECOMPRESS_CHUNKSIZE) && (this->zstdResult != 0);
+    this->outLen = 0;
+
+    while (true) {
+        if (this->inOffset == this->inLen && !mayHaveOutput) {
+            if (this->fillInBuffer() == 0) {
+                S3_CHECK_OR_DIE(this->zstdResult == 0, S3RuntimeError,
+                                "Failed to decompress data: truncated zstd stream");
+                return;
+            }
+        }
+
+        ZSTD_inBuffer input = {this->in, this->inLen, this->inOffset};
+        ZSTD_outBuffer output = {this->out, S3_ZIP_DECOMPRESS_CHUNKSIZE, 0};
+
+        size_t ret = ZSTD_decompressStream(this->zstdStream, &output, &input);
+        S3_CHECK_OR_DIE(!ZSTD_isError(ret), S3RuntimeError,
+                        string("Failed to decompress data: ") + ZSTD_getErrorName(ret));
+
+        this->zstdResult = ret;
+        this->inOffset = input.pos;
+        this->outLen = output.pos;
+
+        if (this->outLen > 0) {
+            return;
+        }
+
+        mayHaveOutput = false;
+    }
+#else
+    S3_DIE(S3RuntimeError, "zstd compressed data is not supported by this build");
+#endif
+}
+
+void DecompressReader::decompressLZ4() {
+    bool mayHaveOutput = (this->outLen == S3_ZIP_DECOMPRESS_CHUNKSIZE);
+    this->outLen = 0;
+
+    while (true) {
+        if (this->inOffset == this->inLen && !mayHaveOutput) {
+            if (this->fillInBuffer() == 0) {
+                S3_CHECK_OR_DIE(this->lz4Decoder.isFinished(), S3RuntimeError,
+                                "Failed to decompress data: truncated lz4 stream");
+                return;
+            }
+        }
+
+        uint64_t consumed = 0;
+        this->outLen =
+            this->lz4Decoder.decode(this->in + this->inOffset, this->inLen - this->inOffset,
+                                    consumed, this->out, S3_ZIP_DECOMPRESS_CHUNKSIZE);
+        this->inOffset += consumed;
+
+        if (this->outLen > 0) {
+            return;
+        }
+
+        mayHaveOutput = false;
+    }
+}
+
 void DecompressReader::close() {
     if (!this->isClosed) {
-        inflateEnd(&zstream);
+        switch (this->compressionType) {
+            case S3_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+                ZSTD_freeDStream(this->zstdStream);
+                this->zstdStream = NULL;
+#endif
+                break;
+            case S3_COMPRESSION_LZ4:
+                break;
+            default:
+                inflateEnd(&zstream);
+                break;
+        }
         this->reader->close();
         this->isClosed = true;
     }
@@ -99,7 +99,7 @@ GPReader* reader_init(const char* url_with_options) {
         InitRemoteLog();
 
         // Prepare memory to be used for thread chunk buffer.
-        PrepareS3MemContext(params);
+        PrepareS3MemContext(params, params.isPrefetch() ? 2 : 1);
 
         reader = new GPReader(params);
         if (reader == NULL) {
@@ -0,0 +1,193 @@
+#include "pipeline_reader.h"
+#include "decompress_reader.h"
+
+PipelineReader::PipelineReader()
+    : reader(NULL),
+      numOfFilled(0),
+      numOfConsumed(0),
+      readOffset(0),
+      eof(false),
+      stopping(false),
+      threadStarted(false),
+      isClosed(true) {
+    pthread_mutex_init(&this->mutex, NULL);
+    pthread_cond_init(&this->cond, NULL);
+}
+
+PipelineReader::~PipelineReader() {
+    this->close();
+
+    pthread_cond_destroy(&this->cond);
+    pthread_mutex_destroy(&this->mutex);
+}
+
+void PipelineReader::setReader(Reader *reader) {
+    this->reader = reader;
+}
+
+static void *PipelineThreadFunc(void *data) {
+    MaskThreadSignals();
+
+    static_cast<PipelineReader *>(data)->fillBuffers();
+    return NULL;
+}
+
+void PipelineReader::open(const S3Params &params) {
+    S3_CHECK_OR_DIE(this->reader != NULL, S3RuntimeError, "upstream reader is NULL");
+
+    // Open in the caller's thread, so that errors are reported right away.
+    this->reader->open(params);
+    this->isClosed = false;
+
+    this->buffers.resize(S3_PIPELINE_BUFFER_NUM);
+    for (uint64_t i = 0; i < this->buffers.size(); i++) {
+        this->buffers[i].data.resize(S3_ZIP_DECOMPRESS_CHUNKSIZE);
+        this->buffers[i].len = 0;
+    }
+
+    this->numOfFilled = 0;
+    this->numOfConsumed = 0;
+    this->readOffset = 0;
+    this->eof = false;
+    this->stopping = false;
+    this->exception = NULL;
+
+    int ret = pthread_create(&this->thread, NULL, PipelineThreadFunc, this);
+    S3_CHECK_OR_DIE(ret == 0, S3RuntimeError, "failed to create pipeline thread");
+    this->threadStarted = true;
+}
+
+bool PipelineReader::fillBuffer(Buffer &buf, bool &atEOF) {
+    buf.len = 0;
+    atEOF = false;
+
+    while (buf.len < buf.data.size()) {
+        {
+            UniqueLock lock(&this->mutex);
+            if (this->stopping) {
+                return false;
+            }
+        }
+
+        uint64_t count = this->reader->read(buf.data.data() + buf.len, buf.data.size() - buf.len);
+        if (count == 0) {
+            atEOF = true;
+            break;
+        }
+
+        buf.len += count;
+    }
+
+    return true;
+}
+
+void PipelineReader::fillBuffers() {
+    S3DEBUG("Pipeline thread starts");
+
+    while (true) {
+        Buffer *buf;
+        {
+            UniqueLock lock(&this->mutex);
+            while (!this->stopping && this->numOfFilled - this->numOfConsumed == this->buffers.size()) {
+                pthread_cond_wait(&this->cond, &this->mutex);
+            }
+
+            if (this->stopping) {
+                break;
+            }
+
+            // Only this thread touches buffers that are not filled yet.
+            buf = &this->buffers[this->numOfFilled % this->buffers.size()];
+        }
+
+        bool atEOF = false;
+        bool filled = false;
+        std::exception_ptr error;
+
+        try {
+            filled = this->fillBuffer(*buf, atEOF);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        UniqueLock lock(&this->mutex);
+        if (error) {
+            this->exception = error;
+            pthread_cond_signal(&this->cond);
+            break;
+        }
+
+        if (!filled) {
+            break;
+        }
+
+        if (buf->len > 0) {
+            this->numOfFilled++;
+        }
+
+        if (atEOF) {
+            this->eof = true;
+        }
+
+        pthread_cond_signal(&this->cond);
+
+        if (atEOF) {
+            break;
+        }
+    }
+
+    S3DEBUG("Pipeline thread ends");
+}
+
+uint64_t PipelineReader::read(char *buf, uint64_t count) {
+    Buffer *current;
+    {
+        UniqueLock lock(&this->mutex);
+        while (this->numOfConsumed == this->numOfFilled && !this->eof && !this->exception) {
+            pthread_cond_wait(&this->cond, &this->mutex);
+        }
+
+        if (this->numOfConsumed == this->numOfFilled) {
+            if (this->exception) {
+                std::rethrow_exception(this->exception);
+            }
+            return 0;
+        }
+
+        // Only this thread touches buffers that are filled.
+        current = &this->buffers[this->numOfConsumed % this->buffers.size()];
+    }
+
+    uint64_t len = std::min(count, current->len - this->readOffset);
+    memcpy(buf, current->data.data() + this->readOffset, len);
+    this->readOffset += len;
+
+    if (this->readOffset == current->len) {
+        UniqueLock lock(&this->mutex);
+        this->readOffset = 0;
+        this->numOfConsumed++;
+        pthread_cond_signal(&this->cond);
+    }
+
+    return len;
+}
+
+void PipelineReader::close() {
+    if (this->threadStarted) {
+        {
+            UniqueLock lock(&this->mutex);
+            this->stopping = true;
+            pthread_cond_signal(&this->cond);
+        }
+
+        pthread_join(this->thread, NULL);
+        this->threadStarted = false;
+    }
+
+    if (!this->isClosed) {
+        this->reader->close();
+        this->isClosed = true;
+    }
+
+    this->buffers.clear();
+}
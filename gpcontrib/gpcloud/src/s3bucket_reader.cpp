@@ -8,6 +8,12 @@ S3BucketReader::S3BucketReader() : Reader() {
 
     this->needNewReader = true;
     this->isFirstFile = true;
+
+    this->prefetching = false;
+    this->prefetchKeyIndex = 0;
+
+    this->readStats.reset(new S3ReadStats());
+    this->openUsec = 0;
 }
 
 S3BucketReader::~S3BucketReader() {
@@ -17,6 +23,10 @@ S3BucketReader::~S3BucketReader() {
 void S3BucketReader::open(const S3Params& params) {
     this->params = params;
 
+    this->readStats.reset(new S3ReadStats());
+    this->params.setReadStats(this->readStats);
+    this->openUsec = GetMonotonicUsec();
+
     this->keyIndex = s3ext_segid;  // we may change it in unit tests
 
     S3_CHECK_OR_DIE(this->s3Interface != NULL, S3RuntimeError, "s3Interface is NULL");
@@ -50,6 +60,76 @@ S3Params S3BucketReader::constructReaderParams(BucketContent& key) {
     return readerParams;
 }
 
+static void* PrefetchThreadFunc(void* data) {
+    MaskThreadSignals();
+
+    static_cast<S3BucketReader*>(data)->prefetchKeyHead();
+    return NULL;
+}
+
+void S3BucketReader::prefetchKeyHead() {
+    S3Url& s3Url = this->prefetchParams.getS3Url();
+    uint64_t keySize = this->prefetchParams.getKeySize();
+
+    try {
+        S3_CHECK_OR_DIE(!S3QueryIsAbortInProgress(), S3QueryAbort, "Prefetching is interrupted");
+
+        std::shared_ptr<S3KeyHead> head(new S3KeyHead(this->params.getMemoryContext()));
+
+        head->compressionType = this->s3Interface->checkCompressionType(s3Url);
+
+        // Fetch exactly the first range S3KeyReader is going to ask for.
+        uint64_t rangeSize = AdaptiveRangeSize(keySize, this->prefetchParams.getChunkSize(),
+                                               this->prefetchParams.getNumOfChunks());
+        uint64_t len = std::min(rangeSize, keySize);
+        if (len > 0) {
+            this->s3Interface->fetchData(0, head->data, len, s3Url);
+        }
+
+        this->prefetchedHead = head;
+    } catch (S3Exception& e) {
+        // Not fatal, the key will be fetched again when it is opened.
+        S3DEBUG("Failed to prefetch %s: %s", s3Url.getFullUrlForCurl().c_str(),
+                e.getMessage().c_str());
+        this->prefetchedHead.reset();
+    } catch (...) {
+        S3DEBUG("Failed to prefetch %s", s3Url.getFullUrlForCurl().c_str());
+        this->prefetchedHead.reset();
+    }
+}
+
+// Start fetching the head of the key after the one just opened, if there is one.
+void S3BucketReader::startPrefetch() {
+    if (!this->params.isPrefetch() || this->prefetching ||
+        this->keyIndex >= this->keyList.contents.size()) {
+        return;
+    }
+
+    this->prefetchKeyIndex = this->keyIndex;
+    this->prefetchParams = constructReaderParams(this->keyList.contents[this->keyIndex]);
+    this->prefetchedHead.reset();
+
+    if (pthread_create(&this->prefetchThread, NULL, PrefetchThreadFunc, this) == 0) {
+        this->prefetching = true;
+    } else {
+        S3DEBUG("Failed to start prefetching thread");
+    }
+}
+
+// Wait for the prefetching thread, and return the head it fetched, if any.
+std::shared_ptr<S3KeyHead> S3BucketReader::finishPrefetch() {
+    std::shared_ptr<S3KeyHead> head;
+
+    if (this->prefetching) {
+        pthread_join(this->prefetchThread, NULL);
+        this->prefetching = false;
+
+        head.swap(this->prefetchedHead);
+    }
+
+    return head;
+}
+
 uint64_t S3BucketReader::readWithoutHeaderLine(char* buf, uint64_t count) {
     char* current = NULL;
     char* end = NULL;
@@ -102,11 +182,25 @@ uint64_t S3BucketReader::read(char* buf, uint64_t count) {
                 S3DEBUG("Read finished for segment: %d", s3ext_segid);
                 return 0;
             }
+            bool prefetched = this->prefetching && this->prefetchKeyIndex == this->keyIndex;
+            std::shared_ptr<S3KeyHead> head = this->finishPrefetch();
+
             BucketContent& key = this->getNextKey();
 
-            this->upstreamReader->open(constructReaderParams(key));
+            S3Params readerParams = constructReaderParams(key);
+            if (prefetched && head) {
+                readerParams.setKeyHead(head);
+            }
+
+            this->upstreamReader->open(readerParams);
             this->needNewReader = false;
 
+            // Release the head before prefetching the next one, in case the reader didn't take it.
+            head.reset();
+            readerParams.setKeyHead(head);
+
+            this->startPrefetch();
+
             // ignore header line if it is not the first file
             if (hasHeader && !this->isFirstFile) {
                 readCount = readWithoutHeaderLine(buf, count);
@@ -129,11 +223,36 @@ uint64_t S3BucketReader::read(char* buf, uint64_t count) {
 }
 
 void S3BucketReader::close() {
+    this->finishPrefetch();
+
     if (this->upstreamReader != NULL) {
         this->upstreamReader->close();
         this->upstreamReader = NULL;
     }
 
+    if (this->readStats->keys > 0) {
+        double seconds = (GetMonotonicUsec() - this->openUsec) / 1000000.0;
+        double mbytes = this->readStats->bytes / (1024.0 * 1024.0);
+
+        S3INFO("Segment %d read %" PRIu64 " bytes from %" PRIu64
+               " keys in %.3f seconds (%.2f MB/s), fetched in %.3f thread-seconds, "
+               "waited %.3f seconds for data, %" PRIu64 " keys prefetched",
+               s3ext_segid, this->readStats->bytes, this->readStats->keys, seconds,
+               seconds > 0 ? mbytes / seconds : 0.0, this->readStats->fetchUsec / 1000000.0,
+               this->readStats->waitUsec / 1000000.0, this->readStats->prefetchedKeys);
+
+        const std::shared_ptr<PreAllocatedMemory>& prealloc =
+            this->params.getMemoryContext().prealloc;
+        if (prealloc) {
+            S3INFO("Segment %d used at most %zu of %zu chunk buffers, waited for one %" PRIu64
+                   " times",
+                   s3ext_segid, prealloc->getPeakUsed(), prealloc->getNumOfChunks(),
+                   prealloc->getNumOfWaits());
+        }
+
+        this->readStats.reset(new S3ReadStats());
+    }
+
     if (!this->keyList.contents.empty()) {
         this->keyList.contents.clear();
     }
@@ -3,12 +3,20 @@
 void S3CommonReader::open(const S3Params &params) {
     this->keyReader.setS3InterfaceService(s3InterfaceService);
 
-    S3CompressionType compressionType = s3InterfaceService->checkCompressionType(params.getS3Url());
+    // The compression type is known already if the beginning of the key was prefetched.
+    S3CompressionType compressionType =
+        params.getKeyHead() ? params.getKeyHead()->compressionType
+                            : s3InterfaceService->checkCompressionType(params.getS3Url());
 
     switch (compressionType) {
         case S3_COMPRESSION_DEFLATE:
         case S3_COMPRESSION_GZIP:
-            this->upstreamReader = &this->decompressReader;
+        case S3_COMPRESSION_ZSTD:
+        case S3_COMPRESSION_LZ4:
+            // Decompress on a thread of its own, concurrently with downloading and parsing.
+            this->upstreamReader = &this->pipelineReader;
+            this->pipelineReader.setReader(&this->decompressReader);
+            this->decompressReader.setCompressionType(compressionType);
             this->decompressReader.setReader(&this->keyReader);
             break;
         case S3_COMPRESSION_PLAIN:
@@ -127,6 +127,8 @@ S3Params InitConfig(const string& urlWithOptions) {
 
     params.setVerifyCert(s3Cfg.GetBool(configSection, "verifycert", "true"));
 
+    params.setPrefetch(s3Cfg.GetBool(configSection, "prefetch", "true"));
+
     string sse_type = s3Cfg.Get(configSection, "server_side_encryption", "");
     if (sse_type == "sse-s3") {
         params.setSSEType(SSE_S3);
@@ -1,5 +1,14 @@
 #include "s3key_reader.h"
 
+uint64_t AdaptiveRangeSize(uint64_t keySize, uint64_t chunkSize, uint64_t numOfChunks) {
+    if (numOfChunks == 0) {
+        return chunkSize;
+    }
+
+    uint64_t perThread = (keySize + numOfChunks - 1) / numOfChunks;
+    return std::min(chunkSize, std::max((uint64_t)S3_MIN_RANGE_SIZE, perThread));
+}
+
 // Return (offset, length) of next chunk to download,
 // or (fileSize, 0) if reach end of file.
 Range OffsetMgr::getNextOffset() {
@@ -29,6 +38,8 @@ ChunkBuffer::ChunkBuffer(const S3Url& s3Url, S3KeyReader& reader, const S3Memory
     status = ReadyToFill;
     eof = false;
     curChunkOffset = 0;
+    fetchUsec = 0;
+    waitUsec = 0;
     pthread_mutex_init(&this->statusMutex, NULL);
     pthread_cond_init(&this->statusCondVar, NULL);
 }
@@ -45,6 +56,8 @@ ChunkBuffer& ChunkBuffer::operator=(const ChunkBuffer& other) {
     this->curFileOffset = other.curFileOffset;
     this->curChunkOffset = other.curChunkOffset;
     this->chunkDataSize = other.chunkDataSize;
+    this->fetchUsec = other.fetchUsec;
+    this->waitUsec = other.waitUsec;
 
     return *this;
 }
@@ -59,8 +72,12 @@ uint64_t ChunkBuffer::read(char* buf, uint64_t len) {
     S3_CHECK_OR_DIE(!S3QueryIsAbortInProgress(), S3QueryAbort, "");
 
     UniqueLock statusLock(&this->statusMutex);
-    while (this->status != ReadyToRead) {
-        pthread_cond_wait(&this->statusCondVar, &this->statusMutex);
+    if (this->status != ReadyToRead) {
+        uint64_t startUsec = GetMonotonicUsec();
+        while (this->status != ReadyToRead) {
+            pthread_cond_wait(&this->statusCondVar, &this->statusMutex);
+        }
+        this->waitUsec += GetMonotonicUsec() - startUsec;
     }
 
     // Error is shared between all chunks.
@@ -118,6 +135,7 @@ uint64_t ChunkBuffer::fill() {
     uint64_t readLen = 0;
 
     if (leftLen != 0) {
+        uint64_t startUsec = GetMonotonicUsec();
         try {
             readLen = this->s3Interface->fetchData(offset, this->chunkData, leftLen, this->s3Url);
             if (readLen != leftLen) {
@@ -130,6 +148,7 @@ uint64_t ChunkBuffer::fill() {
             S3DEBUG("Failed to fetch expected data from S3");
             this->setSharedError(true);
         }
+        this->fetchUsec += GetMonotonicUsec() - startUsec;
     }
 
     if (offset + leftLen >= offsetMgr.getKeySize()) {
@@ -144,6 +163,23 @@ uint64_t ChunkBuffer::fill() {
     return (this->isError()) ? -1 : readLen;
 }
 
+// Only valid before the download thread of this buffer starts.
+bool ChunkBuffer::adoptData(S3VectorUInt8& data) {
+    if (this->status != ReadyToFill || this->chunkDataSize == 0 ||
+        data.size() != this->chunkDataSize) {
+        return false;
+    }
+
+    this->chunkData.swap(data);
+
+    if (this->curFileOffset + this->chunkDataSize >= offsetMgr.getKeySize()) {
+        this->eof = true;
+    }
+
+    this->status = ReadyToRead;
+    return true;
+}
+
 static void* DownloadThreadFunc(void* data) {
     MaskThreadSignals();
 
@@ -151,7 +187,9 @@ static void* DownloadThreadFunc(void* data) {
 
     uint64_t filledSize = 0;
     S3DEBUG("Downloading thread starts");
-    do {
+
+    // the buffer may have been filled up to the end of key with prefetched data already.
+    while (!buffer->isEOF()) {
         if (S3QueryIsAbortInProgress()) {
             S3INFO("Downloading thread is interrupted");
 
@@ -176,7 +214,7 @@ static void* DownloadThreadFunc(void* data) {
                 S3DEBUG("Size of filled data is %" PRIu64, filledSize);
             }
         }
-    } while (!buffer->isEOF());
+    }
     S3DEBUG("Downloading thread ended");
     return NULL;
 }
@@ -189,19 +227,34 @@ void S3KeyReader::open(const S3Params& params) {
     this->numOfChunks = params.getNumOfChunks();
     S3_CHECK_OR_DIE(this->numOfChunks > 0, S3RuntimeError, "numOfChunks must not be zero");
 
-    this->offsetMgr.setKeySize(params.getKeySize());
-    this->offsetMgr.setChunkSize(params.getChunkSize());
-
     S3_CHECK_OR_DIE(params.getChunkSize() > 0, S3RuntimeError,
                     "chunk size must be greater than zero");
 
-    this->chunkBuffers.reserve(this->numOfChunks);
+    // Split the key into as many ranges as there are threads, within limits, and start no more
+    // threads than there are ranges.
+    uint64_t keySize = params.getKeySize();
+    uint64_t rangeSize = AdaptiveRangeSize(keySize, params.getChunkSize(), this->numOfChunks);
+    uint64_t numOfRanges = (keySize + rangeSize - 1) / rangeSize;
+    uint64_t numOfBuffers = std::max((uint64_t)1, std::min(this->numOfChunks, numOfRanges));
+
+    this->offsetMgr.setKeySize(keySize);
+    this->offsetMgr.setChunkSize(rangeSize);
+
+    this->readStats = params.getReadStats();
 
-    for (uint64_t i = 0; i < this->numOfChunks; i++) {
+    this->chunkBuffers.reserve(numOfBuffers);
+
+    for (uint64_t i = 0; i < numOfBuffers; i++) {
         this->chunkBuffers.emplace_back(params.getS3Url(), *this, params.getMemoryContext());
     }
 
-    for (uint64_t i = 0; i < this->numOfChunks; i++) {
+    // The first range may have been downloaded while the previous key was being read.
+    const std::shared_ptr<S3KeyHead>& keyHead = params.getKeyHead();
+    if (keyHead) {
+        this->usedKeyHead = this->chunkBuffers[0].adoptData(keyHead->data);
+    }
+
+    for (uint64_t i = 0; i < numOfBuffers; i++) {
         this->chunkBuffers[i].setS3InterfaceService(this->s3Interface);
 
         pthread_t thread;
@@ -229,7 +282,7 @@ uint64_t S3KeyReader::read(char* buf, uint64_t count) {
             return 0;
         }
 
-        ChunkBuffer& buffer = chunkBuffers[this->curReadingChunk % this->numOfChunks];
+        ChunkBuffer& buffer = chunkBuffers[this->curReadingChunk % this->chunkBuffers.size()];
 
         readLen = buffer.read(buf, count);
 
@@ -264,11 +317,13 @@ void S3KeyReader::reset() {
     this->sharedError = false;
     this->curReadingChunk = 0;
     this->transferredKeyLen = 0;
+    this->usedKeyHead = false;
 
     this->offsetMgr.reset();
 
     this->chunkBuffers.clear();
     this->threads.clear();
+    this->readStats.reset();
 
     this->hasEol = false;
     this->eolAppended = false;
@@ -296,5 +351,17 @@ void S3KeyReader::close() {
         this->threads[i] = 0;
     }
 
+    if (this->readStats && !this->chunkBuffers.empty()) {
+        this->readStats->bytes += this->transferredKeyLen;
+        this->readStats->keys++;
+        if (this->usedKeyHead) {
+            this->readStats->prefetchedKeys++;
+        }
+        for (uint64_t i = 0; i < this->chunkBuffers.size(); i++) {
+            this->readStats->fetchUsec += this->chunkBuffers[i].getFetchUsec();
+            this->readStats->waitUsec += this->chunkBuffers[i].getWaitUsec();
+        }
+    }
+
     this->reset();
 }
@@ -311,3 +311,317 @@ TEST_F(DecompressReaderTest, AbleToDecompressWithIncorrectEncodedStream) {
 
     EXPECT_THROW(decompressReader.read(outputBuffer, sizeof(outputBuffer)), S3RuntimeError);
 }
+
+// ================== LZ4 and zstd ===================
+
+// The text compressed in lz4LinkedBlocks.
+static string LZ4TestText() {
+    string text;
+    char line[64];
+    for (int i = 0; i < 1500; i++) {
+        snprintf(line, sizeof(line), "line %d of the quick brown fox jumps over the lazy dog\n",
+                 i % 7);
+        text += line;
+    }
+    return text;
+}
+
+// "lz4 -B4 -BD -BX --content-size" of LZ4TestText(): two linked blocks of 64KB at most, with
+// block and content checksums.
+static const uint8_t lz4LinkedBlocks[] = {
+    0x04, 0x22, 0x4d, 0x18, 0x5c, 0x40, 0x68, 0x3c, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x46, 0x5f, 0x01, 0x00, 0x00, 0xf1, 0x19, 0x6c, 0x69, 0x6e,
+    0x65, 0x20, 0x30, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x71,
+    0x75, 0x69, 0x63, 0x6b, 0x20, 0x62, 0x72, 0x6f, 0x77, 0x6e, 0x20, 0x66,
+    0x6f, 0x78, 0x20, 0x6a, 0x75, 0x6d, 0x70, 0x73, 0x20, 0x6f, 0x76, 0x65,
+    0x72, 0x1f, 0x00, 0x91, 0x6c, 0x61, 0x7a, 0x79, 0x20, 0x64, 0x6f, 0x67,
+    0x0a, 0x36, 0x00, 0x1f, 0x31, 0x36, 0x00, 0x22, 0x1f, 0x32, 0x36, 0x00,
+    0x22, 0x1f, 0x33, 0x36, 0x00, 0x22, 0x1f, 0x34, 0x36, 0x00, 0x22, 0x1f,
+    0x35, 0x36, 0x00, 0x22, 0x1f, 0x36, 0x36, 0x00, 0x22, 0x0f, 0x7a, 0x01,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0x68, 0x50, 0x20, 0x6a, 0x75, 0x6d, 0x70, 0x44, 0x3d,
+    0xe3, 0x47, 0x4a, 0x00, 0x00, 0x00, 0x0f, 0xde, 0xff, 0x06, 0x0f, 0x72,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x73, 0x50, 0x20, 0x64, 0x6f, 0x67, 0x0a, 0xac, 0xa9, 0x0d, 0xa8,
+    0x00, 0x00, 0x00, 0x00, 0xf0, 0xf6, 0xfd, 0xea,
+};
+
+// "lz4" of "The quick brown fox jumps over the lazy dog", which is stored uncompressed.
+static const uint8_t lz4SmallFrame[] = {
+    0x04, 0x22, 0x4d, 0x18, 0x64, 0x40, 0xa7, 0x2b, 0x00, 0x00, 0x80, 0x54,
+    0x68, 0x65, 0x20, 0x71, 0x75, 0x69, 0x63, 0x6b, 0x20, 0x62, 0x72, 0x6f,
+    0x77, 0x6e, 0x20, 0x66, 0x6f, 0x78, 0x20, 0x6a, 0x75, 0x6d, 0x70, 0x73,
+    0x20, 0x6f, 0x76, 0x65, 0x72, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6c, 0x61,
+    0x7a, 0x79, 0x20, 0x64, 0x6f, 0x67, 0x00, 0x00, 0x00, 0x00, 0xde, 0xa4,
+    0x5e, 0xe8,
+};
+
+class LZ4DecompressReaderTest : public testing::Test {
+   protected:
+    virtual void SetUp() {
+        S3_ZIP_DECOMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
+
+        this->bufReader.setChunkSize(1024 * 1024 * 64);
+        decompressReader.setReader(&bufReader);
+        decompressReader.setCompressionType(S3_COMPRESSION_LZ4);
+    }
+
+    virtual void TearDown() {
+        decompressReader.close();
+
+        S3_ZIP_DECOMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
+    }
+
+    void setData(const vector<uint8_t> &data) {
+        bufReader.setData(data.data(), data.size());
+    }
+
+    string readAll() {
+        string result;
+        char buf[1000];
+        uint64_t count;
+        while ((count = decompressReader.read(buf, sizeof(buf))) != 0) {
+            result.append(buf, count);
+        }
+        return result;
+    }
+
+    DecompressReader decompressReader;
+    MockBufferReader bufReader;
+};
+
+TEST_F(LZ4DecompressReaderTest, AbleToDecompressUncompressedBlock) {
+    setData(vector<uint8_t>(lz4SmallFrame, lz4SmallFrame + sizeof(lz4SmallFrame)));
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_EQ("The quick brown fox jumps over the lazy dog", readAll());
+}
+
+TEST_F(LZ4DecompressReaderTest, AbleToDecompressLinkedBlocksWithChecksums) {
+    setData(vector<uint8_t>(lz4LinkedBlocks, lz4LinkedBlocks + sizeof(lz4LinkedBlocks)));
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_EQ(LZ4TestText(), readAll());
+}
+
+TEST_F(LZ4DecompressReaderTest, AbleToDecompressFragmentalCompressedData) {
+    // Headers and blocks arrive in pieces of 10 bytes, and are decoded 10 bytes at a time.
+    S3_ZIP_DECOMPRESS_CHUNKSIZE = 10;
+    decompressReader.resizeDecompressReaderBuffer(S3_ZIP_DECOMPRESS_CHUNKSIZE);
+
+    setData(vector<uint8_t>(lz4LinkedBlocks, lz4LinkedBlocks + sizeof(lz4LinkedBlocks)));
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_EQ(LZ4TestText(), readAll());
+}
+
+TEST_F(LZ4DecompressReaderTest, AbleToDecompressConcatenatedAndSkippableFrames) {
+    vector<uint8_t> data(lz4SmallFrame, lz4SmallFrame + sizeof(lz4SmallFrame));
+
+    // a skippable frame of 3 bytes
+    const uint8_t skippable[] = {0x50, 0x2a, 0x4d, 0x18, 0x03, 0x00, 0x00, 0x00, 'a', 'b', 'c'};
+    data.insert(data.end(), skippable, skippable + sizeof(skippable));
+
+    data.insert(data.end(), lz4SmallFrame, lz4SmallFrame + sizeof(lz4SmallFrame));
+
+    setData(data);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_EQ(
+        "The quick brown fox jumps over the lazy dog"
+        "The quick brown fox jumps over the lazy dog",
+        readAll());
+}
+
+TEST_F(LZ4DecompressReaderTest, ThrowExceptionForTruncatedStream) {
+    setData(vector<uint8_t>(lz4LinkedBlocks, lz4LinkedBlocks + sizeof(lz4LinkedBlocks) - 20));
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_THROW(readAll(), S3RuntimeError);
+}
+
+TEST_F(LZ4DecompressReaderTest, ThrowExceptionForCorruptedBlock) {
+    vector<uint8_t> data(lz4LinkedBlocks, lz4LinkedBlocks + sizeof(lz4LinkedBlocks));
+    data[sizeof(lz4LinkedBlocks) / 2] ^= 0x55;
+
+    setData(data);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_THROW(readAll(), S3RuntimeError);
+}
+
+TEST_F(LZ4DecompressReaderTest, ThrowExceptionForCorruptedHeader) {
+    vector<uint8_t> data(lz4SmallFrame, lz4SmallFrame + sizeof(lz4SmallFrame));
+    data[5] ^= 0x30;  // block maximum size
+
+    setData(data);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_THROW(readAll(), S3RuntimeError);
+}
+
+TEST_F(LZ4DecompressReaderTest, ThrowExceptionForNotLZ4Data) {
+    const char hello[] = "abcdefghigklmnopqrstuvwxyz";
+    setData(vector<uint8_t>(hello, hello + sizeof(hello)));
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_THROW(readAll(), S3RuntimeError);
+}
+
+// Recompute the header checksum of a frame at data[0] whose header is headerLen bytes long.
+static void LZ4FixHeaderChecksum(vector<uint8_t> &data, uint64_t headerLen) {
+    data[4 + headerLen - 1] = (XXH32((const char *)data.data() + 4, headerLen - 1, 0) >> 8) & 0xFF;
+}
+
+TEST_F(LZ4DecompressReaderTest, ThrowExceptionForContentChecksumMismatch) {
+    // The block has no checksum of its own, only the content checksum catches this.
+    vector<uint8_t> data(lz4SmallFrame, lz4SmallFrame + sizeof(lz4SmallFrame));
+    data[20] ^= 0x01;
+
+    setData(data);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_THROW(readAll(), S3RuntimeError);
+}
+
+TEST_F(LZ4DecompressReaderTest, ThrowExceptionForContentSizeMismatch) {
+    // The header of lz4LinkedBlocks has an 8 bytes content size, at offset 6.
+    vector<uint8_t> data(lz4LinkedBlocks, lz4LinkedBlocks + sizeof(lz4LinkedBlocks));
+    data[6] += 1;
+    LZ4FixHeaderChecksum(data, 11);
+
+    setData(data);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_THROW(readAll(), S3RuntimeError);
+}
+
+TEST_F(LZ4DecompressReaderTest, ThrowExceptionForUnsupportedVersion) {
+    vector<uint8_t> data(lz4SmallFrame, lz4SmallFrame + sizeof(lz4SmallFrame));
+    data[4] = 0xa4;  // version 2
+    LZ4FixHeaderChecksum(data, 3);
+
+    setData(data);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_THROW(readAll(), S3RuntimeError);
+}
+
+TEST_F(LZ4DecompressReaderTest, ThrowExceptionForTooLargeBlock) {
+    // 64KB + 1 bytes, stored uncompressed, in a frame of 64KB blocks.
+    vector<uint8_t> data(lz4SmallFrame, lz4SmallFrame + sizeof(lz4SmallFrame));
+    data[7] = 0x01;
+    data[8] = 0x00;
+    data[9] = 0x01;
+    data[10] = 0x80;
+
+    setData(data);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_THROW(readAll(), S3RuntimeError);
+}
+
+TEST_F(LZ4DecompressReaderTest, ThrowExceptionForMatchBeforeStartOfData) {
+    // A frame of independent 64KB blocks without checksums, with one block of a literal "a"
+    // and a match at offset 2.
+    const uint8_t frame[] = {0x04, 0x22, 0x4d, 0x18, 0x60, 0x40, 0x00, 0x04, 0x00, 0x00,
+                             0x00, 0x10, 'a',  0x02, 0x00, 0x00, 0x00, 0x00, 0x00};
+    vector<uint8_t> data(frame, frame + sizeof(frame));
+    LZ4FixHeaderChecksum(data, 3);
+
+    setData(data);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_THROW(readAll(), S3RuntimeError);
+}
+
+TEST_F(LZ4DecompressReaderTest, ThrowExceptionForTruncatedSkippableFrame) {
+    vector<uint8_t> data(lz4SmallFrame, lz4SmallFrame + sizeof(lz4SmallFrame));
+
+    // a skippable frame of 100 bytes, with 3 of them
+    const uint8_t skippable[] = {0x50, 0x2a, 0x4d, 0x18, 0x64, 0x00, 0x00, 0x00, 'a', 'b', 'c'};
+    data.insert(data.end(), skippable, skippable + sizeof(skippable));
+
+    setData(data);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_THROW(readAll(), S3RuntimeError);
+}
+
+TEST(XXH32Stream, MatchesOneShotHash) {
+    string text = LZ4TestText();
+
+    // Pieces of every size from 1 to 40 bytes, so that they straddle the 16 bytes rounds.
+    for (uint64_t piece = 1; piece <= 40; piece++) {
+        XXH32Stream stream;
+        stream.reset(0);
+        for (uint64_t pos = 0; pos < text.size(); pos += piece) {
+            stream.update(text.data() + pos, std::min(piece, (uint64_t)text.size() - pos));
+        }
+        EXPECT_EQ(XXH32(text.data(), text.size(), 0), stream.digest());
+    }
+
+    // Inputs shorter than one round.
+    XXH32Stream stream;
+    stream.reset(0);
+    stream.update(text.data(), 5);
+    EXPECT_EQ(XXH32(text.data(), 5, 0), stream.digest());
+}
+
+#ifdef USE_ZSTD
+TEST_F(LZ4DecompressReaderTest, AbleToDecompressZstd) {
+    string text = LZ4TestText();
+    vector<uint8_t> data(ZSTD_compressBound(text.size()));
+    size_t len = ZSTD_compress(data.data(), data.size(), text.data(), text.size(), 1);
+    ASSERT_FALSE(ZSTD_isError(len));
+    data.resize(len);
+
+    // small buffers, so that the decoder has output left over with no input left.
+    S3_ZIP_DECOMPRESS_CHUNKSIZE = 1000;
+    decompressReader.resizeDecompressReaderBuffer(S3_ZIP_DECOMPRESS_CHUNKSIZE);
+
+    decompressReader.setCompressionType(S3_COMPRESSION_ZSTD);
+    setData(data);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_EQ(text, readAll());
+}
+
+TEST_F(LZ4DecompressReaderTest, ThrowExceptionForTruncatedZstd) {
+    string text = LZ4TestText();
+    vector<uint8_t> data(ZSTD_compressBound(text.size()));
+    size_t len = ZSTD_compress(data.data(), data.size(), text.data(), text.size(), 1);
+    ASSERT_FALSE(ZSTD_isError(len));
+    data.resize(len - 10);
+
+    decompressReader.setCompressionType(S3_COMPRESSION_ZSTD);
+    setData(data);
+    decompressReader.open(S3Params("s3://abc/def"));
+
+    EXPECT_THROW(readAll(), S3RuntimeError);
+}
+#endif
@@ -0,0 +1,144 @@
+#include "pipeline_reader.cpp"
+#include "gtest/gtest.h"
+
+class MockPipelineUpstreamReader : public Reader {
+   public:
+    MockPipelineUpstreamReader() : offset(0), chunkSize(0), failAt(0), opened(false) {
+    }
+
+    void open(const S3Params &params) {
+        this->opened = true;
+    }
+    void close() {
+        this->opened = false;
+    }
+
+    uint64_t read(char *buf, uint64_t count) {
+        if ((this->failAt > 0) && (this->offset >= this->failAt)) {
+            S3_DIE(S3RuntimeError, "upstream failure");
+        }
+
+        uint64_t size = std::min(count, (uint64_t)(this->data.size() - this->offset));
+        if (this->chunkSize > 0) {
+            size = std::min(size, this->chunkSize);
+        }
+
+        memcpy(buf, this->data.data() + this->offset, size);
+        this->offset += size;
+        return size;
+    }
+
+    string data;
+    uint64_t offset;
+    uint64_t chunkSize;  // 0 means no limit
+    uint64_t failAt;     // throw once this many bytes are read, 0 means never
+    bool opened;
+};
+
+class PipelineReaderTest : public testing::Test {
+   protected:
+    virtual void SetUp() {
+        S3_ZIP_DECOMPRESS_CHUNKSIZE = 100;
+
+        for (int i = 0; i < 1000; i++) {
+            upstream.data.append(std::to_string((long long)i)).append(",");
+        }
+
+        pipelineReader.setReader(&upstream);
+    }
+
+    virtual void TearDown() {
+        pipelineReader.close();
+
+        S3_ZIP_DECOMPRESS_CHUNKSIZE = S3_ZIP_DEFAULT_CHUNKSIZE;
+    }
+
+    string readAll(uint64_t bufSize) {
+        string result;
+        vector<char> buf(bufSize);
+        uint64_t count;
+
+        while ((count = pipelineReader.read(buf.data(), bufSize)) > 0) {
+            result.append(buf.data(), count);
+        }
+
+        return result;
+    }
+
+    MockPipelineUpstreamReader upstream;
+    PipelineReader pipelineReader;
+};
+
+TEST_F(PipelineReaderTest, OpenAndCloseUpstream) {
+    pipelineReader.open(S3Params("s3://abc/def"));
+    EXPECT_TRUE(upstream.opened);
+
+    pipelineReader.close();
+    EXPECT_FALSE(upstream.opened);
+}
+
+TEST_F(PipelineReaderTest, ReadAllWithSmallReadSize) {
+    pipelineReader.open(S3Params("s3://abc/def"));
+    EXPECT_EQ(upstream.data, readAll(7));
+    EXPECT_EQ(0, pipelineReader.read(NULL, 0));
+}
+
+TEST_F(PipelineReaderTest, ReadAllWithLargeReadSize) {
+    pipelineReader.open(S3Params("s3://abc/def"));
+    EXPECT_EQ(upstream.data, readAll(1000));
+}
+
+TEST_F(PipelineReaderTest, ReadAllWithFragmentalUpstream) {
+    upstream.chunkSize = 3;
+
+    pipelineReader.open(S3Params("s3://abc/def"));
+    EXPECT_EQ(upstream.data, readAll(64));
+}
+
+TEST_F(PipelineReaderTest, ReadEmptyUpstream) {
+    upstream.data.clear();
+
+    pipelineReader.open(S3Params("s3://abc/def"));
+    EXPECT_EQ("", readAll(64));
+}
+
+TEST_F(PipelineReaderTest, ThrowUpstreamExceptionAfterDataBeforeIt) {
+    upstream.failAt = 1000;
+
+    pipelineReader.open(S3Params("s3://abc/def"));
+
+    string result;
+    char buf[64];
+    uint64_t count;
+
+    EXPECT_THROW(
+        {
+            while ((count = pipelineReader.read(buf, sizeof(buf))) > 0) {
+                result.append(buf, count);
+            }
+        },
+        S3RuntimeError);
+
+    EXPECT_EQ(upstream.data.substr(0, 1000), result);
+}
+
+TEST_F(PipelineReaderTest, CloseWhenAllBuffersAreFilled) {
+    pipelineReader.open(S3Params("s3://abc/def"));
+
+    char buf[10];
+    EXPECT_EQ(10, pipelineReader.read(buf, sizeof(buf)));
+
+    // The pipeline thread is waiting for free buffers, close() must not hang.
+    pipelineReader.close();
+    EXPECT_FALSE(upstream.opened);
+}
+
+TEST_F(PipelineReaderTest, ReopenAfterClose) {
+    pipelineReader.open(S3Params("s3://abc/def"));
+    EXPECT_EQ(upstream.data, readAll(64));
+    pipelineReader.close();
+
+    upstream.offset = 0;
+    pipelineReader.open(S3Params("s3://abc/def"));
+    EXPECT_EQ(upstream.data, readAll(64));
+}
@@ -285,3 +285,106 @@ TEST_F(S3BucketReaderTest, ReadBucketFileWithHeaderAndFuzyMatch) {
     eolString[0] = '\n';
     eolString[1] = '\0';
 }
+
+class MockFetchKeyHead {
+   public:
+    MockFetchKeyHead(uint64_t len) : len(len) {
+    }
+
+    uint64_t operator()(uint64_t offset, S3VectorUInt8 &data, uint64_t len, const S3Url &s3Url) {
+        data.resize(this->len);
+        return this->len;
+    }
+
+   private:
+    uint64_t len;
+};
+
+TEST_F(S3BucketReaderTest, ReadBucketPrefetchesNextKey) {
+    ListBucketResult result;
+    result.contents.emplace_back("foo", 456);
+    result.contents.emplace_back("bar", 200);
+
+    S3Params params("https://s3-us-east-2.amazonaws.com/s3test.pivotal.io/whatever");
+    params.setNumOfChunks(2);
+    params.setChunkSize(64);
+    params.setPrefetch(true);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+
+    // only "bar" is prefetched, and only its first range
+    EXPECT_CALL(s3Interface, checkCompressionType(_))
+        .Times(1)
+        .WillOnce(Return(S3_COMPRESSION_GZIP));
+    EXPECT_CALL(s3Interface, fetchData(0, _, 64, _)).WillOnce(Invoke(MockFetchKeyHead(64)));
+
+    vector<std::shared_ptr<S3KeyHead>> heads;
+    EXPECT_CALL(s3Reader, open(_))
+        .Times(2)
+        .WillRepeatedly(Invoke([&heads](const S3Params &p) { heads.push_back(p.getKeyHead()); }));
+
+    EXPECT_CALL(s3Reader, read(_, _))
+        .Times(4)
+        .WillOnce(Return(256))
+        .WillOnce(Return(0))
+        .WillOnce(Return(200))
+        .WillOnce(Return(0));
+
+    s3ext_segid = 0;
+    s3ext_segnum = 1;
+
+    bucketReader->open(params);
+    bucketReader->setUpstreamReader(&s3Reader);
+
+    EXPECT_EQ((uint64_t)256, bucketReader->read(buf, sizeof(buf)));
+    EXPECT_EQ((uint64_t)200, bucketReader->read(buf, sizeof(buf)));
+    EXPECT_EQ((uint64_t)0, bucketReader->read(buf, sizeof(buf)));
+
+    ASSERT_EQ((uint64_t)2, heads.size());
+    EXPECT_FALSE(heads[0]);
+    ASSERT_TRUE(heads[1] != NULL);
+    EXPECT_EQ(S3_COMPRESSION_GZIP, heads[1]->compressionType);
+    EXPECT_EQ((uint64_t)64, heads[1]->data.size());
+}
+
+TEST_F(S3BucketReaderTest, ReadBucketFallsBackIfPrefetchFails) {
+    ListBucketResult result;
+    result.contents.emplace_back("foo", 456);
+    result.contents.emplace_back("bar", 200);
+
+    S3Params params("https://s3-us-east-2.amazonaws.com/s3test.pivotal.io/whatever");
+    params.setNumOfChunks(2);
+    params.setChunkSize(64);
+    params.setPrefetch(true);
+
+    EXPECT_CALL(s3Interface, listBucket(_)).Times(1).WillOnce(Return(result));
+    EXPECT_CALL(s3Interface, checkCompressionType(_))
+        .Times(1)
+        .WillOnce(Throw(S3ConnectionError("")));
+
+    vector<std::shared_ptr<S3KeyHead>> heads;
+    EXPECT_CALL(s3Reader, open(_))
+        .Times(2)
+        .WillRepeatedly(Invoke([&heads](const S3Params &p) { heads.push_back(p.getKeyHead()); }));
+
+    EXPECT_CALL(s3Reader, read(_, _))
+        .Times(4)
+        .WillOnce(Return(256))
+        .WillOnce(Return(0))
+        .WillOnce(Return(200))
+        .WillOnce(Return(0));
+
+    s3ext_segid = 0;
+    s3ext_segnum = 1;
+
+    bucketReader->open(params);
+    bucketReader->setUpstreamReader(&s3Reader);
+
+    EXPECT_EQ((uint64_t)256, bucketReader->read(buf, sizeof(buf)));
+    EXPECT_EQ((uint64_t)200, bucketReader->read(buf, sizeof(buf)));
+    EXPECT_EQ((uint64_t)0, bucketReader->read(buf, sizeof(buf)));
+
+    ASSERT_EQ((uint64_t)2, heads.size());
+    EXPECT_FALSE(heads[0]);
+    EXPECT_FALSE(heads[1]);
+}
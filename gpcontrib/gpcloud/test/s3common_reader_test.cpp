@@ -45,8 +45,21 @@ TEST_F(S3CommonReaderTest, OpenGZip) {
     params.setChunkSize(1024 * 1024 * 2);
     this->open(params);
 
-    ASSERT_EQ(this->upstreamReader, &this->decompressReader);
-    ASSERT_TRUE(NULL != dynamic_cast<DecompressReader *>(this->upstreamReader));
+    ASSERT_EQ(this->upstreamReader, &this->pipelineReader);
+    ASSERT_EQ(this->pipelineReader.getReader(), &this->decompressReader);
+    ASSERT_EQ(S3_COMPRESSION_GZIP, this->decompressReader.getCompressionType());
+}
+
+TEST_F(S3CommonReaderTest, OpenLZ4) {
+    EXPECT_CALL(mockS3Interface, checkCompressionType(_)).WillOnce(Return(S3_COMPRESSION_LZ4));
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setChunkSize(1024 * 1024 * 2);
+    this->open(params);
+
+    ASSERT_EQ(this->upstreamReader, &this->pipelineReader);
+    ASSERT_EQ(this->pipelineReader.getReader(), &this->decompressReader);
+    ASSERT_EQ(S3_COMPRESSION_LZ4, this->decompressReader.getCompressionType());
 }
 
 TEST_F(S3CommonReaderTest, OpenPlain) {
@@ -35,6 +35,7 @@ TEST(Config, Basic) {
 
     EXPECT_TRUE(params.isAutoCompress());
     EXPECT_TRUE(params.isVerifyCert());
+    EXPECT_TRUE(params.isPrefetch());
 
     EXPECT_EQ(SSE_S3, params.getSSEType());
 
@@ -73,6 +74,7 @@ TEST(Config, SpecialSwitches) {
 
     EXPECT_TRUE(params.isDebugCurl());
     EXPECT_FALSE(params.isAutoCompress());
+    EXPECT_FALSE(params.isPrefetch());
 }
 
 TEST(Config, SectionExist) {
@@ -414,6 +414,34 @@ TEST_F(S3InterfaceServiceTest, checkItsGzipCompressed) {
     EXPECT_EQ(S3_COMPRESSION_GZIP, this->checkCompressionType(s3Url));
 }
 
+TEST_F(S3InterfaceServiceTest, checkItsZstdCompressed) {
+    vector<uint8_t> raw;
+    raw.resize(4);
+    raw[0] = 0x28;
+    raw[1] = 0xb5;
+    raw[2] = 0x2f;
+    raw[3] = 0xfd;
+    Response response(RESPONSE_OK, raw);
+    EXPECT_CALL(mockRESTfulService, get(_, _)).WillOnce(Return(response));
+
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever");
+    EXPECT_EQ(S3_COMPRESSION_ZSTD, this->checkCompressionType(s3Url));
+}
+
+TEST_F(S3InterfaceServiceTest, checkItsLZ4Compressed) {
+    vector<uint8_t> raw;
+    raw.resize(4);
+    raw[0] = 0x04;
+    raw[1] = 0x22;
+    raw[2] = 0x4d;
+    raw[3] = 0x18;
+    Response response(RESPONSE_OK, raw);
+    EXPECT_CALL(mockRESTfulService, get(_, _)).WillOnce(Return(response));
+
+    S3Url s3Url("https://s3-us-west-2.amazonaws.com/s3test.pivotal.io/whatever");
+    EXPECT_EQ(S3_COMPRESSION_LZ4, this->checkCompressionType(s3Url));
+}
+
 TEST_F(S3InterfaceServiceTest, checkItsNotCompressed) {
     vector<uint8_t> raw;
     raw.resize(4);
@@ -847,3 +847,174 @@ TEST(ChunkBuffer, ChunkBufferOperatorEqual) {
 
     EXPECT_EQ(ReadyToFill, buf1.getStatus());
 }
+
+TEST(AdaptiveRangeSize, SpreadKeyOverThreads) {
+    const uint64_t MB = 1024 * 1024;
+
+    // small keys are not split into ranges smaller than the minimum
+    EXPECT_EQ(8 * MB, AdaptiveRangeSize(1 * MB, 64 * MB, 4));
+    EXPECT_EQ(8 * MB, AdaptiveRangeSize(0, 64 * MB, 4));
+
+    // mid-size keys are spread over all threads
+    EXPECT_EQ(10 * MB, AdaptiveRangeSize(40 * MB, 64 * MB, 4));
+
+    // large keys are read in ranges of chunk size
+    EXPECT_EQ(64 * MB, AdaptiveRangeSize(1024 * MB, 64 * MB, 4));
+    EXPECT_EQ((uint64_t)64, AdaptiveRangeSize(255, 64, 8));
+}
+
+TEST_F(S3KeyReaderTest, MTReadMidSizeKeyInSmallerRanges) {
+    const uint64_t MB = 1024 * 1024;
+
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(4);
+    params.setKeySize(20 * MB);
+    params.setChunkSize(64 * MB);
+
+    EXPECT_CALL(s3Interface, fetchData(0, _, 8 * MB, _))
+        .WillOnce(Invoke(MockFetchData(8 * MB, 8 * MB)));
+    EXPECT_CALL(s3Interface, fetchData(8 * MB, _, 8 * MB, _))
+        .WillOnce(Invoke(MockFetchData(8 * MB, 8 * MB)));
+    EXPECT_CALL(s3Interface, fetchData(16 * MB, _, 4 * MB, _))
+        .WillOnce(Invoke(MockFetchData(4 * MB, 4 * MB)));
+
+    this->open(params);
+
+    // three ranges, so only three threads
+    EXPECT_EQ((uint64_t)3, this->getThreads().size());
+    EXPECT_EQ((uint64_t)8 * MB, this->getOffsetMgr().getChunkSize());
+
+    vector<char> buf(MB);
+    uint64_t total = 0;
+    uint64_t readLen;
+    while ((readLen = this->read(buf.data(), buf.size())) != 0) {
+        total += readLen;
+    }
+
+    // plus the appended EOL
+    EXPECT_EQ(20 * MB + 1, total);
+}
+
+TEST_F(S3KeyReaderTest, MTReadWithPrefetchedKeyHead) {
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(2);
+    params.setKeySize(255);
+    params.setChunkSize(64);
+
+    std::shared_ptr<S3KeyHead> head(new S3KeyHead(params.getMemoryContext()));
+    head->data.resize(64);
+    params.setKeyHead(head);
+
+    std::shared_ptr<S3ReadStats> stats(new S3ReadStats());
+    params.setReadStats(stats);
+
+    EXPECT_CALL(s3Interface, fetchData(0, _, _, _)).Times(0);
+    EXPECT_CALL(s3Interface, fetchData(64, _, _, _)).WillOnce(Invoke(MockFetchData(64, 64)));
+    EXPECT_CALL(s3Interface, fetchData(128, _, _, _)).WillOnce(Invoke(MockFetchData(64, 64)));
+    EXPECT_CALL(s3Interface, fetchData(192, _, _, _)).WillOnce(Invoke(MockFetchData(63, 64)));
+
+    this->open(params);
+    EXPECT_TRUE(this->isUsedKeyHead());
+
+    EXPECT_EQ((uint64_t)64, this->read(buffer, 127));
+    EXPECT_EQ((uint64_t)64, this->read(buffer, 127));
+    EXPECT_EQ((uint64_t)64, this->read(buffer, 127));
+    EXPECT_EQ((uint64_t)63, this->read(buffer, 127));
+    EXPECT_EQ((uint64_t)1, this->read(buffer, 127));
+    EXPECT_EQ((uint64_t)0, this->read(buffer, 127));
+
+    this->close();
+
+    EXPECT_EQ((uint64_t)255, stats->bytes);
+    EXPECT_EQ((uint64_t)1, stats->keys);
+    EXPECT_EQ((uint64_t)1, stats->prefetchedKeys);
+}
+
+TEST_F(S3KeyReaderTest, ReadWholeKeyFromPrefetchedKeyHead) {
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(4);
+    params.setKeySize(50);
+    params.setChunkSize(64);
+
+    std::shared_ptr<S3KeyHead> head(new S3KeyHead(params.getMemoryContext()));
+    head->data.resize(50);
+    params.setKeyHead(head);
+
+    EXPECT_CALL(s3Interface, fetchData(_, _, _, _)).Times(0);
+
+    this->open(params);
+    EXPECT_TRUE(this->isUsedKeyHead());
+    EXPECT_EQ((uint64_t)1, this->getThreads().size());
+
+    EXPECT_EQ((uint64_t)50, this->read(buffer, 127));
+    EXPECT_EQ((uint64_t)1, this->read(buffer, 127));
+    EXPECT_EQ((uint64_t)0, this->read(buffer, 127));
+}
+
+TEST_F(S3KeyReaderTest, IgnorePrefetchedKeyHeadOfWrongSize) {
+    S3Params params("s3://abc/def");
+    params.setNumOfChunks(1);
+    params.setKeySize(255);
+    params.setChunkSize(8192);
+
+    std::shared_ptr<S3KeyHead> head(new S3KeyHead(params.getMemoryContext()));
+    head->data.resize(100);
+    params.setKeyHead(head);
+
+    EXPECT_CALL(s3Interface, fetchData(0, _, _, _)).WillOnce(Invoke(MockFetchData(255, 255)));
+
+    this->open(params);
+    EXPECT_FALSE(this->isUsedKeyHead());
+
+    EXPECT_EQ((uint64_t)255, this->read(buffer, 255));
+    EXPECT_EQ((uint64_t)1, this->read(buffer, 255));
+    EXPECT_EQ((uint64_t)0, this->read(buffer, 255));
+}
+
+struct DelayedDeallocation {
+    PreAllocatedMemory *pool;
+    void *chunk;
+};
+
+static void *DeallocateAfterDelay(void *data) {
+    DelayedDeallocation *d = static_cast<DelayedDeallocation *>(data);
+    usleep(50 * 1000);
+    d->pool->Deallocate(d->chunk);
+    return NULL;
+}
+
+TEST(PreAllocatedMemory, AllocateWaitsForFreeChunk) {
+    PreAllocatedMemory pool(64, 2);
+
+    void *p1 = pool.Allocate();
+    void *p2 = pool.Allocate();
+    EXPECT_NE(p1, p2);
+    EXPECT_EQ((uint64_t)0, pool.getNumOfWaits());
+
+    DelayedDeallocation d = {&pool, p1};
+    pthread_t thread;
+    pthread_create(&thread, NULL, DeallocateAfterDelay, &d);
+
+    // blocks until the other thread returns p1
+    void *p3 = pool.Allocate();
+    pthread_join(thread, NULL);
+
+    EXPECT_EQ(p1, p3);
+    EXPECT_LT((uint64_t)0, pool.getNumOfWaits());
+    EXPECT_EQ((size_t)2, pool.getPeakUsed());
+
+    pool.Deallocate(p2);
+    pool.Deallocate(p3);
+}
+
+TEST(PreAllocatedMemory, AllocateThrowsIfQueryIsCanceledWhileWaiting) {
+    PreAllocatedMemory pool(64, 1);
+
+    void *p1 = pool.Allocate();
+
+    QueryCancelPending = true;
+    EXPECT_THROW(pool.Allocate(), S3QueryAbort);
+    QueryCancelPending = false;
+
+    pool.Deallocate(p1);
+}
@@ -44,6 +44,31 @@ typedef struct zstd_state
 	zstd_context *ctx;			/* ZSTD compression/decompresion contexts */
 } zstd_state;
 
+/*
+ * Each column's CompressionState has its own decompression context, so this
+ * is safe to run on a helper thread as long as a state is only used by one
+ * thread at a time.
+ */
+static bool
+zstd_decompress_threadsafe(CompressionState *cs, const void *src, int32 src_sz,
+						   void *dst, int32 dst_sz, int32 *dst_used)
+{
+	zstd_state *state = (zstd_state *) cs->opaque;
+	size_t		dst_length_used;
+
+	if (src_sz <= 0 || dst_sz <= 0)
+		return false;
+
+	dst_length_used = ZSTD_decompressDCtx(state->ctx->dctx,
+										  dst, dst_sz,
+										  src, src_sz);
+	if (ZSTD_isError(dst_length_used))
+		return false;
+
+	*dst_used = (int32) dst_length_used;
+	return true;
+}
+
 Datum
 zstd_constructor(PG_FUNCTION_ARGS)
 {
@@ -59,6 +84,7 @@ zstd_constructor(PG_FUNCTION_ARGS)
 
 	cs->opaque = (void *) state;
 	cs->desired_sz = NULL;
+	cs->decompress_threadsafe = zstd_decompress_threadsafe;
 
 	if (sa->complevel == 0)
 		sa->complevel = 1;
@@ -27,6 +27,7 @@
 #include "catalog/gp_fastsequence.h"
 #include "catalog/index.h"
 #include "catalog/namespace.h"
+#include "catalog/pg_am.h"
 #include "catalog/pg_appendonly.h"
 #include "catalog/pg_attribute_encoding.h"
 #include "cdb/cdbaocsam.h"
@@ -42,6 +43,7 @@
 #include "miscadmin.h"
 #include "nodes/altertablenodes.h"
 #include "pgstat.h"
+#include "storage/gp_compress.h"
 #include "storage/procarray.h"
 #include "storage/smgr.h"
 #include "utils/builtins.h"
@@ -61,6 +63,8 @@ static AOCSScanDesc aocs_beginscan_internal(Relation relation,
 						Snapshot appendOnlyMetaDataSnapshot,
 						bool *proj,
 						uint32 flags);
+static void aocs_zonemap_load(AOCSScanDesc scan, AOCSFileSegInfo *segInfo);
+static void aocs_zonemap_clear(AOCSScanDesc scan);
 
 /*
  * Open the segment file for a specified column associated with the datum
@@ -328,6 +332,16 @@ initscan_with_colinfo(AOCSScanDesc scan)
 			scan->columnScanInfo.proj_atts[attno] = attno;
 	}
 
+	if (scan->decompressJobs == NULL &&
+		gp_aocs_decompress_threads > 0 &&
+		scan->columnScanInfo.num_proj_atts > 1)
+	{
+		scan->decompressJobs = (GpDecompressJob *)
+			palloc0(scan->columnScanInfo.num_proj_atts * sizeof(GpDecompressJob));
+		scan->decompressCols = (int *)
+			palloc0(scan->columnScanInfo.num_proj_atts * sizeof(int));
+	}
+
 	open_ds_read(scan->rs_base.rs_rd, scan->columnScanInfo.ds,
 				 scan->columnScanInfo.relationTupleDesc,
 				 scan->columnScanInfo.proj_atts, scan->columnScanInfo.num_proj_atts,
@@ -403,6 +417,13 @@ open_next_scan_seg(AOCSScanDesc scan)
 
 				open_all_datumstreamread_segfiles(scan, curSegInfo);
 
+				/*
+				 * A scan that builds the block directory must visit every
+				 * block, so don't skip any.
+				 */
+				if (scan->numZonemapPreds > 0 && scan->blockDirectory == NULL)
+					aocs_zonemap_load(scan, curSegInfo);
+
 				return scan->cur_seg;
 			}
 		}
@@ -434,6 +455,8 @@ close_cur_scan_seg(AOCSScanDesc scan)
 
 	if (scan->blockDirectory)
 		AppendOnlyBlockDirectory_End_forInsert(scan->blockDirectory);
+
+	aocs_zonemap_clear(scan);
 }
 
 static void
@@ -666,6 +689,15 @@ aocs_endscan(AOCSScanDesc scan)
 	if (scan->columnScanInfo.proj_atts)
 		pfree(scan->columnScanInfo.proj_atts);
 
+	if (scan->zonemapPreds)
+		pfree(scan->zonemapPreds);
+
+	if (scan->decompressJobs)
+	{
+		pfree(scan->decompressJobs);
+		pfree(scan->decompressCols);
+	}
+
 	for (int i = 0; i < scan->total_seg; ++i)
 	{
 		if (scan->seginfo[i])
@@ -1080,6 +1112,475 @@ aocs_get_target_tuple(AOCSScanDesc aoscan, int64 targrow, TupleTableSlot *slot)
 	return aocs_gettuple(aoscan, targrow, slot);
 }
 
+/*
+ * Zone map based block skipping.
+ *
+ * For every block written, the block directory records the minimum and
+ * maximum value and the number of NULLs of the column (see
+ * datumstreamwrite_block()). When a segment file is opened for a sequential
+ * scan, the zone maps of the columns referenced by simple conditions of the
+ * scan's qual are turned into row ranges that cannot satisfy the qual. Once
+ * the scan reaches such a range, every projected column is moved past it,
+ * skipping the blocks that lie entirely in the range without reading or
+ * decompressing them.
+ *
+ * The qual is still evaluated by the executor for every returned row, so
+ * the zone maps only need to be conservative.
+ */
+
+/*
+ * Check whether a Var of the scan's qual references a column of the relation
+ * that zone maps are maintained for.
+ */
+static bool
+aocs_zonemap_var_is_usable(Var *var, TupleDesc tupdesc)
+{
+	Form_pg_attribute attr;
+
+	if (IS_SPECIAL_VARNO(var->varno) || var->varlevelsup != 0)
+		return false;
+
+	if (var->varattno <= 0 || var->varattno > tupdesc->natts)
+		return false;
+
+	attr = TupleDescAttr(tupdesc, var->varattno - 1);
+	if (attr->attisdropped || attr->atttypid != var->vartype)
+		return false;
+
+	return OidIsValid(AppendOnlyZoneMap_TypeDomain(var->vartype));
+}
+
+/*
+ * Extract a zone map predicate from a clause of the scan's qual. Supported
+ * are "column op constant" (or "constant op column") with a btree
+ * comparison operator, and NULL tests on a column.
+ */
+static bool
+aocs_zonemap_extract_predicate(Node *clause, TupleDesc tupdesc,
+							   AOCSZoneMapPredicate *pred)
+{
+	if (IsA(clause, NullTest))
+	{
+		NullTest   *ntest = (NullTest *) clause;
+		Var		   *var = (Var *) ntest->arg;
+
+		if (ntest->argisrow || !IsA(var, Var) ||
+			!aocs_zonemap_var_is_usable(var, tupdesc))
+			return false;
+
+		pred->attno = var->varattno - 1;
+		pred->strategy = InvalidStrategy;
+		pred->nulltesttype = ntest->nulltesttype;
+		pred->value = 0;
+		return true;
+	}
+	else if (IsA(clause, OpExpr) && list_length(((OpExpr *) clause)->args) == 2)
+	{
+		OpExpr	   *opexpr = (OpExpr *) clause;
+		Node	   *leftop = linitial(opexpr->args);
+		Node	   *rightop = lsecond(opexpr->args);
+		Oid			opno = opexpr->opno;
+		Oid			opclass;
+		Var		   *var;
+		Const	   *cnst;
+		int			strategy;
+
+		if (IsA(leftop, Var) && IsA(rightop, Const))
+		{
+			var = (Var *) leftop;
+			cnst = (Const *) rightop;
+		}
+		else if (IsA(leftop, Const) && IsA(rightop, Var))
+		{
+			var = (Var *) rightop;
+			cnst = (Const *) leftop;
+			opno = get_commutator(opno);
+			if (!OidIsValid(opno))
+				return false;
+		}
+		else
+			return false;
+
+		if (cnst->constisnull || !aocs_zonemap_var_is_usable(var, tupdesc))
+			return false;
+
+		/* The values must be comparable through their int64 representation */
+		if (AppendOnlyZoneMap_TypeDomain(cnst->consttype) !=
+			AppendOnlyZoneMap_TypeDomain(var->vartype))
+			return false;
+
+		opclass = GetDefaultOpClass(var->vartype, BTREE_AM_OID);
+		if (!OidIsValid(opclass))
+			return false;
+		strategy = get_op_opfamily_strategy(opno, get_opclass_family(opclass));
+		if (strategy == InvalidStrategy)
+			return false;
+
+		pred->attno = var->varattno - 1;
+		pred->strategy = (StrategyNumber) strategy;
+		pred->nulltesttype = IS_NULL;
+		pred->value = AppendOnlyZoneMap_DatumToInt64(cnst->consttype,
+													 cnst->constvalue);
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * aocs_zonemap_init
+ *
+ * Set up zone map based block skipping for a sequential scan, given the
+ * scan's qual as an implicitly-ANDed list of clauses.
+ */
+void
+aocs_zonemap_init(AOCSScanDesc scan, List *qual)
+{
+	TupleDesc	tupdesc = RelationGetDescr(scan->rs_base.rs_rd);
+	ListCell   *lc;
+
+	if (!gp_enable_aocs_zonemap_skipping || scan->total_seg == 0)
+		return;
+
+	foreach(lc, qual)
+	{
+		AOCSZoneMapPredicate pred;
+
+		if (!aocs_zonemap_extract_predicate((Node *) lfirst(lc), tupdesc, &pred))
+			continue;
+
+		if (scan->zonemapPreds == NULL)
+			scan->zonemapPreds = (AOCSZoneMapPredicate *)
+				palloc(list_length(qual) * sizeof(AOCSZoneMapPredicate));
+		scan->zonemapPreds[scan->numZonemapPreds++] = pred;
+	}
+}
+
+/*
+ * aocs_zonemap_blocks_skipped
+ *
+ * Number of column blocks that the scan has skipped so far, for EXPLAIN
+ * ANALYZE.
+ */
+int64
+aocs_zonemap_blocks_skipped(TableScanDesc scan)
+{
+	return ((AOCSScanDesc) scan)->zonemapBlocksSkipped;
+}
+
+/*
+ * Can a row covered by the zone map satisfy the predicate?
+ */
+static bool
+aocs_zonemap_excludes(AOCSZoneMapPredicate *pred, AppendOnlyBlockDirectoryZoneMap *zm)
+{
+	MinipageZoneMapEntry *zone = &zm->zone;
+	bool		hasValues = (zone->flags & ZONEMAP_HAS_VALUES) != 0;
+
+	if (pred->strategy == InvalidStrategy)
+	{
+		if (pred->nulltesttype == IS_NULL)
+			return zone->nullCount == 0;
+		else
+			return !hasValues;
+	}
+
+	/* No operator we consider here is satisfied by a NULL */
+	if (!hasValues)
+		return true;
+
+	switch (pred->strategy)
+	{
+		case BTLessStrategyNumber:
+			return zone->minValue >= pred->value;
+		case BTLessEqualStrategyNumber:
+			return zone->minValue > pred->value;
+		case BTEqualStrategyNumber:
+			return pred->value < zone->minValue || pred->value > zone->maxValue;
+		case BTGreaterEqualStrategyNumber:
+			return zone->maxValue < pred->value;
+		case BTGreaterStrategyNumber:
+			return zone->maxValue <= pred->value;
+		default:
+			return false;
+	}
+}
+
+static int
+aocs_rowrange_cmp(const void *a, const void *b)
+{
+	const AOCSRowRange *ra = (const AOCSRowRange *) a;
+	const AOCSRowRange *rb = (const AOCSRowRange *) b;
+
+	if (ra->firstRowNum < rb->firstRowNum)
+		return -1;
+	if (ra->firstRowNum > rb->firstRowNum)
+		return 1;
+	return 0;
+}
+
+/*
+ * Compute the row ranges of the given segment file that the zone maps prove
+ * not to satisfy the scan's qual.
+ */
+static void
+aocs_zonemap_load(AOCSScanDesc scan, AOCSFileSegInfo *segInfo)
+{
+	AOCSRowRange *ranges = NULL;
+	int			numRanges = 0;
+	int			maxRanges = 0;
+	int			merged;
+
+	aocs_zonemap_clear(scan);
+
+	for (int i = 0; i < scan->numZonemapPreds; i++)
+	{
+		AOCSZoneMapPredicate *pred = &scan->zonemapPreds[i];
+		AppendOnlyBlockDirectoryZoneMap *zonemaps;
+		int			numZoneMaps;
+
+		/* Zone maps of a column are fetched once for all its predicates */
+		bool		seen = false;
+
+		for (int j = 0; j < i; j++)
+		{
+			if (scan->zonemapPreds[j].attno == pred->attno)
+				seen = true;
+		}
+		if (seen)
+			continue;
+
+		zonemaps = AppendOnlyBlockDirectory_GetZoneMaps(scan->rs_base.rs_rd,
+														scan->appendOnlyMetaDataSnapshot,
+														segInfo->segno,
+														pred->attno,
+														&numZoneMaps);
+
+		for (int z = 0; z < numZoneMaps; z++)
+		{
+			bool		excluded = false;
+
+			for (int j = i; j < scan->numZonemapPreds && !excluded; j++)
+			{
+				if (scan->zonemapPreds[j].attno == pred->attno)
+					excluded = aocs_zonemap_excludes(&scan->zonemapPreds[j], &zonemaps[z]);
+			}
+
+			if (!excluded)
+				continue;
+
+			if (numRanges >= maxRanges)
+			{
+				maxRanges = Max(maxRanges * 2, 16);
+				if (ranges == NULL)
+					ranges = palloc(maxRanges * sizeof(AOCSRowRange));
+				else
+					ranges = repalloc(ranges, maxRanges * sizeof(AOCSRowRange));
+			}
+			ranges[numRanges].firstRowNum = zonemaps[z].firstRowNum;
+			ranges[numRanges].lastRowNum = zonemaps[z].firstRowNum + zonemaps[z].rowCount - 1;
+			numRanges++;
+		}
+
+		if (zonemaps)
+			pfree(zonemaps);
+	}
+
+	if (numRanges == 0)
+		return;
+
+	/* Sort the ranges and merge the overlapping or adjacent ones */
+	qsort(ranges, numRanges, sizeof(AOCSRowRange), aocs_rowrange_cmp);
+	merged = 0;
+	for (int i = 1; i < numRanges; i++)
+	{
+		if (ranges[i].firstRowNum <= ranges[merged].lastRowNum + 1)
+			ranges[merged].lastRowNum = Max(ranges[merged].lastRowNum,
+											ranges[i].lastRowNum);
+		else
+			ranges[++merged] = ranges[i];
+	}
+
+	scan->zonemapSkipRanges = ranges;
+	scan->numZonemapSkipRanges = merged + 1;
+	scan->curZonemapSkipRange = 0;
+}
+
+static void
+aocs_zonemap_clear(AOCSScanDesc scan)
+{
+	if (scan->zonemapSkipRanges)
+		pfree(scan->zonemapSkipRanges);
+	scan->zonemapSkipRanges = NULL;
+	scan->numZonemapSkipRanges = 0;
+	scan->curZonemapSkipRange = 0;
+}
+
+/*
+ * Position a column's datum stream so that the next datumstreamread_advance()
+ * returns the first row with a row number of at least targetRowNum. Blocks
+ * that end before that row are skipped using only their headers.
+ */
+static void
+aocs_zonemap_skip_column(AOCSScanDesc scan, AttrNumber attno, int64 targetRowNum)
+{
+	DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+	int64		nextFirstRowNum;
+
+	if (ds->blockFirstRowNum + ds->blockRowCount > targetRowNum)
+	{
+		/* The target row is in the current block */
+		datumstreamread_find(ds, targetRowNum - ds->blockFirstRowNum - 1);
+		return;
+	}
+
+	/*
+	 * Exhaust the current block first, in case there is no block left to
+	 * move to. Reading the next block headers overwrites its row count.
+	 */
+	datumstreamread_find(ds, ds->blockRowCount - 1);
+
+	nextFirstRowNum = ds->blockFirstRowNum + ds->blockRowCount;
+	while (datumstreamread_block_info(ds))
+	{
+		/* See datumstreamread_block() for blocks without a first row number */
+		if (ds->getBlockInfo.firstRow < 0)
+			ds->blockFirstRowNum = nextFirstRowNum;
+
+		if (ds->blockFirstRowNum + ds->blockRowCount > targetRowNum)
+		{
+			datumstreamread_block_content(ds);
+			AOCSScanDesc_UpdateTotalBytesRead(scan, attno);
+
+			if (targetRowNum > ds->blockFirstRowNum)
+				datumstreamread_find(ds, targetRowNum - ds->blockFirstRowNum - 1);
+			return;
+		}
+
+		nextFirstRowNum = ds->blockFirstRowNum + ds->blockRowCount;
+		AppendOnlyStorageRead_SkipCurrentBlock(&ds->ao_read);
+		scan->zonemapBlocksSkipped++;
+	}
+
+	/*
+	 * Reached the end of the segment file, the scan moves on to the next one
+	 * once it finds the block exhausted.
+	 */
+}
+
+/*
+ * If rowNum, which the scan has just read, falls in a row range that the
+ * zone maps prove not to satisfy the qual, move all projected columns past
+ * the range and return true.
+ */
+static bool
+aocs_zonemap_skip(AOCSScanDesc scan, int64 rowNum)
+{
+	AOCSRowRange *range;
+
+	/* The ranges are sorted, and rows are returned in row number order */
+	while (scan->curZonemapSkipRange < scan->numZonemapSkipRanges &&
+		   scan->zonemapSkipRanges[scan->curZonemapSkipRange].lastRowNum < rowNum)
+		scan->curZonemapSkipRange++;
+
+	if (scan->curZonemapSkipRange >= scan->numZonemapSkipRanges)
+		return false;
+
+	range = &scan->zonemapSkipRanges[scan->curZonemapSkipRange];
+	if (rowNum < range->firstRowNum)
+		return false;
+
+	for (AttrNumber i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
+		aocs_zonemap_skip_column(scan, scan->columnScanInfo.proj_atts[i],
+								 range->lastRowNum + 1);
+
+	scan->curZonemapSkipRange++;
+
+	return true;
+}
+
+/*
+ * Move a projected column to its next row, reading the next block if the
+ * current one is exhausted. Returns false at the end of the segment file.
+ */
+static bool
+aocs_advance_column(AOCSScanDesc scan, AttrNumber attno)
+{
+	DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+	int			err;
+
+	err = datumstreamread_advance(ds);
+	Assert(err >= 0);
+	if (err == 0)
+	{
+		err = datumstreamread_block(ds, scan->blockDirectory, attno);
+		if (err < 0)
+			return false;
+
+		AOCSScanDesc_UpdateTotalBytesRead(scan, attno);
+		pgstat_count_buffer_read_ao(scan->rs_base.rs_rd,
+									RelationGuessNumberOfBlocksFromSize(scan->totalBytesRead));
+
+		err = datumstreamread_advance(ds);
+		Assert(err > 0);
+	}
+
+	return true;
+}
+
+/*
+ * Like aocs_advance_column(), for all the projected columns at once. The new
+ * blocks that the columns need are decompressed concurrently, by the
+ * gp_decompress_parallel() helper threads.
+ */
+static bool
+aocs_advance_columns(AOCSScanDesc scan)
+{
+	int			ncols = 0;
+	int			err;
+
+	for (int i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
+	{
+		AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+		DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+		GpDecompressJob *job = &scan->decompressJobs[ncols];
+
+		err = datumstreamread_advance(ds);
+		Assert(err >= 0);
+		if (err > 0)
+			continue;
+
+		err = datumstreamread_block_begin(ds, job);
+		if (err < 0)
+			return false;
+
+		scan->decompressCols[ncols++] = i;
+	}
+
+	if (ncols == 0)
+		return true;
+
+	gp_decompress_parallel(scan->decompressJobs, ncols);
+
+	for (int n = 0; n < ncols; n++)
+	{
+		AttrNumber	attno = scan->columnScanInfo.proj_atts[scan->decompressCols[n]];
+		DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+
+		datumstreamread_block_end(ds, scan->blockDirectory, attno,
+								  &scan->decompressJobs[n]);
+
+		AOCSScanDesc_UpdateTotalBytesRead(scan, attno);
+		pgstat_count_buffer_read_ao(scan->rs_base.rs_rd,
+									RelationGuessNumberOfBlocksFromSize(scan->totalBytesRead));
+
+		err = datumstreamread_advance(ds);
+		Assert(err > 0);
+	}
+
+	return true;
+}
+
 bool
 aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot)
 {
@@ -1130,31 +1631,29 @@ ReadNext:
 		Assert(scan->cur_seg >= 0);
 		curseginfo = scan->seginfo[scan->cur_seg];
 
+		if (scan->decompressJobs != NULL && !aocs_advance_columns(scan))
+		{
+			/*
+			 * Ha, cannot read next block, we need to go to next seg
+			 */
+			close_cur_scan_seg(scan);
+			err = -1;
+			goto ReadNext;
+		}
+
 		/* Read from cur_seg */
 		for (AttrNumber i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
 		{
 			AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
 
-			err = datumstreamread_advance(scan->columnScanInfo.ds[attno]);
-			Assert(err >= 0);
-			if (err == 0)
+			if (scan->decompressJobs == NULL && !aocs_advance_column(scan, attno))
 			{
-				err = datumstreamread_block(scan->columnScanInfo.ds[attno], scan->blockDirectory, attno);
-				if (err < 0)
-				{
-					/*
-					 * Ha, cannot read next block, we need to go to next seg
-					 */
-					close_cur_scan_seg(scan);
-					goto ReadNext;
-				}
-
-				AOCSScanDesc_UpdateTotalBytesRead(scan, attno);
-				pgstat_count_buffer_read_ao(scan->rs_base.rs_rd,
-											RelationGuessNumberOfBlocksFromSize(scan->totalBytesRead));
-
-				err = datumstreamread_advance(scan->columnScanInfo.ds[attno]);
-				Assert(err > 0);
+				/*
+				 * Ha, cannot read next block, we need to go to next seg
+				 */
+				close_cur_scan_seg(scan);
+				err = -1;
+				goto ReadNext;
 			}
 
 			/*
@@ -1179,6 +1678,17 @@ ReadNext:
 		}
 		else
 		{
+			/*
+			 * If the zone maps prove that this row, and the ones after it in
+			 * the same range, cannot satisfy the qual, move past them.
+			 */
+			if (scan->curZonemapSkipRange < scan->numZonemapSkipRanges &&
+				aocs_zonemap_skip(scan, rowNum))
+			{
+				rowNum = INT64CONST(-1);
+				goto ReadNext;
+			}
+
 			AOTupleIdInit(&aoTupleId, curseginfo->segno, rowNum);
 		}
 
@@ -1199,6 +1709,169 @@ ReadNext:
 	return false;
 }
 
+/*
+ * Like aocs_getnext(), but decode up to batch->maxrows rows at a time into
+ * the per-column arrays of 'batch', one column after the other.
+ *
+ * A batch never crosses a block boundary of any projected column. Every
+ * column's current block thus stays in memory until the next call, and
+ * pass-by-reference datums can point straight into the datum stream buffers.
+ */
+bool
+aocs_getnextbatch(AOCSScanDesc scan, ScanDirection direction, TableScanBatch batch)
+{
+	int64		firstRowNum;
+	int			nrows;
+	int			nselected;
+	int			err = 0;
+	bool		isSnapshotAny = (scan->rs_base.rs_snapshot == SnapshotAny);
+
+	Assert(ScanDirectionIsForward(direction));
+
+	/* should not be in ANALYZE - we use a different API */
+	Assert((scan->rs_base.rs_flags & SO_TYPE_ANALYZE) == 0);
+
+	if (scan->columnScanInfo.relationTupleDesc == NULL)
+	{
+		scan->columnScanInfo.relationTupleDesc = batch->tupdesc;
+		/* Pin it! ... and of course release it upon destruction / rescan */
+		PinTupleDesc(scan->columnScanInfo.relationTupleDesc);
+		initscan_with_colinfo(scan);
+	}
+
+	Assert(batch->tupdesc->natts <= scan->columnScanInfo.relationTupleDesc->natts);
+
+	batch->nrows = 0;
+	batch->nselected = 0;
+
+	while (1)
+	{
+		AOCSFileSegInfo *curseginfo;
+
+ReadNext:
+		/* If necessary, open next seg */
+		if (scan->cur_seg < 0 || err < 0)
+		{
+			err = open_next_scan_seg(scan);
+			if (err < 0)
+			{
+				/* No more seg, we are at the end */
+				scan->cur_seg = -1;
+				return false;
+			}
+			scan->segrowsprocessed = 0;
+		}
+
+		Assert(scan->cur_seg >= 0);
+		curseginfo = scan->seginfo[scan->cur_seg];
+
+		/*
+		 * Move every projected column to the next row, reading the next block
+		 * where needed, and see how many rows all the current blocks have left.
+		 */
+		if (scan->decompressJobs != NULL && !aocs_advance_columns(scan))
+		{
+			close_cur_scan_seg(scan);
+			err = -1;
+			goto ReadNext;
+		}
+
+		nrows = batch->maxrows;
+		firstRowNum = INT64CONST(-1);
+		for (AttrNumber i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
+		{
+			AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+			DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+
+			if (scan->decompressJobs == NULL && !aocs_advance_column(scan, attno))
+			{
+				close_cur_scan_seg(scan);
+				err = -1;
+				goto ReadNext;
+			}
+
+			nrows = Min(nrows, ds->blockRowCount - datumstreamread_nth(ds));
+
+			if (firstRowNum == INT64CONST(-1) &&
+				ds->blockFirstRowNum != INT64CONST(-1))
+			{
+				Assert(ds->blockFirstRowNum > 0);
+				firstRowNum = ds->blockFirstRowNum + datumstreamread_nth(ds);
+			}
+		}
+		Assert(nrows > 0);
+
+		if (firstRowNum != INT64CONST(-1) &&
+			scan->curZonemapSkipRange < scan->numZonemapSkipRanges)
+		{
+			if (aocs_zonemap_skip(scan, firstRowNum))
+				goto ReadNext;
+
+			/* Stop in front of the next range the zone maps rule out */
+			if (scan->curZonemapSkipRange < scan->numZonemapSkipRanges)
+				nrows = Min(nrows,
+							scan->zonemapSkipRanges[scan->curZonemapSkipRange].firstRowNum - firstRowNum);
+		}
+
+		/* Decode the rows, one column at a time */
+		for (AttrNumber i = 0; i < scan->columnScanInfo.num_proj_atts; i++)
+		{
+			AttrNumber	attno = scan->columnScanInfo.proj_atts[i];
+			DatumStreamRead *ds = scan->columnScanInfo.ds[attno];
+			Datum	   *values;
+			bool	   *isnull;
+
+			if (batch->values[attno] == NULL)
+			{
+				batch->values[attno] = MemoryContextAlloc(batch->mcxt,
+														  batch->maxrows * sizeof(Datum));
+				batch->isnull[attno] = MemoryContextAlloc(batch->mcxt,
+														  batch->maxrows * sizeof(bool));
+			}
+			values = batch->values[attno];
+			isnull = batch->isnull[attno];
+
+			datumstreamread_get(ds, &values[0], &isnull[0]);
+			for (int r = 1; r < nrows; r++)
+			{
+				err = datumstreamread_advance(ds);
+				Assert(err > 0);
+				datumstreamread_get(ds, &values[r], &isnull[r]);
+			}
+		}
+
+		nselected = 0;
+		for (int r = 0; r < nrows; r++)
+		{
+			AOTupleId	aoTupleId;
+
+			scan->segrowsprocessed++;
+			if (firstRowNum == INT64CONST(-1))
+				AOTupleIdInit(&aoTupleId, curseginfo->segno, scan->segrowsprocessed);
+			else
+				AOTupleIdInit(&aoTupleId, curseginfo->segno, firstRowNum + r);
+
+			if (!isSnapshotAny && !AppendOnlyVisimap_IsVisible(&scan->visibilityMap, &aoTupleId))
+				continue;
+
+			batch->tids[r] = *((ItemPointer) &aoTupleId);
+			batch->selected[nselected++] = r;
+		}
+
+		/* All the rows are invisible */
+		if (nselected == 0)
+			goto ReadNext;
+
+		batch->nrows = nrows;
+		batch->nselected = nselected;
+		scan->cdb_fake_ctid = batch->tids[batch->selected[nselected - 1]];
+		return true;
+	}
+
+	Assert(!"Never here");
+	return false;
+}
+
 
 /* Open next file segment for write.  See SetCurrentFileSegForWrite */
 /* XXX Right now, we put each column to different files */
@@ -555,6 +555,9 @@ aoco_beginscan_extractcolumns(Relation rel, Snapshot snapshot,
 							proj,
 							flags);
 
+	/* Let the scan skip blocks that the zone maps rule out for the qual */
+	aocs_zonemap_init(aoscan, qual);
+
 	if (needFree)
 		pfree(proj);
 	return (TableScanDesc)aoscan;
@@ -689,6 +692,23 @@ aoco_getnextslot(TableScanDesc scan, ScanDirection direction, TupleTableSlot *sl
 	return false;
 }
 
+static bool
+aoco_getnextbatch(TableScanDesc scan, ScanDirection direction, TableScanBatch batch)
+{
+	AOCSScanDesc  aoscan = (AOCSScanDesc)scan;
+	Relation	rel = aoscan->rs_base.rs_rd;
+
+	if (aocs_getnextbatch(aoscan, direction, batch))
+	{
+		if (rel->pgstat_info != NULL)
+			rel->pgstat_info->t_counts.t_tuples_returned += batch->nselected;
+
+		return true;
+	}
+
+	return false;
+}
+
 static Size
 aoco_parallelscan_estimate(Relation rel)
 {
@@ -1308,6 +1328,10 @@ aoco_relation_nontransactional_truncate(Relation rel)
 	heap_truncate_one_relid(aoseg_relid);
 	heap_truncate_one_relid(aoblkdir_relid);
 	heap_truncate_one_relid(aovisimap_relid);
+
+	/* The modcounts start over, forget what ANALYZE saw */
+	if (rel->rd_appendonly->analyzemodcount >= 0)
+		UpdateAppendOnlyEntryAnalyzeModCount(RelationGetRelid(rel), -1);
 }
 
 static void
@@ -2352,6 +2376,11 @@ static const TableAmRoutine ao_column_methods = {
 	.scan_rescan = aoco_rescan,
 	.scan_getnextslot = aoco_getnextslot,
 
+	/*
+	 * GPDB: Batch interface for sequential scans, see TableScanBatchData.
+	 */
+	.scan_getnextbatch = aoco_getnextbatch,
+
 	.parallelscan_estimate = aoco_parallelscan_estimate,
 	.parallelscan_initialize = aoco_parallelscan_initialize,
 	.parallelscan_reinitialize = aoco_parallelscan_reinitialize,
@@ -1091,6 +1091,10 @@ appendonly_relation_nontransactional_truncate(Relation rel)
 	heap_truncate_one_relid(aoseg_relid);
 	heap_truncate_one_relid(aoblkdir_relid);
 	heap_truncate_one_relid(aovisimap_relid);
+
+	/* The modcounts start over, forget what ANALYZE saw */
+	if (rel->rd_appendonly->analyzemodcount >= 0)
+		UpdateAppendOnlyEntryAnalyzeModCount(RelationGetRelid(rel), -1);
 }
 
 static void
@@ -50,6 +50,10 @@ static void extract_minipage(
 				 HeapTuple tuple,
 				 TupleDesc tupleDesc,
 				 int columnGroupNo);
+static void extract_zonemap(
+				AppendOnlyBlockDirectory *blockDirectory,
+				TupleDesc tupleDesc,
+				int columnGroupNo);
 static void write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 			   int columnGroupNo,
 			   MinipagePerColumnGroup *minipageInfo);
@@ -58,7 +62,8 @@ insert_new_entry(AppendOnlyBlockDirectory *blockDirectory,
 				 int columnGroupNo,
 				 int64 firstRowNum,
 				 int64 fileOffset,
-				 int64 rowCount);
+				 int64 rowCount,
+				 MinipageZoneMapEntry *zone);
 static void clear_minipage(MinipagePerColumnGroup *minipagePerColumnGroup);
 static bool blkdir_entry_exists(AppendOnlyBlockDirectory *blockDirectory,
 								AOTupleId *aoTupleId,
@@ -152,6 +157,8 @@ init_internal(AppendOnlyBlockDirectory *blockDirectory)
 
 		minipageInfo->minipage =
 			palloc0(minipage_size(NUM_MINIPAGE_ENTRIES));
+		minipageInfo->zonemap =
+			palloc0(zonemap_size(NUM_MINIPAGE_ENTRIES));
 		minipageInfo->numMinipageEntries = 0;
 		ItemPointerSetInvalid(&minipageInfo->tupleTid);
 	}
@@ -1045,7 +1052,26 @@ AppendOnlyBlockDirectory_InsertEntry(AppendOnlyBlockDirectory *blockDirectory,
 									 int64 rowCount)
 {
 	return insert_new_entry(blockDirectory, columnGroupNo, firstRowNum,
-							fileOffset, rowCount);
+							fileOffset, rowCount, NULL);
+}
+
+/*
+ * AppendOnlyBlockDirectory_InsertEntryWithZoneMap
+ *
+ * Same as AppendOnlyBlockDirectory_InsertEntry(), but also records the zone
+ * map of the rows covered by the new entry. A NULL zone records that no zone
+ * map information is available for the entry.
+ */
+bool
+AppendOnlyBlockDirectory_InsertEntryWithZoneMap(AppendOnlyBlockDirectory *blockDirectory,
+												int columnGroupNo,
+												int64 firstRowNum,
+												int64 fileOffset,
+												int64 rowCount,
+												MinipageZoneMapEntry *zone)
+{
+	return insert_new_entry(blockDirectory, columnGroupNo, firstRowNum,
+							fileOffset, rowCount, zone);
 }
 
 /*
@@ -1102,7 +1128,8 @@ AppendOnlyBlockDirectory_DeleteSegmentFile(AppendOnlyBlockDirectory *blockDirect
  * could mean a new block directory tuple is inserted OR an old tuple is updated.
  *
  * 2. "Inserts" the new entry in the current in-mem minipage -> just sets the
- * in-memory area with the supplied function args.
+ * in-memory area with the supplied function args. The zone map of the entry,
+ * if any, is kept at the same index in the in-memory zone map array.
  *
  */
 static bool
@@ -1110,7 +1137,8 @@ insert_new_entry(AppendOnlyBlockDirectory *blockDirectory,
 				 int columnGroupNo,
 				 int64 firstRowNum,
 				 int64 fileOffset,
-				 int64 rowCount)
+				 int64 rowCount,
+				 MinipageZoneMapEntry *zone)
 {
 	MinipageEntry *entry = NULL;
 	MinipagePerColumnGroup *minipageInfo;
@@ -1146,6 +1174,12 @@ insert_new_entry(AppendOnlyBlockDirectory *blockDirectory,
 	entry->fileOffset = fileOffset;
 	entry->rowCount = rowCount;
 
+	if (zone != NULL)
+		minipageInfo->zonemap->entry[minipageInfo->numMinipageEntries] = *zone;
+	else
+		MemSet(&minipageInfo->zonemap->entry[minipageInfo->numMinipageEntries],
+			   0, sizeof(MinipageZoneMapEntry));
+
 	minipageInfo->numMinipageEntries++;
 
 	ereportif(Debug_appendonly_print_blockdirectory, LOG,
@@ -1207,6 +1241,125 @@ AppendOnlyBlockDirectory_DeleteSegmentFiles(Oid blkdirrelid,
 
 }
 
+/*
+ * AppendOnlyBlockDirectory_GetZoneMaps
+ *
+ * Return the zone maps recorded in the block directory for the given
+ * segment file and column group, in row number order. Entries without zone
+ * map information are left out. The number of returned zone maps is stored
+ * in *numZoneMaps; NULL is returned if there are none, e.g. because the
+ * relation has no block directory.
+ */
+AppendOnlyBlockDirectoryZoneMap *
+AppendOnlyBlockDirectory_GetZoneMaps(Relation aoRel,
+									 Snapshot appendOnlyMetaDataSnapshot,
+									 int segno,
+									 int columnGroupNo,
+									 int *numZoneMaps)
+{
+	AppendOnlyBlockDirectoryZoneMap *zonemaps = NULL;
+	int			maxZoneMaps = 0;
+	Oid			blkdirrelid;
+	Oid			blkdiridxid;
+	Relation	blkdirRel;
+	Relation	blkdirIdx;
+	TupleDesc	tupdesc;
+	ScanKeyData scanKey[2];
+	SysScanDesc indexScan;
+	HeapTuple	tuple;
+
+	*numZoneMaps = 0;
+
+	GetAppendOnlyEntryAuxOids(aoRel, NULL, &blkdirrelid, NULL);
+	if (!OidIsValid(blkdirrelid))
+		return NULL;
+
+	blkdirRel = table_open(blkdirrelid, AccessShareLock);
+	tupdesc = RelationGetDescr(blkdirRel);
+	if (!AOBlkDirHasZoneMap(tupdesc))
+	{
+		table_close(blkdirRel, AccessShareLock);
+		return NULL;
+	}
+
+	blkdiridxid = AppendonlyGetAuxIndex(blkdirRel);
+	Assert(OidIsValid(blkdiridxid));
+	blkdirIdx = index_open(blkdiridxid, AccessShareLock);
+
+	ScanKeyInit(&scanKey[0],
+				Anum_pg_aoblkdir_segno,				/* segno */
+				BTEqualStrategyNumber,
+				F_INT4EQ,
+				Int32GetDatum(segno));
+	ScanKeyInit(&scanKey[1],
+				Anum_pg_aoblkdir_columngroupno,/* columnGroupNo */
+				BTEqualStrategyNumber,
+				F_INT4EQ,
+				Int32GetDatum(columnGroupNo));
+
+	indexScan = systable_beginscan_ordered(blkdirRel,
+										   blkdirIdx,
+										   appendOnlyMetaDataSnapshot,
+										   2 /* nkeys */,
+										   scanKey);
+
+	while ((tuple = systable_getnext_ordered(indexScan, ForwardScanDirection)) != NULL)
+	{
+		Datum		minipageDatum;
+		Datum		zonemapDatum;
+		bool		isnull;
+		Minipage   *minipage;
+		MinipageZoneMap *zonemap;
+
+		zonemapDatum = heap_getattr(tuple, Anum_pg_aoblkdir_zonemap,
+									tupdesc, &isnull);
+		if (isnull)
+			continue;
+		minipageDatum = heap_getattr(tuple, Anum_pg_aoblkdir_minipage,
+									 tupdesc, &isnull);
+		Assert(!isnull);
+
+		minipage = (Minipage *) PG_DETOAST_DATUM(minipageDatum);
+		zonemap = (MinipageZoneMap *) PG_DETOAST_DATUM(zonemapDatum);
+
+		if (zonemap->nEntry == minipage->nEntry)
+		{
+			for (uint32 i = 0; i < minipage->nEntry; i++)
+			{
+				AppendOnlyBlockDirectoryZoneMap *zm;
+
+				if ((zonemap->entry[i].flags & ZONEMAP_VALID) == 0)
+					continue;
+
+				if (*numZoneMaps >= maxZoneMaps)
+				{
+					maxZoneMaps = Max(maxZoneMaps * 2, (int) minipage->nEntry);
+					if (zonemaps == NULL)
+						zonemaps = palloc(maxZoneMaps * sizeof(AppendOnlyBlockDirectoryZoneMap));
+					else
+						zonemaps = repalloc(zonemaps, maxZoneMaps * sizeof(AppendOnlyBlockDirectoryZoneMap));
+				}
+
+				zm = &zonemaps[(*numZoneMaps)++];
+				zm->firstRowNum = minipage->entry[i].firstRowNum;
+				zm->rowCount = minipage->entry[i].rowCount;
+				zm->zone = zonemap->entry[i];
+			}
+		}
+
+		if ((Pointer) minipage != DatumGetPointer(minipageDatum))
+			pfree(minipage);
+		if ((Pointer) zonemap != DatumGetPointer(zonemapDatum))
+			pfree(zonemap);
+	}
+	systable_endscan_ordered(indexScan);
+
+	index_close(blkdirIdx, AccessShareLock);
+	table_close(blkdirRel, AccessShareLock);
+
+	return zonemaps;
+}
+
 /*
  * init_scankeys
  *
@@ -1306,6 +1459,42 @@ extract_minipage(AppendOnlyBlockDirectory *blockDirectory,
 	ItemPointerCopy(&tuple->t_self, &minipageInfo->tupleTid);
 }
 
+/*
+ * extract_zonemap
+ *
+ * Extract the zone maps of the minipage last extracted by extract_minipage(),
+ * so that they are preserved when the minipage is written out again.
+ * Minipages written without zone maps (e.g. for row-oriented tables, or
+ * before the 'zonemap' column existed) get entries without zone map
+ * information.
+ */
+static void
+extract_zonemap(AppendOnlyBlockDirectory *blockDirectory,
+				TupleDesc tupleDesc,
+				int columnGroupNo)
+{
+	Datum	   *values = blockDirectory->values;
+	bool	   *nulls = blockDirectory->nulls;
+	MinipagePerColumnGroup *minipageInfo = &blockDirectory->minipages[columnGroupNo];
+
+	MemSet(minipageInfo->zonemap->entry, 0,
+		   minipageInfo->numMinipageEntries * sizeof(MinipageZoneMapEntry));
+
+	if (AOBlkDirHasZoneMap(tupleDesc) &&
+		!nulls[Anum_pg_aoblkdir_zonemap - 1])
+	{
+		MinipageZoneMap *zonemap;
+
+		zonemap = (MinipageZoneMap *)
+			PG_DETOAST_DATUM(values[Anum_pg_aoblkdir_zonemap - 1]);
+		if (zonemap->nEntry == minipageInfo->numMinipageEntries)
+			memcpy(minipageInfo->zonemap->entry, zonemap->entry,
+				   zonemap->nEntry * sizeof(MinipageZoneMapEntry));
+		if ((Pointer) zonemap != DatumGetPointer(values[Anum_pg_aoblkdir_zonemap - 1]))
+			pfree(zonemap);
+	}
+}
+
 /*
  * load_last_minipage
  *
@@ -1367,6 +1556,9 @@ load_last_minipage(AppendOnlyBlockDirectory *blockDirectory,
 						 tuple,
 						 heapTupleDesc,
 						 columnGroupNo);
+		extract_zonemap(blockDirectory,
+						heapTupleDesc,
+						columnGroupNo);
 	}
 
 	systable_endscan_ordered(idxScanDesc);
@@ -1471,6 +1663,22 @@ write_minipage(AppendOnlyBlockDirectory *blockDirectory,
 		PointerGetDatum(minipageInfo->minipage);
 	nulls[Anum_pg_aoblkdir_minipage - 1] = false;
 
+	/* Zone maps are only maintained for column oriented relations */
+	if (AOBlkDirHasZoneMap(heapTupleDesc))
+	{
+		if (blockDirectory->isAOCol)
+		{
+			SET_VARSIZE(minipageInfo->zonemap,
+						zonemap_size(minipageInfo->numMinipageEntries));
+			minipageInfo->zonemap->nEntry = minipageInfo->numMinipageEntries;
+			values[Anum_pg_aoblkdir_zonemap - 1] =
+				PointerGetDatum(minipageInfo->zonemap);
+			nulls[Anum_pg_aoblkdir_zonemap - 1] = false;
+		}
+		else
+			nulls[Anum_pg_aoblkdir_zonemap - 1] = true;
+	}
+
 	tuple = heaptuple_form_to(heapTupleDesc,
 							  values,
 							  nulls,
@@ -1521,6 +1729,8 @@ clear_minipage(MinipagePerColumnGroup *minipagePerColumnGroup)
 {
 	MemSet(minipagePerColumnGroup->minipage->entry, 0,
 		   minipagePerColumnGroup->numMinipageEntries * sizeof(MinipageEntry));
+	MemSet(minipagePerColumnGroup->zonemap->entry, 0,
+		   minipagePerColumnGroup->numMinipageEntries * sizeof(MinipageZoneMapEntry));
 	minipagePerColumnGroup->numMinipageEntries = 0;
 	ItemPointerSetInvalid(&minipagePerColumnGroup->tupleTid);
 }
@@ -1584,7 +1794,7 @@ AppendOnlyBlockDirectory_InsertPlaceholder(AppendOnlyBlockDirectory *blockDirect
 
 	/* insert placeholder entry with a max row count */
 	insert_new_entry(blockDirectory, columnGroupNo, firstRowNum, fileOffset,
-					 AOTupleId_MaxRowNum);
+					 AOTupleId_MaxRowNum, NULL);
 	/* insert placeholder row containing placeholder entry */
 	write_minipage(blockDirectory, columnGroupNo, minipagePerColumnGroup);
 	/*
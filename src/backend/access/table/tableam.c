@@ -112,6 +112,47 @@ table_scan_update_snapshot(TableScanDesc scan, Snapshot snapshot)
 	scan->rs_flags |= SO_TEMP_SNAPSHOT;
 }
 
+/*
+ * GPDB: Create an empty batch for table_scan_getnextbatch(). The per
+ * attribute arrays are allocated by the table AM for the attributes it
+ * fetches, in the current memory context.
+ */
+TableScanBatch
+table_scan_batch_create(TupleDesc tupdesc, int maxrows)
+{
+	TableScanBatch batch;
+
+	Assert(maxrows > 0);
+
+	batch = palloc0(sizeof(TableScanBatchData));
+	batch->mcxt = CurrentMemoryContext;
+	batch->tupdesc = tupdesc;
+	batch->maxrows = maxrows;
+	batch->values = palloc0(tupdesc->natts * sizeof(Datum *));
+	batch->isnull = palloc0(tupdesc->natts * sizeof(bool *));
+	batch->tids = palloc(maxrows * sizeof(ItemPointerData));
+	batch->selected = palloc(maxrows * sizeof(int));
+
+	return batch;
+}
+
+void
+table_scan_batch_free(TableScanBatch batch)
+{
+	for (int i = 0; i < batch->tupdesc->natts; i++)
+	{
+		if (batch->values[i])
+			pfree(batch->values[i]);
+		if (batch->isnull[i])
+			pfree(batch->isnull[i]);
+	}
+	pfree(batch->values);
+	pfree(batch->isnull);
+	pfree(batch->tids);
+	pfree(batch->selected);
+	pfree(batch);
+}
+
 
 /* ----------------------------------------------------------------------------
  * Parallel table scan related functions.
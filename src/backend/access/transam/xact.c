@@ -1678,6 +1678,9 @@ RecordTransactionCommit(void)
 		forceSyncCommit || nrels > 0)
 #endif
 	{
+		if (isDtxPrepared)
+			waitForDistributedCommitGroup();
+
 		XLogFlush(XactLastRecEnd);
 
 #ifdef FAULT_INJECTOR
@@ -65,7 +65,7 @@ AlterTableCreateAoBlkdirTable(Oid relOid)
 	rel = table_open(relOid, ShareRowExclusiveLock);
 
 	/* Create a tuple descriptor */
-	tupdesc = CreateTemplateTupleDesc(4);
+	tupdesc = CreateTemplateTupleDesc(Natts_pg_aoblkdir);
 	TupleDescInitEntry(tupdesc, (AttrNumber) 1,
 					   "segno",
 					   INT4OID,
@@ -82,8 +82,13 @@ AlterTableCreateAoBlkdirTable(Oid relOid)
 					   "minipage",
 					   BYTEAOID,
 					   -1, 0);
-	/* don't toast 'minipage' */
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5,
+					   "zonemap",
+					   BYTEAOID,
+					   -1, 0);
+	/* don't toast 'minipage' and 'zonemap' */
 	tupdesc->attrs[3].attstorage = 'p';
+	tupdesc->attrs[4].attstorage = 'p';
 
 	/*
 	 * Create index on segno, columngroup_no and first_row_no.
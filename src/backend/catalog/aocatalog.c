@@ -31,6 +31,8 @@
 #include "miscadmin.h"
 #include "storage/lmgr.h"
 #include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/rel.h"
 #include "catalog/gp_fastsequence.h"
 
 /*
@@ -255,6 +257,18 @@ NewRelationCreateAOAuxTables(Oid relOid, bool createBlkDir)
 	AlterTableCreateAoSegTable(relOid);
 	AlterTableCreateAoVisimapTable(relOid);
 
+	/*
+	 * Column-oriented tables keep their zone maps in the block directory.
+	 * Build it now if they are to have zone maps before they get an index.
+	 */
+	if (!createBlkDir && gp_aocs_build_zonemaps)
+	{
+		Relation	rel = table_open(relOid, NoLock);
+
+		createBlkDir = RelationIsAoCols(rel);
+		table_close(rel, NoLock);
+	}
+
 	if (createBlkDir)
 		AlterTableCreateAoBlkdirTable(relOid);
 }
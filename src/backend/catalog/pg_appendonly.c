@@ -72,6 +72,7 @@ InsertAppendOnlyEntry(Oid relid,
 	values[Anum_pg_appendonly_blkdirrelid - 1] = ObjectIdGetDatum(blkdirrelid);
 	values[Anum_pg_appendonly_visimaprelid - 1] = ObjectIdGetDatum(visimaprelid);
 	values[Anum_pg_appendonly_version - 1] = Int16GetDatum(version);
+	values[Anum_pg_appendonly_analyzemodcount - 1] = Int64GetDatum(-1);
 
 	/*
 	 * form the tuple and insert it
@@ -232,6 +233,10 @@ UpdateAppendOnlyEntryAuxOids(Oid relid,
 	{
 		replace[Anum_pg_appendonly_segrelid - 1] = true;
 		newValues[Anum_pg_appendonly_segrelid - 1] = newSegrelid;
+
+		/* The modcounts of a new aoseg table start over */
+		replace[Anum_pg_appendonly_analyzemodcount - 1] = true;
+		newValues[Anum_pg_appendonly_analyzemodcount - 1] = Int64GetDatum(-1);
 	}
 
 	if (OidIsValid(newBlkdirrelid))
@@ -260,6 +265,56 @@ UpdateAppendOnlyEntryAuxOids(Oid relid,
 	CacheInvalidateRelcacheByRelid(relid);
 }
 
+/*
+ * Remember the sum of the segfile modcounts that the relation's statistics
+ * were computed at. See analyze_rel_internal().
+ */
+void
+UpdateAppendOnlyEntryAnalyzeModCount(Oid relid, int64 modcount)
+{
+	Relation	pg_appendonly;
+	ScanKeyData key[1];
+	SysScanDesc scan;
+	HeapTuple	tuple, newTuple;
+	Datum		newValues[Natts_pg_appendonly];
+	bool		newNulls[Natts_pg_appendonly];
+	bool		replace[Natts_pg_appendonly];
+
+	pg_appendonly = table_open(AppendOnlyRelationId, RowExclusiveLock);
+
+	ScanKeyInit(&key[0],
+				Anum_pg_appendonly_relid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(relid));
+
+	scan = systable_beginscan(pg_appendonly, AppendOnlyRelidIndexId, true,
+							  NULL, 1, key);
+	tuple = systable_getnext(scan);
+	if (!HeapTupleIsValid(tuple))
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_OBJECT),
+				 errmsg("missing pg_appendonly entry for relation \"%s\"",
+						get_rel_name(relid))));
+
+	MemSet(newValues, 0, sizeof(newValues));
+	MemSet(newNulls, false, sizeof(newNulls));
+	MemSet(replace, false, sizeof(replace));
+
+	replace[Anum_pg_appendonly_analyzemodcount - 1] = true;
+	newValues[Anum_pg_appendonly_analyzemodcount - 1] = Int64GetDatum(modcount);
+
+	newTuple = heap_modify_tuple(tuple, RelationGetDescr(pg_appendonly),
+								 newValues, newNulls, replace);
+	CatalogTupleUpdate(pg_appendonly, &newTuple->t_self, newTuple);
+
+	heap_freetuple(newTuple);
+
+	systable_endscan(scan);
+	table_close(pg_appendonly, RowExclusiveLock);
+
+	CacheInvalidateRelcacheByRelid(relid);
+}
+
 /*
  * Remove all pg_appendonly entries that the table we are DROPing
  * refers to (using the table's relfilenode)
@@ -225,6 +225,21 @@ callCompressionValidator(PGFunction func, char *comptype, int32 complevel,
 }
 
 #ifdef HAVE_LIBZ
+static bool
+zlib_decompress_threadsafe(CompressionState *cs, const void *src, int32 src_sz,
+						   void *dst, int32 dst_sz, int32 *dst_used)
+{
+	zlib_state	   *state = (zlib_state *) cs->opaque;
+	unsigned long amount_available_used = dst_sz;
+
+	if (state->decompress_fn(dst, &amount_available_used,
+							 (const Bytef *) src, src_sz) != Z_OK)
+		return false;
+
+	*dst_used = amount_available_used;
+	return true;
+}
+
 Datum
 zlib_constructor(PG_FUNCTION_ARGS)
 {
@@ -239,6 +254,7 @@ zlib_constructor(PG_FUNCTION_ARGS)
 
 	cs->opaque = (void *) state;
 	cs->desired_sz = NULL;
+	cs->decompress_threadsafe = zlib_decompress_threadsafe;
 
 	Assert(PointerIsValid(sa->comptype));
 
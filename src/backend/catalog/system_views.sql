@@ -1485,6 +1485,12 @@ CREATE VIEW gp_suboverflowed_backend(segid, pids) AS
 UNION ALL
   SELECT gp_segment_id, gp_get_suboverflowed_backends() FROM gp_dist_random('gp_id') order by 1;
 
+------------------------------------------------------------------
+-- GPDB view of the latency histograms of the phases of dispatch
+------------------------------------------------------------------
+CREATE VIEW gp_dispatch_latency AS
+    SELECT * FROM gp_dispatch_latency();
+
 --
 -- We have a few function definitions in here, too.
 -- At some point there might be enough to justify breaking them out into
@@ -1737,6 +1743,7 @@ REVOKE EXECUTE ON FUNCTION pg_stat_reset_shared(text) FROM public;
 REVOKE EXECUTE ON FUNCTION pg_stat_reset_slru(text) FROM public;
 REVOKE EXECUTE ON FUNCTION pg_stat_reset_single_table_counters(oid) FROM public;
 REVOKE EXECUTE ON FUNCTION pg_stat_reset_single_function_counters(oid) FROM public;
+REVOKE EXECUTE ON FUNCTION gp_dispatch_latency_reset() FROM public;
 
 REVOKE EXECUTE ON FUNCTION lo_import(text) FROM public;
 REVOKE EXECUTE ON FUNCTION lo_import(text, oid) FROM public;
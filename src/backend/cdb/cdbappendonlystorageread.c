@@ -1113,6 +1113,34 @@ AppendOnlyStorageRead_GetBuffer(AppendOnlyStorageRead *storageRead)
 	return content;
 }
 
+/*
+ * Get a pointer to the *small* compressed content, for callers that
+ * decompress it themselves rather than with AppendOnlyStorageRead_Content().
+ *
+ * The pointer is into the read buffer, and is valid until the next block is
+ * read.
+ */
+uint8 *
+AppendOnlyStorageRead_GetCompressedBuffer(AppendOnlyStorageRead *storageRead,
+										  int32 *compressedLen)
+{
+	uint8	   *header;
+	uint8	   *content;
+
+	Assert(storageRead != NULL);
+	Assert(storageRead->isActive);
+	Assert(!storageRead->current.isLarge);
+	Assert(storageRead->current.isCompressed);
+
+	AppendOnlyStorageRead_InternalGetBuffer(storageRead,
+											&header,
+											&content);
+
+	*compressedLen = storageRead->current.compressedLen;
+
+	return content;
+}
+
 /*
  * Copy the large and/or decompressed content out.
  *
@@ -25,6 +25,8 @@
 
 static void BufferedReadIo(
 			   BufferedRead *bufferedRead);
+static void BufferedReadPrefetch(
+			   BufferedRead *bufferedRead);
 static uint8 *BufferedReadUseBeforeBuffer(
 							BufferedRead *bufferedRead,
 							int32 maxReadAheadLen,
@@ -144,6 +146,7 @@ BufferedReadSetFile(
 	bufferedRead->haveTemporaryLimitInEffect = false;
 	bufferedRead->temporaryLimitFileLen = 0;
 	bufferedRead->fileOff =0;
+	bufferedRead->prefetchPosition = 0;
 
 	if (fileLen > 0)
 	{
@@ -158,6 +161,47 @@ BufferedReadSetFile(
 	}
 }
 
+/*
+ * Ask the kernel to read ahead up to gp_appendonly_prefetch_size bytes past
+ * the large read that is about to be done, so that the disk works on them
+ * while the caller processes and decompresses the blocks of this one.
+ *
+ * The advice is only given for sequential reads, and once the window has
+ * moved by at least one large read, to keep the number of calls down.
+ */
+static void
+BufferedReadPrefetch(
+			   BufferedRead *bufferedRead)
+{
+#ifdef USE_PREFETCH
+	int64		readEnd;
+	int64		windowEnd;
+	int64		prefetchStart;
+
+	if (gp_appendonly_prefetch_size <= 0 ||
+		bufferedRead->haveTemporaryLimitInEffect)
+		return;
+
+	readEnd = bufferedRead->largeReadPosition + bufferedRead->largeReadLen;
+	windowEnd = Min(bufferedRead->fileLen,
+					readEnd + (int64) gp_appendonly_prefetch_size * 1024);
+	prefetchStart = Max(bufferedRead->prefetchPosition, readEnd);
+
+	if (windowEnd <= prefetchStart)
+		return;
+	if (windowEnd - prefetchStart < bufferedRead->maxLargeReadLen &&
+		windowEnd < bufferedRead->fileLen)
+		return;
+
+	(void) FilePrefetch(bufferedRead->file,
+						prefetchStart,
+						(int) (windowEnd - prefetchStart),
+						WAIT_EVENT_DATA_FILE_PREFETCH);
+
+	bufferedRead->prefetchPosition = windowEnd;
+#endif
+}
+
 /*
  * Perform a large read i/o.
  */
@@ -173,6 +217,8 @@ BufferedReadIo(
 	Assert(bufferedRead->largeReadLen > 0);
 	largeReadMemory = bufferedRead->largeReadMemory;
 
+	BufferedReadPrefetch(bufferedRead);
+
 	offset = 0;
 	while (largeReadLen > 0)
 	{
@@ -413,6 +459,13 @@ BufferedReadSetTemporaryRange(
 		}
 	}
 
+	/*
+	 * Set the temporary limit before any new read is issued, so that the
+	 * read doesn't prefetch: see BufferedReadPrefetch().
+	 */
+	bufferedRead->haveTemporaryLimitInEffect = true;
+	bufferedRead->temporaryLimitFileLen = afterFileOffset;
+
 	if (newReadNeeded)
 	{
 		int64		remainingFileLen;
@@ -435,13 +488,11 @@ BufferedReadSetTemporaryRange(
 
 		bufferedRead->largeReadPosition = beginFileOffset;
 
+		bufferedRead->prefetchPosition = 0;
+
 		if (bufferedRead->largeReadLen > 0)
 			BufferedReadIo(bufferedRead);
 	}
-
-	bufferedRead->haveTemporaryLimitInEffect = true;
-	bufferedRead->temporaryLimitFileLen = afterFileOffset;
-
 }
 
 /*
@@ -670,6 +721,8 @@ BufferedReadCompleteFile(
 
 	bufferedRead->largeReadPosition = 0;
 	bufferedRead->largeReadLen = 0;
+
+	bufferedRead->prefetchPosition = 0;
 }
 
 
@@ -13,6 +13,7 @@
  */
 #include "postgres.h"
 
+#include "common/hashfn.h"
 #include "cdb/cdbdistributedsnapshot.h"
 #include "cdb/cdblocaldistribxact.h"
 #include "access/distributedlog.h"
@@ -23,12 +24,151 @@
 #include "utils/snapmgr.h"
 #include "storage/procarray.h"
 
+/*
+ * Encodings of the in-progress array on the wire.  The QD picks whichever
+ * is the smallest for each snapshot.
+ *
+ * DS_ENCODING_ARRAY: the distributed xids as they are.
+ * DS_ENCODING_BITMAP: a bitmap of (dxid - xmin) for dxids in [xmin, xmax).
+ * DS_ENCODING_DELTAS: varint-encoded differences from xmin and then from
+ * the previous dxid.
+ */
+#define DS_ENCODING_ARRAY	0
+#define DS_ENCODING_BITMAP	1
+#define DS_ENCODING_DELTAS	2
+
+/*
+ * Don't build a lookup bitmap with fewer words than this, even if there are
+ * fewer in-progress xids; beyond it, the bitmap may be as big as the array.
+ */
+#define DS_MIN_BITMAP_WORDS	64
+
+static int	DistributedSnapshot_ChooseEncoding(DistributedSnapshot *ds,
+											   int *payloadSize);
+static bool LocalXidHashContains(DistributedSnapshotWithLocalMapping *dslm,
+								 TransactionId localXid);
+static void LocalXidHashInsert(DistributedSnapshotWithLocalMapping *dslm,
+							   TransactionId localXid);
+
 int
 GetMaxSnapshotDistributedXidCount()
 {
 	return GetMaxSnapshotXidCount();
 }
 
+/*
+ * Size of the lookup bitmap for a snapshot of 'count' in-progress xids, at
+ * most.
+ */
+int
+DistributedSnapshot_MaxBitmapWords(int count)
+{
+	return Max(count, DS_MIN_BITMAP_WORDS);
+}
+
+/*
+ * Number of slots of the local xid hash for a snapshot of 'count'
+ * in-progress xids: a power of two, at most half full.
+ */
+uint32
+DistributedSnapshot_LocalXidHashSlots(int count)
+{
+	uint32		slots = 16;
+
+	while (slots < (uint32) count * 2)
+		slots <<= 1;
+	return slots;
+}
+
+/*
+ * DistributedSnapshotWithLocalMapping_BuildLookup
+ *		Set up the constant-time lookups of a QE snapshot.
+ *
+ * The caller has allocated inProgressBitmap and localXidHash big enough
+ * for the snapshot, see DistributedSnapshot_MaxBitmapWords() and
+ * DistributedSnapshot_LocalXidHashSlots(), or left them NULL to do without.
+ */
+void
+DistributedSnapshotWithLocalMapping_BuildLookup(DistributedSnapshotWithLocalMapping *dslm)
+{
+	DistributedSnapshot *ds = &dslm->ds;
+	uint64		range;
+	int			words;
+	int			i;
+
+	dslm->inProgressBitmapWords = 0;
+	dslm->localXidHashMask = 0;
+
+	if (ds->count == 0)
+		return;
+
+	if (dslm->localXidHash != NULL)
+	{
+		uint32		slots = DistributedSnapshot_LocalXidHashSlots(ds->count);
+
+		memset(dslm->localXidHash, 0, slots * sizeof(TransactionId));
+		dslm->localXidHashMask = slots - 1;
+		for (i = 0; i < dslm->currentLocalXidsCount; i++)
+			LocalXidHashInsert(dslm, dslm->inProgressMappedLocalXids[i]);
+	}
+
+	/*
+	 * The bitmap is used only if it's not much bigger than the array.  Also
+	 * check that the array is as CreateDistributedSnapshot() makes it, since
+	 * the bitmap loses the order.
+	 */
+	range = ds->xmax - ds->xmin;
+	if (dslm->inProgressBitmap == NULL || ds->xmax < ds->xmin ||
+		range > (uint64) DistributedSnapshot_MaxBitmapWords(ds->count) * 64)
+		return;
+	words = (int) ((range + 63) / 64);
+
+	memset(dslm->inProgressBitmap, 0, words * sizeof(uint64));
+	for (i = 0; i < ds->count; i++)
+	{
+		DistributedTransactionId dxid = ds->inProgressXidArray[i];
+		uint64		off;
+
+		if (dxid < ds->xmin || dxid >= ds->xmax ||
+			(i > 0 && dxid <= ds->inProgressXidArray[i - 1]))
+			return;
+
+		off = dxid - ds->xmin;
+		dslm->inProgressBitmap[off / 64] |= UINT64CONST(1) << (off % 64);
+	}
+	dslm->inProgressBitmapWords = words;
+}
+
+static bool
+LocalXidHashContains(DistributedSnapshotWithLocalMapping *dslm,
+					 TransactionId localXid)
+{
+	uint32		i = murmurhash32(localXid) & dslm->localXidHashMask;
+
+	while (dslm->localXidHash[i] != InvalidTransactionId)
+	{
+		if (dslm->localXidHash[i] == localXid)
+			return true;
+		i = (i + 1) & dslm->localXidHashMask;
+	}
+	return false;
+}
+
+static void
+LocalXidHashInsert(DistributedSnapshotWithLocalMapping *dslm,
+				   TransactionId localXid)
+{
+	uint32		i = murmurhash32(localXid) & dslm->localXidHashMask;
+
+	while (dslm->localXidHash[i] != InvalidTransactionId)
+	{
+		if (dslm->localXidHash[i] == localXid)
+			return;
+		i = (i + 1) & dslm->localXidHashMask;
+	}
+	dslm->localXidHash[i] = localXid;
+}
+
 /*
  * DistributedSnapshotWithLocalMapping_CommittedTest
  *		Is the given XID still-in-progress according to the
@@ -44,6 +184,7 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 	DistributedSnapshot *ds = &dslm->ds;
 	uint32		i;
 	DistributedTransactionId distribXid = InvalidDistributedTransactionId;
+	bool		inProgress = false;
 
 	Assert(!IS_QUERY_DISPATCHER());
 
@@ -73,7 +214,12 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 		if (TransactionIdFollows(localXid, dslm->minCachedLocalXid) &&
 			TransactionIdPrecedes(localXid, dslm->maxCachedLocalXid))
 		{
-			for (i = 0; i < dslm->currentLocalXidsCount; i++)
+			if (dslm->localXidHashMask != 0)
+			{
+				if (LocalXidHashContains(dslm, localXid))
+					return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
+			}
+			else for (i = 0; i < dslm->currentLocalXidsCount; i++)
 			{
 				Assert(dslm->inProgressMappedLocalXids != NULL);
 				Assert(TransactionIdIsValid(dslm->inProgressMappedLocalXids[i]));
@@ -159,51 +305,73 @@ DistributedSnapshotWithLocalMapping_CommittedTest(
 		return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 	}
 
-	for (i = 0; i < ds->count; i++)
+	if (dslm->inProgressBitmapWords > 0)
 	{
-		if (distribXid == ds->inProgressXidArray[i])
-		{
-			/*
-			 * Save the relationship to the local xid so we may avoid checking
-			 * the distributed committed log in a subsequent check. We can
-			 * only record local xids till cache size permits.
-			 */
-			if (dslm->currentLocalXidsCount < ds->count)
-			{
-				Assert(dslm->inProgressMappedLocalXids != NULL);
-				dslm->inProgressMappedLocalXids[dslm->currentLocalXidsCount++] =
-					localXid;
+		uint64		off = distribXid - ds->xmin;
 
-				if (!TransactionIdIsValid(dslm->minCachedLocalXid) ||
-					TransactionIdPrecedes(localXid, dslm->minCachedLocalXid))
-				{
-					dslm->minCachedLocalXid = localXid;
-				}
+		inProgress = (dslm->inProgressBitmap[off / 64] >> (off % 64)) & 1;
+	}
+	else
+	{
+		/*
+		 * Leverage the fact that ds->inProgressXidArray is sorted in
+		 * ascending order based on distribXid while creating the snapshot in
+		 * CreateDistributedSnapshot().
+		 */
+		int			low = 0;
+		int			high = ds->count - 1;
 
-				if (!TransactionIdIsValid(dslm->maxCachedLocalXid) ||
-					TransactionIdFollows(localXid, dslm->maxCachedLocalXid))
-				{
-					dslm->maxCachedLocalXid = localXid;
-				}
-			}
+		while (low <= high)
+		{
+			int			mid = low + (high - low) / 2;
 
-			return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
+			if (distribXid == ds->inProgressXidArray[mid])
+			{
+				inProgress = true;
+				break;
+			}
+			if (distribXid < ds->inProgressXidArray[mid])
+				high = mid - 1;
+			else
+				low = mid + 1;
 		}
+	}
 
+	if (!inProgress)
+	{
 		/*
-		 * Leverage the fact that ds->inProgressXidArray is sorted in
-		 * ascending order based on distribXid while creating the snapshot in
-		 * CreateDistributedSnapshot(). So, can fail fast once known are
-		 * lower than rest of them.
+		 * Not in-progress, therefore visible.
 		 */
-		if (distribXid < ds->inProgressXidArray[i])
-			break;
+		return DISTRIBUTEDSNAPSHOT_COMMITTED_VISIBLE;
 	}
 
 	/*
-	 * Not in-progress, therefore visible.
+	 * Save the relationship to the local xid so we may avoid checking the
+	 * distributed committed log in a subsequent check. We can only record
+	 * local xids till cache size permits.
 	 */
-	return DISTRIBUTEDSNAPSHOT_COMMITTED_VISIBLE;
+	if (dslm->currentLocalXidsCount < ds->count)
+	{
+		Assert(dslm->inProgressMappedLocalXids != NULL);
+		dslm->inProgressMappedLocalXids[dslm->currentLocalXidsCount++] =
+			localXid;
+		if (dslm->localXidHashMask != 0)
+			LocalXidHashInsert(dslm, localXid);
+
+		if (!TransactionIdIsValid(dslm->minCachedLocalXid) ||
+			TransactionIdPrecedes(localXid, dslm->minCachedLocalXid))
+		{
+			dslm->minCachedLocalXid = localXid;
+		}
+
+		if (!TransactionIdIsValid(dslm->maxCachedLocalXid) ||
+			TransactionIdFollows(localXid, dslm->maxCachedLocalXid))
+		{
+			dslm->maxCachedLocalXid = localXid;
+		}
+	}
+
+	return DISTRIBUTEDSNAPSHOT_COMMITTED_INPROGRESS;
 }
 
 /*
@@ -266,22 +434,104 @@ DistributedSnapshot_Copy(DistributedSnapshot *target,
 			source->count * sizeof(DistributedTransactionId));
 }
 
+/*
+ * Number of bytes of the varint encoding of 'value': 7 bits per byte, the
+ * high bit set on all but the last byte.
+ */
+static int
+VarintSize(uint64 value)
+{
+	int			size = 1;
+
+	while (value >= 0x80)
+	{
+		value >>= 7;
+		size++;
+	}
+	return size;
+}
+
+/*
+ * Pick the smallest encoding of the in-progress array of 'ds', and return
+ * the size of the encoded array in *payloadSize.
+ *
+ * The bitmap and delta encodings rely on the array being sorted and within
+ * [xmin, xmax), as CreateDistributedSnapshot() makes it.  If it isn't, the
+ * array is sent as it is.
+ */
+static int
+DistributedSnapshot_ChooseEncoding(DistributedSnapshot *ds, int *payloadSize)
+{
+	uint64		arraySize = sizeof(DistributedTransactionId) * ds->count;
+	uint64		deltaSize = 0;
+	uint64		range;
+	DistributedTransactionId prev;
+	int			encoding = DS_ENCODING_ARRAY;
+	int			i;
+
+	*payloadSize = (int) arraySize;
+
+	if (ds->count == 0 || ds->xmax < ds->xmin)
+		return DS_ENCODING_ARRAY;
+
+	prev = ds->xmin;
+	for (i = 0; i < ds->count; i++)
+	{
+		DistributedTransactionId dxid = ds->inProgressXidArray[i];
+
+		if (dxid < prev || dxid >= ds->xmax ||
+			(i > 0 && dxid == prev))
+			return DS_ENCODING_ARRAY;
+
+		deltaSize += VarintSize(dxid - prev);
+		prev = dxid;
+	}
+
+	if (deltaSize < arraySize)
+	{
+		encoding = DS_ENCODING_DELTAS;
+		*payloadSize = (int) deltaSize;
+	}
+
+	/* compare in bits first, (range + 7) / 8 could overflow */
+	range = ds->xmax - ds->xmin;
+	if (range / 8 < (uint64) *payloadSize &&
+		(range + 7) / 8 < (uint64) *payloadSize)
+	{
+		encoding = DS_ENCODING_BITMAP;
+		*payloadSize = (int) ((range + 7) / 8);
+	}
+
+	return encoding;
+}
+
 int
 DistributedSnapshot_SerializeSize(DistributedSnapshot *ds)
 {
+	int			payloadSize;
+
+	(void) DistributedSnapshot_ChooseEncoding(ds, &payloadSize);
+
 	return sizeof(DistributedSnapshotId) +
 	/* xminAllDistributedSnapshots, xmin, xmax */
 		3 * sizeof(DistributedTransactionId) +
 	/* count */
 		sizeof(int32) +
-	/* Size of inProgressXidArray */
-		sizeof(DistributedTransactionId) * ds->count;
+	/* encoding of inProgressXidArray */
+		sizeof(uint8) +
+	/* inProgressXidArray, encoded */
+		payloadSize;
 }
 
 int
 DistributedSnapshot_Serialize(DistributedSnapshot *ds, char *buf)
 {
 	char	   *p = buf;
+	int			payloadSize;
+	uint8		encoding;
+	int			i;
+
+	encoding = (uint8) DistributedSnapshot_ChooseEncoding(ds, &payloadSize);
 
 	memcpy(p, &ds->xminAllDistributedSnapshots, sizeof(DistributedTransactionId));
 	p += sizeof(DistributedTransactionId);
@@ -293,9 +543,46 @@ DistributedSnapshot_Serialize(DistributedSnapshot *ds, char *buf)
 	p += sizeof(DistributedTransactionId);
 	memcpy(p, &ds->count, sizeof(int32));
 	p += sizeof(int32);
+	*p++ = (char) encoding;
 
-	memcpy(p, ds->inProgressXidArray, sizeof(DistributedTransactionId) * ds->count);
-	p += sizeof(DistributedTransactionId) * ds->count;
+	switch (encoding)
+	{
+		case DS_ENCODING_ARRAY:
+			memcpy(p, ds->inProgressXidArray, payloadSize);
+			break;
+
+		case DS_ENCODING_BITMAP:
+			memset(p, 0, payloadSize);
+			for (i = 0; i < ds->count; i++)
+			{
+				uint64		off = ds->inProgressXidArray[i] - ds->xmin;
+
+				((uint8 *) p)[off / 8] |= 1 << (off % 8);
+			}
+			break;
+
+		case DS_ENCODING_DELTAS:
+			{
+				DistributedTransactionId prev = ds->xmin;
+				uint8	   *q = (uint8 *) p;
+
+				for (i = 0; i < ds->count; i++)
+				{
+					uint64		delta = ds->inProgressXidArray[i] - prev;
+
+					while (delta >= 0x80)
+					{
+						*q++ = (uint8) (delta | 0x80);
+						delta >>= 7;
+					}
+					*q++ = (uint8) delta;
+					prev = ds->inProgressXidArray[i];
+				}
+				Assert((char *) q - p == payloadSize);
+			}
+			break;
+	}
+	p += payloadSize;
 
 	Assert((p - buf) == DistributedSnapshot_SerializeSize(ds));
 
@@ -306,6 +593,7 @@ int
 DistributedSnapshot_Deserialize(const char *buf, DistributedSnapshot *ds)
 {
 	const char *p = buf;
+	uint8		encoding;
 
 	memcpy(&ds->xminAllDistributedSnapshots, p, sizeof(DistributedTransactionId));
 	p += sizeof(DistributedTransactionId);
@@ -317,10 +605,11 @@ DistributedSnapshot_Deserialize(const char *buf, DistributedSnapshot *ds)
 	p += sizeof(DistributedTransactionId);
 	memcpy(&ds->count, p, sizeof(int32));
 	p += sizeof(int32);
+	encoding = (uint8) *p++;
 
 	if (ds->count > 0)
 	{
-		int xipsize = sizeof(DistributedTransactionId) * ds->count;
+		int			i;
 
 		if (ds->inProgressXidArray == NULL)
 		{
@@ -332,8 +621,62 @@ DistributedSnapshot_Deserialize(const char *buf, DistributedSnapshot *ds)
 						 errmsg("out of memory")));
 		}
 
-		memcpy(ds->inProgressXidArray, p, xipsize);
-		p += xipsize;
+		switch (encoding)
+		{
+			case DS_ENCODING_ARRAY:
+				memcpy(ds->inProgressXidArray, p,
+					   sizeof(DistributedTransactionId) * ds->count);
+				p += sizeof(DistributedTransactionId) * ds->count;
+				break;
+
+			case DS_ENCODING_BITMAP:
+				{
+					const uint8 *bitmap = (const uint8 *) p;
+					uint64		range = ds->xmax - ds->xmin;
+					uint64		off;
+					int			n = 0;
+
+					for (off = 0; off < range; off++)
+					{
+						if (bitmap[off / 8] & (1 << (off % 8)))
+						{
+							if (n == ds->count)
+								elog(ERROR, "invalid distributed snapshot bitmap");
+							ds->inProgressXidArray[n++] = ds->xmin + off;
+						}
+					}
+					if (n != ds->count)
+						elog(ERROR, "invalid distributed snapshot bitmap");
+					p += (range + 7) / 8;
+				}
+				break;
+
+			case DS_ENCODING_DELTAS:
+				{
+					DistributedTransactionId prev = ds->xmin;
+
+					for (i = 0; i < ds->count; i++)
+					{
+						uint64		delta = 0;
+						int			shift = 0;
+						uint8		b;
+
+						do
+						{
+							b = (uint8) *p++;
+							delta |= (uint64) (b & 0x7F) << shift;
+							shift += 7;
+						} while ((b & 0x80) != 0 && shift < 64);
+
+						prev += delta;
+						ds->inProgressXidArray[i] = prev;
+					}
+				}
+				break;
+
+			default:
+				elog(ERROR, "invalid distributed snapshot encoding %d", encoding);
+		}
 	}
 
 	Assert((p - buf) == DistributedSnapshot_SerializeSize(ds));
@@ -67,6 +67,7 @@
 #include "optimizer/planner.h"
 #include "parser/parse_clause.h"
 #include "parser/parse_oper.h"
+#include "utils/guc.h"
 #include "utils/lsyscache.h"
 #include "utils/selfuncs.h"
 
@@ -1056,6 +1057,10 @@ add_first_stage_hash_agg_path(PlannerInfo *root,
 	}
 	else
 	{
+		/*
+		 * Only a streaming HashAgg can pass rows through when hashing barely
+		 * reduces them, so make the first stage streaming if that's enabled.
+		 */
 		add_path(ctx->partial_rel,
 				 (Path *) create_agg_path(root,
 										  ctx->partial_rel,
@@ -1063,7 +1068,7 @@ add_first_stage_hash_agg_path(PlannerInfo *root,
 										  ctx->partial_grouping_target,
 										  AGG_HASHED,
 										  ctx->hasAggs ? AGGSPLIT_INITIAL_SERIAL : AGGSPLIT_SIMPLE,
-										  false, /* streaming */
+										  gp_enable_hashagg_passthrough, /* streaming */
 										  ctx->groupClause,
 										  NIL,
 										  ctx->agg_partial_costs,
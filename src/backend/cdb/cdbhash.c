@@ -31,6 +31,7 @@
 #include "utils/catcache.h"
 #include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
+#include "utils/numeric.h"
 #include "utils/syscache.h"
 #include "utils/typcache.h"
 
@@ -53,6 +54,7 @@ bool gp_use_legacy_hashops = false;
 /* local function declarations */
 static int	ispowof2(int numsegs);
 static inline int32 jump_consistent_hash(uint64 key, int32 num_segments);
+static CdbHashKernel cdbhash_kernel_for_func(Oid funcid);
 
 /*================================================================
  *
@@ -94,6 +96,7 @@ makeCdbHash(int numsegs, int natts, Oid *hashfuncs)
 
 	/* Load hash function info */
 	h->hashfuncs = (FmgrInfo *) palloc(natts * sizeof(FmgrInfo));
+	h->kernels = (CdbHashKernel *) palloc(natts * sizeof(CdbHashKernel));
 	for (i = 0; i < natts; i++)
 	{
 		Oid			funcid = hashfuncs[i];
@@ -102,6 +105,7 @@ makeCdbHash(int numsegs, int natts, Oid *hashfuncs)
 			is_legacy_hash = true;
 
 		fmgr_info(funcid, &h->hashfuncs[i]);
+		h->kernels[i] = cdbhash_kernel_for_func(funcid);
 	}
 	h->natts = natts;
 	h->is_legacy_hash = is_legacy_hash;
@@ -164,6 +168,115 @@ cdbhashinit(CdbHash *h)
 	}
 }
 
+/*
+ * Which of the inline hash kernels, if any, computes the same hash as
+ * the given hash function.
+ */
+static CdbHashKernel
+cdbhash_kernel_for_func(Oid funcid)
+{
+	switch (funcid)
+	{
+		case F_HASHINT4:
+			return CDBHASH_KERNEL_INT4;
+		case F_HASHINT8:
+			return CDBHASH_KERNEL_INT8;
+		case F_HASHTEXT:
+			/*
+			 * cdbhash() always passes the default collation, which is
+			 * deterministic, so hashtext() hashes the raw bytes.
+			 */
+			return CDBHASH_KERNEL_TEXT;
+		case F_HASH_NUMERIC:
+			return CDBHASH_KERNEL_NUMERIC;
+		default:
+			return CDBHASH_KERNEL_FMGR;
+	}
+}
+
+/*
+ * Compute the hash of a non-NULL attribute value with an inline kernel.
+ * These must produce the same values as the corresponding functions in
+ * hashfunc.c.
+ */
+static inline uint32
+cdbhash_kernel(CdbHashKernel kernel, Datum datum)
+{
+	switch (kernel)
+	{
+		case CDBHASH_KERNEL_INT4:
+			return DatumGetUInt32(hash_uint32((uint32) DatumGetInt32(datum)));
+
+		case CDBHASH_KERNEL_INT8:
+			{
+				int64		val = DatumGetInt64(datum);
+				uint32		lohalf = (uint32) val;
+				uint32		hihalf = (uint32) (val >> 32);
+
+				lohalf ^= (val >= 0) ? hihalf : ~hihalf;
+
+				return DatumGetUInt32(hash_uint32(lohalf));
+			}
+
+		case CDBHASH_KERNEL_TEXT:
+			{
+				text	   *key = DatumGetTextPP(datum);
+				uint32		hkey;
+
+				hkey = DatumGetUInt32(hash_any((unsigned char *) VARDATA_ANY(key),
+											   VARSIZE_ANY_EXHDR(key)));
+
+				/* Avoid leaking memory for toasted inputs */
+				if ((Pointer) key != DatumGetPointer(datum))
+					pfree(key);
+
+				return hkey;
+			}
+
+		case CDBHASH_KERNEL_NUMERIC:
+			{
+				Numeric		key = DatumGetNumeric(datum);
+				uint32		hkey;
+
+				hkey = numeric_hash_value(key);
+
+				/* Avoid leaking memory for toasted inputs */
+				if ((Pointer) key != DatumGetPointer(datum))
+					pfree(key);
+
+				return hkey;
+			}
+
+		case CDBHASH_KERNEL_FMGR:
+			break;
+	}
+
+	Assert(false);
+	return 0;
+}
+
+/*
+ * Call the hash function of an attribute through fmgr. The caller has
+ * set up fcinfo for it.
+ */
+static inline uint32
+cdbhash_fmgr(FunctionCallInfo fcinfo, Datum datum)
+{
+	uint32		hkey;
+
+	fcinfo->args[0].value = datum;
+	fcinfo->args[0].isnull = false;
+	fcinfo->isnull = false;
+
+	hkey = DatumGetUInt32(FunctionCallInvoke(fcinfo));
+
+	/* Check for null result, since caller is clearly not expecting one */
+	if (fcinfo->isnull)
+		elog(ERROR, "function %u returned NULL", fcinfo->flinfo->fn_oid);
+
+	return hkey;
+}
+
 /*
  * Add an attribute to the CdbHash calculation.
  *
@@ -182,21 +295,21 @@ cdbhash(CdbHash *h, int attno, Datum datum, bool isnull)
 
 		if (!isnull)
 		{
-			LOCAL_FCINFO(fcinfo, 1);
+			CdbHashKernel kernel = h->kernels[attno - 1];
 			uint32		hkey;
 
-			InitFunctionCallInfoData(*fcinfo, &h->hashfuncs[attno - 1], 1,
-									 DEFAULT_COLLATION_OID, /* have to specify collation for attribute of text or bpchar */
-									 NULL, NULL);
-
-			fcinfo->args[0].value = datum;
-			fcinfo->args[0].isnull = false;
+			if (kernel != CDBHASH_KERNEL_FMGR)
+				hkey = cdbhash_kernel(kernel, datum);
+			else
+			{
+				LOCAL_FCINFO(fcinfo, 1);
 
-			hkey = DatumGetUInt32(FunctionCallInvoke(fcinfo));
+				InitFunctionCallInfoData(*fcinfo, &h->hashfuncs[attno - 1], 1,
+										 DEFAULT_COLLATION_OID, /* have to specify collation for attribute of text or bpchar */
+										 NULL, NULL);
 
-			/* Check for null result, since caller is clearly not expecting one */
-			if (fcinfo->isnull)
-				elog(ERROR, "function %u returned NULL", fcinfo->flinfo->fn_oid);
+				hkey = cdbhash_fmgr(fcinfo, datum);
+			}
 
 			hashkey ^= hkey;
 		}
@@ -269,6 +382,130 @@ cdbhashreduce(CdbHash *h)
 	return result;
 }
 
+/*
+ * Initialize the hashes of a batch of tuples, like cdbhashinit().
+ */
+void
+cdbhashinitbatch(CdbHash *h, uint32 *hashes, int nrows)
+{
+	uint32		init = h->is_legacy_hash ? FNV1_32_INIT : 0;
+
+	for (int i = 0; i < nrows; i++)
+		hashes[i] = init;
+}
+
+/*
+ * Add an attribute of a batch of tuples to their hashes, like cdbhash().
+ *
+ * The kernel, or the fmgr call frame, is chosen once for the whole batch,
+ * so the loops over the rows are tight.
+ */
+void
+cdbhashbatch(CdbHash *h, int attno, Datum *datums, bool *isnulls,
+			 int nrows, uint32 *hashes)
+{
+	CdbHashKernel kernel = h->kernels[attno - 1];
+	int			i;
+
+	if (h->is_legacy_hash)
+	{
+		/* The legacy hash functions depend on magic_hash_stash */
+		for (i = 0; i < nrows; i++)
+		{
+			h->hash = hashes[i];
+			cdbhash(h, attno, datums[i], isnulls[i]);
+			hashes[i] = h->hash;
+		}
+		return;
+	}
+
+	/* rotate the hashes left 1 bit */
+	for (i = 0; i < nrows; i++)
+		hashes[i] = (hashes[i] << 1) | (hashes[i] >> 31);
+
+	switch (kernel)
+	{
+		case CDBHASH_KERNEL_INT4:
+			for (i = 0; i < nrows; i++)
+			{
+				if (!isnulls[i])
+					hashes[i] ^= cdbhash_kernel(CDBHASH_KERNEL_INT4, datums[i]);
+			}
+			break;
+
+		case CDBHASH_KERNEL_INT8:
+			for (i = 0; i < nrows; i++)
+			{
+				if (!isnulls[i])
+					hashes[i] ^= cdbhash_kernel(CDBHASH_KERNEL_INT8, datums[i]);
+			}
+			break;
+
+		case CDBHASH_KERNEL_TEXT:
+			for (i = 0; i < nrows; i++)
+			{
+				if (!isnulls[i])
+					hashes[i] ^= cdbhash_kernel(CDBHASH_KERNEL_TEXT, datums[i]);
+			}
+			break;
+
+		case CDBHASH_KERNEL_NUMERIC:
+			for (i = 0; i < nrows; i++)
+			{
+				if (!isnulls[i])
+					hashes[i] ^= cdbhash_kernel(CDBHASH_KERNEL_NUMERIC, datums[i]);
+			}
+			break;
+
+		case CDBHASH_KERNEL_FMGR:
+			{
+				LOCAL_FCINFO(fcinfo, 1);
+
+				InitFunctionCallInfoData(*fcinfo, &h->hashfuncs[attno - 1], 1,
+										 DEFAULT_COLLATION_OID,
+										 NULL, NULL);
+
+				for (i = 0; i < nrows; i++)
+				{
+					if (!isnulls[i])
+						hashes[i] ^= cdbhash_fmgr(fcinfo, datums[i]);
+				}
+			}
+			break;
+	}
+}
+
+/*
+ * Reduce the hashes of a batch of tuples to segment numbers, in place, like
+ * cdbhashreduce().
+ */
+void
+cdbhashreducebatch(CdbHash *h, uint32 *hashes, int nrows)
+{
+	uint32		numsegs = (uint32) h->numsegs;
+	int			i;
+
+	Assert(h->natts > 0);
+
+	switch (h->reducealg)
+	{
+		case REDUCE_BITMASK:
+			for (i = 0; i < nrows; i++)
+				hashes[i] = FASTMOD(hashes[i], numsegs);
+			break;
+
+		case REDUCE_LAZYMOD:
+			for (i = 0; i < nrows; i++)
+				hashes[i] = hashes[i] % numsegs;
+			break;
+
+		case REDUCE_JUMP_HASH:
+			for (i = 0; i < nrows; i++)
+				hashes[i] = jump_consistent_hash(hashes[i], h->numsegs);
+			break;
+	}
+}
+
 /*
  * Return a random segment number, for randomly distributed policy.
  */
@@ -41,7 +41,6 @@ char *
 serializeNode(Node *node, int *size, int *uncompressed_size_out)
 {
 	char	   *pszNode;
-	char	   *sNode;
 	int			uncompressed_size;
 
 	Assert(node != NULL);
@@ -50,6 +49,21 @@ serializeNode(Node *node, int *size, int *uncompressed_size_out)
 	pszNode = nodeToBinaryStringFast(node, &uncompressed_size);
 	Assert(pszNode != NULL);
 
+	if (NULL != uncompressed_size_out)
+		*uncompressed_size_out = uncompressed_size;
+	return compressSerializedNode(pszNode, uncompressed_size, size);
+}
+
+/*
+ * Second half of serializeNode(), for callers that need to look at the
+ * uncompressed string from nodeToBinaryStringFast() first.  The input
+ * string is consumed.
+ */
+char *
+compressSerializedNode(char *pszNode, int uncompressed_size, int *size)
+{
+	char	   *sNode;
+
 	/* If we have been compiled with libzstd, use it to compress it */
 #ifdef USE_ZSTD
 	sNode = compress_string(pszNode, uncompressed_size, size);
@@ -59,8 +73,6 @@ serializeNode(Node *node, int *size, int *uncompressed_size_out)
 	*size = uncompressed_size;
 #endif
 
-	if (NULL != uncompressed_size_out)
-		*uncompressed_size_out = uncompressed_size;
 	return sNode;
 }
 
@@ -93,6 +105,29 @@ deserializeNode(const char *strNode, int size)
 	return node;
 }
 
+/*
+ * First half of deserializeNode(), for callers that need to look at the
+ * uncompressed string before passing it to readNodeFromBinaryString().
+ * The result is palloc'ed in the current memory context.
+ */
+char *
+uncompressSerializedNode(const char *strNode, int size, int *uncompressed_size)
+{
+	Assert(strNode != NULL);
+
+#ifdef USE_ZSTD
+	return uncompress_string(strNode, size, uncompressed_size);
+#else
+	{
+		char	   *sNode = palloc(size);
+
+		memcpy(sNode, strNode, size);
+		*uncompressed_size = size;
+		return sNode;
+	}
+#endif
+}
+
 #ifdef USE_ZSTD
 /*
  * Compress a (binary) string using libzstd
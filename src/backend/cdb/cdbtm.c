@@ -38,6 +38,7 @@
 #include "cdb/cdbvars.h"
 #include "access/transam.h"
 #include "access/xact.h"
+#include "access/xlog.h"
 #include "libpq-fe.h"
 #include "libpq-int.h"
 #include "cdb/cdbfts.h"
@@ -83,6 +84,9 @@ extern bool Test_print_direct_dispatch_info;
 
 #define DTX_PHASE2_SLEEP_TIME_BETWEEN_RETRIES_MSECS 100
 
+/* How often to check for the rest of a distributed commit group */
+#define DTX_GROUP_COMMIT_POLL_USECS 20
+
 uint32 *shmNextSnapshotId;
 slock_t *shmGxidGenLock;
 
@@ -488,6 +492,7 @@ doPrepareTransaction(void)
 
 	Assert(MyTmGxactLocal->state == DTX_STATE_PREPARING);
 	setCurrentDtxState(DTX_STATE_PREPARED);
+	MyTmGxact->commitPending = true;
 
 	SIMPLE_FAULT_INJECTOR("dtm_broadcast_prepare");
 
@@ -1426,6 +1431,7 @@ resetTmGxact(void)
 	MyTmGxact->xminDistributedSnapshot = InvalidDistributedTransactionId;
 	MyTmGxact->includeInCkpt = false;
 	MyTmGxact->sessionId = 0;
+	MyTmGxact->commitPending = false;
 
 	MyTmGxactLocal->explicitBeginRemembered = false;
 	MyTmGxactLocal->writerGangLost = false;
@@ -1482,6 +1488,7 @@ insertedDistributedCommitted(void)
 
 	Assert(MyTmGxactLocal->state == DTX_STATE_INSERTING_COMMITTED);
 	setCurrentDtxState(DTX_STATE_INSERTED_COMMITTED);
+	MyTmGxact->commitPending = false;
 
 	/*
 	 * We don't have to hold ProcArrayLock here because needIncludedInCkpt is used
@@ -1492,6 +1499,35 @@ insertedDistributedCommitted(void)
 		MyTmGxact->includeInCkpt = true;
 }
 
+/*
+ * Group commit of distributed commit records.
+ *
+ * Called after inserting our distributed commit record, before flushing it.
+ * If other distributed transactions have been prepared but not yet inserted
+ * their commit records, wait up to dtx_group_commit_delay microseconds for
+ * them, so that one WAL flush covers all of them: whichever backend gets
+ * WALWriteLock first in XLogFlush() flushes for everyone.
+ */
+void
+waitForDistributedCommitGroup(void)
+{
+	int			waited = 0;
+
+	if (dtx_group_commit_delay <= 0 || !enableFsync)
+		return;
+
+	while (waited < dtx_group_commit_delay && DistributedCommitsPending())
+	{
+		int			step = Min(DTX_GROUP_COMMIT_POLL_USECS,
+							   dtx_group_commit_delay - waited);
+
+		SIMPLE_FAULT_INJECTOR("dtx_group_commit_wait");
+
+		pg_usleep(step);
+		waited += step;
+	}
+}
+
 /*
  * When called, a SET command is dispatched and the writer gang
  * writes the shared snapshot. This function actually does nothing
@@ -212,6 +212,7 @@ bool		gp_interconnect_aggressive_retry = true;	/* fast-track app-level
 														 * retry */
 
 bool		gp_interconnect_full_crc = false;	/* sanity check UDP data. */
+bool		gp_interconnect_compression = false;	/* compress packet payloads */
 
 bool		gp_interconnect_log_stats = false;	/* emit stats at log-level */
 
@@ -262,10 +263,17 @@ double		gp_selectivity_damping_factor = 1;
 bool		gp_selectivity_damping_sigsort = true;
 
 int			gp_hashjoin_tuples_per_bucket = 5;
+bool		gp_enable_hybrid_hashjoin = false;
 
 /* Analyzing aid */
 int			gp_motion_slice_noop = 0;
 
+/* Batched hashing in redistribute motions */
+int			gp_motion_hash_batch_size = 0;
+
+/* Columnar batches in motions */
+int			gp_motion_columnar_batch_size = 0;
+
 /* Greenplum Database Experimental Feature GUCs */
 bool		gp_enable_explain_allstat = false;
 bool		gp_enable_motion_deadlock_sanity = false;	/* planning time sanity
@@ -305,6 +313,12 @@ bool		gp_enable_fast_sri = true;
 /* Enable single-mirror pair dispatch. */
 bool		gp_enable_direct_dispatch = true;
 
+/* Let QEs cache dispatched plans, and dispatch only their fingerprints. */
+bool		gp_enable_qe_plan_cache = false;
+
+/* Number of plans each QE caches. */
+int			gp_qe_plan_cache_size = 64;
+
 /* Force core dump on memory context error */
 bool		coredump_on_memerror = false;
 
@@ -26,6 +26,7 @@
 #include "libpq/pqformat.h"
 
 #include "cdb/cdbconn.h"		/* me */
+#include "cdb/cdbdisp_plancache.h"
 #include "cdb/cdbutil.h"		/* CdbComponentDatabaseInfo */
 #include "cdb/cdbvars.h"
 #include "cdb/cdbgang.h"
@@ -91,6 +92,10 @@ cdbconn_createSegmentDescriptor(struct CdbComponentDatabaseInfo *cdbinfo, int id
 	segdbDesc->isWriter = isWriter;
 	segdbDesc->establishConnTime = 0;
 
+	segdbDesc->planCache = NULL;
+	segdbDesc->planCacheLen = 0;
+	segdbDesc->planCacheSize = 0;
+
 	MemoryContextSwitchTo(oldContext);
 	return segdbDesc;
 }
@@ -334,6 +339,9 @@ cdbconn_disconnect(SegmentDatabaseDescriptor *segdbDesc)
 
 	PQfinish(segdbDesc->conn);
 	segdbDesc->conn = NULL;
+
+	/* a new connection is a new QE, with an empty plan cache */
+	DispatchPlanCacheReset(segdbDesc);
 }
 
 /*
@@ -331,6 +331,11 @@ cdbdisp_makeDispatcherState(bool isExtendedQuery)
 	handle->dispatcherState->largestGangSize = 0;
 	handle->dispatcherState->rootGangSize = 0;
 	handle->dispatcherState->destroyIdleReaderGang = false;
+	memset(&handle->dispatcherState->planKey, 0, sizeof(DispatchPlanKey));
+	handle->dispatcherState->planCacheSize = 0;
+	handle->dispatcherState->cachedQueryText = NULL;
+	handle->dispatcherState->cachedQueryTextLen = 0;
+	handle->dispatcherState->planQueryParms = NULL;
 
 	return handle->dispatcherState;
 }
@@ -28,6 +28,9 @@
 #include "tcop/tcopprot.h"
 #include "cdb/cdbdisp.h"
 #include "cdb/cdbdisp_async.h"
+#include "cdb/cdbdisp_plancache.h"
+#include "cdb/cdbdisp_query.h"
+#include "cdb/cdbdisp_stats.h"
 #include "cdb/cdbdispatchresult.h"
 #include "libpq-fe.h"
 #include "libpq-int.h"
@@ -93,6 +96,15 @@ typedef struct CdbDispatchCmdAsync
 	char	   *query_text;
 	int			query_text_len;
 
+	/*
+	 * For the dispatch latency histograms: when we started sending to the
+	 * first QE, when everything had been sent, and whether any QE has
+	 * responded since.
+	 */
+	instr_time	sendStart;
+	instr_time	sendFinish;
+	bool		firstAckSeen;
+
 } CdbDispatchCmdAsync;
 
 static void *cdbdisp_makeDispatchParams_async(int maxSlices, int largestGangSize, char *queryText, int len);
@@ -141,7 +153,13 @@ static void
 			handlePollError(CdbDispatchCmdAsync *pParms);
 
 static void
-			handlePollSuccess(CdbDispatchCmdAsync *pParms, WaitEvent *revents, int nready);
+			handlePollSuccess(CdbDispatcherState *ds, WaitEvent *revents, int nready);
+
+static void
+			buildFullQueryText(CdbDispatcherState *ds);
+
+static void
+			resendFullPlan(CdbDispatcherState *ds, CdbDispatchResult *dispatchResult);
 
 static bool
 			checkAckMessage(CdbDispatchResult *dispatchResult, const char *message);
@@ -216,15 +234,9 @@ cdbdisp_waitDispatchFinish_async(struct CdbDispatcherState *ds)
 	int				dispatchCount = pParms->dispatchCount;
 	const static int DISPATCH_POLL_TIMEOUT = 500;
 	int			i;
+	WaitEvent  *revents = NULL;
+	int		   *added = NULL;
 
-	/*
-	 * DispWaitSet's lifecycle is in the whole QD process,
-	 * so alloc it in the TopMemoryContext (rather than DispatcherContext)
-	 */
-	ResetWaitEventSet(&DispWaitSet, TopMemoryContext, dispatchCount);
-
-	WaitEvent 		*revents = palloc(sizeof(WaitEvent) * dispatchCount);
-	int 			*added = palloc0(sizeof(int) * dispatchCount);
 	while (true)
 	{
 		int			pollRet;
@@ -251,6 +263,22 @@ cdbdisp_waitDispatchFinish_async(struct CdbDispatcherState *ds)
 				continue;
 			else if (ret > 0)
 			{
+				/*
+				 * Usually the whole message fits in the socket buffer on the
+				 * first try, so set up the wait set only when we find that
+				 * we actually have to wait.
+				 *
+				 * DispWaitSet's lifecycle is in the whole QD process, so
+				 * alloc it in the TopMemoryContext (rather than
+				 * DispatcherContext)
+				 */
+				if (added == NULL)
+				{
+					ResetWaitEventSet(&DispWaitSet, TopMemoryContext, dispatchCount);
+					revents = palloc(sizeof(WaitEvent) * dispatchCount);
+					added = palloc0(sizeof(int) * dispatchCount);
+				}
+
 				/* add segment sock to the waitset */
 				if (!added[i])
 				{
@@ -289,8 +317,17 @@ cdbdisp_waitDispatchFinish_async(struct CdbDispatcherState *ds)
 		}
 		while (pollRet == 0);
 	}
-	pfree(revents);
-	pfree(added);
+	if (added != NULL)
+	{
+		pfree(revents);
+		pfree(added);
+	}
+
+	if (!INSTR_TIME_IS_ZERO(pParms->sendStart))
+	{
+		INSTR_TIME_SET_CURRENT(pParms->sendFinish);
+		DispatchStatsRecordSince(DISPATCH_PHASE_SEND, pParms->sendStart);
+	}
 }
 
 /*
@@ -308,6 +345,9 @@ cdbdisp_dispatchToGang_async(struct CdbDispatcherState *ds,
 
 	CdbDispatchCmdAsync *pParms = (CdbDispatchCmdAsync *) ds->dispatchParams;
 
+	if (INSTR_TIME_IS_ZERO(pParms->sendStart))
+		INSTR_TIME_SET_CURRENT(pParms->sendStart);
+
 	/*
 	 * Start the dispatching
 	 */
@@ -329,8 +369,19 @@ cdbdisp_dispatchToGang_async(struct CdbDispatcherState *ds,
 		}
 		pParms->dispatchResultPtrArray[pParms->dispatchCount++] = qeResult;
 
-		dispatchCommand(qeResult, pParms->query_text, pParms->query_text_len);
+		/* Send just the plan's key if the QE has the plan cached */
+		if (ds->planKey.fingerprint != 0 &&
+			DispatchPlanCacheLookup(segdbDesc, &ds->planKey,
+									ds->planCacheSize))
+			dispatchCommand(qeResult, ds->cachedQueryText, ds->cachedQueryTextLen);
+		else
+		{
+			buildFullQueryText(ds);
+			dispatchCommand(qeResult, pParms->query_text, pParms->query_text_len);
+		}
 	}
+
+	forwardQENotices();
 }
 
 /*
@@ -682,7 +733,7 @@ checkDispatchResult(CdbDispatcherState *ds, int timeout_sec)
 		}
 		/* We have data waiting on one or more of the connections. */
 		else
-			handlePollSuccess(pParms, revents, n);
+			handlePollSuccess(ds, revents, n);
 	} /* for (;;) */
 
 	pfree(revents);
@@ -712,14 +763,13 @@ dispatchCommand(CdbDispatchResult *dispatchResult,
 		char	   *msg = PQerrorMessage(dispatchResult->segdbDesc->conn);
 
 		dispatchResult->stillRunning = false;
+		DispatchPlanCacheReset(dispatchResult->segdbDesc);
 		ereport(ERROR,
 				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 				 errmsg("Command could not be dispatch to segment %s: %s",
 						dispatchResult->segdbDesc->whoami, msg ? msg : "unknown error")));
 	}
 
-	forwardQENotices();
-
 	if (DEBUG1 >= log_min_messages)
 	{
 		TimestampDifference(beforeSend, GetCurrentTimestamp(), &secs, &usecs);
@@ -825,9 +875,10 @@ handlePollError(CdbDispatchCmdAsync *pParms)
  * Receive and process results from QEs.
  */
 static void
-handlePollSuccess(CdbDispatchCmdAsync *pParms,
+handlePollSuccess(CdbDispatcherState *ds,
 				  WaitEvent *revents, int nready)
 {
+	CdbDispatchCmdAsync *pParms = (CdbDispatchCmdAsync *) ds->dispatchParams;
 	int			i = 0;
 
 	/*
@@ -867,11 +918,24 @@ handlePollSuccess(CdbDispatchCmdAsync *pParms,
 		ELOG_DISPATCHER_DEBUG("PQsocket says there are results from %ld of %d (%s)",
 							  pos + 1, pParms->dispatchCount, segdbDesc->whoami);
 
+		if (!pParms->firstAckSeen && !INSTR_TIME_IS_ZERO(pParms->sendFinish))
+		{
+			DispatchStatsRecordSince(DISPATCH_PHASE_FIRST_ACK, pParms->sendFinish);
+			pParms->firstAckSeen = true;
+		}
+
 		/*
 		 * Receive and process results from this QE.
 		 */
 		finished = processResults(dispatchResult);
 
+		/*
+		 * Did the QE ask for the plan, because it didn't have it cached after
+		 * all?  It's waiting for it, rather than failing the query.
+		 */
+		if (!finished && segdbDesc->conn->plan_cache_miss != 0)
+			resendFullPlan(ds, dispatchResult);
+
 		/*
 		 * Are we through with this QE now?
 		 */
@@ -906,6 +970,59 @@ handlePollSuccess(CdbDispatchCmdAsync *pParms,
 	}
 }
 
+/*
+ * Make sure the query text with the plan in full is available.  With the QE
+ * plan cache, cdbdisp_dispatchX() doesn't build it if it believes all the QEs
+ * have the plan cached.
+ */
+static void
+buildFullQueryText(CdbDispatcherState *ds)
+{
+	CdbDispatchCmdAsync *pParms = (CdbDispatchCmdAsync *) ds->dispatchParams;
+
+	if (pParms->query_text == NULL)
+		pParms->query_text = cdbdisp_buildFullPlanQueryText(ds, &pParms->query_text_len);
+}
+
+/*
+ * Dispatch the query again, with the plan in full, to a QE that was sent only
+ * the key of a plan it doesn't have cached.
+ */
+static void
+resendFullPlan(CdbDispatcherState *ds, CdbDispatchResult *dispatchResult)
+{
+	CdbDispatchCmdAsync *pParms = (CdbDispatchCmdAsync *) ds->dispatchParams;
+	SegmentDatabaseDescriptor *segdbDesc = dispatchResult->segdbDesc;
+	uint64		fingerprint = (uint64) segdbDesc->conn->plan_cache_miss;
+
+	segdbDesc->conn->plan_cache_miss = 0;
+
+	if (ds->planKey.fingerprint == 0 || fingerprint != ds->planKey.fingerprint)
+		elog(ERROR, "%s asked for plan " UINT64_FORMAT ", which was not dispatched to it",
+			 segdbDesc->whoami, fingerprint);
+
+	elog(LOG, "plan " UINT64_FORMAT " not found in plan cache of %s, dispatching it in full",
+		 fingerprint, segdbDesc->whoami);
+
+	/* Our idea of what the QE has cached was wrong, start over */
+	DispatchPlanCacheReset(segdbDesc);
+	(void) DispatchPlanCacheLookup(segdbDesc, &ds->planKey, ds->planCacheSize);
+
+	buildFullQueryText(ds);
+	if (PQresendGpQuery_shared(segdbDesc->conn, pParms->query_text,
+							   pParms->query_text_len) == 0)
+	{
+		char	   *msg = PQerrorMessage(segdbDesc->conn);
+
+		dispatchResult->stillRunning = false;
+		DispatchPlanCacheReset(segdbDesc);
+		ereport(ERROR,
+				(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+				 errmsg("Command could not be dispatch to segment %s: %s",
+						segdbDesc->whoami, msg ? msg : "unknown error")));
+	}
+}
+
 /*
  * Send finish or cancel signal to QEs if needed.
  */
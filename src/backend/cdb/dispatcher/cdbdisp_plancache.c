@@ -0,0 +1,420 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbdisp_plancache.c
+ *	  Caching of dispatched plans on the qExec processes.
+ *
+ * When the same plan is dispatched over and over again, e.g. by a prepared
+ * statement, each QE keeps the plan around after the first time, keyed by a
+ * fingerprint, a CRC and the length of its serialized form.  The next time,
+ * the QD dispatches only the key, and the QE uses the plan it already has,
+ * deserialized.
+ * The parameters, snapshot and slice table still travel in the
+ * QueryDispatchDesc as usual.
+ *
+ * The QD never asks a QE whether it has a plan.  Instead, it keeps a mirror
+ * of each QE's cache in its SegmentDatabaseDescriptor.  Both sides keep the
+ * 'cacheSize' most recently dispatched keys, in the same LRU order, and
+ * the size travels with each message, so the mirror always holds a
+ * subset of what the QE has.  Anything that could break that (an error on
+ * the QE, a new connection, a change of size) makes the QD forget what the
+ * QE has; it then just sends the plan in full again.
+ *
+ * Should the QE be sent the key of a plan it doesn't have after all, it
+ * doesn't fail the query.  It asks the QD for the plan instead, and waits for
+ * the QD to dispatch the query again, with the plan in full.
+ *
+ * Portions Copyright (c) 2012-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/cdb/dispatcher/cdbdisp_plancache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "common/hashfn.h"
+#include "libpq-fe.h"
+#include "libpq/libpq.h"
+#include "libpq/pqformat.h"
+#include "port/pg_crc32c.h"
+#include "utils/faultinjector.h"
+#include "utils/memutils.h"
+
+#include "cdb/cdbconn.h"
+#include "cdb/cdbdisp_plancache.h"
+#include "cdb/cdbsrlz.h"
+#include "cdb/cdbutil.h"
+
+/*
+ * A plan cached on a QE.  The serialized form is kept as it came in, and
+ * the plan is deserialized into 'cxt' the first time it's executed.
+ */
+typedef struct QEPlanCacheEntry
+{
+	DispatchPlanKey key;
+	uint64		lastUsed;		/* QEPlanCacheClock when last received */
+	char	   *splan;
+	int			splan_len;
+	MemoryContext cxt;
+	PlannedStmt *plan;			/* deserialized plan, or NULL */
+#ifdef USE_ASSERT_CHECKING
+	DispatchPlanKey planTreeKey;	/* key of 'plan', serialized again */
+#endif
+} QEPlanCacheEntry;
+
+static MemoryContext QEPlanCacheContext = NULL;
+static QEPlanCacheEntry *QEPlanCache = NULL;
+static int	QEPlanCacheLen = 0;
+static int	QEPlanCacheAlloc = 0;
+static uint64 QEPlanCacheClock = 0;
+
+static QEPlanCacheEntry *QEPlanCacheFind(const DispatchPlanKey *key);
+static void QEPlanCacheRemove(QEPlanCacheEntry *entry);
+static void QEPlanCacheEvict(int nentries);
+#ifdef USE_ASSERT_CHECKING
+static void QEPlanCacheTreeKey(PlannedStmt *plan, DispatchPlanKey *key);
+#endif
+
+/*
+ * DispatchPlanFingerprint
+ *		Compute the key of an uncompressed, serialized plan.
+ *
+ * The fingerprint and the CRC are computed by unrelated algorithms, so two
+ * plans that collide in one are no more likely to collide in the other.
+ * Zero means "no fingerprint" on the wire, so it's never used.
+ */
+void
+DispatchPlanFingerprint(const char *splan, int splan_len, DispatchPlanKey *key)
+{
+	pg_crc32c	crc;
+
+	key->fingerprint = hash_bytes_extended((const unsigned char *) splan,
+										   splan_len, (uint64) splan_len);
+	if (key->fingerprint == 0)
+		key->fingerprint = 1;
+
+	INIT_CRC32C(crc);
+	COMP_CRC32C(crc, splan, splan_len);
+	FIN_CRC32C(crc);
+	key->crc = crc;
+
+	key->len = splan_len;
+}
+
+/*
+ * DispatchPlanCacheContains
+ *		Does the QE have the plan cached, as far as the QD knows?
+ *
+ * If the cache size has changed since the last dispatch to the QE,
+ * DispatchPlanCacheLookup() will forget what it has, so this says no too.
+ */
+bool
+DispatchPlanCacheContains(SegmentDatabaseDescriptor *segdbDesc,
+						  const DispatchPlanKey *key, int cacheSize)
+{
+	int			i;
+
+	if (segdbDesc->planCacheSize != cacheSize)
+		return false;
+
+	for (i = 0; i < segdbDesc->planCacheLen; i++)
+	{
+		if (DispatchPlanKeyEquals(&segdbDesc->planCache[i], key))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * DispatchPlanCacheLookup
+ *		Record that the plan is being dispatched to the QE.
+ *
+ * Returns true if the QE already has the plan cached, so that only its
+ * key needs to be sent.  Otherwise the plan must be sent in full,
+ * and the QE will cache it, evicting its least recently used plan if
+ * needed.  This must do exactly what QEPlanCacheReceive() does on the QE.
+ */
+bool
+DispatchPlanCacheLookup(SegmentDatabaseDescriptor *segdbDesc,
+						const DispatchPlanKey *key, int cacheSize)
+{
+	int			i;
+	bool		found = false;
+
+	Assert(key->fingerprint != 0 && cacheSize > 0);
+
+	if (segdbDesc->planCacheSize != cacheSize)
+	{
+		DispatchPlanCacheReset(segdbDesc);
+		segdbDesc->planCache = (DispatchPlanKey *)
+			MemoryContextAlloc(CdbComponentsContext,
+							   cacheSize * sizeof(DispatchPlanKey));
+		segdbDesc->planCacheSize = cacheSize;
+	}
+
+	for (i = 0; i < segdbDesc->planCacheLen; i++)
+	{
+		if (DispatchPlanKeyEquals(&segdbDesc->planCache[i], key))
+		{
+			found = true;
+			break;
+		}
+	}
+
+	/*
+	 * Move it to the front.  If it's new, the last one falls off the end
+	 * when the cache is full.
+	 */
+	if (!found)
+	{
+		if (segdbDesc->planCacheLen < cacheSize)
+			segdbDesc->planCacheLen++;
+		i = segdbDesc->planCacheLen - 1;
+	}
+	memmove(&segdbDesc->planCache[1], &segdbDesc->planCache[0],
+			i * sizeof(DispatchPlanKey));
+	segdbDesc->planCache[0] = *key;
+
+	return found;
+}
+
+/*
+ * DispatchPlanCacheReset
+ *		Forget which plans the QE has cached.
+ */
+void
+DispatchPlanCacheReset(SegmentDatabaseDescriptor *segdbDesc)
+{
+	if (segdbDesc->planCache)
+		pfree(segdbDesc->planCache);
+	segdbDesc->planCache = NULL;
+	segdbDesc->planCacheLen = 0;
+	segdbDesc->planCacheSize = 0;
+}
+
+/*
+ * QEPlanCacheReceive
+ *		Process the plan of a dispatched query that carries a fingerprint.
+ *
+ * Called as soon as the message has been read, before anything else can
+ * fail, so that the cache stays in step with the QD's mirror of it.  If the
+ * plan was sent in full, it's added to the cache.  If only the key was
+ * sent, the cached serialized plan is returned in its place, or NULL if
+ * there is no plan cached under that key.  The caller must then ask the QD
+ * for the plan with QEPlanCacheRequestPlan().
+ */
+const char *
+QEPlanCacheReceive(const DispatchPlanKey *key, int cacheSize,
+				   const char *splan, int *splan_len)
+{
+	QEPlanCacheEntry *entry;
+
+	Assert(key->fingerprint != 0);
+
+	if (cacheSize <= 0)
+		elog(ERROR, "MPPEXEC: invalid plan cache size %d", cacheSize);
+
+	if (QEPlanCacheContext == NULL)
+		QEPlanCacheContext = AllocSetContextCreate(TopMemoryContext,
+												   "QE plan cache",
+												   ALLOCSET_DEFAULT_SIZES);
+
+	/* The QD may have changed the size since last time */
+	if (QEPlanCacheLen > cacheSize)
+		QEPlanCacheEvict(QEPlanCacheLen - cacheSize);
+
+	entry = QEPlanCacheFind(key);
+
+#ifdef FAULT_INJECTOR
+	/* Lose the plan, as if the QD's mirror of the cache were out of step */
+	if (entry != NULL && *splan_len == 0 &&
+		SIMPLE_FAULT_INJECTOR("qe_plan_cache_lose_plan") == FaultInjectorTypeSkip)
+	{
+		QEPlanCacheRemove(entry);
+		entry = NULL;
+	}
+#endif
+
+	if (entry == NULL)
+	{
+		if (*splan_len == 0)
+			return NULL;
+
+		if (QEPlanCacheLen == cacheSize)
+			QEPlanCacheEvict(1);
+
+		if (QEPlanCacheLen == QEPlanCacheAlloc)
+		{
+			int			newalloc = Max(cacheSize, 8);
+
+			if (QEPlanCache == NULL)
+				QEPlanCache = (QEPlanCacheEntry *)
+					MemoryContextAlloc(QEPlanCacheContext,
+									   newalloc * sizeof(QEPlanCacheEntry));
+			else
+				QEPlanCache = (QEPlanCacheEntry *)
+					repalloc(QEPlanCache, newalloc * sizeof(QEPlanCacheEntry));
+			QEPlanCacheAlloc = newalloc;
+		}
+
+		entry = &QEPlanCache[QEPlanCacheLen++];
+		entry->key = *key;
+		entry->cxt = AllocSetContextCreate(QEPlanCacheContext,
+										   "QE cached plan",
+										   ALLOCSET_SMALL_SIZES);
+		entry->splan = MemoryContextAlloc(entry->cxt, *splan_len);
+		memcpy(entry->splan, splan, *splan_len);
+		entry->splan_len = *splan_len;
+		entry->plan = NULL;
+	}
+
+	entry->lastUsed = ++QEPlanCacheClock;
+
+	*splan_len = entry->splan_len;
+	return entry->splan;
+}
+
+/*
+ * QEPlanCacheRequestPlan
+ *		Ask the QD to dispatch the query again, with the plan in full.
+ *
+ * For when QEPlanCacheReceive() didn't find the plan.  The QD answers with
+ * the whole query message; the caller just goes back to reading messages.
+ * Neither the QD nor the QE has set up anything for the query yet, so
+ * there's nothing to clean up.
+ */
+void
+QEPlanCacheRequestPlan(const DispatchPlanKey *key)
+{
+	StringInfoData buf;
+
+	elog(DEBUG1, "plan " UINT64_FORMAT " not found in plan cache, asking QD for it",
+		 key->fingerprint);
+
+	pq_beginmessage(&buf, 'p');
+	pq_sendint64(&buf, key->fingerprint);
+	pq_endmessage(&buf);
+	pq_flush();
+}
+
+/*
+ * QEPlanCacheGetPlan
+ *		Get the deserialized plan for a key just received.
+ *
+ * The first time, the plan is checked against its key, so that a plan that
+ * doesn't match (which would be a bug on the QD) is never executed.
+ *
+ * The plan is shared by all executions of it.  Like a plan in the plancache
+ * on the QD, it must be treated as read-only by the executor; the caller
+ * must make a copy of any part it needs to modify.  Assert-enabled builds
+ * check that each time the plan is used again.
+ */
+PlannedStmt *
+QEPlanCacheGetPlan(const DispatchPlanKey *key)
+{
+	QEPlanCacheEntry *entry = QEPlanCacheFind(key);
+
+	if (entry == NULL)
+		elog(ERROR, "MPPEXEC: plan " UINT64_FORMAT " not found in plan cache",
+			 key->fingerprint);
+
+	if (entry->plan == NULL)
+	{
+		MemoryContext oldcontext;
+		DispatchPlanKey check;
+		PlannedStmt *plan;
+		char	   *str;
+		int			len;
+
+		str = uncompressSerializedNode(entry->splan, entry->splan_len, &len);
+		DispatchPlanFingerprint(str, len, &check);
+		if (!DispatchPlanKeyEquals(&check, &entry->key))
+		{
+			QEPlanCacheRemove(entry);
+			elog(ERROR, "MPPEXEC: plan " UINT64_FORMAT " received does not match its fingerprint",
+				 key->fingerprint);
+		}
+
+		oldcontext = MemoryContextSwitchTo(entry->cxt);
+		plan = (PlannedStmt *) readNodeFromBinaryString(str, len);
+		MemoryContextSwitchTo(oldcontext);
+		pfree(str);
+
+		if (!plan || !IsA(plan, PlannedStmt))
+		{
+			QEPlanCacheRemove(entry);
+			elog(ERROR, "MPPEXEC: receive invalid planned statement");
+		}
+		entry->plan = plan;
+#ifdef USE_ASSERT_CHECKING
+		QEPlanCacheTreeKey(entry->plan, &entry->planTreeKey);
+#endif
+	}
+#ifdef USE_ASSERT_CHECKING
+	else
+	{
+		DispatchPlanKey treeKey;
+
+		/* Check that the last execution didn't scribble on the plan */
+		QEPlanCacheTreeKey(entry->plan, &treeKey);
+		Assert(DispatchPlanKeyEquals(&treeKey, &entry->planTreeKey));
+	}
+#endif
+
+	return entry->plan;
+}
+
+static QEPlanCacheEntry *
+QEPlanCacheFind(const DispatchPlanKey *key)
+{
+	int			i;
+
+	for (i = 0; i < QEPlanCacheLen; i++)
+	{
+		if (DispatchPlanKeyEquals(&QEPlanCache[i].key, key))
+			return &QEPlanCache[i];
+	}
+	return NULL;
+}
+
+#ifdef USE_ASSERT_CHECKING
+static void
+QEPlanCacheTreeKey(PlannedStmt *plan, DispatchPlanKey *key)
+{
+	char	   *str;
+	int			len;
+
+	str = nodeToBinaryStringFast(plan, &len);
+	DispatchPlanFingerprint(str, len, key);
+	pfree(str);
+}
+#endif
+
+static void
+QEPlanCacheRemove(QEPlanCacheEntry *entry)
+{
+	MemoryContextDelete(entry->cxt);
+	*entry = QEPlanCache[--QEPlanCacheLen];
+}
+
+/*
+ * Evict the 'nentries' least recently used plans.
+ */
+static void
+QEPlanCacheEvict(int nentries)
+{
+	while (nentries-- > 0 && QEPlanCacheLen > 0)
+	{
+		int			victim = 0;
+		int			i;
+
+		for (i = 1; i < QEPlanCacheLen; i++)
+		{
+			if (QEPlanCache[i].lastUsed < QEPlanCache[victim].lastUsed)
+				victim = i;
+		}
+
+		QEPlanCacheRemove(&QEPlanCache[victim]);
+	}
+}
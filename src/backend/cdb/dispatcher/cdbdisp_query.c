@@ -45,6 +45,8 @@
 #include "cdb/cdbdisp.h"
 #include "cdb/cdbdisp_query.h"
 #include "cdb/cdbdisp_dtx.h"	/* for qdSerializeDtxContextInfo() */
+#include "cdb/cdbdisp_plancache.h"
+#include "cdb/cdbdisp_stats.h"
 #include "cdb/cdbdispatchresult.h"
 #include "cdb/cdbcopy.h"
 #include "executor/execUtils.h"
@@ -87,6 +89,19 @@ typedef struct DispatchCommandQueryParms
 	char	   *serializedQueryDispatchDesc;
 	int			serializedQueryDispatchDesclen;
 
+	/*
+	 * With the QE plan cache, the plan's key and the size of the cache, else
+	 * 0.  The plan is then kept uncompressed until we know whether any QE
+	 * needs it in full, see cdbdisp_dispatchX().
+	 */
+	DispatchPlanKey planKey;
+	int			planCacheSize;
+	char	   *uncompressedPlantree;
+	int			uncompressedPlantreelen;
+
+	/* Time spent compressing the plan, for the dispatch statistics */
+	instr_time	compressTime;
+
 	/*
 	 * Additional information.
 	 */
@@ -122,6 +137,9 @@ cdbdisp_dispatchX(QueryDesc *queryDesc,
 			bool cancelOnError);
 
 static List *formIdleSegmentIdList(void);
+static bool planCachedOnAllQEs(SliceVec *sliceVector, int nSlices,
+							   const DispatchPlanKey *key, int cacheSize);
+static void compressPlanQueryParms(DispatchCommandQueryParms *pQueryParms);
 
 static bool param_walker(Node *node, ParamWalkerContext *context);
 static Oid	findParamType(List *params, int paramid);
@@ -635,7 +653,7 @@ cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc,
 	 * (corresponding to an initPlan or the main plan), so the parameters are
 	 * fixed and we can include them in the prefix.
 	 */
-	splan = serializeNode((Node *) queryDesc->plannedstmt, &splan_len, &splan_len_uncompressed);
+	splan = nodeToBinaryStringFast((Node *) queryDesc->plannedstmt, &splan_len_uncompressed);
 
 	uint64		plan_size_in_kb = ((uint64) splan_len_uncompressed) / (uint64) 1024;
 
@@ -652,7 +670,32 @@ cdbdisp_buildPlanQueryParms(struct QueryDesc *queryDesc,
 				  errhint("Size controlled by gp_max_plan_size"))));
 	}
 
-	Assert(splan != NULL && splan_len > 0 && splan_len_uncompressed > 0);
+	Assert(splan != NULL && splan_len_uncompressed > 0);
+
+	/*
+	 * If the QEs may have the plan cached, hold off compressing it until
+	 * cdbdisp_dispatchX() knows whether we need to send it at all.
+	 */
+	if (gp_enable_qe_plan_cache &&
+		splan_len_uncompressed <= PLAN_CACHE_MAX_PLAN_SIZE)
+	{
+		DispatchPlanFingerprint(splan, splan_len_uncompressed,
+								&pQueryParms->planKey);
+		pQueryParms->planCacheSize = gp_qe_plan_cache_size;
+		pQueryParms->uncompressedPlantree = splan;
+		pQueryParms->uncompressedPlantreelen = splan_len_uncompressed;
+		splan = NULL;
+		splan_len = 0;
+	}
+	else
+	{
+		instr_time	starttime;
+
+		INSTR_TIME_SET_CURRENT(starttime);
+		splan = compressSerializedNode(splan, splan_len_uncompressed, &splan_len);
+		INSTR_TIME_SET_CURRENT(pQueryParms->compressTime);
+		INSTR_TIME_SUBTRACT(pQueryParms->compressTime, starttime);
+	}
 
 	GetUserIdAndSecContext(&save_userid, &queryDesc->ddesc->secContext);
 	sddesc = serializeNode((Node *) queryDesc->ddesc, &sddesc_len, NULL /* uncompressed_size */ );
@@ -858,6 +901,8 @@ buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
 	int			sddesc_len = pQueryParms->serializedQueryDispatchDesclen;
 	const char *dtxContextInfo = pQueryParms->serializedDtxContextInfo;
 	int			dtxContextInfo_len = pQueryParms->serializedDtxContextInfolen;
+	const DispatchPlanKey *planKey = &pQueryParms->planKey;
+	int32		planCacheSize = pQueryParms->planCacheSize;
 	int64		currentStatementStartTimestamp = GetCurrentStatementStartTimestamp();
 	Oid			sessionUserId = GetSessionUserId();
 	Oid			outerUserId = GetOuterUserId();
@@ -891,7 +936,7 @@ buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
 	 * character.
 	 */
 	command_len = strlen(command) + 1;
-	if (plantree && command_len > QUERY_STRING_TRUNCATE_SIZE)
+	if ((plantree || planKey->fingerprint) && command_len > QUERY_STRING_TRUNCATE_SIZE)
 		command_len = pg_mbcliplen(command, command_len,
 								   QUERY_STRING_TRUNCATE_SIZE-1) + 1;
 
@@ -919,6 +964,10 @@ buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
 		resgroupInfo.len +
 		sizeof(tempNamespaceId) +
 		sizeof(tempToastNamespaceId) +
+		sizeof(n32) * 2 /* planKey->fingerprint */ +
+		sizeof(planKey->crc) +
+		sizeof(planKey->len) +
+		sizeof(planCacheSize) +
 		0;
 
 	shared_query = palloc(total_query_len);
@@ -1024,6 +1073,32 @@ buildGpQueryString(DispatchCommandQueryParms *pQueryParms,
 	memcpy(pos, &tempToastNamespaceId, sizeof(tempToastNamespaceId));
 	pos += sizeof(tempToastNamespaceId);
 
+	/*
+	 * QE plan cache.  If the key is set but there's no plan, the QE is to use
+	 * the plan it has cached.
+	 */
+	n32 = (uint32) (planKey->fingerprint >> 32);
+	n32 = htonl(n32);
+	memcpy(pos, &n32, sizeof(n32));
+	pos += sizeof(n32);
+
+	n32 = (uint32) planKey->fingerprint;
+	n32 = htonl(n32);
+	memcpy(pos, &n32, sizeof(n32));
+	pos += sizeof(n32);
+
+	n32 = htonl(planKey->crc);
+	memcpy(pos, &n32, sizeof(n32));
+	pos += sizeof(n32);
+
+	tmp = htonl(planKey->len);
+	memcpy(pos, &tmp, sizeof(planKey->len));
+	pos += sizeof(planKey->len);
+
+	tmp = htonl(planCacheSize);
+	memcpy(pos, &tmp, sizeof(planCacheSize));
+	pos += sizeof(planCacheSize);
+
 	/*
 	 * fill in length placeholder
 	 */
@@ -1062,6 +1137,8 @@ cdbdisp_dispatchX(QueryDesc* queryDesc,
 	CdbDispatcherState *ds;
 	ErrorData *qeError = NULL;
 	DispatchCommandQueryParms *pQueryParms;
+	instr_time	starttime;
+	instr_time	serializeTime;
 
 	if (log_dispatch_stats)
 		ResetUsage();
@@ -1095,8 +1172,35 @@ cdbdisp_dispatchX(QueryDesc* queryDesc,
 	/* Each slice table has a unique-id. */
 	sliceTbl->ic_instance_id = ++gp_interconnect_id;
 
+	INSTR_TIME_SET_CURRENT(starttime);
 	pQueryParms = cdbdisp_buildPlanQueryParms(queryDesc, planRequiresTxn);
-	queryText = buildGpQueryString(pQueryParms, &queryTextLength);
+
+	/*
+	 * With the QE plan cache, build the query text without the plan for the
+	 * QEs that have it cached, and compress the plan and build the full text
+	 * only if there's any QE that doesn't.
+	 */
+	if (pQueryParms->planKey.fingerprint != 0)
+	{
+		ds->planKey = pQueryParms->planKey;
+		ds->planCacheSize = pQueryParms->planCacheSize;
+		ds->planQueryParms = pQueryParms;
+		ds->cachedQueryText = buildGpQueryString(pQueryParms,
+												 &ds->cachedQueryTextLen);
+
+		if (!planCachedOnAllQEs(sliceVector, nSlices, &ds->planKey,
+								ds->planCacheSize))
+			compressPlanQueryParms(pQueryParms);
+	}
+	if (pQueryParms->serializedPlantree != NULL)
+		queryText = buildGpQueryString(pQueryParms, &queryTextLength);
+
+	INSTR_TIME_SET_CURRENT(serializeTime);
+	INSTR_TIME_SUBTRACT(serializeTime, starttime);
+	INSTR_TIME_SUBTRACT(serializeTime, pQueryParms->compressTime);
+	DispatchStatsRecord(DISPATCH_PHASE_SERIALIZE, serializeTime);
+	if (pQueryParms->serializedPlantree != NULL)
+		DispatchStatsRecord(DISPATCH_PHASE_COMPRESS, pQueryParms->compressTime);
 
 	/*
 	 * Allocate result array with enough slots for QEs of primary gangs.
@@ -1382,6 +1486,81 @@ CdbDispatchCopyEnd(struct CdbCopy *cdbCopy)
 	cdbdisp_destroyDispatcherState(ds);
 }
 
+/*
+ * Do all the QEs we're about to dispatch the plan to have it cached, as far
+ * as we know?
+ */
+static bool
+planCachedOnAllQEs(SliceVec *sliceVector, int nSlices,
+				   const DispatchPlanKey *key, int cacheSize)
+{
+	int			iSlice;
+	int			i;
+
+	for (iSlice = 0; iSlice < nSlices; iSlice++)
+	{
+		ExecSlice  *slice = sliceVector[iSlice].slice;
+		Gang	   *gang;
+
+		if (slice == NULL || slice->gangType == GANGTYPE_UNALLOCATED)
+			continue;
+
+		gang = slice->primaryGang;
+		for (i = 0; i < gang->size; i++)
+		{
+			if (!DispatchPlanCacheContains(gang->db_descriptors[i], key,
+										   cacheSize))
+				return false;
+		}
+	}
+	return true;
+}
+
+/*
+ * Compress the plan that cdbdisp_buildPlanQueryParms() left uncompressed
+ * for the QE plan cache.
+ */
+static void
+compressPlanQueryParms(DispatchCommandQueryParms *pQueryParms)
+{
+	instr_time	starttime;
+
+	Assert(pQueryParms->uncompressedPlantree != NULL);
+
+	INSTR_TIME_SET_CURRENT(starttime);
+	pQueryParms->serializedPlantree =
+		compressSerializedNode(pQueryParms->uncompressedPlantree,
+							   pQueryParms->uncompressedPlantreelen,
+							   &pQueryParms->serializedPlantreelen);
+	pQueryParms->uncompressedPlantree = NULL;
+	INSTR_TIME_SET_CURRENT(pQueryParms->compressTime);
+	INSTR_TIME_SUBTRACT(pQueryParms->compressTime, starttime);
+}
+
+/*
+ * Build the query text with the plan in full, for a QE that was sent only
+ * the key of a plan it turned out not to have cached.  cdbdisp_dispatchX()
+ * builds it up front if it knows some QE needs it; otherwise the plan is
+ * compressed now.
+ */
+char *
+cdbdisp_buildFullPlanQueryText(CdbDispatcherState *ds, int *len)
+{
+	DispatchCommandQueryParms *pQueryParms = ds->planQueryParms;
+
+	Assert(pQueryParms != NULL);
+
+	if (pQueryParms->serializedPlantree == NULL)
+	{
+		MemoryContext oldContext = MemoryContextSwitchTo(DispatcherContext);
+
+		compressPlanQueryParms(pQueryParms);
+		MemoryContextSwitchTo(oldContext);
+	}
+
+	return buildGpQueryString(pQueryParms, len);
+}
+
 /*
  * Helper function only used by CdbDispatchSetCommand()
  *
@@ -1389,6 +1568,7 @@ CdbDispatchCopyEnd(struct CdbCopy *cdbCopy)
  * may contain duplicated segment id. eg, if segment 0 has two
  * idle segment dbs in freelist, the list looks like 0 -> 0.
  */
+
 static List *
 formIdleSegmentIdList(void)
 {
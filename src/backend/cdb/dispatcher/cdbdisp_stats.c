@@ -0,0 +1,186 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbdisp_stats.c
+ *	  Latency histograms of the phases of dispatching a command.
+ *
+ * Every dispatch on the QD adds the time it spent in each phase to a
+ * histogram in shared memory, with power-of-two buckets in microseconds.
+ * They're shown by the gp_dispatch_latency view.
+ *
+ * Portions Copyright (c) 2012-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/cdb/dispatcher/cdbdisp_stats.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "funcapi.h"
+#include "catalog/pg_type.h"
+#include "port/atomics.h"
+#include "port/pg_bitutils.h"
+#include "storage/shmem.h"
+#include "utils/builtins.h"
+
+#include "cdb/cdbdisp_stats.h"
+
+typedef struct DispatchStatsData
+{
+	pg_atomic_uint64 counts[NUM_DISPATCH_PHASES][DISPATCH_STATS_NUM_BUCKETS];
+} DispatchStatsData;
+
+static DispatchStatsData *DispatchStats = NULL;
+
+static const char *const DispatchPhaseNames[NUM_DISPATCH_PHASES] = {
+	"serialize",
+	"compress",
+	"send",
+	"first_ack"
+};
+
+Datum		gp_dispatch_latency(PG_FUNCTION_ARGS);
+Datum		gp_dispatch_latency_reset(PG_FUNCTION_ARGS);
+
+Size
+DispatchStatsShmemSize(void)
+{
+	return MAXALIGN(sizeof(DispatchStatsData));
+}
+
+void
+DispatchStatsShmemInit(void)
+{
+	bool		found;
+	int			i;
+	int			j;
+
+	DispatchStats = (DispatchStatsData *)
+		ShmemInitStruct("Dispatch latency histograms",
+						DispatchStatsShmemSize(), &found);
+
+	if (!found)
+	{
+		for (i = 0; i < NUM_DISPATCH_PHASES; i++)
+			for (j = 0; j < DISPATCH_STATS_NUM_BUCKETS; j++)
+				pg_atomic_init_u64(&DispatchStats->counts[i][j], 0);
+	}
+}
+
+/*
+ * Add a duration to the histogram of a phase.
+ */
+void
+DispatchStatsRecord(DispatchPhase phase, instr_time elapsed)
+{
+	uint64		us;
+	int			bucket;
+
+	Assert(phase >= 0 && phase < NUM_DISPATCH_PHASES);
+
+	if (DispatchStats == NULL)
+		return;
+
+	us = INSTR_TIME_GET_MICROSEC(elapsed);
+	if (us == 0)
+		bucket = 0;
+	else
+		bucket = Min(pg_leftmost_one_pos64(us) + 1,
+					 DISPATCH_STATS_NUM_BUCKETS - 1);
+
+	pg_atomic_fetch_add_u64(&DispatchStats->counts[phase][bucket], 1);
+}
+
+/*
+ * Add the time from 'start' until now to the histogram of a phase.
+ */
+void
+DispatchStatsRecordSince(DispatchPhase phase, instr_time start)
+{
+	instr_time	elapsed;
+
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+	DispatchStatsRecord(phase, elapsed);
+}
+
+/*
+ * gp_dispatch_latency - return the histograms, one row per bucket
+ */
+Datum
+gp_dispatch_latency(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc	tupdesc;
+		MemoryContext oldcontext;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		/* this had better match gp_dispatch_latency in pg_proc.dat */
+		tupdesc = CreateTemplateTupleDesc(4);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "phase",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "lower_us",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "upper_us",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "count",
+						   INT8OID, -1, 0);
+		funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+		funcctx->max_calls = NUM_DISPATCH_PHASES * DISPATCH_STATS_NUM_BUCKETS;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+
+	if (DispatchStats != NULL && funcctx->call_cntr < funcctx->max_calls)
+	{
+		int			phase = funcctx->call_cntr / DISPATCH_STATS_NUM_BUCKETS;
+		int			bucket = funcctx->call_cntr % DISPATCH_STATS_NUM_BUCKETS;
+		Datum		values[4];
+		bool		nulls[4];
+		HeapTuple	tuple;
+
+		MemSet(nulls, false, sizeof(nulls));
+
+		values[0] = CStringGetTextDatum(DispatchPhaseNames[phase]);
+		values[1] = Int64GetDatum(bucket == 0 ? 0 : INT64CONST(1) << (bucket - 1));
+		if (bucket == DISPATCH_STATS_NUM_BUCKETS - 1)
+			nulls[2] = true;
+		else
+			values[2] = Int64GetDatum(INT64CONST(1) << bucket);
+		values[3] = Int64GetDatum((int64)
+								  pg_atomic_read_u64(&DispatchStats->counts[phase][bucket]));
+
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+
+	SRF_RETURN_DONE(funcctx);
+}
+
+/*
+ * gp_dispatch_latency_reset - zero the histograms
+ */
+Datum
+gp_dispatch_latency_reset(PG_FUNCTION_ARGS)
+{
+	int			i;
+	int			j;
+
+	if (DispatchStats != NULL)
+	{
+		for (i = 0; i < NUM_DISPATCH_PHASES; i++)
+			for (j = 0; j < DISPATCH_STATS_NUM_BUCKETS; j++)
+				pg_atomic_write_u64(&DispatchStats->counts[i][j], 0);
+	}
+
+	PG_RETURN_VOID();
+}
@@ -22,6 +22,7 @@
 #include "utils/guc.h"			/* log_min_messages */
 
 #include "cdb/cdbconn.h"		/* SegmentDatabaseDescriptor */
+#include "cdb/cdbdisp_plancache.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbsreh.h"
 #include "cdb/cdbdispatchresult.h"
@@ -254,6 +255,13 @@ cdbdisp_seterrcode(int errcode, /* ERRCODE_xxx or 0 */
 		dispatchResult->errcode = errcode;
 	}
 
+	/*
+	 * The QE might not have processed the plan it was sent, so don't trust
+	 * our idea of what it has cached any more.
+	 */
+	if (dispatchResult->segdbDesc)
+		DispatchPlanCacheReset(dispatchResult->segdbDesc);
+
 	if (!meleeResults)
 		return;
 
@@ -3,14 +3,42 @@
 #include "libpq-int.h"
 #include "cdb/cdbpq.h"
 
+static int sendGpQuery_shared(PGconn *conn, char *shared_query, int query_len, bool nonblock);
+
 int
 PQsendGpQuery_shared(PGconn *conn, char *shared_query, int query_len, bool nonblock)
 {
-	int ret;
-
 	if (!PQsendQueryStart(conn))
 		return 0;
 
+	return sendGpQuery_shared(conn, shared_query, query_len, nonblock);
+}
+
+/*
+ * Send a query again, while it's still in progress.  This is for a QE that
+ * was sent only the key of a plan it doesn't have cached after all, and has
+ * asked for the query with the plan in full, see cdbdisp_plancache.c.  The
+ * QE hasn't started on the query, so as far as libpq is concerned, it's
+ * still the same query.
+ */
+int
+PQresendGpQuery_shared(PGconn *conn, char *shared_query, int query_len)
+{
+	if (conn->asyncStatus != PGASYNC_BUSY)
+	{
+		printfPQExpBuffer(&conn->errorMessage,
+						  libpq_gettext("no query in progress to send again\n"));
+		return 0;
+	}
+
+	return sendGpQuery_shared(conn, shared_query, query_len, false);
+}
+
+static int
+sendGpQuery_shared(PGconn *conn, char *shared_query, int query_len, bool nonblock)
+{
+	int ret;
+
 	if (!shared_query)
 	{
 		printfPQExpBuffer(&conn->errorMessage,
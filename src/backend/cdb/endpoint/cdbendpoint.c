@@ -28,11 +28,11 @@
  * endpoint queries or on QE's retrieve session by UDF gp_get_segment_endpoints().
  *
  * Instead of returning the query result to QD through a normal dest receiver,
- * endpoints write the results to TQueueDestReceiver which is a shared memory
- * queue and can be retrieved from a different process. See
- * SetupEndpointExecState(). The information about the message queue
- * is also stored in the Endpoint so that the retrieve session on the same QE
- * can know.
+ * endpoints write the results to EndpointDestReceiver, which sends them in
+ * batches through a shared memory queue so that they can be retrieved from a
+ * different process. See SetupEndpointExecState(). The information about the
+ * message queue is also stored in the Endpoint so that the retrieve session on
+ * the same QE can know.
  *
  * The token is stored in a different structure EndpointTokenEntry to make the
  * tokens same for all backends within the same session under the same postmaster.
@@ -87,10 +87,10 @@
 #define WAIT_ENDPOINT_TIMEOUT_MS	100
 
 /*
- * The size of endpoint tuple queue in bytes.
- * This value refers upstream PARALLEL_TUPLE_QUEUE_SIZE
+ * The size of endpoint tuple queue in bytes. Large enough to hold a few
+ * batches of the largest gp_endpoint_batch_size.
  */
-#define ENDPOINT_TUPLE_QUEUE_SIZE		65536
+#define ENDPOINT_TUPLE_QUEUE_SIZE		(4 * MAX_ENDPOINT_BATCH_SIZE * 1024)
 
 #define SHMEM_ENDPOINTS_ENTRIES			"SharedMemoryEndpointEntries"
 #define SHMEM_ENPOINTS_SESSION_INFO		"EndpointsSessionInfosHashtable"
@@ -103,6 +103,24 @@
 
 static EndpointExecState * CurrentEndpointExecState;
 
+/*
+ * DestReceiver of an endpoint.
+ *
+ * Rather than a message on the shared memory queue per tuple, as the upstream
+ * TQueueDestReceiver does, the tuples are collected into batches of up to
+ * gp_endpoint_batch_size bytes, and each batch is sent as one message. See
+ * cdbendpoint_private.h for the layout. A tuple larger than that is sent in a
+ * batch of its own.
+ */
+typedef struct EndpointDestReceiver
+{
+	DestReceiver pub;			/* public fields */
+	shm_mq_handle *mqHandle;	/* shm_mq to send to */
+	char	   *batch;			/* tuples not sent yet */
+	Size		batchLen;		/* bytes used in batch */
+	Size		batchSize;		/* size of batch, 0 to send each tuple */
+}			EndpointDestReceiver;
+
 typedef struct EndpointTokenTag
 {
 	int			sessionID;
@@ -142,6 +160,9 @@ static const int8 *create_endpoint_token(void);
 /* Endpoint helper function */
 static Endpoint *alloc_endpoint(const char *cursorName, dsm_handle dsmHandle);
 static void free_endpoint(Endpoint *endpoint);
+static DestReceiver *create_endpoint_dest_receiver(shm_mq_handle *mqHandle);
+static bool send_endpoint_batch(EndpointDestReceiver *receiver,
+								const char *data, Size len);
 static void create_and_connect_mq(TupleDesc tupleDesc,
 								  dsm_segment **mqSeg /* out */ ,
 								  shm_mq_handle **mqHandle /* out */ );
@@ -246,17 +267,17 @@ InitSharedEndpoints()
 
 /*
  * Get the endpoint location. Currently used in EXPLAIN only.
+ *
+ * The endpoints are wherever the top slice runs. Look at its gang rather
+ * than at the flow of the plan tree, ORCA doesn't set flows.
  */
 enum EndPointExecPosition
 GetParallelCursorEndpointPosition(PlannedStmt *plan)
 {
-	if (plan->planTree->flow->flotype == FLOW_SINGLETON)
-	{
-		if (plan->planTree->flow->locustype == CdbLocusType_SegmentGeneral)
-			return ENDPOINT_ON_SINGLE_QE;
-		else
-			return ENDPOINT_ON_ENTRY_DB;
-	}
+	if (plan->slices[0].gangType == GANGTYPE_ENTRYDB_READER)
+		return ENDPOINT_ON_ENTRY_DB;
+	else if (plan->slices[0].gangType == GANGTYPE_SINGLETON_READER)
+		return ENDPOINT_ON_SINGLE_QE;
 	else if (plan->slices[0].directDispatch.isDirectDispatch &&
 			 plan->slices[0].directDispatch.contentIds != NULL)
 	{
@@ -313,7 +334,7 @@ EndpointNotifyQD(const char *message)
 /*
  * Allocate and initialize an endpoint and then create a dest receiver for
  * PARALLEL RETRIEVE CURSOR. The dest receiver is based on shm_mq that is used
- * by the upstream parallel work.
+ * by the upstream parallel work, but sends the tuples in batches.
  */
 void
 SetupEndpointExecState(TupleDesc tupleDesc, const char *cursorName,
@@ -336,7 +357,7 @@ SetupEndpointExecState(TupleDesc tupleDesc, const char *cursorName,
 		alloc_endpoint(cursorName, dsm_segment_handle(CurrentEndpointExecState->dsmSeg));
 	setup_endpoint_token_entry();
 
-	CurrentEndpointExecState->dest = CreateTupleQueueDestReceiver(shmMqHandle);
+	CurrentEndpointExecState->dest = create_endpoint_dest_receiver(shmMqHandle);
 	(CurrentEndpointExecState->dest->rStartup)(CurrentEndpointExecState->dest, operation, tupleDesc);
 	*endpointDest = CurrentEndpointExecState->dest;
 }
@@ -355,10 +376,21 @@ void
 DestroyEndpointExecState()
 {
 	DestReceiver *endpointDest = CurrentEndpointExecState->dest;
+	EndpointDestReceiver *receiver = (EndpointDestReceiver *) endpointDest;
 
 	Assert(CurrentEndpointExecState->endpoint);
 	Assert(CurrentEndpointExecState->dsmSeg);
 
+	/*
+	 * Send the last batch. Not in the rShutdown callback, which also runs on
+	 * abort, when there is no point in waiting for the queue to have room.
+	 */
+	if (receiver->batchLen > 0)
+	{
+		send_endpoint_batch(receiver, receiver->batch, receiver->batchLen);
+		receiver->batchLen = 0;
+	}
+
 	/*
 	 * wait for receiver to start tuple retrieving. ackDone latch will be
 	 * reset to be re-used when retrieving finished. See notify_sender()
@@ -367,7 +399,7 @@ DestroyEndpointExecState()
 	wait_receiver();
 
 	/*
-	 * tqueueShutdownReceiver() (rShutdown callback) will call
+	 * endpoint_shutdown_receiver() (rShutdown callback) will call
 	 * shm_mq_detach(), so need to call it before detach_mq(). Retrieving
 	 * session will set ackDone latch again after shm_mq_detach() called here.
 	 */
@@ -564,6 +596,123 @@ create_and_connect_mq(TupleDesc tupleDesc, dsm_segment **mqSeg /* out */ ,
 						errmsg("attach to endpoint shared message queue failed")));
 }
 
+/*
+ * Send a batch of tuples to the retrieve session.
+ *
+ * Returns true if successful, false if shm_mq has been detached.
+ */
+static bool
+send_endpoint_batch(EndpointDestReceiver *receiver, const char *data, Size len)
+{
+	shm_mq_result result;
+
+	result = shm_mq_send(receiver->mqHandle, len, data, false);
+
+	if (result == SHM_MQ_DETACHED)
+		return false;
+	else if (result != SHM_MQ_SUCCESS && result != SHM_MQ_QUERY_FINISH)
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("could not send tuples to shared-memory queue")));
+
+	return true;
+}
+
+/*
+ * Receive a tuple from the query, and add it to the batch. The batch is sent
+ * when the tuple doesn't fit in anymore.
+ */
+static bool
+endpoint_receive_slot(TupleTableSlot *slot, DestReceiver *self)
+{
+	EndpointDestReceiver *receiver = (EndpointDestReceiver *) self;
+	MinimalTuple tuple;
+	Size		len;
+	bool		shouldFree;
+	bool		result = true;
+
+	tuple = ExecFetchSlotMinimalTuple(slot, &shouldFree);
+	len = MAXALIGN(tuple->t_len);
+
+	if (receiver->batchLen > 0 && receiver->batchLen + len > receiver->batchSize)
+	{
+		result = send_endpoint_batch(receiver, receiver->batch, receiver->batchLen);
+		receiver->batchLen = 0;
+	}
+
+	if (result)
+	{
+		if (len > receiver->batchSize)
+			result = send_endpoint_batch(receiver, (char *) tuple, tuple->t_len);
+		else
+		{
+			memcpy(receiver->batch + receiver->batchLen, tuple, tuple->t_len);
+			receiver->batchLen += len;
+		}
+	}
+
+	if (shouldFree)
+		pfree(tuple);
+
+	return result;
+}
+
+static void
+endpoint_startup_receiver(DestReceiver *self, int operation, TupleDesc typeinfo)
+{
+	/* do nothing */
+}
+
+/*
+ * Detach from the message queue. The batch that is not sent yet is dropped,
+ * see DestroyEndpointExecState().
+ */
+static void
+endpoint_shutdown_receiver(DestReceiver *self)
+{
+	EndpointDestReceiver *receiver = (EndpointDestReceiver *) self;
+
+	if (receiver->mqHandle != NULL)
+		shm_mq_detach(receiver->mqHandle);
+	receiver->mqHandle = NULL;
+	receiver->batchLen = 0;
+}
+
+static void
+endpoint_destroy_receiver(DestReceiver *self)
+{
+	EndpointDestReceiver *receiver = (EndpointDestReceiver *) self;
+
+	if (receiver->mqHandle != NULL)
+		shm_mq_detach(receiver->mqHandle);
+	if (receiver->batch != NULL)
+		pfree(receiver->batch);
+	pfree(self);
+}
+
+/*
+ * Create the DestReceiver that sends tuples to the endpoint's message queue.
+ */
+static DestReceiver *
+create_endpoint_dest_receiver(shm_mq_handle *mqHandle)
+{
+	EndpointDestReceiver *self;
+
+	self = (EndpointDestReceiver *) palloc0(sizeof(EndpointDestReceiver));
+
+	self->pub.receiveSlot = endpoint_receive_slot;
+	self->pub.rStartup = endpoint_startup_receiver;
+	self->pub.rShutdown = endpoint_shutdown_receiver;
+	self->pub.rDestroy = endpoint_destroy_receiver;
+	self->pub.mydest = DestTupleQueue;
+	self->mqHandle = mqHandle;
+	self->batchSize = (Size) gp_endpoint_batch_size * 1024;
+	if (self->batchSize > 0)
+		self->batch = palloc(self->batchSize);
+
+	return (DestReceiver *) self;
+}
+
 /*
  * Create/reuse EndpointTokenEntry for current session in shared memory.
  * EndpointTokenEntry is used for authentication in the retrieve sessions.
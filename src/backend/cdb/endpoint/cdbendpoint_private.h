@@ -28,6 +28,13 @@
 
 #define ENDPOINT_MSG_QUEUE_MAGIC		0x1949100119980802U
 
+/*
+ * Each message on the tuple queue is a batch of MinimalTuples, stored one
+ * after another at MAXALIGN'd offsets. The receiver walks the batch using
+ * t_len of each tuple, and returns the tuples in place, without copying them
+ * out of the queue.
+ */
+
 /*
  * Naming rules for endpoint:
  * cursorname_sessionIdHex_segIndexHex
@@ -82,8 +82,11 @@ typedef struct RetrieveExecEntry
 	shm_mq_handle *mqHandle;
 	/* tuple slot used for retrieve data */
 	TupleTableSlot *retrieveTs;
-	/* TupleQueueReader to read tuple from message queue */
-	TupleQueueReader *tqReader;
+	/* The batch of tuples being returned, it points into the message queue */
+	char	   *batch;
+	Size		batchLen;
+	/* Offset of the next tuple in batch */
+	Size		batchPos;
 	/* Track retrieve state */
 	enum RetrieveState retrieveState;
 }			RetrieveExecEntry;
@@ -132,6 +135,8 @@ static void retrieve_subxact_callback(SubXactEvent event,
 									  SubTransactionId mySubid,
 									  SubTransactionId parentSubid,
 									  void *arg);
+static MinimalTuple receive_batched_tuple(RetrieveExecEntry *entry, bool nowait,
+										  bool *done);
 static TupleTableSlot *retrieve_next_tuple(void);
 static void retrieve_conn_detach(dsm_segment *segment, Datum datum);
 
@@ -234,6 +239,9 @@ init_retrieve_exec_entry(RetrieveExecEntry * entry)
 	entry->endpoint = NULL;
 	entry->mqHandle = NULL;
 	entry->retrieveTs = NULL;
+	entry->batch = NULL;
+	entry->batchLen = 0;
+	entry->batchPos = 0;
 	entry->retrieveState = RETRIEVE_STATE_INIT;
 }
 
@@ -480,10 +488,11 @@ attach_receiver_mq(dsm_handle dsmHandle)
 	if (entry->retrieveTs != NULL)
 		ExecClearTuple(entry->retrieveTs);
 	else
-		entry->retrieveTs = MakeTupleTableSlot(td, &TTSOpsHeapTuple);
+		entry->retrieveTs = MakeTupleTableSlot(td, &TTSOpsMinimalTuple);
 
-	/* Create the tuple queue reader. */
-	entry->tqReader = CreateTupleQueueReader(entry->mqHandle);
+	entry->batch = NULL;
+	entry->batchLen = 0;
+	entry->batchPos = 0;
 	entry->retrieveState = RETRIEVE_STATE_ATTACHED;
 
 	MemoryContextSwitchTo(oldcontext);
@@ -520,6 +529,53 @@ notify_sender(bool finished)
 	LWLockRelease(ParallelCursorEndpointLock);
 }
 
+/*
+ * Return the next tuple of the current batch, receiving the next batch from
+ * the message queue when the current one is used up.
+ *
+ * The tuple stays in the message queue, which is only advanced by the next
+ * shm_mq_receive(), i.e. after all tuples of the batch have been returned.
+ *
+ * Returns NULL if there are no remaining tuples, with *done set, or if nowait
+ * is true and no batch is ready to return.
+ */
+static MinimalTuple
+receive_batched_tuple(RetrieveExecEntry *entry, bool nowait, bool *done)
+{
+	MinimalTuple tuple;
+
+	*done = false;
+
+	if (entry->batchPos >= entry->batchLen)
+	{
+		shm_mq_result result;
+		Size		nbytes;
+		void	   *data;
+
+		result = shm_mq_receive(entry->mqHandle, &nbytes, &data, nowait);
+
+		if (result == SHM_MQ_DETACHED)
+		{
+			*done = true;
+			return NULL;
+		}
+
+		/* In non-blocking mode, bail out if no batch is ready yet. */
+		if (result == SHM_MQ_WOULD_BLOCK)
+			return NULL;
+		Assert(result == SHM_MQ_SUCCESS);
+
+		entry->batch = (char *) data;
+		entry->batchLen = nbytes;
+		entry->batchPos = 0;
+	}
+
+	tuple = (MinimalTuple) (entry->batch + entry->batchPos);
+	entry->batchPos += MAXALIGN(tuple->t_len);
+
+	return tuple;
+}
+
 /*
  * Read a tuple from shared memory message queue.
  *
@@ -529,7 +585,7 @@ static TupleTableSlot *
 retrieve_next_tuple()
 {
 	TupleTableSlot *result = NULL;
-	HeapTuple	tup = NULL;
+	MinimalTuple tup = NULL;
 	bool		readerdone = false;
 	RetrieveExecEntry *entry = RetrieveCtl.current_entry;
 
@@ -542,7 +598,7 @@ retrieve_next_tuple()
 		 * try to receive data with nowait, so that empty result will not hang
 		 * here
 		 */
-		tup = TupleQueueReaderNext(entry->tqReader, true, &readerdone);
+		tup = receive_batched_tuple(entry, true, &readerdone);
 
 		entry->retrieveState = RETRIEVE_STATE_RECEIVING;
 
@@ -562,14 +618,16 @@ retrieve_next_tuple()
 	 * the first time retrieve an invalid data, but not finish
 	 */
 	if (readerdone == false && tup == NULL)
-		tup = TupleQueueReaderNext(entry->tqReader, false, &readerdone);
+		tup = receive_batched_tuple(entry, false, &readerdone);
 
 	/* readerdone returns true only after sender detached message queue */
 	if (readerdone)
 	{
 		Assert(!tup);
-		DestroyTupleQueueReader(entry->tqReader);
-		entry->tqReader = NULL;
+		ExecClearTuple(entry->retrieveTs);
+		entry->batch = NULL;
+		entry->batchLen = 0;
+		entry->batchPos = 0;
 
 		/*
 		 * dsm_detach will send SIGUSR1 to sender which may interrupt the
@@ -588,13 +646,13 @@ retrieve_next_tuple()
 		return NULL;
 	}
 
-	if (HeapTupleIsValid(tup))
+	if (tup != NULL)
 	{
 		ExecClearTuple(entry->retrieveTs);
 		result = entry->retrieveTs;
-		ExecStoreHeapTuple(tup, /* tuple to store */
-						   result,	/* slot in which to store the tuple */
-						   false);	/* slot should not pfree tuple */
+		ExecStoreMinimalTuple(tup,	/* tuple to store */
+							  result,	/* slot in which to store the tuple */
+							  false);	/* slot should not pfree tuple */
 	}
 	return result;
 }
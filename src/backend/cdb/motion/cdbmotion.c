@@ -24,6 +24,7 @@
 #include "cdb/cdbvars.h"
 #include "cdb/htupfifo.h"
 #include "cdb/ml_ipc.h"
+#include "cdb/tupcolbatch.h"
 #include "cdb/tupleremap.h"
 #include "cdb/tupser.h"
 #include "utils/memutils.h"
@@ -69,6 +70,22 @@ static void processIncomingChunks(MotionLayerState *mlStates,
 					  int16 srcRoute);
 
 static inline void reconstructTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry, TupleRemapper *remapper);
+static inline void storeTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry,
+							  TupleRemapper *remapper, MinimalTuple tup);
+
+static SendReturnCode addTupleToColumnarBatch(MotionLayerState *mlStates,
+											  ChunkTransportState *transportStates,
+											  MotionNodeEntry *pMNEntry,
+											  TupleTableSlot *slot,
+											  int16 targetRoute);
+static SendReturnCode sendColumnarBatch(MotionLayerState *mlStates,
+										ChunkTransportState *transportStates,
+										MotionNodeEntry *pMNEntry,
+										struct ColumnarBatch *batch,
+										int16 targetRoute);
+static void flushColumnarBatches(MotionLayerState *mlStates,
+								 ChunkTransportState *transportStates,
+								 MotionNodeEntry *pMNEntry);
 
 /* Stats-function declarations. */
 static void statSendTuple(MotionLayerState *mlStates, MotionNodeEntry *pMNEntry, TupleChunkList tcList);
@@ -100,8 +117,29 @@ reconstructTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry, TupleRem
 	/* We're done with the chunks now. */
 	clearTCList(NULL, &pCSEntry->chunk_list);
 
-	if (!tup)
-		return;
+	if (tup)
+		storeTuple(pMNEntry, pCSEntry, remapper, tup);
+	else if (pSerInfo->batch_tuples)
+	{
+		/* The chunks held a columnar batch of tuples. */
+		for (int i = 0; i < pSerInfo->batch_ntuples; i++)
+			storeTuple(pMNEntry, pCSEntry, remapper, pSerInfo->batch_tuples[i]);
+
+		pfree(pSerInfo->batch_tuples);
+		pSerInfo->batch_tuples = NULL;
+		pSerInfo->batch_ntuples = 0;
+	}
+}
+
+/*
+ * Store a newly arrived tuple, to be returned to the caller of the Motion
+ * Layer.
+ */
+static inline void
+storeTuple(MotionNodeEntry *pMNEntry, ChunkSorterEntry *pCSEntry,
+		   TupleRemapper *remapper, MinimalTuple tup)
+{
+	SerTupInfo *pSerInfo = &pMNEntry->ser_tup_info;
 
 	tup = TRCheckAndRemap(remapper, pSerInfo->tupdesc, tup);
 
@@ -274,6 +312,19 @@ UpdateMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool preserve
 	pEntry->tuple_desc = CreateTupleDescCopy(tupDesc);
 	InitSerTupInfo(pEntry->tuple_desc, &pEntry->ser_tup_info);
 
+	/*
+	 * Send tuples in columnar batches, if enabled. Record types need their
+	 * typmods remapped tuple by tuple, so leave them alone.
+	 */
+	if (gp_motion_columnar_batch_size > 0 &&
+		!pEntry->ser_tup_info.has_record_types &&
+		ColumnarBatchSupported(pEntry->tuple_desc))
+		pEntry->columnar_batch_size = gp_motion_columnar_batch_size;
+	else
+		pEntry->columnar_batch_size = 0;
+	pEntry->columnar_batches = NULL;
+	pEntry->num_columnar_batches = 0;
+
 	if (!preserveOrder)
 	{
 		/* Create a tuple-store for the motion node's incoming tuples. */
@@ -460,6 +511,10 @@ SendTuple(MotionLayerState *mlStates,
 	 */
 	pMNEntry = getMotionNodeEntry(mlStates, motNodeID);
 
+	if (pMNEntry->columnar_batch_size > 0)
+		return addTupleToColumnarBatch(mlStates, transportStates, pMNEntry,
+									   slot, targetRoute);
+
 #ifdef AMS_VERBOSE_LOGGING
 	elog(DEBUG5, "Serializing HeapTuple for sending.");
 #endif
@@ -473,7 +528,9 @@ SendTuple(MotionLayerState *mlStates,
 	/* Create and store the serialized form, and some stats about it. */
 	oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
 
-	sent = SerializeTuple(slot, &pMNEntry->ser_tup_info, &b, &tcList, targetRoute);
+	sent = SerializeTuple(slot, &pMNEntry->ser_tup_info,
+						  mlStates, transportStates, motNodeID,
+						  &b, &tcList, targetRoute);
 
 	MemoryContextSwitchTo(oldCtxt);
 	if (sent > 0)
@@ -489,6 +546,18 @@ SendTuple(MotionLayerState *mlStates,
 
 		return SEND_COMPLETE;
 	}
+	else if (sent == SERIALIZE_TUPLE_SCATTERED)
+	{
+		/* Already sent straight from the packet buffers */
+		statSendTuple(mlStates, pMNEntry, &tcList);
+
+		return SEND_COMPLETE;
+	}
+	else if (sent == SERIALIZE_TUPLE_STOPPED)
+	{
+		pMNEntry->stopped = true;
+		return STOP_SENDING;
+	}
 	/* Otherwise fall-through */
 
 #ifdef AMS_VERBOSE_LOGGING
@@ -521,6 +590,126 @@ SendTuple(MotionLayerState *mlStates,
 	return rc;
 }
 
+/*
+ * Add a tuple to the columnar batch of its route, and send the batch out
+ * once it's full.
+ */
+static SendReturnCode
+addTupleToColumnarBatch(MotionLayerState *mlStates,
+						ChunkTransportState *transportStates,
+						MotionNodeEntry *pMNEntry,
+						TupleTableSlot *slot,
+						int16 targetRoute)
+{
+	MemoryContext oldCtxt;
+	ColumnarBatch **batchp;
+	bool		full;
+
+	oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
+
+	if (pMNEntry->columnar_batches == NULL)
+	{
+		ChunkTransportStateEntry *pEntry;
+
+		getChunkTransportState(transportStates, pMNEntry->motion_node_id, &pEntry);
+
+		/* One batch per route, plus one for broadcasting. */
+		pMNEntry->num_columnar_batches = pEntry->numConns + 1;
+		pMNEntry->columnar_batches =
+			palloc0(pMNEntry->num_columnar_batches * sizeof(ColumnarBatch *));
+	}
+
+	if (targetRoute == BROADCAST_SEGIDX)
+		batchp = &pMNEntry->columnar_batches[pMNEntry->num_columnar_batches - 1];
+	else
+	{
+		Assert(targetRoute >= 0 && targetRoute < pMNEntry->num_columnar_batches - 1);
+		batchp = &pMNEntry->columnar_batches[targetRoute];
+	}
+
+	if (*batchp == NULL)
+		*batchp = CreateColumnarBatch(pMNEntry->tuple_desc,
+									  pMNEntry->columnar_batch_size);
+
+	full = AppendToColumnarBatch(*batchp, slot);
+
+	MemoryContextSwitchTo(oldCtxt);
+
+	if (!full)
+		return SEND_COMPLETE;
+
+	return sendColumnarBatch(mlStates, transportStates, pMNEntry, *batchp,
+							 targetRoute);
+}
+
+/*
+ * Send out the tuples collected in a columnar batch.
+ */
+static SendReturnCode
+sendColumnarBatch(MotionLayerState *mlStates,
+				  ChunkTransportState *transportStates,
+				  MotionNodeEntry *pMNEntry,
+				  ColumnarBatch *batch,
+				  int16 targetRoute)
+{
+	TupleChunkListData tcList;
+	MemoryContext oldCtxt;
+	SendReturnCode rc;
+
+	oldCtxt = MemoryContextSwitchTo(mlStates->motion_layer_mctx);
+
+	SerializeColumnarBatchIntoChunks(&pMNEntry->ser_tup_info, &tcList, batch);
+
+	MemoryContextSwitchTo(oldCtxt);
+
+	/* do the send. */
+	if (!SendTupleChunkToAMS(mlStates, transportStates, pMNEntry->motion_node_id,
+							 targetRoute, tcList.p_first))
+	{
+		pMNEntry->stopped = true;
+		rc = STOP_SENDING;
+	}
+	else
+	{
+		/* update stats */
+		statSendTuple(mlStates, pMNEntry, &tcList);
+
+		rc = SEND_COMPLETE;
+	}
+
+	/* cleanup */
+	clearTCList(&pMNEntry->ser_tup_info.chunkCache, &tcList);
+
+	return rc;
+}
+
+/*
+ * Send out all the partially filled columnar batches.
+ */
+static void
+flushColumnarBatches(MotionLayerState *mlStates,
+					 ChunkTransportState *transportStates,
+					 MotionNodeEntry *pMNEntry)
+{
+	for (int i = 0; i < pMNEntry->num_columnar_batches; i++)
+	{
+		ColumnarBatch *batch = pMNEntry->columnar_batches[i];
+		int16		targetRoute;
+
+		if (batch == NULL || batch->ntuples == 0)
+			continue;
+
+		if (i == pMNEntry->num_columnar_batches - 1)
+			targetRoute = BROADCAST_SEGIDX;
+		else
+			targetRoute = i;
+
+		if (sendColumnarBatch(mlStates, transportStates, pMNEntry, batch,
+							  targetRoute) == STOP_SENDING)
+			break;
+	}
+}
+
 /*
  * Sends a token to all peer Motion Nodes, indicating that this motion
  * node has no more tuples to send out.
@@ -539,6 +728,10 @@ SendEndOfStream(MotionLayerState *mlStates,
 	 */
 	pMNEntry = getMotionNodeEntry(mlStates, motNodeID);
 
+	/* Tuples still waiting in columnar batches go before the EOS. */
+	if (pMNEntry->columnar_batches != NULL && !pMNEntry->stopped)
+		flushColumnarBatches(mlStates, transportStates, pMNEntry);
+
 	transportStates->SendEos(transportStates, motNodeID, s_eos_chunk_data);
 
 	/*
@@ -799,6 +992,11 @@ EndMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool flushCommLa
 			 * table.
 			 */
 			clearTCList(&pMNEntry->ser_tup_info.chunkCache, &pCSEntry->chunk_list);
+			if (pCSEntry->partial_tuple)
+			{
+				pfree(pCSEntry->partial_tuple);
+				pCSEntry->partial_tuple = NULL;
+			}
 			if (pMNEntry->preserve_order)	/* Clean up the tuple-store. */
 				htfifo_destroy(pCSEntry->ready_tuples);
 		}
@@ -837,6 +1035,17 @@ EndMotionLayerNode(MotionLayerState *mlStates, int16 motNodeID, bool flushCommLa
 		}
 	}
 
+	if (pMNEntry->columnar_batches != NULL)
+	{
+		for (int i = 0; i < pMNEntry->num_columnar_batches; i++)
+		{
+			if (pMNEntry->columnar_batches[i] != NULL)
+				DestroyColumnarBatch(pMNEntry->columnar_batches[i]);
+		}
+		pfree(pMNEntry->columnar_batches);
+		pMNEntry->columnar_batches = NULL;
+	}
+
 	CleanupSerTupInfo(&pMNEntry->ser_tup_info);
 	FreeTupleDesc(pMNEntry->tuple_desc);
 	if (!pMNEntry->preserve_order)
@@ -919,6 +1128,8 @@ getChunkSorterEntry(MotionLayerState *mlStates,
 	chunkSorterEntry->chunk_list.num_chunks = 0;
 	chunkSorterEntry->chunk_list.p_first = NULL;
 	chunkSorterEntry->chunk_list.p_last = NULL;
+	chunkSorterEntry->partial_tuple = NULL;
+	chunkSorterEntry->partial_tuple_received = 0;
 	chunkSorterEntry->end_of_stream = false;
 	chunkSorterEntry->init = true;
 
@@ -985,6 +1196,11 @@ materializeChunk(TupleChunkListItem *tcItem)
 	return;
 }
 
+/* Is a tuple partially received, either as a list of chunks or directly? */
+#define HasPartialTupleData(chunkSorterEntry) \
+	((chunkSorterEntry)->chunk_list.num_chunks != 0 || \
+	 (chunkSorterEntry)->partial_tuple != NULL)
+
 /*
  * Add another tuple-chunk to the chunk sorter.  If the new chunk
  * completes another HeapTuple, that tuple will be deserialized and
@@ -1013,7 +1229,7 @@ addChunkToSorter(ChunkTransportState *transportStates,
 		case TC_WHOLE:
 		case TC_EMPTY:
 			/* There shouldn't be any partial tuple data in the list! */
-			if (chunkSorterEntry->chunk_list.num_chunks != 0)
+			if (HasPartialTupleData(chunkSorterEntry))
 			{
 				ereport(ERROR,
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
@@ -1030,7 +1246,7 @@ addChunkToSorter(ChunkTransportState *transportStates,
 		case TC_PARTIAL_START:
 
 			/* There shouldn't be any partial tuple data in the list! */
-			if (chunkSorterEntry->chunk_list.num_chunks != 0)
+			if (HasPartialTupleData(chunkSorterEntry))
 			{
 				ereport(ERROR,
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
@@ -1038,6 +1254,18 @@ addChunkToSorter(ChunkTransportState *transportStates,
 								srcRoute, motNodeID)));
 			}
 
+			/*
+			 * Copy a regular tuple's data straight into the tuple, rather
+			 * than keeping the chunks around and reassembling them later.
+			 */
+			chunkSorterEntry->partial_tuple =
+				BeginChunkedTuple(tcItem, &chunkSorterEntry->partial_tuple_received);
+			if (chunkSorterEntry->partial_tuple != NULL)
+			{
+				pfree(tcItem);
+				break;
+			}
+
 			/*
 			 * we don't have enough to reconstruct the tuple, we need to copy
 			 * the chunk data out of our shared buffer
@@ -1052,7 +1280,7 @@ addChunkToSorter(ChunkTransportState *transportStates,
 		case TC_PARTIAL_MID:
 
 			/* There should be partial tuple data in the list. */
-			if (chunkSorterEntry->chunk_list.num_chunks <= 0)
+			if (!HasPartialTupleData(chunkSorterEntry))
 			{
 				ereport(ERROR,
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
@@ -1060,6 +1288,15 @@ addChunkToSorter(ChunkTransportState *transportStates,
 								srcRoute, motNodeID)));
 			}
 
+			if (chunkSorterEntry->partial_tuple != NULL)
+			{
+				AddChunkToTuple(chunkSorterEntry->partial_tuple,
+								&chunkSorterEntry->partial_tuple_received,
+								tcItem);
+				pfree(tcItem);
+				break;
+			}
+
 			/*
 			 * we don't have enough to reconstruct the tuple, we need to copy
 			 * the chunk data out of our shared buffer
@@ -1074,7 +1311,7 @@ addChunkToSorter(ChunkTransportState *transportStates,
 		case TC_PARTIAL_END:
 
 			/* There should be partial tuple data in the list. */
-			if (chunkSorterEntry->chunk_list.num_chunks <= 0)
+			if (!HasPartialTupleData(chunkSorterEntry))
 			{
 				ereport(ERROR,
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
@@ -1082,6 +1319,23 @@ addChunkToSorter(ChunkTransportState *transportStates,
 								srcRoute, motNodeID)));
 			}
 
+			if (chunkSorterEntry->partial_tuple != NULL)
+			{
+				MinimalTuple tup = chunkSorterEntry->partial_tuple;
+
+				if (!AddChunkToTuple(tup, &chunkSorterEntry->partial_tuple_received,
+									 tcItem))
+					ereport(ERROR,
+							(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+							 errmsg("received TC_PARTIAL_END chunk from [src=%d,mn=%d] before the end of the tuple data",
+									srcRoute, motNodeID)));
+				pfree(tcItem);
+
+				chunkSorterEntry->partial_tuple = NULL;
+				storeTuple(pMNEntry, chunkSorterEntry, conn->remapper, tup);
+				break;
+			}
+
 			/* Put this chunk into the list, then turn it into a HeapTuple! */
 			appendChunkToTCList(&chunkSorterEntry->chunk_list, tcItem);
 			reconstructTuple(pMNEntry, chunkSorterEntry, conn->remapper);
@@ -1093,7 +1347,7 @@ addChunkToSorter(ChunkTransportState *transportStates,
 			elog(LOG, "Got end-of-stream. motnode %d route %d", motNodeID, srcRoute);
 #endif
 			/* There shouldn't be any partial tuple data in the list! */
-			if (chunkSorterEntry->chunk_list.num_chunks != 0)
+			if (HasPartialTupleData(chunkSorterEntry))
 			{
 				ereport(ERROR,
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
@@ -25,12 +25,17 @@
 #include "cdb/ml_ipc.h"
 #include "cdb/cdbvars.h"
 #include "cdb/cdbdisp.h"
+#include "cdb/tupchunk.h"
 
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
 #include <netinet/in.h>
 
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
 /*
   #define AMS_VERBOSE_LOGGING
 */
@@ -70,6 +75,21 @@ static void cleanup_interconnect_handle(interconnect_handle_t *h);
 static interconnect_handle_t *allocate_interconnect_handle(void);
 static void destroy_interconnect_handle(interconnect_handle_t *h);
 static interconnect_handle_t *find_interconnect_handle(ChunkTransportState *icContext);
+static int	decompressPacketPayload(MotionConn *conn, uint8 *src, int srclen,
+									uint8 *dst, int dstcap,
+									ChunkTransportState *transportStates);
+
+/*
+ * Interconnect compression.
+ *
+ * Packets with less payload than this are not worth compressing. A
+ * connection whose packets fail to compress by at least 1/8 skips the next
+ * compressBackoff packets, doubling that up to IC_COMPRESS_MAX_BACKOFF as
+ * long as compression keeps failing.
+ */
+#define IC_COMPRESS_MIN_PAYLOAD		256
+#define IC_COMPRESS_MAX_BACKOFF		128
+#define IC_COMPRESS_LEVEL			1
 
 static void
 logChunkParseDetails(MotionConn *conn, uint32 ic_instance_id)
@@ -96,6 +116,8 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 	TupleChunkListItem lastTcItem = NULL;
 	uint32		tcSize;
 	int			bytesProcessed = 0;
+	uint8	   *msgPos;
+	int32		msgSize;
 
 	if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP ||
 		Gp_interconnect_type == INTERCONNECT_TYPE_PROXY)
@@ -117,9 +139,55 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 		 conn->recvBytes, conn->msgSize, conn->pBuff, conn->msgPos);
 #endif
 
-	while (bytesProcessed != conn->msgSize)
+	msgPos = conn->msgPos;
+	msgSize = conn->msgSize;
+
+	/*
+	 * A compressed packet carries a single TC_COMPRESSED chunk.  Inflate it
+	 * into a buffer of our own, leaving room for the packet header in front
+	 * so that the offsets below work out the same.
+	 */
+	if (msgSize - bytesProcessed >= TUPLE_CHUNK_HEADER_SIZE)
 	{
-		if (conn->msgSize - bytesProcessed < TUPLE_CHUNK_HEADER_SIZE)
+		uint16		tcType;
+
+		memcpy(&tcType, msgPos + bytesProcessed + 2, sizeof(uint16));
+		if (tcType == TC_COMPRESSED)
+		{
+			static uint8 *inflateBuf = NULL;
+			int			compressedSize;
+
+			if (inflateBuf == NULL)
+				inflateBuf = MemoryContextAlloc(TopMemoryContext, MAX_PACKET_SIZE);
+
+			compressedSize = (*(uint16 *) (msgPos + bytesProcessed));
+			if (TUPLE_CHUNK_HEADER_SIZE + compressedSize != msgSize - bytesProcessed)
+			{
+				logChunkParseDetails(conn, transportStates->sliceTable->ic_instance_id);
+
+				ereport(ERROR,
+						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+						 errmsg("interconnect error parsing message: malformed compressed packet"),
+						 errdetail("compressed chunk %d bytes, packet %d bytes processed %d",
+								   compressedSize, msgSize, bytesProcessed)));
+			}
+
+			msgSize = bytesProcessed +
+				decompressPacketPayload(conn,
+										msgPos + bytesProcessed + TUPLE_CHUNK_HEADER_SIZE,
+										compressedSize,
+										inflateBuf + bytesProcessed,
+										MAX_PACKET_SIZE - bytesProcessed,
+										transportStates);
+			msgPos = inflateBuf;
+		}
+	}
+	conn->stat_payload_bytes_recvd += msgSize - bytesProcessed;
+	conn->stat_wire_bytes_recvd += conn->msgSize - bytesProcessed;
+
+	while (bytesProcessed != msgSize)
+	{
+		if (msgSize - bytesProcessed < TUPLE_CHUNK_HEADER_SIZE)
 		{
 			logChunkParseDetails(conn, transportStates->sliceTable->ic_instance_id);
 
@@ -127,10 +195,10 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 					(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 					 errmsg("interconnect error parsing message: insufficient data received"),
 					 errdetail("conn->msgSize %d bytesProcessed %d < chunk-header %d",
-							   conn->msgSize, bytesProcessed, TUPLE_CHUNK_HEADER_SIZE)));
+							   msgSize, bytesProcessed, TUPLE_CHUNK_HEADER_SIZE)));
 		}
 
-		tcSize = TUPLE_CHUNK_HEADER_SIZE + (*(uint16 *) (conn->msgPos + bytesProcessed));
+		tcSize = TUPLE_CHUNK_HEADER_SIZE + (*(uint16 *) (msgPos + bytesProcessed));
 
 		/* sanity check */
 		if (tcSize > Gp_max_packet_size)
@@ -157,7 +225,7 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 					 errdetail("tcSize %d > max %d header %d processed %d/%d from %p",
 							   tcSize, Gp_max_packet_size,
 							   TUPLE_CHUNK_HEADER_SIZE, bytesProcessed,
-							   conn->msgSize, conn->msgPos)));
+							   msgSize, msgPos)));
 		}
 
 
@@ -168,7 +236,7 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 		if (Gp_interconnect_type == INTERCONNECT_TYPE_TCP ||
 			Gp_interconnect_type == INTERCONNECT_TYPE_PROXY)
 		{
-			if (tcSize >= conn->msgSize)
+			if (tcSize >= msgSize)
 			{
 				/*
 				 * see MPP-720: it is possible that our message got messed up
@@ -182,10 +250,10 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 						(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
 						 errmsg("interconnect error parsing message"),
 						 errdetail("tcSize %d >= conn->msgSize %d",
-								   tcSize, conn->msgSize)));
+								   tcSize, msgSize)));
 			}
 		}
-		Assert(tcSize < conn->msgSize);
+		Assert(tcSize < msgSize);
 
 		/*
 		 * We store the data inplace, and handle any necessary copying later
@@ -195,7 +263,7 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 
 		tcItem->p_next = NULL;
 		tcItem->chunk_length = tcSize;
-		tcItem->inplace = (char *) (conn->msgPos + bytesProcessed);
+		tcItem->inplace = (char *) (msgPos + bytesProcessed);
 
 		bytesProcessed += tcSize;
 
@@ -225,6 +293,130 @@ RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates)
 	return firstTcItem;
 }
 
+/*
+ * Inflate the payload of a compressed packet. Returns the inflated size.
+ */
+static int
+decompressPacketPayload(MotionConn *conn, uint8 *src, int srclen,
+						uint8 *dst, int dstcap,
+						ChunkTransportState *transportStates)
+{
+#ifdef USE_ZSTD
+	static ZSTD_DCtx *cxt = NULL;	/* ZSTD decompression context */
+	size_t		dst_length_used;
+
+	if (!cxt)
+	{
+		cxt = ZSTD_createDCtx();
+		if (!cxt)
+			elog(ERROR, "out of memory");
+	}
+
+	dst_length_used = ZSTD_decompressDCtx(cxt, dst, dstcap, src, srclen);
+	if (!ZSTD_isError(dst_length_used))
+		return (int) dst_length_used;
+
+	logChunkParseDetails(conn, transportStates->sliceTable->ic_instance_id);
+
+	ereport(ERROR,
+			(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+			 errmsg("interconnect error decompressing packet: %s",
+					ZSTD_getErrorName(dst_length_used))));
+#else
+	logChunkParseDetails(conn, transportStates->sliceTable->ic_instance_id);
+
+	ereport(ERROR,
+			(errcode(ERRCODE_GP_INTERCONNECTION_ERROR),
+			 errmsg("interconnect error parsing message: received a compressed packet"),
+			 errdetail("Interconnect compression is not supported by this build.")));
+#endif
+	return 0;					/* keep compiler quiet */
+}
+
+/* See ml_ipc.h */
+int
+CompressPacketPayload(MotionConn *conn, uint8 *payload, int len)
+{
+#ifdef USE_ZSTD
+	static ZSTD_CCtx *cxt = NULL;	/* ZSTD compression context */
+	static uint8 *deflateBuf = NULL;
+	size_t		dstcap;
+	size_t		dst_length_used;
+
+	if (!gp_interconnect_compression || len < IC_COMPRESS_MIN_PAYLOAD)
+		return len;
+
+	if (conn->compressSkip > 0)
+	{
+		conn->compressSkip--;
+		return len;
+	}
+
+	if (!cxt)
+	{
+		cxt = ZSTD_createCCtx();
+		if (!cxt)
+			elog(ERROR, "out of memory");
+	}
+	if (deflateBuf == NULL)
+		deflateBuf = MemoryContextAlloc(TopMemoryContext, MAX_PACKET_SIZE);
+
+	/*
+	 * Don't let zstd produce anything that doesn't save at least 1/8 of the
+	 * payload; it gives up with an error instead, and we send the packet as
+	 * it is.
+	 */
+	dstcap = len - len / 8 - TUPLE_CHUNK_HEADER_SIZE;
+	dst_length_used = ZSTD_compressCCtx(cxt,
+										deflateBuf, dstcap,
+										payload, len,
+										IC_COMPRESS_LEVEL);
+	if (ZSTD_isError(dst_length_used))
+	{
+		conn->compressBackoff = Min(Max(conn->compressBackoff * 2, 1),
+									IC_COMPRESS_MAX_BACKOFF);
+		conn->compressSkip = conn->compressBackoff;
+		return len;
+	}
+	conn->compressBackoff = 0;
+
+	SetChunkDataSize(payload, dst_length_used);
+	SetChunkType(payload, TC_COMPRESSED);
+	memcpy(payload + TUPLE_CHUNK_HEADER_SIZE, deflateBuf, dst_length_used);
+
+	return TUPLE_CHUNK_HEADER_SIZE + (int) dst_length_used;
+#else
+	return len;
+#endif
+}
+
+/* See ml_ipc.h */
+void
+GetMotionCompressionStats(ChunkTransportState *transportStates, int16 motNodeID,
+						  uint64 *payloadBytes, uint64 *wireBytes)
+{
+	ChunkTransportStateEntry *pEntry;
+	int			i;
+
+	*payloadBytes = 0;
+	*wireBytes = 0;
+
+	if (transportStates == NULL ||
+		motNodeID <= 0 ||
+		motNodeID > transportStates->size)
+		return;
+
+	pEntry = &transportStates->states[motNodeID - 1];
+	if (!pEntry->valid || pEntry->motNodeId != motNodeID || pEntry->conns == NULL)
+		return;
+
+	for (i = 0; i < pEntry->numConns; i++)
+	{
+		*payloadBytes += pEntry->conns[i].stat_payload_bytes_recvd;
+		*wireBytes += pEntry->conns[i].stat_wire_bytes_recvd;
+	}
+}
+
 /*=========================================================================
  * VISIBLE FUNCTIONS
  */
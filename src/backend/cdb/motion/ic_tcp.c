@@ -2800,6 +2800,10 @@ flushBuffer(ChunkTransportState *transportStates,
 	}
 #endif
 
+	conn->msgSize = PACKET_HEADER_SIZE +
+		CompressPacketPayload(conn, conn->pBuff + PACKET_HEADER_SIZE,
+							  conn->msgSize - PACKET_HEADER_SIZE);
+
 	/* first set header length */
 	*(uint32 *) conn->pBuff = conn->msgSize;
 
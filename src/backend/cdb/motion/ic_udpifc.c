@@ -4518,6 +4518,10 @@ prepareXmit(MotionConn *conn)
 {
 	Assert(conn != NULL);
 
+	conn->msgSize = sizeof(conn->conn_info) +
+		CompressPacketPayload(conn, conn->pBuff + sizeof(conn->conn_info),
+							  conn->msgSize - sizeof(conn->conn_info));
+
 	conn->conn_info.len = conn->msgSize;
 	conn->conn_info.crc = 0;
 
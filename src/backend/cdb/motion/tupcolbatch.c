@@ -0,0 +1,683 @@
+/*-------------------------------------------------------------------------
+ * tupcolbatch.c
+ *	   Columnar batches of tuples, for sending through the Motion layer.
+ *
+ * Instead of sending each tuple on its own, a sender can accumulate a batch
+ * of tuples for a route, and send them as one message with the values of
+ * each column stored together. Each column is encoded in whichever of these
+ * forms is the smallest:
+ *
+ * - plain: the values one after another,
+ * - run-length: each run of equal values as a count and the value,
+ * - dictionary: up to 256 distinct values, and a one-byte code per value.
+ *
+ * Low-cardinality and sorted columns shrink a lot this way, and the
+ * per-tuple chunk headers and length words are saved as well.
+ *
+ * The encoded form of a batch is:
+ *
+ *	uint32		number of tuples
+ *	uint16		number of attributes
+ *	per attribute:
+ *		uint8	COLBATCH_NO_NULLS, COLBATCH_SOME_NULLS or COLBATCH_ALL_NULLS
+ *		[bitmap of the NULLs, one bit per tuple, if COLBATCH_SOME_NULLS]
+ *		uint8	COLBATCH_PLAIN, COLBATCH_RLE or COLBATCH_DICT, unless all NULL
+ *		the non-NULL values, encoded as above
+ *
+ * A value is sent the way it's stored in a tuple, without alignment
+ * padding, so its length is known from the attribute's type. Varlenas are
+ * sent with a short header when possible.
+ *
+ * Portions Copyright (c) 2012-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/backend/cdb/motion/tupcolbatch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/tupmacs.h"
+#include "access/tuptoaster.h"
+#include "cdb/tupcolbatch.h"
+#include "common/hashfn.h"
+#include "utils/memutils.h"
+
+/* How the NULLs of a column are sent */
+#define COLBATCH_NO_NULLS		0
+#define COLBATCH_SOME_NULLS		1
+#define COLBATCH_ALL_NULLS		2
+
+/* How the non-NULL values of a column are sent */
+#define COLBATCH_PLAIN			0
+#define COLBATCH_RLE			1
+#define COLBATCH_DICT			2
+
+#define COLBATCH_MAX_DICT		256
+#define COLBATCH_DICT_HASH_SIZE	(2 * COLBATCH_MAX_DICT)
+
+/* Initial number of tuples to allocate space for in a batch */
+#define COLBATCH_INITIAL_TUPLES	64
+
+/* Room for a pass-by-value datum of any length */
+typedef union
+{
+	char		c;
+	int16		s;
+	int32		i;
+	Datum		d;
+} ColBatchByval;
+
+typedef struct ColBatchReader
+{
+	char	   *pos;
+	char	   *end;
+} ColBatchReader;
+
+static void appendVarlena(StringInfo buf, Form_pg_attribute attr, struct varlena *v);
+static void encodeColumn(ColumnarBatch *batch, int attno, StringInfo buf);
+static int	buildDictionary(ColumnarBatch *batch, int attno, int *dictrows,
+							Size *dictsize);
+static void decodeColumn(ColBatchReader *reader, Form_pg_attribute attr,
+						 int attno, int natts, int ntuples,
+						 Datum *values, bool *isnull);
+static Datum readValue(ColBatchReader *reader, Form_pg_attribute attr);
+
+#define BatchValuePtr(batch, idx) ((batch)->data.data + (batch)->offsets[idx])
+
+static inline bool
+batchValuesEqual(ColumnarBatch *batch, int idx1, int idx2)
+{
+	return batch->lens[idx1] == batch->lens[idx2] &&
+		memcmp(BatchValuePtr(batch, idx1), BatchValuePtr(batch, idx2),
+			   batch->lens[idx1]) == 0;
+}
+
+static void invalidColumnarBatch(void) pg_attribute_noreturn();
+
+static void
+invalidColumnarBatch(void)
+{
+	ereport(ERROR,
+			(errcode(ERRCODE_PROTOCOL_VIOLATION),
+			 errmsg("invalid columnar tuple batch")));
+}
+
+static inline char *
+readBytes(ColBatchReader *reader, Size len)
+{
+	char	   *p = reader->pos;
+
+	if (len > reader->end - reader->pos)
+		invalidColumnarBatch();
+	reader->pos += len;
+
+	return p;
+}
+
+bool
+ColumnarBatchSupported(TupleDesc tupdesc)
+{
+	/* A tuple with no attributes is sent as a TC_EMPTY chunk */
+	return tupdesc->natts > 0;
+}
+
+ColumnarBatch *
+CreateColumnarBatch(TupleDesc tupdesc, int maxtuples)
+{
+	ColumnarBatch *batch;
+	int			alloctuples = Min(maxtuples, COLBATCH_INITIAL_TUPLES);
+
+	Assert(maxtuples > 0 && maxtuples <= COLUMNAR_BATCH_MAX_TUPLES);
+
+	batch = palloc(sizeof(ColumnarBatch));
+	batch->tupdesc = tupdesc;
+	batch->maxtuples = maxtuples;
+	batch->alloctuples = alloctuples;
+	batch->ntuples = 0;
+	initStringInfo(&batch->data);
+	batch->offsets = palloc(alloctuples * tupdesc->natts * sizeof(uint32));
+	batch->lens = palloc(alloctuples * tupdesc->natts * sizeof(int32));
+	batch->codes = palloc(alloctuples * sizeof(uint8));
+
+	return batch;
+}
+
+void
+DestroyColumnarBatch(ColumnarBatch *batch)
+{
+	pfree(batch->data.data);
+	pfree(batch->offsets);
+	pfree(batch->lens);
+	pfree(batch->codes);
+	pfree(batch);
+}
+
+bool
+AppendToColumnarBatch(ColumnarBatch *batch, TupleTableSlot *slot)
+{
+	TupleDesc	tupdesc = batch->tupdesc;
+	int			natts = tupdesc->natts;
+	int			base;
+
+	Assert(batch->ntuples < batch->maxtuples);
+
+	if (batch->ntuples == batch->alloctuples)
+	{
+		int			alloctuples = Min(batch->alloctuples * 2, batch->maxtuples);
+
+		batch->offsets = repalloc(batch->offsets,
+								  alloctuples * natts * sizeof(uint32));
+		batch->lens = repalloc(batch->lens,
+							   alloctuples * natts * sizeof(int32));
+		batch->codes = repalloc(batch->codes, alloctuples * sizeof(uint8));
+		batch->alloctuples = alloctuples;
+	}
+
+	slot_getallattrs(slot);
+
+	base = batch->ntuples * natts;
+	for (int i = 0; i < natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+		Datum		val = slot->tts_values[i];
+		uint32		off = batch->data.len;
+
+		if (slot->tts_isnull[i])
+		{
+			batch->lens[base + i] = -1;
+			continue;
+		}
+
+		if (attr->attbyval)
+		{
+			ColBatchByval buf;
+
+			store_att_byval(&buf, val, attr->attlen);
+			appendBinaryStringInfo(&batch->data, (char *) &buf, attr->attlen);
+		}
+		else if (attr->attlen > 0)
+			appendBinaryStringInfo(&batch->data, DatumGetPointer(val), attr->attlen);
+		else if (attr->attlen == -1)
+			appendVarlena(&batch->data, attr, (struct varlena *) DatumGetPointer(val));
+		else
+		{
+			char	   *str = DatumGetCString(val);
+
+			Assert(attr->attlen == -2);
+			appendBinaryStringInfo(&batch->data, str, strlen(str) + 1);
+		}
+
+		batch->offsets[base + i] = off;
+		batch->lens[base + i] = batch->data.len - off;
+	}
+
+	return ++batch->ntuples >= batch->maxtuples;
+}
+
+/*
+ * Append a varlena to the batch. External values are fetched and sent
+ * inline, like SerializeTuple() does, and the header is shortened when
+ * possible, like heap_fill_tuple() does.
+ */
+static void
+appendVarlena(StringInfo buf, Form_pg_attribute attr, struct varlena *v)
+{
+	struct varlena *fetched = NULL;
+
+	if (VARATT_IS_EXTERNAL(v))
+		v = fetched = heap_tuple_fetch_attr(v);
+
+	if (attr->attstorage != 'p' && VARATT_CAN_MAKE_SHORT(v))
+	{
+		char		hdr;
+		Size		len = VARATT_CONVERTED_SHORT_SIZE(v);
+
+		SET_VARSIZE_SHORT(&hdr, len);
+		appendBinaryStringInfo(buf, &hdr, VARHDRSZ_SHORT);
+		appendBinaryStringInfo(buf, VARDATA(v), len - VARHDRSZ_SHORT);
+	}
+	else
+		appendBinaryStringInfo(buf, (char *) v, VARSIZE_ANY(v));
+
+	if (fetched)
+		pfree(fetched);
+}
+
+void
+EncodeColumnarBatch(ColumnarBatch *batch, StringInfo buf)
+{
+	uint32		ntuples = batch->ntuples;
+	uint16		natts = batch->tupdesc->natts;
+
+	appendBinaryStringInfo(buf, (char *) &ntuples, sizeof(ntuples));
+	appendBinaryStringInfo(buf, (char *) &natts, sizeof(natts));
+
+	for (int i = 0; i < natts; i++)
+		encodeColumn(batch, i, buf);
+
+	batch->ntuples = 0;
+	resetStringInfo(&batch->data);
+}
+
+static void
+encodeColumn(ColumnarBatch *batch, int attno, StringInfo buf)
+{
+	int			natts = batch->tupdesc->natts;
+	int			ntuples = batch->ntuples;
+	int			nvalues = 0;
+	int			lastidx = -1;
+	uint32		nruns = 0;
+	Size		plainsize = 0;
+	Size		rlesize = sizeof(uint32);
+	Size		dictsize = 0;
+	int			ndict = 0;
+	int			dictrows[COLBATCH_MAX_DICT];
+	int			idx;
+
+	/* Count the values, and the size of the plain and run-length forms */
+	for (int row = 0; row < ntuples; row++)
+	{
+		idx = row * natts + attno;
+		if (batch->lens[idx] < 0)
+			continue;
+
+		plainsize += batch->lens[idx];
+		if (lastidx < 0 || !batchValuesEqual(batch, lastidx, idx))
+		{
+			nruns++;
+			rlesize += sizeof(uint16) + batch->lens[idx];
+		}
+		lastidx = idx;
+		nvalues++;
+	}
+
+	if (nvalues == 0)
+	{
+		appendStringInfoCharMacro(buf, COLBATCH_ALL_NULLS);
+		return;
+	}
+
+	if (nvalues < ntuples)
+	{
+		int			nbytes = (ntuples + 7) / 8;
+		uint8	   *bitmap;
+
+		appendStringInfoCharMacro(buf, COLBATCH_SOME_NULLS);
+		enlargeStringInfo(buf, nbytes);
+		bitmap = (uint8 *) buf->data + buf->len;
+		memset(bitmap, 0, nbytes);
+		for (int row = 0; row < ntuples; row++)
+		{
+			if (batch->lens[row * natts + attno] < 0)
+				bitmap[row / 8] |= 1 << (row % 8);
+		}
+		buf->len += nbytes;
+		buf->data[buf->len] = '\0';
+	}
+	else
+		appendStringInfoCharMacro(buf, COLBATCH_NO_NULLS);
+
+	/*
+	 * A dictionary takes at least a byte per value, don't bother building
+	 * one if that's already no better.
+	 */
+	if (1 + nvalues < Min(plainsize, rlesize))
+		ndict = buildDictionary(batch, attno, dictrows, &dictsize);
+
+	if (ndict > 0 && 1 + dictsize + nvalues < Min(plainsize, rlesize))
+	{
+		uint8		n = ndict - 1;
+
+		appendStringInfoCharMacro(buf, COLBATCH_DICT);
+		appendStringInfoCharMacro(buf, n);
+		for (int i = 0; i < ndict; i++)
+		{
+			idx = dictrows[i] * natts + attno;
+			appendBinaryStringInfo(buf, BatchValuePtr(batch, idx), batch->lens[idx]);
+		}
+		appendBinaryStringInfo(buf, (char *) batch->codes, nvalues);
+	}
+	else if (rlesize < plainsize)
+	{
+		uint16		runlen = 0;
+
+		appendStringInfoCharMacro(buf, COLBATCH_RLE);
+		appendBinaryStringInfo(buf, (char *) &nruns, sizeof(nruns));
+
+		lastidx = -1;
+		for (int row = 0; row <= ntuples; row++)
+		{
+			if (row < ntuples)
+			{
+				idx = row * natts + attno;
+				if (batch->lens[idx] < 0)
+					continue;
+				if (lastidx >= 0 && batchValuesEqual(batch, lastidx, idx))
+				{
+					runlen++;
+					continue;
+				}
+			}
+			else
+				idx = -1;
+
+			/* End of a run */
+			if (lastidx >= 0)
+			{
+				appendBinaryStringInfo(buf, (char *) &runlen, sizeof(runlen));
+				appendBinaryStringInfo(buf, BatchValuePtr(batch, lastidx),
+									   batch->lens[lastidx]);
+			}
+			lastidx = idx;
+			runlen = 1;
+		}
+	}
+	else
+	{
+		appendStringInfoCharMacro(buf, COLBATCH_PLAIN);
+		for (int row = 0; row < ntuples; row++)
+		{
+			idx = row * natts + attno;
+			if (batch->lens[idx] >= 0)
+				appendBinaryStringInfo(buf, BatchValuePtr(batch, idx), batch->lens[idx]);
+		}
+	}
+}
+
+/*
+ * Build a dictionary of the distinct values of a column. The code of each
+ * non-NULL value is stored in batch->codes, and the row where each
+ * dictionary entry first appears in 'dictrows'.
+ *
+ * Returns the number of dictionary entries, or 0 if there are too many
+ * distinct values.
+ */
+static int
+buildDictionary(ColumnarBatch *batch, int attno, int *dictrows, Size *dictsize)
+{
+	int			natts = batch->tupdesc->natts;
+	int16		hashtable[COLBATCH_DICT_HASH_SIZE];
+	int			ndict = 0;
+	int			nvalues = 0;
+
+	memset(hashtable, -1, sizeof(hashtable));
+	*dictsize = 0;
+
+	for (int row = 0; row < batch->ntuples; row++)
+	{
+		int			idx = row * natts + attno;
+		uint32		h;
+
+		if (batch->lens[idx] < 0)
+			continue;
+
+		h = hash_bytes((unsigned char *) BatchValuePtr(batch, idx), batch->lens[idx]);
+		for (;;)
+		{
+			int			entry;
+
+			h &= COLBATCH_DICT_HASH_SIZE - 1;
+			entry = hashtable[h];
+			if (entry < 0)
+			{
+				if (ndict == COLBATCH_MAX_DICT)
+					return 0;
+				dictrows[ndict] = row;
+				hashtable[h] = ndict;
+				*dictsize += batch->lens[idx];
+				batch->codes[nvalues] = ndict++;
+				break;
+			}
+			if (batchValuesEqual(batch, dictrows[entry] * natts + attno, idx))
+			{
+				batch->codes[nvalues] = entry;
+				break;
+			}
+			h++;
+		}
+		nvalues++;
+	}
+
+	return ndict;
+}
+
+/*
+ * Decode a batch encoded by EncodeColumnarBatch(). The tuples are allocated
+ * in the current memory context.
+ */
+MinimalTuple *
+DecodeColumnarBatch(TupleDesc tupdesc, char *data, int len, int *ntuples_p)
+{
+	ColBatchReader reader;
+	MemoryContext decodeCxt;
+	MemoryContext oldCxt;
+	MinimalTuple *tuples;
+	Datum	   *values;
+	bool	   *isnull;
+	uint32		ntuples;
+	uint16		natts;
+
+	reader.pos = data;
+	reader.end = data + len;
+
+	memcpy(&ntuples, readBytes(&reader, sizeof(ntuples)), sizeof(ntuples));
+	memcpy(&natts, readBytes(&reader, sizeof(natts)), sizeof(natts));
+	if (ntuples == 0 || ntuples > COLUMNAR_BATCH_MAX_TUPLES ||
+		natts != tupdesc->natts)
+		invalidColumnarBatch();
+
+	tuples = palloc(ntuples * sizeof(MinimalTuple));
+
+	/* The decoded columns, and values that had to be copied, go in here. */
+	decodeCxt = AllocSetContextCreate(CurrentMemoryContext,
+									  "ColumnarBatchDecode",
+									  ALLOCSET_DEFAULT_SIZES);
+	oldCxt = MemoryContextSwitchTo(decodeCxt);
+
+	values = palloc(ntuples * natts * sizeof(Datum));
+	isnull = palloc(ntuples * natts * sizeof(bool));
+
+	for (int i = 0; i < natts; i++)
+		decodeColumn(&reader, TupleDescAttr(tupdesc, i), i, natts, ntuples,
+					 values, isnull);
+	if (reader.pos != reader.end)
+		invalidColumnarBatch();
+
+	MemoryContextSwitchTo(oldCxt);
+
+	for (int row = 0; row < ntuples; row++)
+		tuples[row] = heap_form_minimal_tuple(tupdesc,
+											  &values[row * natts],
+											  &isnull[row * natts]);
+
+	MemoryContextDelete(decodeCxt);
+
+	*ntuples_p = ntuples;
+	return tuples;
+}
+
+static void
+decodeColumn(ColBatchReader *reader, Form_pg_attribute attr,
+			 int attno, int natts, int ntuples,
+			 Datum *values, bool *isnull)
+{
+	uint8		nullmode = *readBytes(reader, 1);
+	uint8		encoding;
+	int			nvalues = 0;
+
+	switch (nullmode)
+	{
+		case COLBATCH_ALL_NULLS:
+			for (int row = 0; row < ntuples; row++)
+				isnull[row * natts + attno] = true;
+			return;
+
+		case COLBATCH_NO_NULLS:
+			for (int row = 0; row < ntuples; row++)
+				isnull[row * natts + attno] = false;
+			nvalues = ntuples;
+			break;
+
+		case COLBATCH_SOME_NULLS:
+			{
+				uint8	   *bitmap = (uint8 *) readBytes(reader, (ntuples + 7) / 8);
+
+				for (int row = 0; row < ntuples; row++)
+				{
+					bool		null = (bitmap[row / 8] & (1 << (row % 8))) != 0;
+
+					isnull[row * natts + attno] = null;
+					if (!null)
+						nvalues++;
+				}
+			}
+			break;
+
+		default:
+			invalidColumnarBatch();
+	}
+
+	encoding = *readBytes(reader, 1);
+	switch (encoding)
+	{
+		case COLBATCH_PLAIN:
+			for (int row = 0; row < ntuples; row++)
+			{
+				if (!isnull[row * natts + attno])
+					values[row * natts + attno] = readValue(reader, attr);
+			}
+			break;
+
+		case COLBATCH_RLE:
+			{
+				uint32		nruns;
+				uint16		runlen = 0;
+				Datum		value = (Datum) 0;
+
+				memcpy(&nruns, readBytes(reader, sizeof(nruns)), sizeof(nruns));
+				for (int row = 0; row < ntuples; row++)
+				{
+					if (isnull[row * natts + attno])
+						continue;
+					if (runlen == 0)
+					{
+						if (nruns-- == 0)
+							invalidColumnarBatch();
+						memcpy(&runlen, readBytes(reader, sizeof(runlen)), sizeof(runlen));
+						if (runlen == 0)
+							invalidColumnarBatch();
+						value = readValue(reader, attr);
+					}
+					values[row * natts + attno] = value;
+					runlen--;
+				}
+				if (runlen != 0 || nruns != 0)
+					invalidColumnarBatch();
+			}
+			break;
+
+		case COLBATCH_DICT:
+			{
+				int			ndict = (uint8) *readBytes(reader, 1) + 1;
+				Datum		dict[COLBATCH_MAX_DICT];
+				uint8	   *codes;
+
+				for (int i = 0; i < ndict; i++)
+					dict[i] = readValue(reader, attr);
+				codes = (uint8 *) readBytes(reader, nvalues);
+				for (int row = 0; row < ntuples; row++)
+				{
+					if (isnull[row * natts + attno])
+						continue;
+					if (*codes >= ndict)
+						invalidColumnarBatch();
+					values[row * natts + attno] = dict[*codes++];
+				}
+			}
+			break;
+
+		default:
+			invalidColumnarBatch();
+	}
+}
+
+/*
+ * Read one value. The returned datum points into the batch, except for a
+ * varlena with a 4-byte header that isn't suitably aligned, which is copied.
+ */
+static Datum
+readValue(ColBatchReader *reader, Form_pg_attribute attr)
+{
+	char	   *p = reader->pos;
+	Size		avail = reader->end - reader->pos;
+	Size		len;
+	Datum		value;
+
+	if (attr->attlen > 0)
+	{
+		len = attr->attlen;
+		if (len > avail)
+			invalidColumnarBatch();
+		if (attr->attbyval)
+		{
+			ColBatchByval buf;
+
+			memcpy(&buf, p, len);
+			value = fetch_att(&buf, true, len);
+		}
+		else
+			value = PointerGetDatum(p);
+	}
+	else if (attr->attlen == -1)
+	{
+		if (avail < VARHDRSZ_SHORT)
+			invalidColumnarBatch();
+
+		if (VARATT_IS_1B(p))
+		{
+			/* External values are always sent inline */
+			if (VARATT_IS_1B_E(p))
+				invalidColumnarBatch();
+			len = VARSIZE_1B(p);
+			value = PointerGetDatum(p);
+		}
+		else
+		{
+			varattrib_4b hdr;
+
+			if (avail < VARHDRSZ)
+				invalidColumnarBatch();
+			memcpy(&hdr, p, VARHDRSZ);
+			len = VARSIZE_4B(&hdr);
+			if (len < VARHDRSZ || len > avail)
+				invalidColumnarBatch();
+
+			if (INTALIGN(p) == (uintptr_t) p)
+				value = PointerGetDatum(p);
+			else
+			{
+				char	   *copy = palloc(len);
+
+				memcpy(copy, p, len);
+				value = PointerGetDatum(copy);
+			}
+		}
+		if (len > avail)
+			invalidColumnarBatch();
+	}
+	else
+	{
+		Assert(attr->attlen == -2);
+		len = strnlen(p, avail);
+		if (len == avail)
+			invalidColumnarBatch();
+		len++;
+		value = CStringGetDatum(p);
+	}
+
+	reader->pos += len;
+	return value;
+}
@@ -21,6 +21,8 @@
 #include "catalog/pg_type.h"
 #include "cdb/cdbmotion.h"
 #include "cdb/cdbsrlz.h"
+#include "cdb/ml_ipc.h"
+#include "cdb/tupcolbatch.h"
 #include "cdb/tupser.h"
 #include "cdb/cdbvars.h"
 #include "libpq/pqformat.h"
@@ -39,6 +41,19 @@
  */
 #define RECORD_CACHE_MAGIC_TUPLEN	-1
 
+/*
+ * Likewise, a columnar batch of tuples (see tupcolbatch.c) is sent with a
+ * special "tuple length".
+ */
+#define COLUMNAR_BATCH_MAGIC_TUPLEN	-2
+
+/*
+ * When a tuple is scattered over several packets, chunks are only written
+ * directly into a packet if at least this many bytes of it fit. Otherwise
+ * the packet is flushed by sending a chunk of this size the regular way.
+ */
+#define SCATTER_MIN_CHUNK_DATA		64
+
 /* A MemoryContext used within the tuple serialize code, so that freeing of
  * space is SUPAFAST.  It is initialized in the first call to InitSerTupInfo()
  * since that must be called before any tuple serialization or deserialization
@@ -260,6 +275,77 @@ addByteStringToChunkList(TupleChunkList tcList, char *data, int datalen, TupleCh
 	return;
 }
 
+/*
+ * Copy the next part of a tuple body being reassembled. Returns true when
+ * the body is complete.
+ */
+static bool
+addDataToChunkedTuple(MinimalTuple tup, uint32 *received, char *data, uint32 len)
+{
+	uint32		tupbodylen = tup->t_len - MINIMAL_TUPLE_DATA_OFFSET;
+
+	if (len > tupbodylen - *received)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("chunked tuple is longer than its declared length %u",
+						tupbodylen)));
+
+	memcpy((char *) tup + MINIMAL_TUPLE_DATA_OFFSET + *received, data, len);
+	*received += len;
+
+	return *received == tupbodylen;
+}
+
+/*
+ * Start reassembling a tuple from its TC_PARTIAL_START chunk: allocate the
+ * MinimalTuple, and copy the first part of the body into it.
+ *
+ * Returns NULL if the chunk doesn't start a regular tuple, e.g. a record
+ * cache; such chunks are collected and passed to CvtChunksToTup() instead.
+ */
+MinimalTuple
+BeginChunkedTuple(TupleChunkListItem tcItem, uint32 *received)
+{
+	char	   *data = GetChunkDataPtr(tcItem) + TUPLE_CHUNK_HEADER_SIZE;
+	uint32		datalen = tcItem->chunk_length - TUPLE_CHUNK_HEADER_SIZE;
+	int			tupbodylen;
+	MinimalTuple tup;
+
+	if (datalen < sizeof(tupbodylen))
+		return NULL;
+
+	memcpy(&tupbodylen, data, sizeof(tupbodylen));
+	if (tupbodylen == RECORD_CACHE_MAGIC_TUPLEN ||
+		tupbodylen == COLUMNAR_BATCH_MAGIC_TUPLEN)
+		return NULL;
+
+	if (tupbodylen < 0 || tupbodylen > MaxAllocSize - MINIMAL_TUPLE_DATA_OFFSET)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROTOCOL_VIOLATION),
+				 errmsg("chunked tuple is too large")));
+
+	tup = palloc(tupbodylen + MINIMAL_TUPLE_DATA_OFFSET);
+	tup->t_len = tupbodylen + MINIMAL_TUPLE_DATA_OFFSET;
+
+	*received = 0;
+	addDataToChunkedTuple(tup, received, data + sizeof(tupbodylen),
+						  datalen - sizeof(tupbodylen));
+
+	return tup;
+}
+
+/*
+ * Copy the data of the next chunk of a tuple started with
+ * BeginChunkedTuple(). Returns true when the tuple is complete.
+ */
+bool
+AddChunkToTuple(MinimalTuple tup, uint32 *received, TupleChunkListItem tcItem)
+{
+	return addDataToChunkedTuple(tup, received,
+								 GetChunkDataPtr(tcItem) + TUPLE_CHUNK_HEADER_SIZE,
+								 tcItem->chunk_length - TUPLE_CHUNK_HEADER_SIZE);
+}
+
 /*
  * Convert RecordCache into a byte-sequence, and store it directly
  * into a chunklist for transmission.
@@ -349,25 +435,196 @@ SerializeRecordCacheIntoChunks(SerTupInfo *pSerInfo,
 	return;
 }
 
+/*
+ * Encode a columnar batch of tuples, and store it into a chunklist for
+ * transmission. The batch is emptied.
+ */
+void
+SerializeColumnarBatchIntoChunks(SerTupInfo *pSerInfo,
+								 TupleChunkList tcList,
+								 ColumnarBatch *batch)
+{
+	TupleChunkListItem tcItem;
+	StringInfoData buf;
+	int			tupbodylen = COLUMNAR_BATCH_MAGIC_TUPLEN;
+
+	AssertArg(tcList != NULL);
+	AssertArg(pSerInfo != NULL);
+	AssertArg(batch->ntuples > 0);
+
+	/* get ready to go */
+	tcList->p_first = NULL;
+	tcList->p_last = NULL;
+	tcList->num_chunks = 0;
+	tcList->serialized_data_length = 0;
+	tcList->max_chunk_length = Gp_max_tuple_chunk_size;
+
+	tcItem = getChunkFromCache(&pSerInfo->chunkCache);
+
+	/* assume that we'll take a single chunk */
+	SetChunkType(tcItem->chunk_data, TC_WHOLE);
+	tcItem->chunk_length = TUPLE_CHUNK_HEADER_SIZE;
+	appendChunkToTCList(tcList, tcItem);
+
+	initStringInfo(&buf);
+	EncodeColumnarBatch(batch, &buf);
+
+	addByteStringToChunkList(tcList, (char *) &tupbodylen, sizeof(int),
+							 &pSerInfo->chunkCache);
+	addByteStringToChunkList(tcList, buf.data, buf.len, &pSerInfo->chunkCache);
+
+	pfree(buf.data);
+
+	/*
+	 * if we have more than 1 chunk we have to set the chunk types on our
+	 * first chunk and last chunk
+	 */
+	if (tcList->num_chunks > 1)
+	{
+		SetChunkType(tcList->p_first->chunk_data, TC_PARTIAL_START);
+		SetChunkType(tcList->p_last->chunk_data, TC_PARTIAL_END);
+	}
+}
+
 static bool
 CandidateForSerializeDirect(int16 targetRoute, struct directTransportBuffer *b)
 {
 	return targetRoute != BROADCAST_SEGIDX && b->pri != NULL && b->prilen > TUPLE_CHUNK_HEADER_SIZE;
 }
 
+/*
+ * Copy len bytes, starting at offset, of the on-wire form of a tuple: its
+ * body length followed by its body.
+ */
+static void
+CopyTupleWireData(char *dst, uint32 tupbodylen, char *tupbody,
+				  uint32 offset, uint32 len)
+{
+	if (offset < sizeof(tupbodylen))
+	{
+		uint32		n = Min(len, sizeof(tupbodylen) - offset);
+
+		memcpy(dst, (char *) &tupbodylen + offset, n);
+		dst += n;
+		offset += n;
+		len -= n;
+	}
+
+	if (len > 0)
+		memcpy(dst, tupbody + offset - sizeof(tupbodylen), len);
+}
+
+static TupleChunkType
+ScatterChunkType(uint32 offset, uint32 len, uint32 total)
+{
+	if (offset == 0)
+		return (len == total) ? TC_WHOLE : TC_PARTIAL_START;
+	return (offset + len == total) ? TC_PARTIAL_END : TC_PARTIAL_MID;
+}
+
+/*
+ * Send a tuple that does not fit in the free space of the current packet,
+ * as chunks written straight into the packet buffers, rather than copying
+ * it into a TupleChunkList first.
+ *
+ * Once a packet is full, a small chunk is sent through SendTupleChunkToAMS(),
+ * which flushes the packet and starts the next one; the chunks after it are
+ * again written in place.
+ *
+ * Returns false if all the receivers have stopped.
+ */
+static bool
+SerializeTupleScatter(struct MotionLayerState *mlStates,
+					  struct ChunkTransportState *transportStates,
+					  int16 motNodeID, int16 targetRoute,
+					  uint32 tupbodylen, char *tupbody,
+					  TupleChunkList tcList)
+{
+	union
+	{
+		TupleChunkListItemData item;
+		char		data[sizeof(TupleChunkListItemData) +
+						 TUPLE_CHUNK_HEADER_SIZE + SCATTER_MIN_CHUNK_DATA];
+	}			flushChunk;
+	uint32		total = sizeof(tupbodylen) + tupbodylen;
+	uint32		offset = 0;
+
+	while (offset < total)
+	{
+		struct directTransportBuffer b;
+		int			room;
+		uint32		len;
+
+		getTransportDirectBuffer(transportStates, motNodeID, targetRoute, &b);
+
+		room = Min(b.prilen, Gp_max_tuple_chunk_size + TUPLE_CHUNK_HEADER_SIZE) -
+			TUPLE_CHUNK_HEADER_SIZE;
+
+		if (b.pri != NULL && room >= (int) Min(total - offset, SCATTER_MIN_CHUNK_DATA))
+		{
+			len = Min((uint32) room, total - offset);
+
+			CopyTupleWireData((char *) b.pri + TUPLE_CHUNK_HEADER_SIZE,
+							  tupbodylen, tupbody, offset, len);
+			SetChunkType(b.pri, ScatterChunkType(offset, len, total));
+			SetChunkDataSize(b.pri, len);
+
+			putTransportDirectBuffer(transportStates, motNodeID, targetRoute,
+									 TUPLE_CHUNK_HEADER_SIZE + len);
+		}
+		else
+		{
+			TupleChunkListItem tcItem = &flushChunk.item;
+
+			len = Min(SCATTER_MIN_CHUNK_DATA, total - offset);
+
+			tcItem->p_next = NULL;
+			tcItem->inplace = NULL;
+			tcItem->chunk_length = TUPLE_CHUNK_HEADER_SIZE + len;
+			CopyTupleWireData((char *) tcItem->chunk_data + TUPLE_CHUNK_HEADER_SIZE,
+							  tupbodylen, tupbody, offset, len);
+			SetChunkType(tcItem->chunk_data, ScatterChunkType(offset, len, total));
+			SetChunkDataSize(tcItem->chunk_data, len);
+
+			if (!SendTupleChunkToAMS(mlStates, transportStates, motNodeID,
+									 targetRoute, tcItem))
+				return false;
+
+			/* This receiver has stopped, don't bother with the rest */
+			if (b.pri == NULL)
+				break;
+		}
+
+		offset += len;
+		tcList->num_chunks++;
+		tcList->serialized_data_length += len;
+	}
+
+	return true;
+}
+
 /*
  *
  * First try to serialize a tuple directly into a buffer.
  *
  * We're called with at least enough space for a tuple-chunk-header.
  *
- * Convert a HeapTuple into a byte-sequence, and store it directly
- * into a chunklist for transmission.
+ * If the tuple doesn't fit, but can be sent directly, scatter it over the
+ * transport's packet buffers. Otherwise convert a HeapTuple into a
+ * byte-sequence, and store it into a chunklist for transmission.
+ *
+ * Returns the length of the chunk written into 'b', or one of the
+ * SERIALIZE_TUPLE_* codes. tcList holds the number of chunks and bytes
+ * sent in all cases but the first.
  *
  * This code is based on the printtup_internal_20() function in printtup.c.
  */
 int
-SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTransportBuffer *b, TupleChunkList tcList, int16 targetRoute)
+SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo,
+			   struct MotionLayerState *mlStates,
+			   struct ChunkTransportState *transportStates,
+			   int16 motNodeID,
+			   struct directTransportBuffer *b, TupleChunkList tcList, int16 targetRoute)
 {
 	int                natts;
 	int                dataSize = TUPLE_CHUNK_HEADER_SIZE;
@@ -483,6 +740,19 @@ SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTranspor
 		return dataSize;
 	}
 
+	if (targetRoute != BROADCAST_SEGIDX && b->pri != NULL)
+	{
+		bool		stillActive;
+
+		stillActive = SerializeTupleScatter(mlStates, transportStates,
+											motNodeID, targetRoute,
+											tupbodylen, tupbody, tcList);
+
+		if (shouldFreeTuple)
+			pfree(mintuple);
+		return stillActive ? SERIALIZE_TUPLE_SCATTERED : SERIALIZE_TUPLE_STOPPED;
+	}
+
 	/*
 	 * If direct in-line serialization failed then we fallback to chunked
 	 * out-of-line serialization.
@@ -535,7 +805,7 @@ SerializeTuple(TupleTableSlot *slot, SerTupInfo *pSerInfo, struct directTranspor
 	/*
 	 * performed "out-of-line" serialization
 	 */
-	return 0;
+	return SERIALIZE_TUPLE_CHUNKED;
 }
 
 /*
@@ -694,6 +964,23 @@ CvtChunksToTup(TupleChunkList tcList, SerTupInfo *pSerInfo, TupleRemapper *remap
 
 			return NULL;
 		}
+		else if (tupbodylen == COLUMNAR_BATCH_MAGIC_TUPLEN)
+		{
+			/*
+			 * A batch of tuples. They are handed back in pSerInfo, for the
+			 * caller to collect.
+			 */
+			Assert(pSerInfo->batch_tuples == NULL);
+			pSerInfo->batch_tuples =
+				DecodeColumnarBatch(pSerInfo->tupdesc, pos,
+									serData.len - sizeof(tupbodylen),
+									&pSerInfo->batch_ntuples);
+
+			if (serDataMustFree)
+				pfree(serData.data);
+
+			return NULL;
+		}
 		else
 		{
 			/* A normal MinimalTuple */
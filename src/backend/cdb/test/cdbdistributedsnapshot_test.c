@@ -25,6 +25,10 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 
 		dslm.inProgressMappedLocalXids =
 			(TransactionId*)malloc(5 * sizeof(TransactionId));
+		dslm.inProgressBitmap = NULL;
+		dslm.inProgressBitmapWords = 0;
+		dslm.localXidHash = NULL;
+		dslm.localXidHashMask = 0;
 
 		ds->inProgressXidArray =
 			(DistributedTransactionId*)malloc(SIZE_OF_IN_PROGRESS_ARRAY);
@@ -153,6 +157,120 @@ test__DistributedSnapshotWithLocalMapping_CommittedTest(void **state)
 	free(dslm.inProgressMappedLocalXids);
 }
 
+/*
+ * Serialize and deserialize a snapshot, and check that it comes back the
+ * same, in the expected number of bytes.
+ */
+static void
+check_serialize_roundtrip(DistributedSnapshot *ds, int expectedPayloadSize)
+{
+	DistributedSnapshot result;
+	DistributedTransactionId resultXids[10];
+	char		buf[256];
+	int			len;
+	int			i;
+
+	len = DistributedSnapshot_Serialize(ds, buf);
+	assert_int_equal(len, DistributedSnapshot_SerializeSize(ds));
+	assert_int_equal(len, sizeof(DistributedSnapshotId) +
+					 3 * sizeof(DistributedTransactionId) +
+					 sizeof(int32) + 1 + expectedPayloadSize);
+
+	result.inProgressXidArray = resultXids;
+	assert_int_equal(DistributedSnapshot_Deserialize(buf, &result), len);
+
+	assert_true(result.xminAllDistributedSnapshots == ds->xminAllDistributedSnapshots);
+	assert_int_equal(result.distribSnapshotId, ds->distribSnapshotId);
+	assert_true(result.xmin == ds->xmin);
+	assert_true(result.xmax == ds->xmax);
+	assert_int_equal(result.count, ds->count);
+	for (i = 0; i < ds->count; i++)
+		assert_true(result.inProgressXidArray[i] == ds->inProgressXidArray[i]);
+}
+
+static void
+test__DistributedSnapshot_Serialize(void **state)
+{
+	DistributedSnapshot ds;
+	DistributedTransactionId xids[10];
+	int			i;
+
+	ds.inProgressXidArray = xids;
+	ds.distribSnapshotId = 12345;
+	ds.xminAllDistributedSnapshots = 1000;
+
+	/* Empty */
+	ds.xmin = ds.xmax = 1000;
+	ds.count = 0;
+	check_serialize_roundtrip(&ds, 0);
+
+	/* Dense: 10 xids in a range of 20 fit in a 3-byte bitmap */
+	ds.xmin = 1000;
+	ds.xmax = 1020;
+	ds.count = 10;
+	for (i = 0; i < 10; i++)
+		xids[i] = 1000 + 2 * i;
+	check_serialize_roundtrip(&ds, 3);
+
+	/* Sparse: deltas of 100 take one byte each, 500 two bytes */
+	ds.xmin = 1000;
+	ds.xmax = 100000;
+	ds.count = 4;
+	xids[0] = 1100;
+	xids[1] = 1200;
+	xids[2] = 1700;
+	xids[3] = 1800;
+	check_serialize_roundtrip(&ds, 5);
+
+	/* Not sorted: sent as an array */
+	xids[0] = 1200;
+	xids[1] = 1100;
+	check_serialize_roundtrip(&ds, 4 * sizeof(DistributedTransactionId));
+
+	/* Outside [xmin, xmax): sent as an array */
+	xids[0] = 1100;
+	xids[1] = 1200;
+	xids[3] = 100000;
+	check_serialize_roundtrip(&ds, 4 * sizeof(DistributedTransactionId));
+}
+
+static void
+test__DistributedSnapshotWithLocalMapping_BuildLookup(void **state)
+{
+	DistributedSnapshotWithLocalMapping dslm;
+	DistributedSnapshot *ds = &dslm.ds;
+	DistributedTransactionId xids[3] = {50, 100, 200};
+	uint64		bitmap[64];
+	TransactionId hash[16];
+
+	memset(&dslm, 0, sizeof(dslm));
+	dslm.inProgressBitmap = bitmap;
+	dslm.localXidHash = hash;
+	ds->inProgressXidArray = xids;
+	ds->xminAllDistributedSnapshots = 3;
+	ds->xmin = 3;
+	ds->xmax = 300;
+	ds->count = 3;
+
+	DistributedSnapshotWithLocalMapping_BuildLookup(&dslm);
+	assert_int_equal(dslm.inProgressBitmapWords, 5);
+	assert_int_equal(dslm.localXidHashMask, 15);
+	assert_true(bitmap[0] == UINT64CONST(1) << 47);
+	assert_true(bitmap[1] == UINT64CONST(1) << 33);
+	assert_true(bitmap[3] == UINT64CONST(1) << 5);
+	assert_true(bitmap[2] == 0 && bitmap[4] == 0);
+
+	LocalXidHashInsert(&dslm, 10);
+	assert_true(LocalXidHashContains(&dslm, 10));
+	assert_false(LocalXidHashContains(&dslm, 20));
+
+	/* A range too wide for the bitmap falls back to the array */
+	ds->xmax = 3 + 64 * 64 + 1;
+	DistributedSnapshotWithLocalMapping_BuildLookup(&dslm);
+	assert_int_equal(dslm.inProgressBitmapWords, 0);
+	assert_int_equal(dslm.localXidHashMask, 15);
+}
+
 int
 main(int argc, char* argv[])
 {
@@ -160,7 +278,9 @@ main(int argc, char* argv[])
 
 	const UnitTest tests[] =
 	{
-		unit_test(test__DistributedSnapshotWithLocalMapping_CommittedTest)
+		unit_test(test__DistributedSnapshotWithLocalMapping_CommittedTest),
+		unit_test(test__DistributedSnapshot_Serialize),
+		unit_test(test__DistributedSnapshotWithLocalMapping_BuildLookup)
 	};
 
 	MemoryContextInit();
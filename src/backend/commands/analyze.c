@@ -118,6 +118,7 @@
 
 #include "catalog/heap.h"
 #include "catalog/pg_am.h"
+#include "catalog/pg_appendonly.h"
 #include "cdb/cdbappendonlyam.h"
 #include "cdb/cdbaocsam.h"
 #include "cdb/cdbdisp_query.h"
@@ -147,6 +148,37 @@
 /* Fix attr number of return record of function gp_acquire_sample_rows */
 #define FIX_ATTR_NUM  3
 
+/*
+ * Memory for the columns of the sample that are deformed at a time, see
+ * AnlSampleColumns.
+ */
+#define ANL_SAMPLE_COLUMNS_MEM	(64 * 1024 * 1024)
+
+/*
+ * The columns of the sample rows, deformed a batch of columns at a time.
+ *
+ * Fetching a column with heap_getattr() walks over all the columns before it
+ * unless their offsets are fixed, which makes fetching every column of a wide
+ * table quadratic in the number of columns. Instead, each row is deformed
+ * left to right just once, remembering where it stopped, and the values of
+ * the current batch of columns are kept in arrays that compute_stats reads
+ * through ind_fetch_func.
+ */
+typedef struct AnlSampleColumns
+{
+	HeapTuple  *rows;
+	int			numrows;
+	TupleDesc	tupDesc;
+	int			maxcols;		/* most columns in a batch */
+	int			firstatt;		/* first column of the batch, 0-based */
+	int			ncols;			/* columns in the batch */
+	Datum	   *values;			/* numrows * maxcols, row by row */
+	bool	   *isnull;
+	int		   *nextatt;		/* next column to deform, in each row */
+	uint32	   *offset;			/* its offset, if nextatt > 0 */
+	bool	   *slow;			/* can't use attcacheoff from nextatt on */
+} AnlSampleColumns;
+
 /* Per-index data for ANALYZE */
 typedef struct AnlIndexData
 {
@@ -199,12 +231,18 @@ static void update_attstats(Oid relid, bool inh,
 							int natts, VacAttrStats **vacattrstats);
 static Datum std_fetch_func(VacAttrStatsP stats, int rownum, bool *isNull);
 static Datum ind_fetch_func(VacAttrStatsP stats, int rownum, bool *isNull);
+static AnlSampleColumns *anl_sample_columns_create(HeapTuple *rows, int numrows,
+												   TupleDesc tupDesc);
+static void anl_sample_columns_fetch(AnlSampleColumns *columns,
+									 VacAttrStats *stats);
 
 static void analyze_rel_internal(Oid relid, RangeVar *relation,
 								 VacuumParams *params, List *va_cols,
 								 bool in_outer_xact, BufferAccessStrategy bstrategy,
 								 gp_acquire_sample_rows_context *ctx);
 static void acquire_hll_by_query(Relation onerel, int nattrs, VacAttrStats **attrstats, int elevel);
+static int64 acquire_ao_modcount(Relation onerel);
+static bool ao_stats_up_to_date(Relation onerel, int64 modcount);
 
 /*
  *	analyze_rel() -- analyze one relation
@@ -255,6 +293,7 @@ analyze_rel_internal(Oid relid, RangeVar *relation,
 	int			elevel;
 	AcquireSampleRowsFunc acquirefunc = NULL;
 	BlockNumber relpages = 0;
+	int64		aomodcount = -1;
 
 	/* Select logging level */
 	if (params->options & VACOPT_VERBOSE)
@@ -399,6 +438,19 @@ analyze_rel_internal(Oid relid, RangeVar *relation,
 		return;
 	}
 
+	/*
+	 * With INCREMENTAL, find out whether an append-optimized table has been
+	 * modified since its statistics were computed. Every insert, delete and
+	 * update bumps the modcount of a segfile, and nothing ever decreases it,
+	 * so an unchanged sum over all segfiles means the contents are the same.
+	 * Reading it takes a catalog lookup on each segment instead of a sample.
+	 */
+	if ((params->options & VACOPT_INCREMENTAL) &&
+		Gp_role == GP_ROLE_DISPATCH && !ctx && va_cols == NIL &&
+		onerel->rd_rel->relkind == RELKIND_RELATION &&
+		RelationIsAppendOptimized(onerel))
+		aomodcount = acquire_ao_modcount(onerel);
+
 	/*
 	 * OK, let's do it.  First let other backends know I'm in ANALYZE.
 	 */
@@ -419,8 +471,28 @@ analyze_rel_internal(Oid relid, RangeVar *relation,
 	 * To distinguish the two requests, we check the ctx->inherited value here.
 	 */
 	if (onerel->rd_rel->relkind != RELKIND_PARTITIONED_TABLE && (!ctx || !ctx->inherited))
-		do_analyze_rel(onerel, params, va_cols, acquirefunc,
-					   relpages, false, in_outer_xact, elevel, ctx);
+	{
+		if (aomodcount >= 0 && ao_stats_up_to_date(onerel, aomodcount))
+			ereport(elevel,
+					(errmsg("skipping \"%s\" --- not modified since it was last analyzed",
+							RelationGetRelationName(onerel))));
+		else
+		{
+			do_analyze_rel(onerel, params, va_cols, acquirefunc,
+						   relpages, false, in_outer_xact, elevel, ctx);
+
+			/*
+			 * The modcount was read by a separate dispatched query, before
+			 * the sample was acquired, so the sample may include changes
+			 * that committed in between. That's safe: the modcount we
+			 * store is never newer than the statistics, so at worst the
+			 * next incremental ANALYZE does work it could have skipped.
+			 */
+			if (aomodcount >= 0)
+				UpdateAppendOnlyEntryAnalyzeModCount(RelationGetRelid(onerel),
+													 aomodcount);
+		}
+	}
 
 	/*
 	 * If there are child tables, do recursive ANALYZE.
@@ -771,10 +843,15 @@ do_analyze_rel(Relation onerel, VacuumParams *params,
 	if (numrows > 0 || !sample_needed)
 	{
 		HeapTuple *validRows = (HeapTuple *) palloc(numrows * sizeof(HeapTuple));
+		AnlSampleColumns *sampleColumns = NULL;
 		MemoryContext col_context,
 					old_context;
 		bool		build_ext_stats;
 
+		if (numrows > 0)
+			sampleColumns = anl_sample_columns_create(rows, numrows,
+													  onerel->rd_att);
+
 		pgstat_progress_update_param(PROGRESS_ANALYZE_PHASE,
 									 PROGRESS_ANALYZE_PHASE_COMPUTE_STATS);
 
@@ -861,8 +938,17 @@ do_analyze_rel(Relation onerel, VacuumParams *params,
 
 			if (validRowsLength > 0)
 			{
+				AnalyzeAttrFetchFunc fetchfunc = std_fetch_func;
+
+				/* the deformed columns have a value for every sample row */
+				if (!rowIndexes)
+				{
+					anl_sample_columns_fetch(sampleColumns, stats);
+					fetchfunc = ind_fetch_func;
+				}
+
 				stats->compute_stats(stats,
-									 std_fetch_func,
+									 fetchfunc,
 									 validRowsLength, // numbers of rows in sample excluding toowide if any.
 									 totalrows);
 				/*
@@ -2127,6 +2213,62 @@ acquire_index_number_of_blocks(Relation indexrel, Relation tablerel)
 	}
 }
 
+/*
+ * Sum up the modcounts of all segfiles of an append-optimized relation, on
+ * all segments.
+ */
+static int64
+acquire_ao_modcount(Relation onerel)
+{
+	Oid			segrelid;
+	char	   *sql;
+	int64		modcount;
+
+	GetAppendOnlyEntryAuxOids(onerel, &segrelid, NULL, NULL);
+
+	/* pg_aoseg and pg_aocsseg tables both have a modcount column */
+	sql = psprintf("select pg_catalog.sum(modcount) from %s",
+				   quote_qualified_identifier(get_namespace_name(get_rel_namespace(segrelid)),
+											  get_rel_name(segrelid)));
+	modcount = get_size_from_segDBs(sql);
+	pfree(sql);
+
+	return modcount;
+}
+
+/*
+ * Are the statistics of an append-optimized relation still valid for the
+ * given modcount? Besides the relation being unmodified since the last
+ * incremental ANALYZE, every column that ANALYZE would process must have its
+ * statistics, which isn't the case after e.g. ADD COLUMN, or if they were
+ * never gathered because the relation was empty.
+ */
+static bool
+ao_stats_up_to_date(Relation onerel, int64 modcount)
+{
+	TupleDesc	tupdesc = RelationGetDescr(onerel);
+	int			i;
+
+	if (onerel->rd_appendonly->analyzemodcount != modcount)
+		return false;
+
+	for (i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+
+		if (attr->attisdropped || attr->attstattarget == 0)
+			continue;
+
+		if (!SearchSysCacheExists3(STATRELATTINH,
+								   ObjectIdGetDatum(RelationGetRelid(onerel)),
+								   Int16GetDatum(attr->attnum),
+								   BoolGetDatum(false)))
+			return false;
+	}
+
+	return true;
+}
+
 /*
  * parse_record_to_string
  *
@@ -2863,7 +3005,8 @@ std_fetch_func(VacAttrStatsP stats, int rownum, bool *isNull)
 }
 
 /*
- * Fetch function for analyzing index expressions.
+ * Fetch function for analyzing index expressions, and table columns that
+ * anl_sample_columns_fetch() has deformed.
  *
  * We have not bothered to construct index tuples, instead the data is
  * just in Datum arrays.
@@ -2880,6 +3023,164 @@ ind_fetch_func(VacAttrStatsP stats, int rownum, bool *isNull)
 }
 
 
+/*
+ * Set up to deform the columns of the sample rows. The arrays are allocated
+ * in anl_context, the values point into the rows.
+ */
+static AnlSampleColumns *
+anl_sample_columns_create(HeapTuple *rows, int numrows, TupleDesc tupDesc)
+{
+	MemoryContext oldcontext = MemoryContextSwitchTo(anl_context);
+	AnlSampleColumns *columns = palloc0(sizeof(AnlSampleColumns));
+	Size		rowmem = (Size) numrows * (sizeof(Datum) + sizeof(bool));
+
+	columns->rows = rows;
+	columns->numrows = numrows;
+	columns->tupDesc = tupDesc;
+	columns->maxcols = Max(1, Min(tupDesc->natts,
+								  ANL_SAMPLE_COLUMNS_MEM / rowmem));
+	columns->firstatt = 0;
+	columns->ncols = 0;
+	columns->values = palloc((Size) numrows * columns->maxcols * sizeof(Datum));
+	columns->isnull = palloc((Size) numrows * columns->maxcols * sizeof(bool));
+	columns->nextatt = palloc0(numrows * sizeof(int));
+	columns->offset = palloc0(numrows * sizeof(uint32));
+	columns->slow = palloc0(numrows * sizeof(bool));
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return columns;
+}
+
+/*
+ * Deform one sample row up to column 'endatt' (0-based, exclusive), keeping
+ * the values from column 'firstatt' on. This is heap_deform_tuple(), resumed
+ * where the previous call stopped.
+ */
+static void
+anl_sample_columns_deform_row(AnlSampleColumns *columns, int rowno,
+							  int firstatt, int endatt,
+							  Datum *values, bool *isnull)
+{
+	HeapTuple	tuple = columns->rows[rowno];
+	TupleDesc	tupleDesc = columns->tupDesc;
+	HeapTupleHeader tup = tuple->t_data;
+	bool		hasnulls = HeapTupleHasNulls(tuple);
+	int			tupnatts = HeapTupleHeaderGetNatts(tup);
+	char	   *tp = (char *) tup + tup->t_hoff;
+	bits8	   *bp = tup->t_bits;
+	int			attnum = columns->nextatt[rowno];
+	uint32		off = columns->offset[rowno];
+	bool		slow = columns->slow[rowno];
+
+	for (; attnum < endatt && attnum < tupnatts; attnum++)
+	{
+		Form_pg_attribute thisatt = TupleDescAttr(tupleDesc, attnum);
+		bool		keep = (attnum >= firstatt);
+
+		if (hasnulls && att_isnull(attnum, bp))
+		{
+			if (keep)
+			{
+				values[attnum - firstatt] = (Datum) 0;
+				isnull[attnum - firstatt] = true;
+			}
+			slow = true;		/* can't use attcacheoff anymore */
+			continue;
+		}
+
+		if (!slow && thisatt->attcacheoff >= 0)
+			off = thisatt->attcacheoff;
+		else if (thisatt->attlen == -1)
+		{
+			/*
+			 * We can only cache the offset for a varlena attribute if the
+			 * offset is already suitably aligned, so that there would be no
+			 * pad bytes in any case: then the offset will be valid for either
+			 * an aligned or unaligned value.
+			 */
+			if (!slow &&
+				off == att_align_nominal(off, thisatt->attalign))
+				thisatt->attcacheoff = off;
+			else
+			{
+				off = att_align_pointer(off, thisatt->attalign, -1,
+										tp + off);
+				slow = true;
+			}
+		}
+		else
+		{
+			/* not varlena, so safe to use att_align_nominal */
+			off = att_align_nominal(off, thisatt->attalign);
+
+			if (!slow)
+				thisatt->attcacheoff = off;
+		}
+
+		if (keep)
+		{
+			values[attnum - firstatt] = fetchatt(thisatt, tp + off);
+			isnull[attnum - firstatt] = false;
+		}
+
+		off = att_addlength_pointer(off, thisatt->attlen, tp + off);
+
+		if (thisatt->attlen <= 0)
+			slow = true;		/* can't use attcacheoff anymore */
+	}
+
+	/* columns added after the row was written */
+	for (; attnum < endatt; attnum++)
+	{
+		if (attnum >= firstatt)
+			values[attnum - firstatt] = getmissingattr(tupleDesc, attnum + 1,
+													   &isnull[attnum - firstatt]);
+	}
+
+	columns->nextatt[rowno] = attnum;
+	columns->offset[rowno] = off;
+	columns->slow[rowno] = slow;
+}
+
+/*
+ * Point stats->exprvals and stats->exprnulls at the sample values of the
+ * column, deforming the batch of columns that starts with it if it isn't
+ * deformed yet.
+ */
+static void
+anl_sample_columns_fetch(AnlSampleColumns *columns, VacAttrStats *stats)
+{
+	int			att = stats->tupattnum - 1;
+
+	if (att < columns->firstatt || att >= columns->firstatt + columns->ncols)
+	{
+		int			endatt = Min(att + columns->maxcols, columns->tupDesc->natts);
+
+		for (int rowno = 0; rowno < columns->numrows; rowno++)
+		{
+			/* columns are usually analyzed in order, if not start over */
+			if (columns->nextatt[rowno] > att)
+			{
+				columns->nextatt[rowno] = 0;
+				columns->offset[rowno] = 0;
+				columns->slow[rowno] = false;
+			}
+
+			anl_sample_columns_deform_row(columns, rowno, att, endatt,
+										  columns->values + (Size) rowno * columns->maxcols,
+										  columns->isnull + (Size) rowno * columns->maxcols);
+		}
+
+		columns->firstatt = att;
+		columns->ncols = endatt - att;
+	}
+
+	stats->exprvals = columns->values + (att - columns->firstatt);
+	stats->exprnulls = columns->isnull + (att - columns->firstatt);
+	stats->rowstride = columns->maxcols;
+}
+
 /*==========================================================================
  *
  * Code below this point represents the "standard" type-specific statistics
@@ -51,13 +51,18 @@
 #include "parser/parse_expr.h"
 #include "parser/parse_relation.h"
 #include "pgstat.h"
+#include "port/pg_bitutils.h"
 #include "port/pg_bswap.h"
+#include "port/simd.h"
 #include "rewrite/rewriteHandler.h"
 #include "storage/fd.h"
 #include "storage/execute_pipe.h"
 #include "tcop/tcopprot.h"
 #include "tcop/utility.h"
 #include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/datetime.h"
+#include "utils/fmgroids.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/partcache.h"
@@ -231,6 +236,11 @@ static bool CopyReadLine(CopyState cstate);
 static bool CopyReadLineText(CopyState cstate);
 static int	CopyReadAttributesText(CopyState cstate, int stop_processing_at_field);
 static int	CopyReadAttributesCSV(CopyState cstate, int stop_processing_at_field);
+static inline int CopyScanSpecialChars(const char *s, int len,
+									   char c1, char c2, char c3, char c4,
+									   bool highbit);
+static Datum CopyInputFunctionCall(FmgrInfo *flinfo, char *string,
+								   Oid typioparam, int32 typmod);
 static Datum CopyReadBinaryAttribute(CopyState cstate,
 									 int column_no, FmgrInfo *flinfo,
 									 Oid typioparam, int32 typmod,
@@ -5607,10 +5617,10 @@ NextCopyFromX(CopyState cstate, ExprContext *econtext,
 
 			cstate->cur_attname = NameStr(att->attname);
 			cstate->cur_attval = string;
-			values[m] = InputFunctionCall(&in_functions[m],
-										  string,
-										  typioparams[m],
-										  att->atttypmod);
+			values[m] = CopyInputFunctionCall(&in_functions[m],
+											  string,
+											  typioparams[m],
+											  att->atttypmod);
 			if (string != NULL)
 				nulls[m] = false;
 			cstate->cur_attname = NULL;
@@ -6372,6 +6382,12 @@ CopyReadLineText(CopyState cstate)
 	char		quotec = '\0';
 	char		escapec = '\0';
 
+	/* bytes that the loop below must look at one at a time */
+	char		special1 = '\n';
+	char		special2 = '\r';
+	char		special3 = '\\';
+	char		special4 = '\\';
+
 	if (cstate->csv_mode)
 	{
 		quotec = cstate->quote[0];
@@ -6379,6 +6395,13 @@ CopyReadLineText(CopyState cstate)
 		/* ignore special escape processing if it's the same as quotec */
 		if (quotec == escapec)
 			escapec = '\0';
+
+		/*
+		 * A backslash only matters at the start of a line, which is never
+		 * skipped, see below.
+		 */
+		special3 = quotec;
+		special4 = escapec ? escapec : quotec;
 	}
 
 	mblen_str[1] = '\0';
@@ -6448,6 +6471,31 @@ CopyReadLineText(CopyState cstate)
 			need_data = false;
 		}
 
+		/*
+		 * Skip over the run of bytes that can neither end the line nor
+		 * change the CSV quoting state, many at a time.  They're transferred
+		 * to line_buf along with the rest of the line.  The first byte of a
+		 * line is left to the loop, because of the \. end-of-copy marker.
+		 */
+		if (!first_char_in_line || !cstate->csv_mode)
+		{
+			int			skip;
+
+			skip = CopyScanSpecialChars(copy_raw_buf + raw_buf_ptr,
+										copy_buf_len - raw_buf_ptr,
+										special1, special2,
+										special3, special4,
+										cstate->encoding_embeds_ascii);
+			if (skip > 0)
+			{
+				raw_buf_ptr += skip;
+				first_char_in_line = false;
+				last_was_esc = false;
+				if (raw_buf_ptr >= copy_buf_len)
+					continue;
+			}
+		}
+
 		/* OK to fetch a character */
 		prev_raw_ptr = raw_buf_ptr;
 		c = copy_raw_buf[raw_buf_ptr++];
@@ -6823,6 +6871,182 @@ not_end_of_copy:
 	return result;
 }
 
+/*
+ * Return the offset of the first byte in s[0 .. len) that is one of c1 .. c4,
+ * or that has its high bit set if 'highbit' is true; len if there's none.
+ *
+ * This is the inner loop of COPY FROM in text and CSV format, so where SIMD
+ * is available it looks at 32 bytes at a time.
+ */
+static inline int
+CopyScanSpecialChars(const char *s, int len, char c1, char c2, char c3,
+					 char c4, bool highbit)
+{
+	int			i = 0;
+
+#ifndef USE_NO_SIMD
+	const Vector8 v1 = vector8_broadcast(c1);
+	const Vector8 v2 = vector8_broadcast(c2);
+	const Vector8 v3 = vector8_broadcast(c3);
+	const Vector8 v4 = vector8_broadcast(c4);
+	const int	nelem = sizeof(Vector8);
+
+	for (; i + 2 * nelem <= len; i += 2 * nelem)
+	{
+		Vector8		chunk1 = vector8_load(s + i);
+		Vector8		chunk2 = vector8_load(s + i + nelem);
+		Vector8		match1;
+		Vector8		match2;
+		uint32		mask;
+
+		match1 = vector8_or(vector8_or(vector8_eq(chunk1, v1),
+									   vector8_eq(chunk1, v2)),
+							vector8_or(vector8_eq(chunk1, v3),
+									   vector8_eq(chunk1, v4)));
+		match2 = vector8_or(vector8_or(vector8_eq(chunk2, v1),
+									   vector8_eq(chunk2, v2)),
+							vector8_or(vector8_eq(chunk2, v3),
+									   vector8_eq(chunk2, v4)));
+		if (highbit)
+		{
+			match1 = vector8_or(match1, chunk1);
+			match2 = vector8_or(match2, chunk2);
+		}
+
+		mask = vector8_highbit_mask(match1) |
+			(vector8_highbit_mask(match2) << nelem);
+		if (mask != 0)
+			return i + pg_rightmost_one_pos32(mask);
+	}
+#endif
+
+	for (; i < len; i++)
+	{
+		char		c = s[i];
+
+		if (c == c1 || c == c2 || c == c3 || c == c4 ||
+			(highbit && IS_HIGHBIT_SET(c)))
+			break;
+	}
+
+	return i;
+}
+
+/*
+ * Parse a plain decimal integer, with an optional sign and at most 18
+ * digits, so that it can't overflow an int64.  Returns false for anything
+ * else, leaving it to the type's input function.
+ */
+static inline bool
+CopyParseSimpleInteger(const char *s, int64 *result)
+{
+	bool		neg = false;
+	int64		val = 0;
+	int			ndigits = 0;
+
+	if (*s == '-')
+	{
+		neg = true;
+		s++;
+	}
+	else if (*s == '+')
+		s++;
+
+	while (*s >= '0' && *s <= '9')
+	{
+		if (++ndigits > 18)
+			return false;
+		val = val * 10 + (*s++ - '0');
+	}
+
+	if (*s != '\0' || ndigits == 0)
+		return false;
+
+	*result = neg ? -val : val;
+	return true;
+}
+
+/*
+ * Parse a date in ISO 8601 format, YYYY-MM-DD, which date_in() reads the
+ * same way whatever the DateStyle.  Returns false for anything else,
+ * including invalid dates, leaving it to date_in().
+ */
+static inline bool
+CopyParseISODate(const char *s, DateADT *result)
+{
+	int			year;
+	int			month;
+	int			day;
+	int			i;
+
+	for (i = 0; i < 10; i++)
+	{
+		if (i == 4 || i == 7)
+		{
+			if (s[i] != '-')
+				return false;
+		}
+		else if (s[i] < '0' || s[i] > '9')
+			return false;
+	}
+	if (s[10] != '\0')
+		return false;
+
+	year = (s[0] - '0') * 1000 + (s[1] - '0') * 100 + (s[2] - '0') * 10 + (s[3] - '0');
+	month = (s[5] - '0') * 10 + (s[6] - '0');
+	day = (s[8] - '0') * 10 + (s[9] - '0');
+
+	if (year == 0 || month < 1 || month > MONTHS_PER_YEAR || day < 1 ||
+		day > day_tab[isleap(year)][month - 1])
+		return false;
+
+	*result = date2j(year, month, day) - POSTGRES_EPOCH_JDATE;
+	return true;
+}
+
+/*
+ * Convert an input field to a Datum.
+ *
+ * Integers and dates are common enough in bulk loads that it pays to parse
+ * their simplest forms here, without a trip through the type's input
+ * function.  Anything out of the ordinary still goes to the input function,
+ * so that errors are reported the same way.
+ */
+static Datum
+CopyInputFunctionCall(FmgrInfo *flinfo, char *string, Oid typioparam,
+					  int32 typmod)
+{
+	int64		ival;
+	DateADT		date;
+
+	if (string != NULL)
+	{
+		switch (flinfo->fn_oid)
+		{
+			case F_INT2IN:
+				if (CopyParseSimpleInteger(string, &ival) &&
+					ival >= PG_INT16_MIN && ival <= PG_INT16_MAX)
+					return Int16GetDatum((int16) ival);
+				break;
+			case F_INT4IN:
+				if (CopyParseSimpleInteger(string, &ival) &&
+					ival >= PG_INT32_MIN && ival <= PG_INT32_MAX)
+					return Int32GetDatum((int32) ival);
+				break;
+			case F_INT8IN:
+				if (CopyParseSimpleInteger(string, &ival))
+					return Int64GetDatum(ival);
+				break;
+			case F_DATE_IN:
+				if (CopyParseISODate(string, &date))
+					return DateADTGetDatum(date);
+				break;
+		}
+	}
+
+	return InputFunctionCall(flinfo, string, typioparam, typmod);
+}
+
 /*
  *	Return decimal value for a hexadecimal digit
  */
@@ -6860,10 +7084,13 @@ CopyReadAttributesText(CopyState cstate, int stop_processing_at_field)
 	char		delimc = cstate->delim[0];
 	char		escapec = cstate->escape[0];
 	bool		delim_off = cstate->delim_off;
+	bool		escape_off = cstate->escape_off;
 	int			fieldno;
 	char	   *output_ptr;
 	char	   *cur_ptr;
 	char	   *line_end_ptr;
+	char		scanc1;
+	char		scanc2;
 
 	/*
 	 * We need a special case for zero-column tables: check that the input
@@ -6895,6 +7122,10 @@ CopyReadAttributesText(CopyState cstate, int stop_processing_at_field)
 	cur_ptr = cstate->line_buf.data + cstate->line_buf.cursor;
 	line_end_ptr = cstate->line_buf.data + cstate->line_buf.len;
 
+	/* the bytes that end a run of plain data in a field */
+	scanc1 = delim_off ? escapec : delimc;
+	scanc2 = escape_off ? scanc1 : escapec;
+
 	/* Outer loop iterates over fields */
 	fieldno = 0;
 	for (;;)
@@ -6941,6 +7172,19 @@ CopyReadAttributesText(CopyState cstate, int stop_processing_at_field)
 		{
 			char		c;
 
+			/* Copy the run of bytes up to the next delimiter or escape */
+			if (!delim_off || !escape_off)
+			{
+				int			run;
+
+				run = CopyScanSpecialChars(cur_ptr, line_end_ptr - cur_ptr,
+										   scanc1, scanc2, scanc2, scanc2,
+										   false);
+				memcpy(output_ptr, cur_ptr, run);
+				output_ptr += run;
+				cur_ptr += run;
+			}
+
 			end_ptr = cur_ptr;
 			if (cur_ptr >= line_end_ptr)
 				break;
@@ -6950,7 +7194,7 @@ CopyReadAttributesText(CopyState cstate, int stop_processing_at_field)
 				found_delim = true;
 				break;
 			}
-			if (c == escapec && !cstate->escape_off)
+			if (c == escapec && !escape_off)
 			{
 				if (cur_ptr >= line_end_ptr)
 					break;
@@ -7189,6 +7433,16 @@ CopyReadAttributesCSV(CopyState cstate, int stop_processing_at_field)
 			/* Not in quote */
 			for (;;)
 			{
+				int			run;
+
+				/* Copy the run of bytes up to the next delimiter or quote */
+				run = CopyScanSpecialChars(cur_ptr, line_end_ptr - cur_ptr,
+										   delim_off ? quotec : delimc,
+										   quotec, quotec, quotec, false);
+				memcpy(output_ptr, cur_ptr, run);
+				output_ptr += run;
+				cur_ptr += run;
+
 				end_ptr = cur_ptr;
 				if (cur_ptr >= line_end_ptr)
 					goto endfield;
@@ -7212,6 +7466,16 @@ CopyReadAttributesCSV(CopyState cstate, int stop_processing_at_field)
 			/* In quote */
 			for (;;)
 			{
+				int			run;
+
+				/* Copy the run of bytes up to the next escape or quote */
+				run = CopyScanSpecialChars(cur_ptr, line_end_ptr - cur_ptr,
+										   escapec, quotec, quotec, quotec,
+										   false);
+				memcpy(output_ptr, cur_ptr, run);
+				output_ptr += run;
+				cur_ptr += run;
+
 				end_ptr = cur_ptr;
 				if (cur_ptr >= line_end_ptr)
 					ereport(ERROR,
@@ -3559,6 +3559,18 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 				 */
 				hinstrument.space_peak =
 					Max(hinstrument.space_peak, worker_hi->space_peak);
+
+				/* GPDB: likewise for the hybrid hash join batches */
+				if (worker_hi->hybrid)
+				{
+					hinstrument.hybrid = true;
+					hinstrument.nbatch_resident =
+						Max(hinstrument.nbatch_resident, worker_hi->nbatch_resident);
+					hinstrument.nbatch_spilled =
+						Max(hinstrument.nbatch_spilled, worker_hi->nbatch_spilled);
+					hinstrument.nbatch_split =
+						Max(hinstrument.nbatch_split, worker_hi->nbatch_split);
+				}
 			}
 		}
 	}
@@ -3600,6 +3612,33 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 							 hinstrument.nbuckets, hinstrument.nbatch,
 							 spacePeakKb);
 		}
+
+		/*
+		 * GPDB: with hybrid hash join, show how many of the planned batches
+		 * stayed in memory during the first pass, how many were dumped out,
+		 * and how many batches were split off batches that were too big.
+		 */
+		if (hinstrument.hybrid)
+		{
+			if (es->format != EXPLAIN_FORMAT_TEXT)
+			{
+				ExplainPropertyInteger("Resident Hash Batches", NULL,
+									   hinstrument.nbatch_resident, es);
+				ExplainPropertyInteger("Spilled Hash Batches", NULL,
+									   hinstrument.nbatch_spilled, es);
+				ExplainPropertyInteger("Split Hash Batches", NULL,
+									   hinstrument.nbatch_split, es);
+			}
+			else
+			{
+				appendStringInfoSpaces(es->str, es->indent * 2);
+				appendStringInfo(es->str,
+								 "Hybrid Batches: %d resident, %d spilled, %d split\n",
+								 hinstrument.nbatch_resident,
+								 hinstrument.nbatch_spilled,
+								 hinstrument.nbatch_split);
+			}
+		}
 	}
 }
 
@@ -19,6 +19,7 @@
 
 #include "libpq-fe.h"
 #include "libpq-int.h"
+#include "cdb/cdbaocsam.h"		/* aocs_zonemap_blocks_skipped() */
 #include "cdb/cdbconn.h"		/* SegmentDatabaseDescriptor */
 #include "cdb/cdbdisp.h"                /* CheckDispatchResult() */
 #include "cdb/cdbdispatchresult.h"	/* CdbDispatchResults */
@@ -27,6 +28,7 @@
 #include "cdb/cdbutil.h"
 #include "cdb/cdbvars.h"		/* GpIdentity.segindex */
 #include "cdb/cdbendpoint.h"
+#include "cdb/ml_ipc.h"			/* GetMotionCompressionStats() */
 #include "cdb/memquota.h"
 #include "libpq/pqformat.h"		/* pq_beginmessage() etc. */
 #include "miscadmin.h"
@@ -62,6 +64,11 @@ typedef struct CdbExplain_StatInst
 	bool		workfileCreated;	/* workfile created in this node */
 	instr_time	firststart;		/* Start time of first iteration of node */
 	int			numPartScanned; /* Number of part tables scanned */
+	double		icpayloadbytes;	/* Motion bytes received, uncompressed */
+	double		icwirebytes;	/* Motion bytes received, on the wire */
+	double		rfnfiltered;	/* SeqScan rows removed by runtime filters */
+	double		zmnskipped;		/* AOCS blocks skipped by zone maps */
+	double		aggnpassed;		/* Agg rows passed through unhashed */
 
 	TuplesortInstrumentation sortstats; /* Sort stats, if this is a Sort node */
 	HashInstrumentation hashstats; /* Hash stats, if this is a Hash node */
@@ -126,6 +133,15 @@ typedef struct CdbExplain_NodeSummary
 	CdbExplain_Agg totalWorkfileCreated;
 	/* Used for DynamicSeqScan, DynamicIndexScan, DynamicBitmapHeapScan, and DynamicForeignScan */
 	CdbExplain_Agg totalPartTableScanned;
+	/* Used for Motion, when gp_interconnect_compression is on */
+	CdbExplain_Agg icpayloadbytes;
+	CdbExplain_Agg icwirebytes;
+	/* Used for SeqScan, when runtime filters were pushed down to it */
+	CdbExplain_Agg rfnfiltered;
+	/* Used for SeqScan on AOCS tables, when zone maps let it skip blocks */
+	CdbExplain_Agg zmnskipped;
+	/* Used for streaming HashAgg, when it passed rows through */
+	CdbExplain_Agg aggnpassed;
 
 	/* insts array info */
 	int			segindex0;		/* segment id of insts[0] */
@@ -844,6 +860,28 @@ cdbexplain_collectStatsFromNode(PlanState *planstate, CdbExplain_SendStatCtx *ct
 	si->firststart = instr->firststart;
 	si->numPartScanned = instr->numPartScanned;
 
+	if (IsA(planstate, MotionState))
+	{
+		uint64		payloadBytes;
+		uint64		wireBytes;
+
+		GetMotionCompressionStats(planstate->state->interconnect_context,
+								  ((Motion *) planstate->plan)->motionID,
+								  &payloadBytes, &wireBytes);
+		si->icpayloadbytes = payloadBytes;
+		si->icwirebytes = wireBytes;
+	}
+	if (IsA(planstate, SeqScanState))
+	{
+		SeqScanState *ss = (SeqScanState *) planstate;
+
+		si->rfnfiltered = ss->rf_nfiltered;
+		if (ss->ss.ss_currentScanDesc &&
+			RelationIsAoCols(ss->ss.ss_currentRelation))
+			si->zmnskipped = aocs_zonemap_blocks_skipped(ss->ss.ss_currentScanDesc);
+	}
+	if (IsA(planstate, AggState))
+		si->aggnpassed = ((AggState *) planstate)->streaming_passthrough_nrows;
 	if (IsA(planstate, SortState))
 	{
 		SortState *sortstate = (SortState *) planstate;
@@ -982,6 +1020,11 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
 	CdbExplain_DepStatAcc peakmemused;
 	CdbExplain_DepStatAcc vmem_reserved;
 	CdbExplain_DepStatAcc totalPartTableScanned;
+	CdbExplain_DepStatAcc icpayloadbytes;
+	CdbExplain_DepStatAcc icwirebytes;
+	CdbExplain_DepStatAcc rfnfiltered;
+	CdbExplain_DepStatAcc zmnskipped;
+	CdbExplain_DepStatAcc aggnpassed;
 	int			imsgptr;
 	int			nInst;
 
@@ -1006,6 +1049,11 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
 	cdbexplain_depStatAcc_init0(&workmemwanted);
 	cdbexplain_depStatAcc_init0(&totalWorkfileCreated);
 	cdbexplain_depStatAcc_init0(&totalPartTableScanned);
+	cdbexplain_depStatAcc_init0(&icpayloadbytes);
+	cdbexplain_depStatAcc_init0(&icwirebytes);
+	cdbexplain_depStatAcc_init0(&rfnfiltered);
+	cdbexplain_depStatAcc_init0(&zmnskipped);
+	cdbexplain_depStatAcc_init0(&aggnpassed);
 
 	/* Initialize per-slice accumulators. */
 	cdbexplain_depStatAcc_init0(&peakmemused);
@@ -1044,6 +1092,11 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
 		cdbexplain_depStatAcc_upd(&workmemwanted, rsi->workmemwanted, rsh, rsi, nsi);
 		cdbexplain_depStatAcc_upd(&totalWorkfileCreated, (rsi->workfileCreated ? 1 : 0), rsh, rsi, nsi);
 		cdbexplain_depStatAcc_upd(&totalPartTableScanned, rsi->numPartScanned, rsh, rsi, nsi);
+		cdbexplain_depStatAcc_upd(&icpayloadbytes, rsi->icpayloadbytes, rsh, rsi, nsi);
+		cdbexplain_depStatAcc_upd(&icwirebytes, rsi->icwirebytes, rsh, rsi, nsi);
+		cdbexplain_depStatAcc_upd(&rfnfiltered, rsi->rfnfiltered, rsh, rsi, nsi);
+		cdbexplain_depStatAcc_upd(&zmnskipped, rsi->zmnskipped, rsh, rsi, nsi);
+		cdbexplain_depStatAcc_upd(&aggnpassed, rsi->aggnpassed, rsh, rsi, nsi);
 
 		/* Update per-slice accumulators. */
 		cdbexplain_depStatAcc_upd(&peakmemused, rsh->worker.peakmemused, rsh, rsi, nsi);
@@ -1057,6 +1110,11 @@ cdbexplain_depositStatsToNode(PlanState *planstate, CdbExplain_RecvStatCtx *ctx)
 	ns->workmemwanted = workmemwanted.agg;
 	ns->totalWorkfileCreated = totalWorkfileCreated.agg;
 	ns->totalPartTableScanned = totalPartTableScanned.agg;
+	ns->icpayloadbytes = icpayloadbytes.agg;
+	ns->icwirebytes = icwirebytes.agg;
+	ns->rfnfiltered = rfnfiltered.agg;
+	ns->zmnskipped = zmnskipped.agg;
+	ns->aggnpassed = aggnpassed.agg;
 
 	/* Roll up summary over all nodes of slice into RecvStatCtx. */
 	ctx->workmemused_max = Max(ctx->workmemused_max, workmemused.agg.vmax);
@@ -1485,6 +1543,50 @@ cdbexplain_showExecStats(struct PlanState *planstate, ExplainState *es)
 		}
 	}
 
+	/*
+	 * Bytes received by a Motion before and after interconnect compression,
+	 * if any of its packets were compressed.
+	 */
+	if (es->analyze && ns->icwirebytes.vsum < ns->icpayloadbytes.vsum)
+	{
+		if (es->format == EXPLAIN_FORMAT_TEXT)
+		{
+			appendStringInfoSpaces(es->str, es->indent * 2);
+			appendStringInfo(es->str, "Interconnect Compression: %ldkB to %ldkB\n",
+							 (long) kb(ns->icpayloadbytes.vsum),
+							 (long) kb(ns->icwirebytes.vsum));
+		}
+		else
+		{
+			ExplainPropertyInteger("Interconnect Bytes Before Compression", "kB", kb(ns->icpayloadbytes.vsum), es);
+			ExplainPropertyInteger("Interconnect Bytes After Compression", "kB", kb(ns->icwirebytes.vsum), es);
+		}
+	}
+
+	/*
+	 * Rows that a scan dropped because the runtime filters of the hash joins
+	 * above rejected them, summed over all segments.
+	 */
+	if (es->analyze && ns->rfnfiltered.vsum > 0)
+		ExplainPropertyFloat("Rows Removed by Runtime Filter", NULL,
+							 ns->rfnfiltered.vsum, 0, es);
+
+	/*
+	 * Column blocks that an AOCS scan did not read because their zone maps
+	 * ruled out the qual, summed over all segments.
+	 */
+	if (es->analyze && ns->zmnskipped.vsum > 0)
+		ExplainPropertyFloat("Blocks Skipped by Zone Map", NULL,
+							 ns->zmnskipped.vsum, 0, es);
+
+	/*
+	 * Rows that a streaming HashAgg handed on without hashing them, summed
+	 * over all segments.
+	 */
+	if (es->analyze && ns->aggnpassed.vsum > 0)
+		ExplainPropertyFloat("Rows Passed Through", NULL,
+							 ns->aggnpassed.vsum, 0, es);
+
 	/*
 	 * Actual work_mem used and wanted
 	 */
@@ -2208,7 +2310,7 @@ void ExplainParallelRetrieveCursor(ExplainState *es, QueryDesc* queryDesc)
 		{
 			appendStringInfo(
 							 &endpointInfoStr, "\"on segment: contentid [%d]\"",
-							 gp_session_id % plan->planTree->flow->numsegments);
+							 plan->slices[0].segindex);
 			break;
 		}
 		case ENDPOINT_ON_SOME_QE:
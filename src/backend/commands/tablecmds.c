@@ -1827,6 +1827,10 @@ ao_aux_tables_safe_truncate(Relation rel)
 	 */
 	RemoveFastSequenceEntry(RelationGetRelid(rel), aoseg_relid);
 	InsertInitialFastSequenceEntries(aoseg_relid);
+
+	/* The modcounts start over, forget what ANALYZE saw */
+	if (rel->rd_appendonly->analyzemodcount >= 0)
+		UpdateAppendOnlyEntryAnalyzeModCount(RelationGetRelid(rel), -1);
 }
 
 /*
@@ -123,6 +123,7 @@ ExecVacuum(ParseState *pstate, VacuumStmt *vacstmt, bool isTopLevel, bool auto_s
 	bool		disable_page_skipping = false;
 	bool		rootonly = false;
 	bool		fullscan = false;
+	bool		incremental = false;
 	int		ao_phase = 0;
 	ListCell   *lc;
 
@@ -144,6 +145,8 @@ ExecVacuum(ParseState *pstate, VacuumStmt *vacstmt, bool isTopLevel, bool auto_s
 			rootonly = defGetBoolean(opt);
 		else if (strcmp(opt->defname, "fullscan") == 0)
 			fullscan = defGetBoolean(opt);
+		else if (strcmp(opt->defname, "incremental") == 0)
+			incremental = defGetBoolean(opt);
 		else if (!vacstmt->is_vacuumcmd)
 			ereport(ERROR,
 					(errcode(ERRCODE_SYNTAX_ERROR),
@@ -192,6 +195,8 @@ ExecVacuum(ParseState *pstate, VacuumStmt *vacstmt, bool isTopLevel, bool auto_s
 		params.options |= VACOPT_ROOTONLY;
 	if (fullscan)
 		params.options |= VACOPT_FULLSCAN;
+	if (incremental)
+		params.options |= VACOPT_INCREMENTAL;
 	params.options |= ao_phase;
 
 	/* sanity checks on options */
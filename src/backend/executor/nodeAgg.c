@@ -270,6 +270,7 @@
 #include "utils/dynahash.h"
 #include "utils/expandeddatum.h"
 #include "utils/faultinjector.h"
+#include "utils/guc.h"
 #include "utils/logtape.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
@@ -317,6 +318,16 @@
  */
 #define CHUNKHDRSZ 16
 
+/*
+ * A streaming HashAgg checks how well hashing reduces its input after this
+ * many rows of a round, and again when the round ends. If the ratio of groups
+ * to input rows is at least gp_hashagg_passthrough_ratio, the hash table is
+ * flushed and the next HASHAGG_PASSTHROUGH_ROWS rows are passed through, each
+ * with transition states of its own, before hashing is tried again.
+ */
+#define HASHAGG_PASSTHROUGH_PROBE_ROWS 10000
+#define HASHAGG_PASSTHROUGH_ROWS 1000000
+
 /*
  * Track all tapes needed for a HashAgg that spills. We don't know the maximum
  * number of tapes needed at the start of the algorithm (because it can
@@ -429,6 +440,8 @@ static void agg_fill_hash_table(AggState *aggstate);
 static bool agg_refill_hash_table(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table_in_memory(AggState *aggstate);
+static bool hash_agg_passthrough_wanted(AggState *aggstate);
+static TupleTableSlot *agg_retrieve_passthrough(AggState *aggstate);
 static void hash_agg_check_limits(AggState *aggstate);
 static void hash_agg_enter_spill_mode(AggState *aggstate);
 static void hash_agg_update_metrics(AggState *aggstate, bool from_tape,
@@ -2227,7 +2240,7 @@ ExecAgg(PlanState *pstate)
 		switch (node->phase->aggstrategy)
 		{
 			case AGG_HASHED:
-				if (!node->table_filled)
+				if (!node->table_filled && node->streaming_passthrough_left == 0)
 					agg_fill_hash_table(node);
 				/* FALLTHROUGH */
 			case AGG_MIXED:
@@ -2644,6 +2657,19 @@ agg_fill_hash_table(AggState *aggstate)
 		 * hash lookups do this too
 		 */
 		ResetExprContext(aggstate->tmpcontext);
+
+		/* don't wait for the hash table to fill up if it's hardly reducing */
+		if (aggstate->streaming &&
+			++aggstate->streaming_round_ninput == HASHAGG_PASSTHROUGH_PROBE_ROWS &&
+			hash_agg_passthrough_wanted(aggstate))
+			aggstate->table_filled = true;
+	}
+
+	/* decide how to go on after this round is returned */
+	if (aggstate->streaming && !aggstate->input_done)
+	{
+		aggstate->streaming_passthrough = hash_agg_passthrough_wanted(aggstate);
+		aggstate->streaming_round_ninput = 0;
 	}
 
 	/* finalize spills, if any */
@@ -2821,6 +2847,25 @@ agg_retrieve_hash_table(AggState *aggstate)
 
 	while (result == NULL)
 	{
+		if (aggstate->streaming_passthrough_left > 0)
+		{
+			result = agg_retrieve_passthrough(aggstate);
+			if (result != NULL)
+				break;
+
+			if (aggstate->input_done)
+			{
+				aggstate->agg_done = true;
+				break;
+			}
+
+			/* see if hashing reduces the input better now */
+			agg_fill_hash_table(aggstate);
+			if (aggstate->agg_done)
+				break;
+			continue;
+		}
+
 		result = agg_retrieve_hash_table_in_memory(aggstate);
 		if (result == NULL)
 		{
@@ -2854,6 +2899,14 @@ agg_retrieve_hash_table(AggState *aggstate)
 					aggstate->table_filled = false;
 				}
 
+				/* the last round barely reduced its input, pass rows through */
+				if (aggstate->streaming_passthrough)
+				{
+					aggstate->streaming_passthrough = false;
+					aggstate->streaming_passthrough_left = HASHAGG_PASSTHROUGH_ROWS;
+					continue;
+				}
+
 				/* refill the hash table from outer, since streaming doesn't spill */
 				agg_fill_hash_table(aggstate);
 
@@ -2872,6 +2925,95 @@ agg_retrieve_hash_table(AggState *aggstate)
 	return result;
 }
 
+/*
+ * Whether the current round of a streaming HashAgg reduced its input so little
+ * that the next rows should rather be passed through.
+ *
+ * Grouping sets aren't supported, which no streaming plan uses.
+ */
+static bool
+hash_agg_passthrough_wanted(AggState *aggstate)
+{
+	Agg		   *node = (Agg *) aggstate->ss.ps.plan;
+
+	if (!gp_enable_hashagg_passthrough ||
+		aggstate->aggstrategy != AGG_HASHED ||
+		node->groupingSets != NIL ||
+		aggstate->streaming_round_ninput < HASHAGG_PASSTHROUGH_PROBE_ROWS)
+		return false;
+
+	return aggstate->hash_ngroups_current >=
+		gp_hashagg_passthrough_ratio * aggstate->streaming_round_ninput;
+}
+
+/*
+ * Streaming HashAgg in pass-through mode: return the next input row as a group
+ * of its own, without looking it up in the hash table. The next aggregation
+ * stage combines it like any other partial group.
+ *
+ * Returns NULL once HASHAGG_PASSTHROUGH_ROWS rows have been passed through, or
+ * at the end of the input, which sets input_done.
+ */
+static TupleTableSlot *
+agg_retrieve_passthrough(AggState *aggstate)
+{
+	ExprContext *econtext = aggstate->ss.ps.ps_ExprContext;
+	ExprContext *tmpcontext = aggstate->tmpcontext;
+	AggStatePerGroup pergroup;
+	TupleTableSlot *outerslot;
+	TupleTableSlot *result;
+
+	if (aggstate->streaming_passthrough_pergroup == NULL && aggstate->numtrans > 0)
+		aggstate->streaming_passthrough_pergroup = (AggStatePerGroup)
+			MemoryContextAlloc(aggstate->ss.ps.state->es_query_cxt,
+							   sizeof(AggStatePerGroupData) * aggstate->numtrans);
+	pergroup = aggstate->streaming_passthrough_pergroup;
+
+	while (aggstate->streaming_passthrough_left > 0)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		outerslot = fetch_input_tuple(aggstate);
+		if (TupIsNull(outerslot))
+		{
+			aggstate->input_done = true;
+			break;
+		}
+		aggstate->streaming_passthrough_left--;
+		aggstate->streaming_passthrough_nrows += 1;
+
+		/*
+		 * The previous row has been sent on, so its transition values aren't
+		 * needed anymore.
+		 */
+		ReScanExprContext(aggstate->hashcontext);
+		ResetExprContext(econtext);
+
+		select_current_set(aggstate, 0, true);
+		for (int transno = 0; transno < aggstate->numtrans; transno++)
+			initialize_aggregate(aggstate, &aggstate->pertrans[transno],
+								 &pergroup[transno]);
+		aggstate->hash_pergroup[0] = pergroup;
+
+		tmpcontext->ecxt_outertuple = outerslot;
+		advance_aggregates(aggstate);
+		ResetExprContext(tmpcontext);
+
+		/* the row itself supplies the grouping columns */
+		econtext->ecxt_outertuple = outerslot;
+
+		finalize_aggregates(aggstate, aggstate->peragg, pergroup);
+
+		result = project_aggregates(aggstate);
+		if (result)
+			return result;
+	}
+
+	aggstate->hash_pergroup[0] = NULL;
+
+	return NULL;
+}
+
 /*
  * Retrieve the groups from the in-memory hash tables without considering any
  * spilled tuples.
@@ -3379,6 +3521,10 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 	aggstate->sort_in = NULL;
 	aggstate->sort_out = NULL;
 	aggstate->streaming = node->streaming;
+	aggstate->streaming_passthrough = false;
+	aggstate->streaming_round_ninput = 0;
+	aggstate->streaming_passthrough_left = 0;
+	aggstate->streaming_passthrough_pergroup = NULL;
 
 	/*
 	 * phases[0] always exists, but is dummy in sorted/plain mode
@@ -4797,6 +4943,9 @@ ExecReScanAgg(AggState *node)
 		node->hash_ever_spilled = false;
 		node->hash_spill_mode = false;
 		node->hash_ngroups_current = 0;
+		node->streaming_passthrough = false;
+		node->streaming_round_ninput = 0;
+		node->streaming_passthrough_left = 0;
 
 		ReScanExprContext(node->hashcontext);
 		/* Rebuild an empty hash table */
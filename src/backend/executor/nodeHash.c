@@ -21,6 +21,7 @@
  *		MultiExecHash	- generate an in-memory hash table of the relation
  *		ExecInitHash	- initialize node and subnodes
  *		ExecEndHash		- shutdown node and subnodes
+ *		ExecRuntimeFilterCheck - check a row against a runtime filter
  */
 
 #include "postgres.h"
@@ -32,11 +33,13 @@
 #include "access/htup_details.h"
 #include "access/parallel.h"
 #include "catalog/pg_statistic.h"
+#include "catalog/pg_type.h"
 #include "commands/tablespace.h"
 #include "executor/execdebug.h"
 #include "executor/hashjoin.h"
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "lib/bloomfilter.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "port/atomics.h"
@@ -52,6 +55,10 @@
 #include "cdb/cdbvars.h"
 
 static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
+static void ExecHashGrowBatchArrays(HashJoinTable hashtable, int nbatch);
+static long ExecHashDumpBatches(HashJoinTable hashtable, long *ninmemory);
+static bool ExecHashDumpResidentBatches(HashJoinTable hashtable);
+static void ExecHashSplitCurrentBatch(HashJoinTable hashtable);
 static void ExecHashIncreaseNumBuckets(HashJoinTable hashtable);
 static void ExecParallelHashIncreaseNumBatches(HashJoinTable hashtable);
 static void ExecParallelHashIncreaseNumBuckets(HashJoinTable hashtable);
@@ -76,6 +83,10 @@ static HashJoinTuple ExecParallelHashTupleAlloc(HashJoinTable hashtable,
 												size_t size,
 												dsa_pointer *shared);
 static void MultiExecPrivateHash(HashState *node);
+static void RuntimeFilterBuildBegin(HashState *node);
+static void RuntimeFilterBuildAdd(HashState *node, ExprContext *econtext,
+								  uint32 hashvalue);
+static void RuntimeFilterBuildEnd(HashState *node);
 static void MultiExecParallelHash(HashState *node);
 static inline HashJoinTuple ExecParallelHashFirstTuple(HashJoinTable table,
 													   int bucketno);
@@ -174,6 +185,9 @@ MultiExecPrivateHash(HashState *node)
 
 	SIMPLE_FAULT_INJECTOR("multi_exec_hash_large_vmem");
 
+	if (node->runtime_filter)
+		RuntimeFilterBuildBegin(node);
+
 	/*
 	 * Get all tuples from the node below the Hash node and insert into the
 	 * hash table (or temp files).
@@ -208,6 +222,9 @@ MultiExecPrivateHash(HashState *node)
 				ExecHashTableInsert(node, hashtable, slot, hashvalue);
 			}
 			hashtable->totalTuples += 1;
+
+			if (node->runtime_filter)
+				RuntimeFilterBuildAdd(node, econtext, hashvalue);
 		}
 
 		if (hashkeys_null)
@@ -234,6 +251,196 @@ MultiExecPrivateHash(HashState *node)
 		hashtable->spacePeak = hashtable->spaceUsed;
 
 	hashtable->partialTuples = hashtable->totalTuples;
+
+	if (node->runtime_filter)
+		RuntimeFilterBuildEnd(node);
+}
+
+/* ----------------------------------------------------------------
+ *		GPDB: Runtime filters
+ *
+ *		While the hash table is built, the hash value of every inner
+ *		row goes into the Bloom filter of the runtime filter, and the
+ *		range of the key values is tracked. Once the hash table is
+ *		complete, the filter is marked ready, and the scan it was pushed
+ *		down to (see ExecHashJoinPushdownRuntimeFilter()) starts checking
+ *		its rows with ExecRuntimeFilterCheck().
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * If the Bloom filter turns out to be fuller than this, because there were
+ * many more inner rows than estimated, it lets too many rows through to be
+ * worth checking.
+ */
+#define RUNTIME_FILTER_MAX_BLOOM_FILL	0.5
+
+/*
+ * Every this many rows checked, stop checking if fewer than
+ * 1 / RUNTIME_FILTER_MIN_REJECT_FRAC of them were rejected.
+ */
+#define RUNTIME_FILTER_CHECK_INTERVAL	16384
+#define RUNTIME_FILTER_MIN_REJECT_FRAC	10
+
+static void
+RuntimeFilterBuildBegin(HashState *node)
+{
+	RuntimeFilter *rf = node->runtime_filter;
+	MemoryContext oldcxt;
+
+	rf->ready = false;
+	rf->rangeempty = true;
+	rf->nchecked = 0;
+	rf->nrejected = 0;
+	rf->disabled = false;
+
+	if (rf->bloom)
+		bloom_free(rf->bloom);
+
+	oldcxt = MemoryContextSwitchTo(node->ps.state->es_query_cxt);
+	rf->bloom = bloom_create((int64) rf->bloom_elems, work_mem, 0);
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * Convert a key value to int64, for the range check. The types are the ones
+ * ExecHashJoinPushdownRuntimeFilter() accepts for it.
+ */
+static int64
+RuntimeFilterDatumGetInt64(Datum value, Oid typid)
+{
+	switch (typid)
+	{
+		case INT2OID:
+			return DatumGetInt16(value);
+		case INT4OID:
+		case DATEOID:
+			return DatumGetInt32(value);
+		case INT8OID:
+			return DatumGetInt64(value);
+		default:
+			elog(ERROR, "unexpected type %u in runtime filter", typid);
+			return 0;			/* keep compiler quiet */
+	}
+}
+
+static void
+RuntimeFilterBuildAdd(HashState *node, ExprContext *econtext, uint32 hashvalue)
+{
+	RuntimeFilter *rf = node->runtime_filter;
+
+	bloom_add_element(rf->bloom, (unsigned char *) &hashvalue, sizeof(hashvalue));
+
+	if (rf->hasrange)
+	{
+		ExprState  *keyexpr = (ExprState *) linitial(node->hashkeys);
+		Datum		keyval;
+		bool		isnull;
+
+		/* ExecHashGetHashValue() just evaluated it, so this is cheap */
+		keyval = ExecEvalExprSwitchContext(keyexpr, econtext, &isnull);
+		if (!isnull)
+		{
+			int64		val = RuntimeFilterDatumGetInt64(keyval, rf->innertype);
+
+			if (rf->rangeempty)
+			{
+				rf->minval = rf->maxval = val;
+				rf->rangeempty = false;
+			}
+			else if (val < rf->minval)
+				rf->minval = val;
+			else if (val > rf->maxval)
+				rf->maxval = val;
+		}
+	}
+}
+
+static void
+RuntimeFilterBuildEnd(HashState *node)
+{
+	RuntimeFilter *rf = node->runtime_filter;
+
+	if (bloom_prop_bits_set(rf->bloom) > RUNTIME_FILTER_MAX_BLOOM_FILL)
+	{
+		bloom_free(rf->bloom);
+		rf->bloom = NULL;
+	}
+
+	if (rf->bloom || rf->hasrange)
+		rf->ready = true;
+}
+
+/*
+ * ExecRuntimeFilterCheck
+ *		Can a row with the given key values find a join partner?
+ *
+ * 'values' and 'isnull' hold the key columns of the row, in the order of the
+ * hash keys. Returns false if the row surely has no partner in the hash
+ * table. Before the hash table is built, every row passes.
+ */
+bool
+ExecRuntimeFilterCheck(RuntimeFilter *rf, Datum *values, bool *isnull)
+{
+	uint32		hashkey = 0;
+	bool		pass = true;
+
+	if (!rf->ready || rf->disabled)
+		return true;
+
+	if (rf->hasrange)
+	{
+		/* single strict key, see ExecHashJoinPushdownRuntimeFilter() */
+		if (isnull[0] || rf->rangeempty)
+			pass = false;
+		else
+		{
+			int64		val = RuntimeFilterDatumGetInt64(values[0], rf->outertype);
+
+			pass = (val >= rf->minval && val <= rf->maxval);
+		}
+	}
+
+	if (pass && rf->bloom)
+	{
+		MemoryContext oldcxt = MemoryContextSwitchTo(rf->tmpcxt);
+
+		/* compute the hash value the same way as ExecHashGetHashValue() */
+		for (int i = 0; i < rf->nkeys; i++)
+		{
+			hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+			if (isnull[i])
+			{
+				if (rf->hashstrict[i])
+				{
+					pass = false;
+					break;
+				}
+				/* else, leave hashkey unmodified, equivalent to hashcode 0 */
+			}
+			else
+				hashkey ^= DatumGetUInt32(FunctionCall1Coll(&rf->hashfunctions[i],
+															rf->collations[i],
+															values[i]));
+		}
+
+		MemoryContextSwitchTo(oldcxt);
+		MemoryContextReset(rf->tmpcxt);
+
+		if (pass)
+			pass = !bloom_lacks_element(rf->bloom, (unsigned char *) &hashkey,
+										sizeof(hashkey));
+	}
+
+	rf->nchecked++;
+	if (!pass)
+		rf->nrejected++;
+	if (rf->nchecked % RUNTIME_FILTER_CHECK_INTERVAL == 0 &&
+		rf->nrejected * RUNTIME_FILTER_MIN_REJECT_FRAC < rf->nchecked)
+		rf->disabled = true;
+
+	return pass;
 }
 
 /* ----------------------------------------------------------------
@@ -535,6 +742,13 @@ ExecHashTableCreate(HashState *state, HashJoinState *hjstate,
 	hashtable->nbatch_original = nbatch;
 	hashtable->nbatch_outstart = nbatch;
 	hashtable->growEnabled = true;
+	hashtable->hybrid = (gp_enable_hybrid_hashjoin &&
+						 state->parallel_state == NULL &&
+						 !hjstate->reuse_hashtable);
+	hashtable->batchResident = NULL;
+	hashtable->batchSpace = NULL;
+	hashtable->batchSplits = NULL;
+	hashtable->nbatch_spilled = 0;
 	hashtable->totalTuples = 0;
 	hashtable->partialTuples = 0;
 	hashtable->skewTuples = 0;
@@ -620,6 +834,14 @@ ExecHashTableCreate(HashState *state, HashJoinState *hjstate,
 		 */
 		hashtable->innerBatchFile = (BufFile **) palloc0(nbatch * sizeof(BufFile *));
 		hashtable->outerBatchFile = (BufFile **) palloc0(nbatch * sizeof(BufFile *));
+
+		/* with hybrid hash join, all batches start out in memory */
+		if (hashtable->hybrid)
+		{
+			hashtable->batchResident = (bool *) palloc(nbatch * sizeof(bool));
+			memset(hashtable->batchResident, true, nbatch * sizeof(bool));
+			hashtable->batchSpace = (Size *) palloc0(nbatch * sizeof(Size));
+		}
 	}
 
 	MemoryContextSwitchTo(oldcxt);
@@ -1020,20 +1242,25 @@ static void
 ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 {
 	int			oldnbatch = hashtable->nbatch;
-	int			curbatch = hashtable->curbatch;
 	int			nbatch;
-	MemoryContext oldcxt;
 	long		ninmemory;
 	long		nfreed;
-	Size		spaceUsedBefore = hashtable->spaceUsed;
-	Size		spaceFreed = 0;
-	HashJoinTableStats *stats = hashtable->stats;
-	HashMemoryChunk oldchunks;
 
 	/* do nothing if we've decided to shut off growth */
 	if (!hashtable->growEnabled)
 		return;
 
+	/*
+	 * With hybrid hash join, dump out some of the other batches that are
+	 * still in memory if we can, else split the current batch.
+	 */
+	if (hashtable->hybrid)
+	{
+		if (!ExecHashDumpResidentBatches(hashtable))
+			ExecHashSplitCurrentBatch(hashtable);
+		return;
+	}
+
 	/* safety check to avoid overflow */
 	if (oldnbatch > Min(INT_MAX / 2, MaxAllocSize / (sizeof(void *) * 2)))
 		return;
@@ -1049,6 +1276,45 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 		   hashtable, nbatch, hashtable->spaceUsed);
 #endif
 
+	ExecHashGrowBatchArrays(hashtable, nbatch);
+	hashtable->nbatch = nbatch;
+
+	/*
+	 * Scan through the existing hash table entries and dump out any that are
+	 * no longer of the current batch.
+	 */
+	nfreed = ExecHashDumpBatches(hashtable, &ninmemory);
+
+	/*
+	 * If we dumped out either all or none of the tuples in the table, disable
+	 * further expansion of nbatch.  This situation implies that we have
+	 * enough tuples of identical hashvalues to overflow spaceAllowed.
+	 * Increasing nbatch will not fix it since there's no way to subdivide the
+	 * group any more finely. We have to just gut it out and hope the server
+	 * has enough RAM.
+	 */
+	if (nfreed == 0 || nfreed == ninmemory)
+	{
+		hashtable->growEnabled = false;
+#ifdef HJDEBUG
+		printf("Hashjoin %p: disabling further increase of nbatch\n",
+			   hashtable);
+#endif
+	}
+
+}
+
+/*
+ * ExecHashGrowBatchArrays
+ *		enlarge the per-batch file and statistics arrays to 'nbatch' entries
+ */
+static void
+ExecHashGrowBatchArrays(HashJoinTable hashtable, int nbatch)
+{
+	int			oldnbatch = hashtable->nbatch;
+	HashJoinTableStats *stats = hashtable->stats;
+	MemoryContext oldcxt;
+
 	oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
 
 	if (hashtable->innerBatchFile == NULL)
@@ -1083,14 +1349,28 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 	}
 
 	MemoryContextSwitchTo(oldcxt);
+}
 
-	hashtable->nbatch = nbatch;
+/*
+ * ExecHashDumpBatches
+ *		rebuild the in-memory hash table after the set of batches kept in
+ *		memory has changed, dumping out the tuples of all other batches to
+ *		their inner batch files
+ *
+ * Returns the number of tuples dumped out; *ninmemory is set to the number
+ * of tuples that were in memory before.
+ */
+static long
+ExecHashDumpBatches(HashJoinTable hashtable, long *ninmemory)
+{
+	int			curbatch = hashtable->curbatch;
+	long		nfreed;
+	Size		spaceUsedBefore = hashtable->spaceUsed;
+	Size		spaceFreed = 0;
+	HashJoinTableStats *stats = hashtable->stats;
+	HashMemoryChunk oldchunks;
 
-	/*
-	 * Scan through the existing hash table entries and dump out any that are
-	 * no longer of the current batch.
-	 */
-	ninmemory = nfreed = 0;
+	*ninmemory = nfreed = 0;
 
 	/* If know we need to resize nbuckets, we can do it while rebatching. */
 	if (hashtable->nbuckets_optimal != hashtable->nbuckets)
@@ -1133,11 +1413,11 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 			int			bucketno;
 			int			batchno;
 
-			ninmemory++;
+			(*ninmemory)++;
 			ExecHashGetBucketAndBatch(hashtable, hashTuple->hashvalue,
 									  &bucketno, &batchno);
 
-			if (batchno == curbatch)
+			if (ExecHashBatchInMemory(hashtable, batchno))
 			{
 				/* keep tuple in memory - copy it into the new chunk */
 				HashJoinTuple copyTuple;
@@ -1182,7 +1462,7 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 
 #ifdef HJDEBUG
 	printf("Hashjoin %p: freed %ld of %ld tuples, space now %zu\n",
-		   hashtable, nfreed, ninmemory, hashtable->spaceUsed);
+		   hashtable, nfreed, *ninmemory, hashtable->spaceUsed);
 #endif
 
 	/* Update work_mem high-water mark and amount spilled. */
@@ -1193,23 +1473,191 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 		stats->batchstats[curbatch].spillrows_out += nfreed;
 	}
 
+	return nfreed;
+}
+
+/*
+ * ExecHashDumpResidentBatches
+ *		hybrid hash join: dump out the largest of the batches that are kept
+ *		in memory alongside batch 0, until the hash table is down to half of
+ *		its allowed space
+ *
+ * Returns false if there were no such batches to dump out, so the caller
+ * must split the current batch instead.
+ */
+static bool
+ExecHashDumpResidentBatches(HashJoinTable hashtable)
+{
+	Size		spaceTarget = hashtable->spaceAllowed / 2;
+	Size		spaceToFree;
+	Size		spaceFreed = 0;
+	bool		othersResident = false;
+	long		ninmemory;
+	int			i;
+
+	/* batches other than batch 0 are only kept in memory in the first pass */
+	if (hashtable->batchResident == NULL || hashtable->curbatch != 0)
+		return false;
+
+	spaceToFree = hashtable->spaceUsed +
+		hashtable->nbuckets_optimal * sizeof(HashJoinTuple);
+	spaceToFree = (spaceToFree > spaceTarget) ? spaceToFree - spaceTarget : 0;
+
+	/* pick the victims, largest first */
+	for (;;)
+	{
+		int			victim = -1;
+
+		for (i = 1; i < hashtable->nbatch_original; i++)
+		{
+			if (hashtable->batchResident[i] &&
+				(victim < 0 ||
+				 hashtable->batchSpace[i] > hashtable->batchSpace[victim]))
+				victim = i;
+		}
+		if (victim < 0)
+			break;
+		if (spaceFreed >= spaceToFree && spaceFreed > 0)
+		{
+			othersResident = true;
+			break;
+		}
+
+#ifdef HJDEBUG
+		printf("Hashjoin %p: dumping out resident batch %d of %zu bytes\n",
+			   hashtable, victim, hashtable->batchSpace[victim]);
+#endif
+		hashtable->batchResident[victim] = false;
+		hashtable->nbatch_spilled++;
+		spaceFreed += hashtable->batchSpace[victim];
+		hashtable->batchSpace[victim] = 0;
+	}
+
 	/*
-	 * If we dumped out either all or none of the tuples in the table, disable
-	 * further expansion of nbatch.  This situation implies that we have
-	 * enough tuples of identical hashvalues to overflow spaceAllowed.
-	 * Increasing nbatch will not fix it since there's no way to subdivide the
-	 * group any more finely. We have to just gut it out and hope the server
-	 * has enough RAM.
+	 * Once batch 0 is the only one left in memory, forget about the others
+	 * for good, so that further growth splits it.
 	 */
-	if (nfreed == 0 || nfreed == ninmemory)
+	if (!othersResident)
 	{
-		hashtable->growEnabled = false;
+		pfree(hashtable->batchResident);
+		pfree(hashtable->batchSpace);
+		hashtable->batchResident = NULL;
+		hashtable->batchSpace = NULL;
+	}
+
+	/* nothing in memory but batch 0 */
+	if (spaceFreed == 0)
+		return false;
+
+	(void) ExecHashDumpBatches(hashtable, &ninmemory);
+
+	return true;
+}
+
+/*
+ * ExecHashSplitCurrentBatch
+ *		hybrid hash join: split the current batch in two, dumping out the
+ *		new half to its inner batch file
+ *
+ * Unlike ExecHashIncreaseNumBatches, this leaves all the other batches
+ * alone, so that a batch that fits in memory is never rewritten just
+ * because some other batch didn't.
+ */
+static void
+ExecHashSplitCurrentBatch(HashJoinTable hashtable)
+{
+	int			curbatch = hashtable->curbatch;
+	int			oldnbatch = hashtable->nbatch;
+	int			nbatch = oldnbatch + 1;
+	int			child;
+	HashBatchSplit *splits;
+	long		ninmemory;
+	long		nfreed;
+	int			i;
+
+	Assert(hashtable->parallel_state == NULL);
+
+	/* safety check to avoid overflow */
+	if (oldnbatch >= Min(INT_MAX / 2, MaxAllocSize / sizeof(HashBatchSplit)))
+		return;
+
+	if (hashtable->batchSplits == NULL)
+	{
+		int			log2_nbatch = my_log2(hashtable->nbatch_original);
+
+		/* first split, set up the tree with the original batches */
+		Assert(oldnbatch == hashtable->nbatch_original);
+		splits = (HashBatchSplit *)
+			MemoryContextAlloc(hashtable->hashCxt,
+							   oldnbatch * sizeof(HashBatchSplit));
+		for (i = 0; i < oldnbatch; i++)
+		{
+			splits[i].firstchild = -1;
+			splits[i].nextsibling = -1;
+			splits[i].splitbit = 0;
+			splits[i].nextbit = log2_nbatch;
+			splits[i].growEnabled = true;
+		}
+		hashtable->batchSplits = splits;
+	}
+	splits = hashtable->batchSplits;
+
+	/*
+	 * We run out of hash bits to split on after 32 levels.  Like with
+	 * ExecHashIncreaseNumBatches, we then just have to gut it out.
+	 */
+	if (!splits[curbatch].growEnabled || splits[curbatch].nextbit >= 32)
+	{
+		splits[curbatch].growEnabled = false;
+		return;
+	}
+
 #ifdef HJDEBUG
-		printf("Hashjoin %p: disabling further increase of nbatch\n",
-			   hashtable);
+	printf("Hashjoin %p: splitting batch %d on bit %d because space = %zu\n",
+		   hashtable, curbatch, splits[curbatch].nextbit, hashtable->spaceUsed);
 #endif
+
+	ExecHashGrowBatchArrays(hashtable, nbatch);
+	splits = (HashBatchSplit *) repalloc(splits,
+										 nbatch * sizeof(HashBatchSplit));
+	hashtable->batchSplits = splits;
+
+	/* the new batch goes last among the current batch's children */
+	child = oldnbatch;
+	splits[child].firstchild = -1;
+	splits[child].nextsibling = -1;
+	splits[child].splitbit = splits[curbatch].nextbit;
+	splits[child].nextbit = splits[curbatch].nextbit + 1;
+	splits[child].growEnabled = true;
+	splits[curbatch].nextbit++;
+
+	if (splits[curbatch].firstchild < 0)
+		splits[curbatch].firstchild = child;
+	else
+	{
+		i = splits[curbatch].firstchild;
+		while (splits[i].nextsibling >= 0)
+			i = splits[i].nextsibling;
+		splits[i].nextsibling = child;
 	}
 
+	hashtable->nbatch = nbatch;
+
+	nfreed = ExecHashDumpBatches(hashtable, &ninmemory);
+
+	/*
+	 * As in ExecHashIncreaseNumBatches, if the split moved all or none of
+	 * the tuples, splitting further won't help.
+	 */
+	if (nfreed == 0 || nfreed == ninmemory)
+	{
+		splits[curbatch].growEnabled = false;
+		splits[child].growEnabled = false;
+#ifdef HJDEBUG
+		printf("Hashjoin %p: disabling further splits of batch %d\n",
+			   hashtable, curbatch);
+#endif
+	}
 }
 
 /*
@@ -1753,8 +2201,8 @@ ExecParallelHashIncreaseNumBuckets(HashJoinTable hashtable)
  * case by not forcing the slot contents into minimal form; not clear if it's
  * worth the messiness required.
  *
- * Returns true if the tuple belonged to this batch and was inserted to
- * the in-memory hash table, or false if it belonged to a later batch and
+ * Returns true if the tuple belonged to a batch in memory and was inserted
+ * to the in-memory hash table, or false if it belonged to a later batch and
  * was pushed to a temp file.
  */
 bool
@@ -1766,6 +2214,7 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 	MinimalTuple tuple = ExecFetchSlotMinimalTuple(slot, &shouldFree);
 	int			bucketno;
 	int			batchno;
+	bool		inmemory;
 	PlanState *ps = &hashState->ps;
 
 	ExecHashGetBucketAndBatch(hashtable, hashvalue,
@@ -1774,7 +2223,8 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 	/*
 	 * decide whether to put the tuple in the hash table or a temp file
 	 */
-	if (batchno == hashtable->curbatch)
+	inmemory = ExecHashBatchInMemory(hashtable, batchno);
+	if (inmemory)
 	{
 		/*
 		 * put the tuple in hash table
@@ -1821,6 +2271,8 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 
 		/* Account for space used, and back off if we've used too much */
 		hashtable->spaceUsed += hashTupleSize;
+		if (hashtable->batchSpace)
+			hashtable->batchSpace[batchno] += hashTupleSize;
 		if (hashtable->spaceUsed > hashtable->spacePeak)
 			hashtable->spacePeak = hashtable->spaceUsed;
 		if (hashtable->spaceUsed +
@@ -1851,7 +2303,7 @@ ExecHashTableInsert(HashState *hashState, HashJoinTable hashtable,
 	if (shouldFree)
 		heap_free_minimal_tuple(tuple);
 
-	return (batchno == hashtable->curbatch);
+	return inmemory;
 }
 
 /*
@@ -2085,6 +2537,11 @@ ExecHashGetHashValue(HashState *hashState, HashJoinTable hashtable,
  * value.  This causes batchno to steal bits from bucketno when the number of
  * virtual buckets exceeds 2^32.  It's better to have longer bucket chains
  * than to lose the ability to divide batches.
+ *
+ * The exception is hybrid hash join, which splits one batch at a time (see
+ * ExecHashSplitCurrentBatch).  Once it has, nbatch_original is the power of
+ * 2 to start from, and we then follow the splits of that batch: a batch
+ * split off the current one claims the tuples that have its split bit set.
  */
 void
 ExecHashGetBucketAndBatch(HashJoinTable hashtable,
@@ -2095,7 +2552,31 @@ ExecHashGetBucketAndBatch(HashJoinTable hashtable,
 	uint32		nbuckets = (uint32) hashtable->nbuckets;
 	uint32		nbatch = (uint32) hashtable->nbatch;
 
-	if (nbatch > 1)
+	if (nbatch > 1 && hashtable->batchSplits != NULL)
+	{
+		HashBatchSplit *splits = hashtable->batchSplits;
+		uint32		rotated = pg_rotate_right32(hashvalue,
+												hashtable->log2_nbuckets);
+		int			batch;
+		int			child;
+
+		batch = rotated & (hashtable->nbatch_original - 1);
+		child = splits[batch].firstchild;
+		while (child >= 0)
+		{
+			if (rotated & ((uint32) 1 << splits[child].splitbit))
+			{
+				batch = child;
+				child = splits[batch].firstchild;
+			}
+			else
+				child = splits[child].nextsibling;
+		}
+
+		*bucketno = hashvalue & (nbuckets - 1);
+		*batchno = batch;
+	}
+	else if (nbatch > 1)
 	{
 		*bucketno = hashvalue & (nbuckets - 1);
 		*batchno = pg_rotate_right32(hashvalue,
@@ -2108,6 +2589,25 @@ ExecHashGetBucketAndBatch(HashJoinTable hashtable,
 	}
 }
 
+/*
+ * ExecHashBatchInMemory
+ *		Is the given batch kept in the in-memory hash table?
+ *
+ * That's normally only the current batch, but hybrid hash join keeps other
+ * batches in memory too during the first pass, until they're dumped out.
+ */
+bool
+ExecHashBatchInMemory(HashJoinTable hashtable, int batchno)
+{
+	if (batchno == hashtable->curbatch)
+		return true;
+
+	return (hashtable->curbatch == 0 &&
+			hashtable->batchResident != NULL &&
+			batchno < hashtable->nbatch_original &&
+			hashtable->batchResident[batchno]);
+}
+
 /*
  * ExecScanHashBucket
  *		scan a hash bucket for matches to the current outer tuple
@@ -3074,7 +3574,7 @@ ExecHashRemoveNextSkewBucket(HashState *hashState, HashJoinTable hashtable)
 		tupleSize = HJTUPLE_OVERHEAD + tuple->t_len;
 
 		/* Decide whether to put the tuple in the hash table or a temp file */
-		if (batchno == hashtable->curbatch)
+		if (ExecHashBatchInMemory(hashtable, batchno))
 		{
 			/* Move the tuple to the main hash table */
 			HashJoinTuple copyTuple;
@@ -3092,6 +3592,8 @@ ExecHashRemoveNextSkewBucket(HashState *hashState, HashJoinTable hashtable)
 
 			/* We have reduced skew space, but overall space doesn't change */
 			hashtable->spaceUsedSkew -= tupleSize;
+			if (hashtable->batchSpace)
+				hashtable->batchSpace[batchno] += tupleSize;
 		}
 		else
 		{
@@ -3250,6 +3752,16 @@ ExecHashGetInstrumentation(HashInstrumentation *instrument,
 	instrument->nbatch = hashtable->nbatch;
 	instrument->nbatch_original = hashtable->nbatch_original;
 	instrument->space_peak = hashtable->spacePeak;
+
+	/* hybrid hash join only ever adds batches by splitting one */
+	instrument->hybrid = hashtable->hybrid;
+	if (hashtable->hybrid)
+	{
+		instrument->nbatch_resident = hashtable->nbatch_original -
+			hashtable->nbatch_spilled;
+		instrument->nbatch_spilled = hashtable->nbatch_spilled;
+		instrument->nbatch_split = hashtable->nbatch - hashtable->nbatch_original;
+	}
 }
 
 /*
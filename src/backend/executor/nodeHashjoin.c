@@ -122,7 +122,12 @@
 
 #include "cdb/cdbvars.h"
 #include "miscadmin.h"			/* work_mem */
+#include "nodes/nodeFuncs.h"
+#include "parser/parsetree.h"
 #include "utils/faultinjector.h"
+#include "utils/fmgroids.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
 
 /*
  * States of the ExecHashJoin state machine
@@ -163,6 +168,7 @@ static void ReleaseHashTable(HashJoinState *node);
 static void SpillCurrentBatch(HashJoinState *node);
 static bool ExecHashJoinReloadHashTable(HashJoinState *hjstate);
 static void ExecEagerFreeHashJoin(HashJoinState *node);
+static void ExecHashJoinPushdownRuntimeFilter(HashJoinState *hjstate);
 
 /* ----------------------------------------------------------------
  *		ExecHashJoinImpl
@@ -486,9 +492,10 @@ ExecHashJoinImpl(PlanState *pstate, bool parallel)
 
 				/*
 				 * The tuple might not belong to the current batch (where
-				 * "current batch" includes the skew buckets if any).
+				 * "current batch" includes the skew buckets if any, and the
+				 * other batches that hybrid hash join kept in memory).
 				 */
-				if (batchno != hashtable->curbatch &&
+				if (!ExecHashBatchInMemory(hashtable, batchno) &&
 					node->hj_CurSkewBucketNo == INVALID_SKEW_BUCKET_NO)
 				{
 					bool		shouldFree;
@@ -955,9 +962,179 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	hjstate->hj_MatchedOuter = false;
 	hjstate->hj_OuterNotEmpty = false;
 
+	if (gp_enable_runtime_filter_pushdown)
+		ExecHashJoinPushdownRuntimeFilter(hjstate);
+
 	return hjstate;
 }
 
+/*
+ * Find the scan that produces output column 'resno' of 'ps', looking through
+ * the outer side of inner and semi joins in the same slice. Returns the scan
+ * and the attribute number of the column in the scanned relation, or NULL.
+ *
+ * Rows of the scan that the runtime filter drops cannot produce any output
+ * from those joins that the hash join above would not drop too.
+ */
+static SeqScanState *
+RuntimeFilterFindScan(PlanState *ps, AttrNumber resno, AttrNumber *scanattno)
+{
+	for (;;)
+	{
+		TargetEntry *tle;
+		Expr	   *expr;
+		Var		   *var;
+
+		tle = get_tle_by_resno(ps->plan->targetlist, resno);
+		if (tle == NULL)
+			return NULL;
+		expr = tle->expr;
+		while (IsA(expr, RelabelType))
+			expr = ((RelabelType *) expr)->arg;
+		if (!IsA(expr, Var))
+			return NULL;
+		var = (Var *) expr;
+
+		if (IsA(ps, SeqScanState))
+		{
+			if (var->varno != ((Scan *) ps->plan)->scanrelid || var->varattno <= 0)
+				return NULL;
+			*scanattno = var->varattno;
+			return (SeqScanState *) ps;
+		}
+
+		if (IsA(ps, HashJoinState) ||
+			IsA(ps, NestLoopState) ||
+			IsA(ps, MergeJoinState))
+		{
+			JoinType	jointype = ((Join *) ps->plan)->jointype;
+
+			if ((jointype != JOIN_INNER && jointype != JOIN_SEMI) ||
+				var->varno != OUTER_VAR)
+				return NULL;
+			ps = outerPlanState(ps);
+			resno = var->varattno;
+			continue;
+		}
+
+		return NULL;
+	}
+}
+
+/*
+ * GPDB: Push a runtime filter down from the hash join to the scan that
+ * produces all of its outer hash keys, if there is one in this slice. While
+ * the hash table is built, the Hash node fills in the filter, and the scan
+ * then drops the rows that cannot find a join partner, before they go
+ * through the rest of the plan. See ExecRuntimeFilterCheck().
+ *
+ * A scan below a Motion runs in a different process; that's out of reach.
+ * But when the inner side is broadcast, the outer side usually isn't moved
+ * at all, which is the common plan for a small dimension table joined with
+ * a large fact table.
+ */
+static void
+ExecHashJoinPushdownRuntimeFilter(HashJoinState *hjstate)
+{
+	HashJoin   *node = (HashJoin *) hjstate->js.ps.plan;
+	HashState  *hashstate = castNode(HashState, innerPlanState(hjstate));
+	Hash	   *hash = (Hash *) hashstate->ps.plan;
+	int			nkeys = list_length(node->hashkeys);
+	SeqScanState *scan = NULL;
+	AttrNumber *scanattnos;
+	RuntimeFilter *rf;
+	ListCell   *lc;
+	ListCell   *lc2;
+	int			i;
+
+	/* only joins that drop the outer rows without a partner */
+	if (node->join.jointype != JOIN_INNER &&
+		node->join.jointype != JOIN_SEMI &&
+		node->join.jointype != JOIN_RIGHT)
+		return;
+	if (nkeys == 0 || hash->plan.parallel_aware)
+		return;
+
+	scanattnos = palloc(nkeys * sizeof(AttrNumber));
+	i = 0;
+	foreach(lc, node->hashkeys)
+	{
+		Expr	   *expr = (Expr *) lfirst(lc);
+		SeqScanState *keyscan;
+
+		while (IsA(expr, RelabelType))
+			expr = ((RelabelType *) expr)->arg;
+		if (!IsA(expr, Var) || ((Var *) expr)->varno != OUTER_VAR)
+			return;
+
+		keyscan = RuntimeFilterFindScan(outerPlanState(hjstate),
+										((Var *) expr)->varattno,
+										&scanattnos[i]);
+		if (keyscan == NULL || (scan != NULL && keyscan != scan))
+			return;
+		scan = keyscan;
+		i++;
+	}
+
+	rf = palloc0(sizeof(RuntimeFilter));
+	rf->nkeys = nkeys;
+	rf->scanattnos = scanattnos;
+	rf->hashfunctions = palloc(nkeys * sizeof(FmgrInfo));
+	rf->collations = palloc(nkeys * sizeof(Oid));
+	rf->hashstrict = palloc(nkeys * sizeof(bool));
+	i = 0;
+	forboth(lc, node->hashoperators, lc2, node->hashcollations)
+	{
+		Oid			hashop = lfirst_oid(lc);
+		Oid			left_hashfn;
+		Oid			right_hashfn;
+
+		if (!get_op_hash_functions(hashop, &left_hashfn, &right_hashfn))
+			elog(ERROR, "could not find hash function for hash operator %u",
+				 hashop);
+		fmgr_info(left_hashfn, &rf->hashfunctions[i]);
+		rf->collations[i] = lfirst_oid(lc2);
+		rf->hashstrict[i] = op_strict(hashop);
+		i++;
+	}
+
+	/*
+	 * For a single integer key, also keep track of the range of the inner
+	 * values. It's cheap to check, and effective against keys that correlate
+	 * with the scan order, like dates.
+	 */
+	if (nkeys == 1)
+	{
+		switch (get_opcode(linitial_oid(node->hashoperators)))
+		{
+			case F_INT2EQ:
+			case F_INT4EQ:
+			case F_INT8EQ:
+			case F_INT24EQ:
+			case F_INT42EQ:
+			case F_INT28EQ:
+			case F_INT82EQ:
+			case F_INT48EQ:
+			case F_INT84EQ:
+			case F_DATE_EQ:
+				rf->hasrange = true;
+				rf->outertype = getBaseType(exprType(linitial(node->hashkeys)));
+				rf->innertype = getBaseType(exprType(linitial(hash->hashkeys)));
+				break;
+			default:
+				break;
+		}
+	}
+
+	rf->bloom_elems = Max(hash->plan.plan_rows, 1.0);
+	rf->tmpcxt = AllocSetContextCreate(CurrentMemoryContext,
+									   "RuntimeFilter",
+									   ALLOCSET_SMALL_SIZES);
+
+	hashstate->runtime_filter = rf;
+	scan->runtime_filters = lappend(scan->runtime_filters, rf);
+}
+
 /* ----------------------------------------------------------------
  *		ExecEndHashJoin
  *
@@ -1695,6 +1872,20 @@ ExecReScanHashJoin(HashJoinState *node)
 				ExecReScan(node->js.ps.righttree);
 	}
 
+	/*
+	 * GPDB: If the hash table is to be built again, the runtime filter
+	 * describes the old one. The outer side may be read before the new hash
+	 * table is complete, see HJ_BUILD_HASHTABLE, so let every row through
+	 * until then.
+	 */
+	if (node->hj_JoinState == HJ_BUILD_HASHTABLE)
+	{
+		HashState  *hashNode = castNode(HashState, innerPlanState(node));
+
+		if (hashNode->runtime_filter)
+			hashNode->runtime_filter->ready = false;
+	}
+
 	/* Always reset intra-tuple state */
 	node->hj_CurHashValue = 0;
 	node->hj_CurBucketNo = 0;
@@ -57,6 +57,9 @@ static uint32 evalHashKey(ExprContext *econtext, List *hashkeys, CdbHash *h);
 
 static void doSendEndOfStream(Motion *motion, MotionState *node);
 static void doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot);
+static void doSendTupleToRoute(Motion *motion, MotionState *node,
+							   TupleTableSlot *outerTupleSlot, int16 targetRoute);
+static void doSendTupleBatch(Motion *motion, MotionState *node);
 
 
 /*=========================================================================
@@ -247,7 +250,12 @@ execMotionSender(MotionState *node)
 
 		if (done || TupIsNull(outerTupleSlot))
 		{
-			doSendEndOfStream(motion, node);
+			/* Send the tuples still waiting to be hashed first */
+			if (node->sendBatchCount > 0)
+				doSendTupleBatch(motion, node);
+
+			if (!node->stopRequested)
+				doSendEndOfStream(motion, node);
 			done = true;
 		}
 		else if (motion->motionType == MOTIONTYPE_GATHER_SINGLE &&
@@ -261,7 +269,22 @@ execMotionSender(MotionState *node)
 		}
 		else
 		{
-			doSendTuple(motion, node, outerTupleSlot);
+			if (node->sendBatchSize > 0)
+			{
+				/*
+				 * Buffer the tuple, and send the batch once it is full. The
+				 * child reuses its slot, so the tuple has to be copied. Only
+				 * an on-page heap tuple is not: the buffer slot references it
+				 * and takes another pin on its buffer.
+				 */
+				node->numTuplesFromChild++;
+				ExecCopySlot(node->sendBatchSlots[node->sendBatchCount++],
+							 outerTupleSlot);
+				if (node->sendBatchCount == node->sendBatchSize)
+					doSendTupleBatch(motion, node);
+			}
+			else
+				doSendTuple(motion, node, outerTupleSlot);
 			/* doSendTuple() may have set node->stopRequested as a side-effect */
 
 			if (node->stopRequested)
@@ -698,6 +721,8 @@ ExecInitMotion(Motion *node, EState *estate, int eflags)
 	motionstate->stopRequested = false;
 	motionstate->hashExprs = NIL;
 	motionstate->cdbhash = NULL;
+	motionstate->sendBatchSize = 0;
+	motionstate->sendBatchCount = 0;
 
 	/* Look up the sending and receiving gang's slice table entries. */
 	sendSlice = &sliceTable->slices[node->motionID];
@@ -820,6 +845,30 @@ ExecInitMotion(Motion *node, EState *estate, int eflags)
 		motionstate->cdbhash = makeCdbHash(motionstate->numHashSegments,
 										   nkeys,
 										   node->hashFuncs);
+
+		/*
+		 * Buffer tuples from the child, so that their keys can be hashed in
+		 * batches. The buffer slots have the same type as the child's result
+		 * slot, which the compiled hash expressions may rely on, and which
+		 * lets ExecCopySlot() pin heap buffers instead of copying tuples.
+		 */
+		if (nkeys > 0 && gp_motion_hash_batch_size > 1)
+		{
+			int			batchSize = gp_motion_hash_batch_size;
+			const TupleTableSlotOps *outerOps;
+
+			outerOps = ExecGetResultSlotOps(outerPlan, NULL);
+
+			motionstate->sendBatchSize = batchSize;
+			motionstate->sendBatchSlots = palloc(batchSize * sizeof(TupleTableSlot *));
+			for (int i = 0; i < batchSize; i++)
+				motionstate->sendBatchSlots[i] =
+					ExecInitExtraTupleSlot(estate, ExecGetResultType(outerPlan),
+										   outerOps);
+			motionstate->sendBatchKeys = palloc(batchSize * sizeof(Datum));
+			motionstate->sendBatchKeyNulls = palloc(batchSize * sizeof(bool));
+			motionstate->sendBatchHashes = palloc(batchSize * sizeof(uint32));
+		}
 	}
 
 	/*
@@ -1148,7 +1197,6 @@ void
 doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot)
 {
 	int16		targetRoute;
-	SendReturnCode sendRC;
 	ExprContext *econtext = node->ps.ps_ExprContext;
 
 	/* We got a tuple from the child-plan. */
@@ -1214,6 +1262,18 @@ doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot)
 	else
 		elog(ERROR, "unknown motion type %d", motion->motionType);
 
+	doSendTupleToRoute(motion, node, outerTupleSlot, targetRoute);
+}
+
+/*
+ * Send a tuple, whose route has been chosen, to the AMS.
+ */
+static void
+doSendTupleToRoute(Motion *motion, MotionState *node,
+				   TupleTableSlot *outerTupleSlot, int16 targetRoute)
+{
+	SendReturnCode sendRC;
+
 	CheckAndSendRecordCache(node->ps.state->motionlayer_context,
 							node->ps.state->interconnect_context,
 							motion->motionID,
@@ -1249,6 +1309,69 @@ doSendTuple(Motion *motion, MotionState *node, TupleTableSlot *outerTupleSlot)
 #endif
 }
 
+/*
+ * Hash the tuples buffered in a redistribute motion, and send them out.
+ *
+ * The hash keys are evaluated one key at a time over all the tuples, and
+ * each key is then hashed with cdbhashbatch().
+ */
+static void
+doSendTupleBatch(Motion *motion, MotionState *node)
+{
+	ExprContext *econtext = node->ps.ps_ExprContext;
+	CdbHash    *h = node->cdbhash;
+	int			nrows = node->sendBatchCount;
+	MemoryContext oldContext;
+	ListCell   *hk;
+	int			i;
+
+	Assert(motion->motionType == MOTIONTYPE_HASH);
+	Assert(nrows > 0);
+
+	/* The key values must all stay valid until they are hashed */
+	ResetExprContext(econtext);
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	cdbhashinitbatch(h, node->sendBatchHashes, nrows);
+
+	i = 0;
+	foreach(hk, node->hashExprs)
+	{
+		ExprState  *keyexpr = (ExprState *) lfirst(hk);
+
+		for (int r = 0; r < nrows; r++)
+		{
+			econtext->ecxt_outertuple = node->sendBatchSlots[r];
+			node->sendBatchKeys[r] = ExecEvalExpr(keyexpr, econtext,
+												  &node->sendBatchKeyNulls[r]);
+		}
+
+		cdbhashbatch(h, i + 1, node->sendBatchKeys, node->sendBatchKeyNulls,
+					 nrows, node->sendBatchHashes);
+		i++;
+	}
+
+	cdbhashreducebatch(h, node->sendBatchHashes, nrows);
+
+	MemoryContextSwitchTo(oldContext);
+
+	node->sendBatchCount = 0;
+
+	for (int r = 0; r < nrows && !node->stopRequested; r++)
+	{
+		int16		targetRoute = node->sendBatchHashes[r];
+
+		Assert(node->sendBatchHashes[r] < node->numHashSegments &&
+			   "redistribute destination outside segment array");
+		Assert(targetRoute != BROADCAST_SEGIDX);
+
+		doSendTupleToRoute(motion, node, node->sendBatchSlots[r], targetRoute);
+	}
+
+	for (int r = 0; r < nrows; r++)
+		ExecClearTuple(node->sendBatchSlots[r]);
+}
+
 
 /*
  * ExecReScanMotion
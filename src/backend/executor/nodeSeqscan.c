@@ -16,6 +16,7 @@
  * INTERFACE ROUTINES
  *		ExecSeqScan				sequentially scans a relation.
  *		ExecSeqNext				retrieve next tuple in sequential order.
+ *		ExecSeqScanBatch		sequentially scans a relation a batch at a time.
  *		ExecInitSeqScan			creates and initializes a seqscan node.
  *		ExecEndSeqScan			releases any storage allocated.
  *		ExecReScanSeqScan		rescans the relation
@@ -29,12 +30,37 @@
 
 #include "access/relscan.h"
 #include "access/tableam.h"
+#include "catalog/objectaccess.h"
 #include "executor/execdebug.h"
+#include "executor/nodeHash.h"
 #include "executor/nodeSeqscan.h"
+#include "miscadmin.h"
+#include "utils/acl.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
 #include "utils/rel.h"
 #include "nodes/nodeFuncs.h"
 
+/* Number of rows requested from the table AM per batch */
+#define SEQSCAN_BATCH_SIZE		1024
+
+/*
+ * GPDB: A qual of the form "Var op Const" that the batch scan path evaluates
+ * over the column arrays of a batch, before any tuple is formed.
+ */
+typedef struct SeqScanBatchQual
+{
+	int			attidx;			/* 0-based attribute number of the Var */
+	int			varargno;		/* operator argument the Var is passed as */
+	FmgrInfo	flinfo;
+	FunctionCallInfo fcinfo;	/* with the Const argument filled in */
+} SeqScanBatchQual;
+
 static TupleTableSlot *SeqNext(SeqScanState *node);
+static bool SeqRuntimeFiltersPass(SeqScanState *node, TupleTableSlot *slot);
+static void SeqBatchRuntimeFilterEval(RuntimeFilter *rf, TableScanBatch batch);
+static bool SeqNextBatch(SeqScanState *node);
+static void ExecInitSeqScanBatch(SeqScanState *node, List *qual);
 
 /* ----------------------------------------------------------------
  *						Scan Support
@@ -84,13 +110,275 @@ SeqNext(SeqScanState *node)
 	}
 
 	/*
-	 * get the next tuple from the table
+	 * get the next tuple from the table, skipping the ones that the runtime
+	 * filters of the joins above reject
 	 */
-	if (table_scan_getnextslot(scandesc, direction, slot))
-		return slot;
+	while (table_scan_getnextslot(scandesc, direction, slot))
+	{
+		if (node->runtime_filters == NIL || SeqRuntimeFiltersPass(node, slot))
+			return slot;
+
+		node->rf_nfiltered += 1;
+		CHECK_FOR_INTERRUPTS();
+	}
 	return NULL;
 }
 
+/*
+ * SeqRuntimeFiltersPass -- check a tuple against the runtime filters
+ */
+static bool
+SeqRuntimeFiltersPass(SeqScanState *node, TupleTableSlot *slot)
+{
+	ListCell   *lc;
+
+	foreach(lc, node->runtime_filters)
+	{
+		RuntimeFilter *rf = (RuntimeFilter *) lfirst(lc);
+		Datum		values[INDEX_MAX_KEYS];
+		bool		isnull[INDEX_MAX_KEYS];
+
+		if (!rf->ready || rf->disabled || rf->nkeys > INDEX_MAX_KEYS)
+			continue;
+
+		for (int i = 0; i < rf->nkeys; i++)
+			values[i] = slot_getattr(slot, rf->scanattnos[i], &isnull[i]);
+
+		if (!ExecRuntimeFilterCheck(rf, values, isnull))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * SeqBatchRuntimeFilterEval -- remove the rows that a runtime filter rejects
+ * from the batch's selection.
+ */
+static void
+SeqBatchRuntimeFilterEval(RuntimeFilter *rf, TableScanBatch batch)
+{
+	Datum		values[INDEX_MAX_KEYS];
+	bool		isnull[INDEX_MAX_KEYS];
+	int			nselected = 0;
+
+	if (!rf->ready || rf->disabled || rf->nkeys > INDEX_MAX_KEYS)
+		return;
+
+	/* the key columns are in the target list, so the AM fetches them */
+	for (int i = 0; i < rf->nkeys; i++)
+	{
+		if (batch->values[rf->scanattnos[i] - 1] == NULL)
+			return;
+	}
+
+	for (int j = 0; j < batch->nselected; j++)
+	{
+		int			row = batch->selected[j];
+
+		for (int i = 0; i < rf->nkeys; i++)
+		{
+			int			attidx = rf->scanattnos[i] - 1;
+
+			values[i] = batch->values[attidx][row];
+			isnull[i] = batch->isnull[attidx][row];
+		}
+
+		if (ExecRuntimeFilterCheck(rf, values, isnull))
+			batch->selected[nselected++] = row;
+	}
+
+	batch->nselected = nselected;
+}
+
+/*
+ * SeqBatchQualInit -- set up a qual to be evaluated over batches, if it is
+ * simple enough.
+ */
+static bool
+SeqBatchQualInit(SeqScanBatchQual *bq, Expr *clause, Index scanrelid)
+{
+	OpExpr	   *op;
+	Expr	   *leftop;
+	Expr	   *rightop;
+	Var		   *var;
+	Const	   *con;
+	int			varargno;
+
+	if (!IsA(clause, OpExpr))
+		return false;
+	op = (OpExpr *) clause;
+	if (list_length(op->args) != 2 || op->opretset)
+		return false;
+
+	leftop = linitial(op->args);
+	rightop = lsecond(op->args);
+	if (IsA(leftop, Var) && IsA(rightop, Const))
+	{
+		var = (Var *) leftop;
+		con = (Const *) rightop;
+		varargno = 0;
+	}
+	else if (IsA(leftop, Const) && IsA(rightop, Var))
+	{
+		var = (Var *) rightop;
+		con = (Const *) leftop;
+		varargno = 1;
+	}
+	else
+		return false;
+
+	if (var->varno != scanrelid || var->varlevelsup != 0 ||
+		var->varattno <= 0 || con->constisnull)
+		return false;
+
+	/*
+	 * The batch quals are evaluated ahead of the others, in a different order
+	 * than ExecQual() would use. Only accept operators that cannot throw
+	 * errors, which leakproof functions promise not to do.
+	 */
+	set_opfuncid(op);
+	if (!func_strict(op->opfuncid) || !get_func_leakproof(op->opfuncid))
+		return false;
+	if (pg_proc_aclcheck(op->opfuncid, GetUserId(), ACL_EXECUTE) != ACLCHECK_OK)
+		return false;
+	InvokeFunctionExecuteHook(op->opfuncid);
+
+	fmgr_info(op->opfuncid, &bq->flinfo);
+	fmgr_info_set_expr((Node *) clause, &bq->flinfo);
+	bq->fcinfo = palloc0(SizeForFunctionCallInfo(2));
+	InitFunctionCallInfoData(*bq->fcinfo, &bq->flinfo, 2,
+							 op->inputcollid, NULL, NULL);
+	bq->fcinfo->args[1 - varargno].value = con->constvalue;
+	bq->fcinfo->args[1 - varargno].isnull = false;
+	bq->fcinfo->args[varargno].isnull = false;
+	bq->attidx = var->varattno - 1;
+	bq->varargno = varargno;
+
+	return true;
+}
+
+/*
+ * SeqBatchQualEval -- remove the rows that fail 'bq' from the batch's
+ * selection.
+ */
+static void
+SeqBatchQualEval(SeqScanBatchQual *bq, TableScanBatch batch)
+{
+	Datum	   *values = batch->values[bq->attidx];
+	bool	   *isnull = batch->isnull[bq->attidx];
+	FunctionCallInfo fcinfo = bq->fcinfo;
+	int			nselected = 0;
+
+	for (int i = 0; i < batch->nselected; i++)
+	{
+		int			row = batch->selected[i];
+		Datum		result;
+
+		/* The operator is strict, so NULL never passes */
+		if (isnull[row])
+			continue;
+
+		fcinfo->args[bq->varargno].value = values[row];
+		fcinfo->isnull = false;
+		result = FunctionCallInvoke(fcinfo);
+		if (!fcinfo->isnull && DatumGetBool(result))
+			batch->selected[nselected++] = row;
+	}
+
+	batch->nselected = nselected;
+}
+
+/* ----------------------------------------------------------------
+ *		SeqNextBatch
+ *
+ *		Fetch the next batch from the table AM, and evaluate the
+ *		batch quals over it. Returns false at the end of the scan.
+ * ----------------------------------------------------------------
+ */
+static bool
+SeqNextBatch(SeqScanState *node)
+{
+	TableScanDesc scandesc = node->ss.ss_currentScanDesc;
+	EState	   *estate = node->ss.ps.state;
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	TableScanBatch batch = node->batch;
+
+	if (scandesc == NULL)
+	{
+		/* See SeqNext() */
+		scandesc = table_beginscan_es(node->ss.ss_currentRelation,
+									  estate->es_snapshot,
+									  node->ss.ps.plan->targetlist,
+									  node->ss.ps.plan->qual,
+									  NULL,
+									  NULL);
+		node->ss.ss_currentScanDesc = scandesc;
+	}
+
+	node->batchpos = 0;
+	while (table_scan_getnextbatch(scandesc, estate->es_direction, batch))
+	{
+		int			nselected = batch->nselected;
+
+		/*
+		 * Remember which attributes the AM fetches, to copy only those into
+		 * the scan slot.
+		 */
+		if (node->batchatts == NULL)
+		{
+			node->batchatts = palloc(batch->tupdesc->natts * sizeof(int));
+			for (int i = 0; i < batch->tupdesc->natts; i++)
+			{
+				if (batch->values[i] != NULL)
+					node->batchatts[node->nbatchatts++] = i;
+			}
+
+			for (int q = 0; q < node->nbatchquals; q++)
+			{
+				if (batch->values[node->batchquals[q].attidx] == NULL)
+					elog(ERROR, "batch scan of relation \"%s\" did not fetch attribute %d",
+						 RelationGetRelationName(node->ss.ss_currentRelation),
+						 node->batchquals[q].attidx + 1);
+			}
+		}
+
+		if (node->nbatchquals > 0)
+		{
+			MemoryContext oldcontext;
+
+			oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+			for (int q = 0; q < node->nbatchquals && batch->nselected > 0; q++)
+				SeqBatchQualEval(&node->batchquals[q], batch);
+			MemoryContextSwitchTo(oldcontext);
+			ResetExprContext(econtext);
+		}
+
+		InstrCountFiltered1(node, nselected - batch->nselected);
+
+		if (node->runtime_filters != NIL)
+		{
+			ListCell   *lc;
+
+			nselected = batch->nselected;
+			foreach(lc, node->runtime_filters)
+			{
+				if (batch->nselected == 0)
+					break;
+				SeqBatchRuntimeFilterEval((RuntimeFilter *) lfirst(lc), batch);
+			}
+			node->rf_nfiltered += nselected - batch->nselected;
+		}
+
+		if (batch->nselected > 0)
+			return true;
+
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	return false;
+}
+
 /*
  * SeqRecheck -- access method routine to recheck a tuple in EvalPlanQual
  */
@@ -123,6 +411,79 @@ ExecSeqScan(PlanState *pstate)
 					(ExecScanRecheckMtd) SeqRecheck);
 }
 
+/* ----------------------------------------------------------------
+ *		ExecSeqScanBatch(node)
+ *
+ *		Like ExecSeqScan, but fetches the tuples from the table AM
+ *		a batch at a time, see TableScanBatchData. The quals that
+ *		were not evaluated over the batch are checked here, one
+ *		tuple at a time, as ExecScan() does.
+ * ----------------------------------------------------------------
+ */
+static TupleTableSlot *
+ExecSeqScanBatch(PlanState *pstate)
+{
+	SeqScanState *node = castNode(SeqScanState, pstate);
+	TableScanBatch batch = node->batch;
+	ExprState  *qual = node->ss.ps.qual;
+	ProjectionInfo *projInfo = node->ss.ps.ps_ProjInfo;
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
+	Oid			tableOid = RelationGetRelid(node->ss.ss_currentRelation);
+
+	ResetExprContext(econtext);
+
+	for (;;)
+	{
+		int			row;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (QueryFinishPending)
+			return NULL;
+
+		if (node->batchpos >= batch->nselected)
+		{
+			if (!SeqNextBatch(node))
+			{
+				ExecClearTuple(slot);
+				if (projInfo)
+					return ExecClearTuple(projInfo->pi_state.resultslot);
+				else
+					return slot;
+			}
+		}
+
+		row = batch->selected[node->batchpos++];
+
+		ExecClearTuple(slot);
+		for (int i = 0; i < node->nbatchatts; i++)
+		{
+			int			attidx = node->batchatts[i];
+
+			slot->tts_values[attidx] = batch->values[attidx][row];
+			slot->tts_isnull[attidx] = batch->isnull[attidx][row];
+		}
+		slot->tts_tid = batch->tids[row];
+		slot->tts_tableOid = tableOid;
+		ExecStoreVirtualTuple(slot);
+
+		econtext->ecxt_scantuple = slot;
+
+		if (qual == NULL || ExecQual(qual, econtext))
+		{
+			if (projInfo)
+				return ExecProject(projInfo);
+			else
+				return slot;
+		}
+		else
+			InstrCountFiltered1(node, 1);
+
+		ResetExprContext(econtext);
+	}
+}
+
 /* ----------------------------------------------------------------
  *		ExecInitSeqScan
  * ----------------------------------------------------------------
@@ -186,14 +547,64 @@ ExecInitSeqScanForPartition(SeqScan *node, EState *estate,
 	ExecAssignScanProjectionInfo(&scanstate->ss);
 
 	/*
-	 * initialize child expressions
+	 * GPDB: Fetch a batch of tuples at a time if the table AM supports it.
+	 * EvalPlanQual rechecks substitute single tuples, so they always take
+	 * the tuple at a time path.
 	 */
-	scanstate->ss.ps.qual =
-		ExecInitQual(node->plan.qual, (PlanState *) scanstate);
+	if (gp_enable_aocs_batch_scan &&
+		table_scan_supports_batch(currentRelation) &&
+		estate->es_epq_active == NULL)
+	{
+		ExecInitSeqScanBatch(scanstate, node->plan.qual);
+		scanstate->ss.ps.ExecProcNode = ExecSeqScanBatch;
+	}
+	else
+	{
+		/*
+		 * initialize child expressions
+		 */
+		scanstate->ss.ps.qual =
+			ExecInitQual(node->plan.qual, (PlanState *) scanstate);
+	}
 
 	return scanstate;
 }
 
+/*
+ * ExecInitSeqScanBatch -- set up the batch scan path
+ *
+ * The simple quals are evaluated over the batches; ps.qual only holds the
+ * remaining ones.
+ */
+static void
+ExecInitSeqScanBatch(SeqScanState *node, List *qual)
+{
+	Index		scanrelid = ((Scan *) node->ss.ps.plan)->scanrelid;
+	TupleTableSlot *slot = node->ss.ss_ScanTupleSlot;
+	List	   *residual = NIL;
+	ListCell   *lc;
+
+	node->batch = table_scan_batch_create(slot->tts_tupleDescriptor,
+										  SEQSCAN_BATCH_SIZE);
+	node->batchpos = 0;
+	node->nbatchatts = 0;
+	node->batchatts = NULL;
+
+	node->nbatchquals = 0;
+	node->batchquals = palloc(Max(list_length(qual), 1) * sizeof(SeqScanBatchQual));
+	foreach(lc, qual)
+	{
+		Expr	   *clause = (Expr *) lfirst(lc);
+
+		if (SeqBatchQualInit(&node->batchquals[node->nbatchquals], clause, scanrelid))
+			node->nbatchquals++;
+		else
+			residual = lappend(residual, clause);
+	}
+
+	node->ss.ps.qual = ExecInitQual(residual, (PlanState *) node);
+}
+
 /* ----------------------------------------------------------------
  *		ExecEndSeqScan
  *
@@ -227,6 +638,10 @@ ExecEndSeqScan(SeqScanState *node)
 	 */
 	if (scanDesc != NULL)
 		table_endscan(scanDesc);
+
+	if (node->batch)
+		table_scan_batch_free(node->batch);
+	node->batch = NULL;
 }
 
 /* ----------------------------------------------------------------
@@ -251,6 +666,13 @@ ExecReScanSeqScan(SeqScanState *node)
 		table_rescan(scan,		/* scan desc */
 					 NULL);		/* new scan keys */
 
+	if (node->batch)
+	{
+		node->batch->nrows = 0;
+		node->batch->nselected = 0;
+		node->batchpos = 0;
+	}
+
 	ExecScanReScan((ScanState *) node);
 }
 
@@ -43,7 +43,7 @@ extern MemoryContext MessageContext;
 //---------------------------------------------------------------------------
 PlannedStmt *
 CGPOptimizer::GPOPTOptimizedPlan(
-	Query *query,
+	Query *query, bool is_parallel_cursor,
 	bool *
 		had_unexpected_failure	// output : set to true if optimizer unexpectedly failed to produce plan
 )
@@ -52,6 +52,7 @@ CGPOptimizer::GPOPTOptimizedPlan(
 	PlannedStmt *plStmt = nullptr;
 
 	*had_unexpected_failure = false;
+	gpopt_context.m_is_parallel_cursor = is_parallel_cursor;
 
 	GPOS_TRY
 	{
@@ -229,9 +230,11 @@ CGPOptimizer::TerminateGPOPT()
 //---------------------------------------------------------------------------
 extern "C" {
 PlannedStmt *
-GPOPTOptimizedPlan(Query *query, bool *had_unexpected_failure)
+GPOPTOptimizedPlan(Query *query, bool is_parallel_cursor,
+				   bool *had_unexpected_failure)
 {
-	return CGPOptimizer::GPOPTOptimizedPlan(query, had_unexpected_failure);
+	return CGPOptimizer::GPOPTOptimizedPlan(query, is_parallel_cursor,
+											had_unexpected_failure);
 }
 }
 
@@ -34,6 +34,7 @@
 #include "catalog/pg_collation.h"
 extern "C" {
 #include "access/external.h"
+#include "catalog/partition.h"
 #include "catalog/pg_inherits.h"
 #include "foreign/fdwapi.h"
 #include "nodes/nodeFuncs.h"
@@ -44,6 +45,7 @@ extern "C" {
 #include "partitioning/partdesc.h"
 #include "storage/lmgr.h"
 #include "utils/fmgroids.h"
+#include "utils/guc.h"
 #include "utils/memutils.h"
 #include "utils/partcache.h"
 }
@@ -2261,16 +2263,24 @@ gpdb::InjectFaultInOptTasks(const char *fault_name)
 #endif
 
 /*
- * To detect changes to catalog tables that require resetting the Metadata
- * Cache, we use the normal PostgreSQL catalog cache invalidation mechanism.
- * We register a callback to a cache on all the catalog tables that contain
+ * To detect changes to catalog tables that affect the Metadata Cache, we
+ * use the normal PostgreSQL catalog cache invalidation mechanism. We
+ * register a callback to a cache on all the catalog tables that contain
  * information that's contained in the ORCA metadata cache.
-
- * There is no fine-grained mechanism in the metadata cache for invalidating
- * individual entries ATM, so we just blow the whole cache whenever anything
- * changes. The callback simply increments a counter. Whenever we start
- * planning a query, we check the counter to see if it has changed since the
- * last planned query, and reset the whole cache if it has.
+ *
+ * The callbacks remember which relations, and which catalog cache entries
+ * (by hash value), were invalidated. Whenever we start planning a query,
+ * MDCacheNeedsReset() hands the invalidations seen since the last planned
+ * query over to the MDCache*Invalidated() functions, which COptTasks uses
+ * to evict only the affected metadata objects. A change to a partition also
+ * invalidates the objects of its ancestors, whose metadata and statistics
+ * cover their partitions.
+ *
+ * We still blow the whole cache when we cannot tell what was invalidated:
+ * on invalidation of the whole relcache or of a whole catalog cache, on
+ * changes to operator families (which reach the cached types and operators
+ * in too many ways), and when more invalidations than we care to remember
+ * pile up between two queries.
  *
  * To make sure we've covered all catalog tables that contain information
  * that's stored in the metadata cache, there are "catalog tables: xxx"
@@ -2279,21 +2289,130 @@ gpdb::InjectFaultInOptTasks(const char *fault_name)
  * anything fetched via the wrapper functions in this file can end up in the
  * metadata cache and hence need to have an invalidation callback registered.
  */
-static bool mdcache_invalidation_counter_registered = false;
-static int64 mdcache_invalidation_counter = 0;
-static int64 last_mdcache_invalidation_counter = 0;
+#define MDCACHE_MAX_INVALIDATIONS 256
+
+typedef struct MDCacheSyscacheInval
+{
+	int			cacheid;
+	uint32		hashvalue;
+} MDCacheSyscacheInval;
+
+typedef struct MDCacheInvalidations
+{
+	bool		reset;
+	int			num_relids;
+	Oid			relids[MDCACHE_MAX_INVALIDATIONS];
+	int			num_syscache;
+	MDCacheSyscacheInval syscache[MDCACHE_MAX_INVALIDATIONS];
+} MDCacheInvalidations;
+
+static bool mdcache_invalidation_callbacks_registered = false;
+
+/* invalidations received since the last call to MDCacheNeedsReset() */
+static MDCacheInvalidations mdcache_pending_invals;
+
+/*
+ * invalidations handed over by the last call to MDCacheNeedsReset(); relids
+ * are sorted, and include the partition ancestors of the invalidated ones
+ */
+static MDCacheInvalidations mdcache_invals;
+
+/*
+ * False from the time MDCacheNeedsReset() takes the pending invalidations
+ * until MDCacheInvalidationsProcessed() says that the metadata cache has
+ * been evicted or reset accordingly. If we error out in between, the
+ * invalidations are lost, and the next call resets the whole cache.
+ */
+static bool mdcache_invals_valid = true;
+
+/* relations whose statistics were checked against mdcache_invals */
+static int mdcache_num_stats_checked = 0;
+static Oid mdcache_stats_checked_relids[MDCACHE_MAX_INVALIDATIONS];
+static bool mdcache_stats_checked_result[MDCACHE_MAX_INVALIDATIONS];
 
 static void
-mdsyscache_invalidation_counter_callback(Datum arg, int cacheid,
-										 uint32 hashvalue)
+mdcache_add_invalidated_relid(MDCacheInvalidations *invals, Oid relid)
+{
+	int			i;
+
+	for (i = 0; i < invals->num_relids; i++)
+	{
+		if (invals->relids[i] == relid)
+			return;
+	}
+
+	if (invals->num_relids == MDCACHE_MAX_INVALIDATIONS)
+	{
+		invals->reset = true;
+		return;
+	}
+
+	invals->relids[invals->num_relids++] = relid;
+}
+
+/*
+ * Was the catalog cache entry with the given hash value invalidated? A zero
+ * hash value asks about any entry.
+ */
+static bool
+mdcache_syscache_invalidated(int cacheid, uint32 hashvalue)
 {
-	mdcache_invalidation_counter++;
+	int			i;
+
+	for (i = 0; i < mdcache_invals.num_syscache; i++)
+	{
+		if (mdcache_invals.syscache[i].cacheid == cacheid &&
+			(hashvalue == 0 || mdcache_invals.syscache[i].hashvalue == hashvalue))
+			return true;
+	}
+
+	return false;
 }
 
 static void
-mdrelcache_invalidation_counter_callback(Datum arg, Oid relid)
+mdsyscache_invalidation_callback(Datum arg, int cacheid, uint32 hashvalue)
 {
-	mdcache_invalidation_counter++;
+	MDCacheInvalidations *invals = &mdcache_pending_invals;
+	int			i;
+
+	/* a zero hash value means that the whole catalog cache was flushed */
+	if (hashvalue == 0 || cacheid == AMOPOPID || cacheid == OPFAMILYOID)
+	{
+		invals->reset = true;
+		return;
+	}
+
+	for (i = 0; i < invals->num_syscache; i++)
+	{
+		if (invals->syscache[i].cacheid == cacheid &&
+			invals->syscache[i].hashvalue == hashvalue)
+			return;
+	}
+
+	if (invals->num_syscache == MDCACHE_MAX_INVALIDATIONS)
+	{
+		invals->reset = true;
+		return;
+	}
+
+	invals->syscache[invals->num_syscache].cacheid = cacheid;
+	invals->syscache[invals->num_syscache].hashvalue = hashvalue;
+	invals->num_syscache++;
+}
+
+static void
+mdrelcache_invalidation_callback(Datum arg, Oid relid)
+{
+	MDCacheInvalidations *invals = &mdcache_pending_invals;
+
+	/* InvalidOid means that the whole relcache was flushed */
+	if (!OidIsValid(relid))
+	{
+		invals->reset = true;
+		return;
+	}
+
+	mdcache_add_invalidated_relid(invals, relid);
 }
 
 static void
@@ -2352,35 +2471,205 @@ register_mdcache_invalidation_callbacks(void)
 	for (i = 0; i < lengthof(metadata_caches); i++)
 	{
 		CacheRegisterSyscacheCallback(metadata_caches[i],
-									  &mdsyscache_invalidation_counter_callback,
+									  &mdsyscache_invalidation_callback,
 									  (Datum) 0);
 	}
 
 	/* also register the relcache callback */
-	CacheRegisterRelcacheCallback(&mdrelcache_invalidation_counter_callback,
+	CacheRegisterRelcacheCallback(&mdrelcache_invalidation_callback,
 								  (Datum) 0);
 }
 
-// Has there been any catalog changes since last call?
+// Hand the catalog changes since the last call over to the
+// MDCache*Invalidated() functions. Returns true if the whole metadata cache
+// needs to be reset instead.
 bool
 gpdb::MDCacheNeedsReset(void)
 {
 	GP_WRAP_START;
 	{
-		if (!mdcache_invalidation_counter_registered)
+		MDCacheInvalidations *invals = &mdcache_invals;
+		int			num_relids;
+		int			i;
+
+		if (!mdcache_invalidation_callbacks_registered)
 		{
 			register_mdcache_invalidation_callbacks();
-			mdcache_invalidation_counter_registered = true;
+			mdcache_invalidation_callbacks_registered = true;
 		}
-		if (last_mdcache_invalidation_counter == mdcache_invalidation_counter)
+
+		/*
+		 * If we errored out while looking up partition ancestors or evicting
+		 * the affected objects the last time around, we lost track of what
+		 * was invalidated.
+		 */
+		if (!mdcache_invals_valid)
 		{
-			return false;
+			mdcache_pending_invals.reset = true;
 		}
-		else
+
+		memcpy(invals, &mdcache_pending_invals, sizeof(MDCacheInvalidations));
+		mdcache_pending_invals.reset = false;
+		mdcache_pending_invals.num_relids = 0;
+		mdcache_pending_invals.num_syscache = 0;
+		mdcache_num_stats_checked = 0;
+
+		/*
+		 * Unless selective eviction is enabled, any catalog change resets
+		 * the whole cache, as before.
+		 */
+		if (!optimizer_mdcache_selective_eviction &&
+			(invals->num_relids > 0 || invals->num_syscache > 0))
+		{
+			invals->reset = true;
+		}
+
+		mdcache_invals_valid = false;
+		num_relids = invals->num_relids;
+		for (i = 0; i < num_relids && !invals->reset; i++)
 		{
-			last_mdcache_invalidation_counter = mdcache_invalidation_counter;
+			/* catalog tables: pg_inherits */
+			List *ancestors = get_partition_ancestors(invals->relids[i]);
+			ListCell *lc;
+
+			foreach (lc, ancestors)
+			{
+				mdcache_add_invalidated_relid(invals, lfirst_oid(lc));
+			}
+			list_free(ancestors);
+		}
+
+		if (invals->reset)
+		{
+			invals->num_relids = 0;
+			invals->num_syscache = 0;
 			return true;
 		}
+
+		qsort(invals->relids, invals->num_relids, sizeof(Oid), oid_cmp);
+		return false;
+	}
+	GP_WRAP_END;
+
+	return true;
+}
+
+// The metadata cache has been evicted or reset according to the catalog
+// changes that MDCacheNeedsReset() handed over.
+void
+gpdb::MDCacheInvalidationsProcessed(void)
+{
+	mdcache_invals_valid = true;
+}
+
+// Were there any catalog changes that MDCacheNeedsReset() handed over?
+bool
+gpdb::MDCacheHasInvalidations(void)
+{
+	// No GP_WRAP_START/END needed here, and in the functions below that
+	// just look at the invalidations.
+	return mdcache_invals.num_relids > 0 || mdcache_invals.num_syscache > 0;
+}
+
+// Was the relation or index, or one of its partitions, changed? InvalidOid
+// asks about any relation.
+bool
+gpdb::MDCacheRelationInvalidated(Oid relid)
+{
+	if (!OidIsValid(relid))
+	{
+		return mdcache_invals.num_relids > 0;
+	}
+
+	return nullptr != bsearch(&relid, mdcache_invals.relids,
+							  mdcache_invals.num_relids, sizeof(Oid), oid_cmp);
+}
+
+// Was any entry of the catalog cache changed?
+bool
+gpdb::MDCacheAnySyscacheInvalidated(int cacheid)
+{
+	return mdcache_syscache_invalidated(cacheid, 0);
+}
+
+// Was the catalog cache entry with the given keys changed? Keys beyond the
+// number the catalog cache uses are ignored.
+bool
+gpdb::MDCacheSyscacheInvalidated(int cacheid, Datum key1, Datum key2,
+								 Datum key3)
+{
+	GP_WRAP_START;
+	{
+		if (!mdcache_syscache_invalidated(cacheid, 0))
+		{
+			return false;
+		}
+
+		return mdcache_syscache_invalidated(
+			cacheid, GetSysCacheHashValue(cacheid, key1, key2, key3, 0));
+	}
+	GP_WRAP_END;
+
+	return true;
+}
+
+// Were the statistics of any column of the relation changed?
+bool
+gpdb::MDCacheRelationStatsInvalidated(Oid relid)
+{
+	GP_WRAP_START;
+	{
+		HeapTuple tp;
+		AttrNumber natts;
+		bool result = false;
+		int i;
+
+		if (!mdcache_syscache_invalidated(STATRELATTINH, 0))
+		{
+			return false;
+		}
+
+		for (i = 0; i < mdcache_num_stats_checked; i++)
+		{
+			if (mdcache_stats_checked_relids[i] == relid)
+			{
+				return mdcache_stats_checked_result[i];
+			}
+		}
+
+		/* catalog tables: pg_class */
+		tp = SearchSysCache1(RELOID, ObjectIdGetDatum(relid));
+		if (!HeapTupleIsValid(tp))
+		{
+			return false;
+		}
+		natts = ((Form_pg_class) GETSTRUCT(tp))->relnatts;
+		ReleaseSysCache(tp);
+
+		for (AttrNumber attno = 1; attno <= natts && !result; attno++)
+		{
+			result = mdcache_syscache_invalidated(
+						 STATRELATTINH,
+						 GetSysCacheHashValue3(STATRELATTINH,
+											   ObjectIdGetDatum(relid),
+											   Int16GetDatum(attno),
+											   BoolGetDatum(false))) ||
+					 mdcache_syscache_invalidated(
+						 STATRELATTINH,
+						 GetSysCacheHashValue3(STATRELATTINH,
+											   ObjectIdGetDatum(relid),
+											   Int16GetDatum(attno),
+											   BoolGetDatum(true)));
+		}
+
+		if (mdcache_num_stats_checked < MDCACHE_MAX_INVALIDATIONS)
+		{
+			mdcache_stats_checked_relids[mdcache_num_stats_checked] = relid;
+			mdcache_stats_checked_result[mdcache_num_stats_checked] = result;
+			mdcache_num_stats_checked++;
+		}
+
+		return result;
 	}
 	GP_WRAP_END;
 
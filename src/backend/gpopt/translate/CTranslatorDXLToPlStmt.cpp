@@ -160,7 +160,8 @@ CTranslatorDXLToPlStmt::~CTranslatorDXLToPlStmt()
 PlannedStmt *
 CTranslatorDXLToPlStmt::GetPlannedStmtFromDXL(const CDXLNode *dxlnode,
 											  const Query *orig_query,
-											  bool can_set_tag)
+											  bool can_set_tag,
+											  bool is_parallel_cursor)
 {
 	GPOS_ASSERT(nullptr != dxlnode);
 
@@ -185,10 +186,28 @@ CTranslatorDXLToPlStmt::GetPlannedStmtFromDXL(const CDXLNode *dxlnode,
 
 	CDXLTranslationContextArray *ctxt_translation_prev_siblings =
 		GPOS_NEW(m_mp) CDXLTranslationContextArray(m_mp);
-	Plan *plan = TranslateDXLOperatorToPlan(dxlnode, &dxl_translate_ctxt,
-											ctxt_translation_prev_siblings);
+	Plan *plan;
+	if (is_parallel_cursor && IsGatherMotionToEndpoints(dxlnode))
+	{
+		plan = TranslateDXLGatherMotionToEndpoints(
+			dxlnode, &dxl_translate_ctxt, ctxt_translation_prev_siblings);
+	}
+	else
+	{
+		plan = TranslateDXLOperatorToPlan(dxlnode, &dxl_translate_ctxt,
+										  ctxt_translation_prev_siblings);
+	}
 	ctxt_translation_prev_siblings->Release();
 
+	if (is_parallel_cursor && GANGTYPE_UNALLOCATED == topslice->gangType)
+	{
+		// The endpoint needs a QE to serve the retrieve connections, so a
+		// plan that ends on the coordinator runs its top slice in an entry
+		// DB process, like cdbllize does for the Postgres planner.
+		topslice->gangType = GANGTYPE_ENTRYDB_READER;
+		topslice->numsegments = 1;
+	}
+
 	GPOS_ASSERT(nullptr != plan);
 
 	// collect oids from rtable
@@ -2279,40 +2298,7 @@ CTranslatorDXLToPlStmt::TranslateDXLMotion(
 	sendslice->parentIndex = recvslice->sliceIndex;
 	m_dxl_to_plstmt_context->SetCurrentSlice(sendslice);
 
-	// only one sender
-	if (1 == input_segids_array->Size())
-	{
-		int segindex = *((*input_segids_array)[0]);
-
-		// only one segment in total
-		if (segindex == COORDINATOR_CONTENT_ID)
-		{
-			// sender is on coordinator, must be singleton gang
-			sendslice->gangType = GANGTYPE_ENTRYDB_READER;
-		}
-		else if (1 == gpdb::GetGPSegmentCount())
-		{
-			// sender is on segment, can not tell it's singleton or
-			// all-segment gang, so treat it as all-segment reader gang.
-			// It can be promoted to writer gang later if needed.
-			sendslice->gangType = GANGTYPE_PRIMARY_READER;
-		}
-		else
-		{
-			// multiple segments, must be singleton gang
-			sendslice->gangType = GANGTYPE_SINGLETON_READER;
-		}
-		sendslice->numsegments = 1;
-		sendslice->segindex = segindex;
-	}
-	else
-	{
-		// Mark it as reader for now. Will be overwritten into WRITER, if we
-		// encounter a DML node.
-		sendslice->gangType = GANGTYPE_PRIMARY_READER;
-		sendslice->numsegments = m_num_of_segments;
-		sendslice->segindex = 0;
-	}
+	SetSendingSliceGang(sendslice, input_segids_array);
 	sendslice->directDispatch.isDirectDispatch = false;
 	sendslice->directDispatch.contentIds = NIL;
 	sendslice->directDispatch.haveProcessedAnyCalculations = false;
@@ -2483,6 +2469,148 @@ CTranslatorDXLToPlStmt::TranslateDXLMotion(
 	return (Plan *) motion;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CTranslatorDXLToPlStmt::SetSendingSliceGang
+//
+//	@doc:
+//		Set the gang of a slice that sends the output of a motion, based on
+//		the motion's input segments
+//
+//---------------------------------------------------------------------------
+void
+CTranslatorDXLToPlStmt::SetSendingSliceGang(
+	PlanSlice *sendslice, const IntPtrArray *input_segids_array) const
+{
+	// only one sender
+	if (1 == input_segids_array->Size())
+	{
+		int segindex = *((*input_segids_array)[0]);
+
+		// only one segment in total
+		if (segindex == COORDINATOR_CONTENT_ID)
+		{
+			// sender is on coordinator, must be singleton gang
+			sendslice->gangType = GANGTYPE_ENTRYDB_READER;
+		}
+		else if (1 == gpdb::GetGPSegmentCount())
+		{
+			// sender is on segment, can not tell it's singleton or
+			// all-segment gang, so treat it as all-segment reader gang.
+			// It can be promoted to writer gang later if needed.
+			sendslice->gangType = GANGTYPE_PRIMARY_READER;
+		}
+		else
+		{
+			// multiple segments, must be singleton gang
+			sendslice->gangType = GANGTYPE_SINGLETON_READER;
+		}
+		sendslice->numsegments = 1;
+		sendslice->segindex = segindex;
+	}
+	else
+	{
+		// Mark it as reader for now. Will be overwritten into WRITER, if we
+		// encounter a DML node.
+		sendslice->gangType = GANGTYPE_PRIMARY_READER;
+		sendslice->numsegments = m_num_of_segments;
+		sendslice->segindex = 0;
+	}
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CTranslatorDXLToPlStmt::IsGatherMotionToEndpoints
+//
+//	@doc:
+//		Can the given root of a PARALLEL RETRIEVE CURSOR plan be left out, so
+//		that the endpoints are on the slice that feeds it? That's the case for
+//		a Gather Motion that doesn't need to preserve an order. A merging
+//		Gather Motion is kept, the endpoint on the coordinator then returns
+//		the rows in order, as with the Postgres planner.
+//
+//---------------------------------------------------------------------------
+BOOL
+CTranslatorDXLToPlStmt::IsGatherMotionToEndpoints(const CDXLNode *dxlnode)
+{
+	if (EdxlopPhysicalMotionGather !=
+		dxlnode->GetOperator()->GetDXLOperator())
+	{
+		return false;
+	}
+
+	return 0 == (*dxlnode)[EdxlgmIndexSortColList]->Arity();
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CTranslatorDXLToPlStmt::TranslateDXLGatherMotionToEndpoints
+//
+//	@doc:
+//		Translate the DXL Gather Motion at the root of a PARALLEL RETRIEVE
+//		CURSOR plan into a GPDB Result node. The top slice takes the place of
+//		the motion's sending slice, so each sender becomes an endpoint.
+//
+//---------------------------------------------------------------------------
+Plan *
+CTranslatorDXLToPlStmt::TranslateDXLGatherMotionToEndpoints(
+	const CDXLNode *motion_dxlnode, CDXLTranslateContext *output_context,
+	CDXLTranslationContextArray *ctxt_translation_prev_siblings)
+{
+	CDXLPhysicalMotion *motion_dxlop =
+		CDXLPhysicalMotion::Cast(motion_dxlnode->GetOperator());
+	PlanSlice *topslice = m_dxl_to_plstmt_context->GetCurrentSlice();
+
+	GPOS_ASSERT(0 == topslice->sliceIndex);
+
+	SetSendingSliceGang(topslice, motion_dxlop->GetInputSegIdsArray());
+	if (GANGTYPE_SINGLETON_READER == topslice->gangType)
+	{
+		// The input is the same on every segment, e.g. a replicated table.
+		// Like the Postgres planner, spread the endpoints of different
+		// sessions over the segments instead of always using the first one.
+		topslice->segindex = gp_session_id % m_num_of_segments;
+	}
+
+	Result *result = MakeNode(Result);
+
+	Plan *plan = &(result->plan);
+	plan->plan_node_id = m_dxl_to_plstmt_context->GetNextPlanId();
+
+	// translate operator costs, now that the slice has its segments
+	TranslatePlanCosts(motion_dxlnode, plan);
+
+	CDXLNode *project_list_dxlnode = (*motion_dxlnode)[EdxlgmIndexProjList];
+	CDXLNode *filter_dxlnode = (*motion_dxlnode)[EdxlgmIndexFilter];
+	CDXLNode *child_dxlnode =
+		(*motion_dxlnode)[motion_dxlop->GetRelationChildIdx()];
+
+	CDXLTranslateContext child_context(m_mp, false,
+									   output_context->GetColIdToParamIdMap());
+
+	Plan *child_plan = TranslateDXLOperatorToPlan(
+		child_dxlnode, &child_context, ctxt_translation_prev_siblings);
+
+	CDXLTranslationContextArray *child_contexts =
+		GPOS_NEW(m_mp) CDXLTranslationContextArray(m_mp);
+	child_contexts->Append(&child_context);
+
+	// translate proj list and filter
+	TranslateProjListAndFilter(project_list_dxlnode, filter_dxlnode,
+							   nullptr,	 // translate context for the base table
+							   child_contexts, &plan->targetlist, &plan->qual,
+							   output_context);
+
+	// cleanup
+	child_contexts->Release();
+
+	plan->lefttree = child_plan;
+
+	SetParamIds(plan);
+
+	return (Plan *) result;
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		CTranslatorDXLToPlStmt::TranslateDXLRedistributeMotionToResultHashFilters
@@ -63,11 +63,15 @@ extern "C" {
 #include "naucrates/exception.h"
 #include "naucrates/init.h"
 #include "naucrates/md/CMDIdCast.h"
+#include "naucrates/md/CMDIdColStats.h"
+#include "naucrates/md/CMDIdGPDB.h"
 #include "naucrates/md/CMDIdRelStats.h"
 #include "naucrates/md/CMDIdScCmp.h"
 #include "naucrates/md/CSystemId.h"
+#include "naucrates/md/IMDCacheObject.h"
 #include "naucrates/md/IMDId.h"
 #include "naucrates/md/IMDRelStats.h"
+#include "naucrates/md/IMDScalarOp.h"
 #include "naucrates/traceflags/traceflags.h"
 
 using namespace gpos;
@@ -266,7 +270,7 @@ COptTasks::LogExceptionMessageAndDelete(CHAR *err_buf)
 PlannedStmt *
 COptTasks::ConvertToPlanStmtFromDXL(
 	CMemoryPool *mp, CMDAccessor *md_accessor, const Query *orig_query,
-	const CDXLNode *dxlnode, bool can_set_tag,
+	const CDXLNode *dxlnode, bool can_set_tag, bool is_parallel_cursor,
 	DistributionHashOpsKind distribution_hashops)
 {
 	GPOS_ASSERT(nullptr != md_accessor);
@@ -288,7 +292,7 @@ COptTasks::ConvertToPlanStmtFromDXL(
 	CTranslatorDXLToPlStmt dxl_to_plan_stmt_translator(
 		mp, md_accessor, &dxl_to_plan_stmt_ctxt, gpdb::GetGPSegmentCount());
 	return dxl_to_plan_stmt_translator.GetPlannedStmtFromDXL(
-		dxlnode, orig_query, can_set_tag);
+		dxlnode, orig_query, can_set_tag, is_parallel_cursor);
 }
 
 
@@ -445,6 +449,129 @@ COptTasks::GetCostModel(CMemoryPool *mp, ULONG num_segments)
 	return cost_model;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		COptTasks::IsMDCacheObjectInvalidated
+//
+//	@doc:
+//		Is the metadata cache object affected by the catalog changes handed
+//		over by gpdb::MDCacheNeedsReset()? Objects we cannot tell about are
+//		considered affected.
+//
+//---------------------------------------------------------------------------
+BOOL
+COptTasks::IsMDCacheObjectInvalidated(IMDCacheObject *const &md_obj,
+									  void *  // arg
+)
+{
+	IMDId *mdid = md_obj->MDId();
+
+	switch (mdid->MdidType())
+	{
+		case IMDId::EmdidGeneral:
+		{
+			OID oid = CMDIdGPDB::CastMdid(mdid)->Oid();
+
+			if (IMDCacheObject::EmdtType == md_obj->MDType())
+			{
+				// types refer to their operators and aggregates, some of
+				// which are looked up by name
+				return gpdb::MDCacheSyscacheInvalidated(TYPEOID,
+														ObjectIdGetDatum(oid)) ||
+					   gpdb::MDCacheAnySyscacheInvalidated(OPEROID) ||
+					   gpdb::MDCacheAnySyscacheInvalidated(PROCOID) ||
+					   gpdb::MDCacheAnySyscacheInvalidated(AGGFNOID);
+			}
+
+			// an operator takes its strictness and more from the function
+			// that implements it
+			if (IMDCacheObject::EmdtOp == md_obj->MDType())
+			{
+				IMDId *func_mdid =
+					dynamic_cast<IMDScalarOp *>(md_obj)->FuncMdId();
+
+				if (gpdb::MDCacheSyscacheInvalidated(
+						PROCOID,
+						ObjectIdGetDatum(
+							CMDIdGPDB::CastMdid(func_mdid)->Oid())))
+				{
+					return true;
+				}
+			}
+
+			// operators, functions and aggregates; the oid of an aggregate
+			// is also the oid of its pg_proc entry
+			return gpdb::MDCacheSyscacheInvalidated(OPEROID,
+													ObjectIdGetDatum(oid)) ||
+				   gpdb::MDCacheSyscacheInvalidated(PROCOID,
+													ObjectIdGetDatum(oid)) ||
+				   gpdb::MDCacheSyscacheInvalidated(AGGFNOID,
+													ObjectIdGetDatum(oid));
+		}
+		case IMDId::EmdidRelStats:
+		{
+			OID rel_oid =
+				CMDIdGPDB::CastMdid(
+					CMDIdRelStats::CastMdid(mdid)->GetRelMdId())
+					->Oid();
+
+			return gpdb::MDCacheRelationInvalidated(rel_oid) ||
+				   gpdb::MDCacheRelationStatsInvalidated(rel_oid);
+		}
+		case IMDId::EmdidColStats:
+		{
+			OID rel_oid =
+				CMDIdGPDB::CastMdid(
+					CMDIdColStats::CastMdid(mdid)->GetRelMdId())
+					->Oid();
+
+			return gpdb::MDCacheRelationInvalidated(rel_oid) ||
+				   gpdb::MDCacheRelationStatsInvalidated(rel_oid);
+		}
+		case IMDId::EmdidCastFunc:
+		{
+			CMDIdCast *mdid_cast = CMDIdCast::CastMdid(mdid);
+			OID src_oid = CMDIdGPDB::CastMdid(mdid_cast->MdidSrc())->Oid();
+			OID dest_oid = CMDIdGPDB::CastMdid(mdid_cast->MdidDest())->Oid();
+
+			// without a pg_cast entry, the coercion path may go through
+			// the array type or a function of the target type
+			return gpdb::MDCacheSyscacheInvalidated(
+					   CASTSOURCETARGET, ObjectIdGetDatum(src_oid),
+					   ObjectIdGetDatum(dest_oid)) ||
+				   gpdb::MDCacheSyscacheInvalidated(
+					   TYPEOID, ObjectIdGetDatum(dest_oid)) ||
+				   gpdb::MDCacheAnySyscacheInvalidated(PROCOID);
+		}
+		case IMDId::EmdidScCmp:
+		{
+			// comparison operators are looked up by name
+			return gpdb::MDCacheAnySyscacheInvalidated(OPEROID);
+		}
+		case IMDId::EmdidRel:
+		case IMDId::EmdidInd:
+		case IMDId::EmdidGPDBCtas:
+		case IMDId::EmdidExtStatsInfo:
+		{
+			return gpdb::MDCacheRelationInvalidated(
+				CMDIdGPDB::CastMdid(mdid)->Oid());
+		}
+		case IMDId::EmdidCheckConstraint:
+		{
+			return gpdb::MDCacheSyscacheInvalidated(
+				CONSTROID, ObjectIdGetDatum(CMDIdGPDB::CastMdid(mdid)->Oid()));
+		}
+		case IMDId::EmdidExtStats:
+		{
+			// the mdid only has the oid of the statistics object, and
+			// CREATE/DROP STATISTICS invalidate the relation
+			return gpdb::MDCacheRelationInvalidated(InvalidOid);
+		}
+		default:
+			return true;
+	}
+}
+
 //---------------------------------------------------------------------------
 //	@function:
 //		COptTasks::OptimizeTask
@@ -485,11 +612,21 @@ COptTasks::OptimizeTask(void *ptr)
 		CMDCache::Reset();
 		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
 	}
-	else if (CMDCache::ULLGetCacheQuota() !=
-			 (ULLONG) optimizer_mdcache_size * 1024L)
+	else
 	{
-		CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		// evict only the objects affected by the catalog changes
+		if (gpdb::MDCacheHasInvalidations())
+		{
+			CMDCache::Evict(IsMDCacheObjectInvalidated, nullptr);
+		}
+
+		if (CMDCache::ULLGetCacheQuota() !=
+			(ULLONG) optimizer_mdcache_size * 1024L)
+		{
+			CMDCache::SetCacheQuota(optimizer_mdcache_size * 1024L);
+		}
 	}
+	gpdb::MDCacheInvalidationsProcessed();
 
 
 	// load search strategy
@@ -587,6 +724,7 @@ COptTasks::OptimizeTask(void *ptr)
 					(PlannedStmt *) gpdb::CopyObject(ConvertToPlanStmtFromDXL(
 						mp, &mda, opt_ctxt->m_query, plan_dxl,
 						opt_ctxt->m_query->canSetTag,
+						opt_ctxt->m_is_parallel_cursor,
 						query_to_dxl_translator->GetDistributionHashOpsKind()));
 			}
 
@@ -78,6 +78,10 @@ public:
 	// reset global instance
 	static void Reset();
 
+	// evict the objects selected by the given function
+	static ULONG Evict(CMDAccessor::MDCache::MatchFuncPtr match_func,
+					   void *arg);
+
 	// global accessor
 	static CMDAccessor::MDCache *
 	Pcache()
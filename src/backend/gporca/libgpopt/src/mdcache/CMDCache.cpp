@@ -124,4 +124,21 @@ CMDCache::Reset()
 	Init();
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CMDCache::Evict
+//
+//	@doc:
+//		Evict the objects selected by the given function, e.g. the ones
+//		affected by a catalog change
+//
+//---------------------------------------------------------------------------
+ULONG
+CMDCache::Evict(CMDAccessor::MDCache::MatchFuncPtr match_func, void *arg)
+{
+	GPOS_ASSERT(nullptr != m_pcache && "Metadata cache was not created");
+
+	return m_pcache->EvictMatchingEntries(match_func, arg);
+}
+
 // EOF
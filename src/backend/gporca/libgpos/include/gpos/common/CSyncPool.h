@@ -6,16 +6,15 @@
 //		CSyncPool.h
 //
 //	@doc:
-//		Template-based synchronized object pool class with minimum synchronization
-//		overhead; it provides thread-safe object retrieval and release through
-//		atomic primitives (lock-free);
+//		Template-based object pool class; it provides object retrieval and
+//		release in constant time
 //
 //		Object pool is dynamically created during construction and released at
 //		destruction; users retrieve objects without incurring the construction
 //		cost (memory allocation, constructor invocation)
 //
-//		In order for the objects to be used in lock-free lists, the class uses
-//		the clock algorithm to recycle objects.
+//		Recycled objects are kept in a FIFO queue, so that an object is reused
+//		as late as possible after it has been released.
 //---------------------------------------------------------------------------
 #ifndef GPOS_CSyncPool_H
 #define GPOS_CSyncPool_H
@@ -35,7 +34,8 @@ namespace gpos
 //		CSyncPool<class T>
 //
 //	@doc:
-//		Object pool class (not thread-safe, despite the name)
+//		Object pool class; the pool does no locking of its own, so a pool
+//		must only be used by one thread at a time
 //
 //---------------------------------------------------------------------------
 template <class T>
@@ -51,8 +51,8 @@ private:
 	// bitmap indicating object reservation
 	ULONG *m_objs_reserved;
 
-	// bitmap indicating object recycle
-	ULONG *m_objs_recycled;
+	// circular queue of the ids of unreserved objects
+	ULONG *m_free_ids;
 
 	// number of allocated objects
 	ULONG m_numobjs;
@@ -60,62 +60,29 @@ private:
 	// number of elements (ULONG) in bitmap
 	ULONG m_bitmap_size;
 
-	// offset of last lookup - clock index
-	ULONG_PTR m_last_lookup_idx;
+	// position of the first id in the queue of unreserved objects
+	ULONG m_free_head;
+
+	// number of ids in the queue of unreserved objects
+	ULONG m_free_count;
 
 	// offset of id inside the object
 	ULONG m_id_offset;
 
-	// atomically set bit if it is unset
+	// check if object is reserved
 	BOOL
-	SetBit(ULONG *dest, ULONG bit_val)
+	IsReserved(ULONG id) const
 	{
-		GPOS_ASSERT(nullptr != dest);
-
-		ULONG old_val = *dest;
-
-		// keep trying while the bit is unset
-		while (0 == (bit_val & old_val))
-		{
-			ULONG new_val = bit_val | old_val;
-
-			// attempt to set the bit
-			if (*dest == old_val)
-			{
-				*dest = new_val;
-				return true;
-			}
+		ULONG bit_val = 1 << (id % BITS_PER_ULONG);
 
-			old_val = *dest;
-		}
-
-		return false;
+		return bit_val == (m_objs_reserved[id / BITS_PER_ULONG] & bit_val);
 	}
 
-	// atomically unset bit if it is set
-	BOOL
-	UnsetBit(ULONG *dest, ULONG bit_val)
+	// flip reservation bit of object
+	void
+	FlipReserved(ULONG id)
 	{
-		GPOS_ASSERT(nullptr != dest);
-
-		ULONG old_val = *dest;
-
-		// keep trying while the bit is set
-		while (bit_val == (bit_val & old_val))
-		{
-			ULONG new_val = bit_val ^ old_val;
-
-			// attempt to set the bit
-			if (*dest == old_val)
-			{
-				*dest = new_val;
-				return true;
-			}
-
-			old_val = *dest;
-		}
-
-		return false;
+		m_objs_reserved[id / BITS_PER_ULONG] ^= 1 << (id % BITS_PER_ULONG);
 	}
 
 public:
@@ -126,10 +93,11 @@ public:
 		: m_mp(mp),
 		  m_objects(nullptr),
 		  m_objs_reserved(nullptr),
-		  m_objs_recycled(nullptr),
+		  m_free_ids(nullptr),
 		  m_numobjs(size),
 		  m_bitmap_size(size / BITS_PER_ULONG + 1),
-		  m_last_lookup_idx(0),
+		  m_free_head(0),
+		  m_free_count(0),
 		  m_id_offset(gpos::ulong_max)
 	{
 	}
@@ -141,31 +109,21 @@ public:
 		{
 			GPOS_ASSERT(nullptr != m_objects);
 			GPOS_ASSERT(nullptr != m_objs_reserved);
-			GPOS_ASSERT(nullptr != m_objs_recycled);
+			GPOS_ASSERT(nullptr != m_free_ids);
 
 #ifdef GPOS_DEBUG
 			if (!ITask::Self()->HasPendingExceptions())
 			{
 				for (ULONG i = 0; i < m_numobjs; i++)
 				{
-					ULONG elem_offset = i / BITS_PER_ULONG;
-					ULONG bit_offset = i % BITS_PER_ULONG;
-					ULONG bit_val = 1 << bit_offset;
-
-					BOOL reserved =
-						(bit_val == (m_objs_reserved[elem_offset] & bit_val));
-					BOOL recycled =
-						(bit_val == (m_objs_recycled[elem_offset] & bit_val));
-
-					GPOS_ASSERT((!reserved || recycled) &&
-								"Object is still in use");
+					GPOS_ASSERT(!IsReserved(i) && "Object is still in use");
 				}
 			}
 #endif	// GPOS_DEBUG
 
 			GPOS_DELETE_ARRAY(m_objects);
 			GPOS_DELETE_ARRAY(m_objs_reserved);
-			GPOS_DELETE_ARRAY(m_objs_recycled);
+			GPOS_DELETE_ARRAY(m_free_ids);
 		}
 	}
 
@@ -177,22 +135,24 @@ public:
 
 		m_objects = GPOS_NEW_ARRAY(m_mp, T, m_numobjs);
 		m_objs_reserved = GPOS_NEW_ARRAY(m_mp, ULONG, m_bitmap_size);
-		m_objs_recycled = GPOS_NEW_ARRAY(m_mp, ULONG, m_bitmap_size);
+		m_free_ids = GPOS_NEW_ARRAY(m_mp, ULONG, m_numobjs);
 
 		m_id_offset = id_offset;
 
-		// initialize object ids
+		// initialize object ids, all objects start out unreserved
 		for (ULONG i = 0; i < m_numobjs; i++)
 		{
 			ULONG *id = (ULONG *) (((BYTE *) &m_objects[i]) + m_id_offset);
 			*id = i;
+			m_free_ids[i] = i;
 		}
+		m_free_head = 0;
+		m_free_count = m_numobjs;
 
-		// initialize bitmaps
+		// initialize bitmap
 		for (ULONG i = 0; i < m_bitmap_size; i++)
 		{
 			m_objs_reserved[i] = 0;
-			m_objs_recycled[i] = 0;
 		}
 	}
 
@@ -203,48 +163,24 @@ public:
 		GPOS_ASSERT(gpos::ulong_max != m_id_offset &&
 					"Id offset not initialized.");
 
-		// iterate over all objects twice (two full clock rotations);
-		// objects marked as recycled cannot be reserved on the first round;
-		for (ULONG i = 0; i < 2 * m_numobjs; i++)
+		if (0 < m_free_count)
 		{
-			// move clock index
-			ULONG_PTR index = (m_last_lookup_idx++) % m_numobjs;
+			ULONG index = m_free_ids[m_free_head];
 
-			ULONG elem_offset = (ULONG) index / BITS_PER_ULONG;
-			ULONG bit_offset = (ULONG) index % BITS_PER_ULONG;
-			ULONG bit_val = 1 << bit_offset;
+			m_free_head = (m_free_head + 1) % m_numobjs;
+			m_free_count--;
 
-			// attempt to reserve object
-			if (SetBit(&m_objs_reserved[elem_offset], bit_val))
-			{
-				// set id in corresponding object
-				T *elem = &m_objects[index];
+			GPOS_ASSERT(!IsReserved(index) && "Object is already reserved");
+			FlipReserved(index);
 
-#ifdef GPOS_DEBUG
-				ULONG *id = (ULONG *) (((BYTE *) elem) + m_id_offset);
-				GPOS_ASSERT(index == *id);
-#endif	// GPOS_DEBUG
-
-				return elem;
-			}
+			T *elem = &m_objects[index];
 
-			// object is reserved, check if it has been marked for recycling
-			if (bit_val == (bit_val & m_objs_recycled[elem_offset]))
-			{
-				// attempt to unset the recycle bit
-				if (UnsetBit(&m_objs_recycled[elem_offset], bit_val))
-				{
 #ifdef GPOS_DEBUG
-					BOOL recycled =
+			ULONG *id = (ULONG *) (((BYTE *) elem) + m_id_offset);
+			GPOS_ASSERT(index == *id);
 #endif	// GPOS_DEBUG
 
-						// unset the reserve bit - must succeed
-						UnsetBit(&m_objs_reserved[elem_offset], bit_val);
-
-					GPOS_ASSERT(recycled &&
-								"Object was reserved before being recycled");
-				}
-			}
+			return elem;
 		}
 
 		// no object is currently available, create a new one
@@ -270,22 +206,12 @@ public:
 		}
 
 		GPOS_ASSERT(offset < m_numobjs);
+		GPOS_ASSERT(IsReserved(offset) && "Object is not reserved");
+		GPOS_ASSERT(m_free_count < m_numobjs);
 
-		ULONG elem_offset = offset / BITS_PER_ULONG;
-		ULONG bit_offset = offset % BITS_PER_ULONG;
-		ULONG bit_val = 1 << bit_offset;
-
-#ifdef GPOS_DEBUG
-		ULONG reserved = m_objs_reserved[elem_offset];
-		GPOS_ASSERT((bit_val == (bit_val & reserved)) &&
-					"Object is not reserved");
-
-		BOOL mark_recycled =
-#endif	// GPOS_DEBUG
-			SetBit(&m_objs_recycled[elem_offset], bit_val);
-
-		GPOS_ASSERT(mark_recycled &&
-					"Object has already been marked for recycling");
+		FlipReserved(offset);
+		m_free_ids[(m_free_head + m_free_count) % m_numobjs] = offset;
+		m_free_count++;
 	}
 
 };	// class CSyncPool
@@ -77,6 +77,9 @@ public:
 	using HashFuncPtr = ULONG (*)(const K &);
 	using EqualFuncPtr = BOOL (*)(const K &, const K &);
 
+	// type definition of function selecting cached objects to evict
+	using MatchFuncPtr = BOOL (*)(const T &, void *);
+
 private:
 	using CCacheHashTableEntry = CCacheEntry<T, K>;
 
@@ -514,6 +517,60 @@ public:
 		return m_eviction_factor;
 	}
 
+	// evict the entries whose objects match the given function, regardless
+	// of their gclock counters; entries that are still in use are marked
+	// for deletion instead, and go away when released; returns the number
+	// of entries evicted or marked
+	ULONG
+	EvictMatchingEntries(MatchFuncPtr match_func, void *arg)
+	{
+		GPOS_ASSERT(nullptr != match_func);
+
+		CCacheHashtableIter iter(m_hash_table);
+		BOOL advanced = false;
+		ULONG num_evicted = 0;
+
+		while (advanced || iter.Advance())
+		{
+			advanced = false;
+			CCacheHashTableEntry *entry = nullptr;
+			BOOL deleted = false;
+			// Scope for CCacheHashtableIterAccessor
+			{
+				CCacheHashtableIterAccessor acc(iter);
+
+				if (nullptr != (entry = acc.Value()) &&
+					!entry->IsMarkedForDeletion() &&
+					match_func(entry->Val(), arg))
+				{
+					if (EXPECTED_REF_COUNT_FOR_DELETE == entry->RefCount())
+					{
+						// remove advances iterator automatically
+						acc.Remove(entry);
+						deleted = true;
+						advanced = true;
+
+						m_cache_size -= entry->Pmp()->TotalAllocatedSize();
+					}
+					else
+					{
+						entry->MarkForDeletion();
+					}
+					num_evicted++;
+				}
+			}
+
+			// now free the memory of the evicted entry
+			if (deleted)
+			{
+				GPOS_ASSERT(nullptr != entry);
+				DestroyCacheEntry(entry);
+			}
+		}
+
+		return num_evicted;
+	}
+
 };	//  CCache
 
 // invalid key
@@ -0,0 +1,56 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2023 VMware Inc.
+//
+//	@filename:
+//		CSyncPoolTest.h
+//
+//	@doc:
+//		Tests for CSyncPool
+//---------------------------------------------------------------------------
+#ifndef GPOS_CSyncPoolTest_H
+#define GPOS_CSyncPoolTest_H
+
+#include "gpos/common/CSyncPool.h"
+#include "gpos/types.h"
+
+namespace gpos
+{
+//---------------------------------------------------------------------------
+//	@class:
+//		CSyncPoolTest
+//
+//	@doc:
+//		Static unit tests for the object pool
+//
+//---------------------------------------------------------------------------
+class CSyncPoolTest
+{
+private:
+	// pooled element
+	struct SElem
+	{
+		// payload
+		ULONG m_value{0};
+
+		// object id, set by the pool
+		ULONG m_id{0};
+
+		// ctor
+		SElem() = default;
+	};
+
+public:
+	// unittests
+	static GPOS_RESULT EresUnittest();
+	static GPOS_RESULT EresUnittest_Basics();
+	static GPOS_RESULT EresUnittest_Overflow();
+	static GPOS_RESULT EresUnittest_ReuseOrder();
+
+};	// class CSyncPoolTest
+}  // namespace gpos
+
+
+#endif	// !GPOS_CSyncPoolTest_H
+
+// EOF
@@ -35,6 +35,7 @@
 #include "unittest/gpos/common/CStackTest.h"
 #include "unittest/gpos/common/CSyncHashtableTest.h"
 #include "unittest/gpos/common/CSyncListTest.h"
+#include "unittest/gpos/common/CSyncPoolTest.h"
 #include "unittest/gpos/error/CErrorHandlerTest.h"
 #include "unittest/gpos/error/CExceptionTest.h"
 #include "unittest/gpos/error/CLoggerTest.h"
@@ -76,6 +77,7 @@ static gpos::CUnittest rgut[] = {
 	GPOS_UNITTEST_STD(CStackTest),
 	GPOS_UNITTEST_STD(CSyncHashtableTest),
 	GPOS_UNITTEST_STD(CSyncListTest),
+	GPOS_UNITTEST_STD(CSyncPoolTest),
 
 	// error
 	GPOS_UNITTEST_STD(CErrorHandlerTest),
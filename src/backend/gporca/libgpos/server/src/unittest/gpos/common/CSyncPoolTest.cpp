@@ -0,0 +1,221 @@
+//---------------------------------------------------------------------------
+//	Greenplum Database
+//	Copyright (C) 2023 VMware Inc.
+//
+//	@filename:
+//		CSyncPoolTest.cpp
+//
+//	@doc:
+//		Tests for CSyncPool
+//---------------------------------------------------------------------------
+
+#include "unittest/gpos/common/CSyncPoolTest.h"
+
+#include "gpos/base.h"
+#include "gpos/memory/CAutoMemoryPool.h"
+#include "gpos/test/CUnittest.h"
+
+#define GPOS_SPOOL_SIZE 10
+
+using namespace gpos;
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CSyncPoolTest::EresUnittest
+//
+//	@doc:
+//		Unittest for object pool
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CSyncPoolTest::EresUnittest()
+{
+	CUnittest rgut[] = {
+		GPOS_UNITTEST_FUNC(CSyncPoolTest::EresUnittest_Basics),
+		GPOS_UNITTEST_FUNC(CSyncPoolTest::EresUnittest_Overflow),
+		GPOS_UNITTEST_FUNC(CSyncPoolTest::EresUnittest_ReuseOrder)};
+
+	return CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CSyncPoolTest::EresUnittest_Basics
+//
+//	@doc:
+//		Retrieve all preallocated objects, recycle them and retrieve them
+//		again
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CSyncPoolTest::EresUnittest_Basics()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	CSyncPool<SElem> pool(mp, GPOS_SPOOL_SIZE);
+	pool.Init(GPOS_OFFSET(SElem, m_id));
+
+	SElem *rgpelem[GPOS_SPOOL_SIZE];
+
+	// every preallocated object is handed out exactly once, in id order
+	for (ULONG i = 0; i < GPOS_SPOOL_SIZE; i++)
+	{
+		rgpelem[i] = pool.PtRetrieve();
+		if (i != rgpelem[i]->m_id)
+		{
+			return GPOS_FAILED;
+		}
+		rgpelem[i]->m_value = i;
+	}
+
+	for (ULONG i = 0; i < GPOS_SPOOL_SIZE; i++)
+	{
+		if (i != rgpelem[i]->m_value)
+		{
+			return GPOS_FAILED;
+		}
+		pool.Recycle(rgpelem[i]);
+	}
+
+	// recycled objects are handed out again
+	for (ULONG i = 0; i < GPOS_SPOOL_SIZE; i++)
+	{
+		SElem *pelem = pool.PtRetrieve();
+		if (pelem != rgpelem[i])
+		{
+			return GPOS_FAILED;
+		}
+	}
+
+	for (ULONG i = 0; i < GPOS_SPOOL_SIZE; i++)
+	{
+		pool.Recycle(rgpelem[i]);
+	}
+
+	return GPOS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CSyncPoolTest::EresUnittest_Overflow
+//
+//	@doc:
+//		Once all preallocated objects are in use, objects are allocated
+//		from the memory pool, and deleted when recycled
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CSyncPoolTest::EresUnittest_Overflow()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	CSyncPool<SElem> pool(mp, GPOS_SPOOL_SIZE);
+	pool.Init(GPOS_OFFSET(SElem, m_id));
+
+	SElem *rgpelem[2 * GPOS_SPOOL_SIZE];
+
+	for (ULONG i = 0; i < GPOS_ARRAY_SIZE(rgpelem); i++)
+	{
+		rgpelem[i] = pool.PtRetrieve();
+
+		// objects beyond the pool size are not part of the pool
+		ULONG id = i < GPOS_SPOOL_SIZE ? i : gpos::ulong_max;
+		if (id != rgpelem[i]->m_id)
+		{
+			return GPOS_FAILED;
+		}
+	}
+
+	// recycle an overflow object first, then a pooled one, and make sure
+	// the pooled one is the next to be handed out
+	pool.Recycle(rgpelem[GPOS_SPOOL_SIZE]);
+	pool.Recycle(rgpelem[0]);
+
+	SElem *pelem = pool.PtRetrieve();
+	if (pelem != rgpelem[0])
+	{
+		return GPOS_FAILED;
+	}
+
+	// the pool is exhausted again, so this is a new overflow object
+	SElem *pelemOverflow = pool.PtRetrieve();
+	if (gpos::ulong_max != pelemOverflow->m_id)
+	{
+		return GPOS_FAILED;
+	}
+	rgpelem[GPOS_SPOOL_SIZE] = pelemOverflow;
+
+	for (ULONG i = 0; i < GPOS_ARRAY_SIZE(rgpelem); i++)
+	{
+		pool.Recycle(rgpelem[i]);
+	}
+
+	return GPOS_OK;
+}
+
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CSyncPoolTest::EresUnittest_ReuseOrder
+//
+//	@doc:
+//		Recycled objects are reused in FIFO order, after all objects that
+//		were free before them
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CSyncPoolTest::EresUnittest_ReuseOrder()
+{
+	CAutoMemoryPool amp;
+	CMemoryPool *mp = amp.Pmp();
+
+	CSyncPool<SElem> pool(mp, GPOS_SPOOL_SIZE);
+	pool.Init(GPOS_OFFSET(SElem, m_id));
+
+	// an object recycled right away goes to the back of the queue
+	SElem *pelemFirst = pool.PtRetrieve();
+	pool.Recycle(pelemFirst);
+
+	SElem *rgpelem[GPOS_SPOOL_SIZE];
+	for (ULONG i = 0; i < GPOS_SPOOL_SIZE; i++)
+	{
+		rgpelem[i] = pool.PtRetrieve();
+		if ((i + 1) % GPOS_SPOOL_SIZE != rgpelem[i]->m_id)
+		{
+			return GPOS_FAILED;
+		}
+	}
+
+	// recycle in an order different from the one of retrieval, with the
+	// queue wrapping around the end of its array
+	const ULONG rgulOrder[] = {3, 7, 0, 9, 5, 1, 8, 2, 6, 4};
+	GPOS_ASSERT(GPOS_SPOOL_SIZE == GPOS_ARRAY_SIZE(rgulOrder));
+
+	for (ULONG i = 0; i < GPOS_ARRAY_SIZE(rgulOrder); i++)
+	{
+		pool.Recycle(rgpelem[rgulOrder[i]]);
+	}
+
+	for (ULONG i = 0; i < GPOS_ARRAY_SIZE(rgulOrder); i++)
+	{
+		SElem *pelem = pool.PtRetrieve();
+		if (pelem != rgpelem[rgulOrder[i]])
+		{
+			return GPOS_FAILED;
+		}
+	}
+
+	for (ULONG i = 0; i < GPOS_SPOOL_SIZE; i++)
+	{
+		pool.Recycle(rgpelem[i]);
+	}
+
+	return GPOS_OK;
+}
+
+
+// EOF
@@ -47,7 +47,8 @@ CCacheTest::EresUnittest()
 		GPOS_UNITTEST_FUNC(CCacheTest::EresUnittest_Eviction),
 		GPOS_UNITTEST_FUNC(CCacheTest::EresUnittest_Iteration),
 		GPOS_UNITTEST_FUNC(CCacheTest::EresUnittest_DeepObject),
-		GPOS_UNITTEST_FUNC(CCacheTest::EresUnittest_IterativeDeletion)};
+		GPOS_UNITTEST_FUNC(CCacheTest::EresUnittest_IterativeDeletion),
+		GPOS_UNITTEST_FUNC(CCacheTest::EresUnittest_EvictMatching)};
 
 	fUnique = true;
 	GPOS_RESULT eres = CUnittest::EresExecute(rgut, GPOS_ARRAY_SIZE(rgut));
@@ -985,4 +986,82 @@ CCacheTest::EresUnittest_IterativeDeletion()
 	return GPOS_OK;
 }
 
+//---------------------------------------------------------------------------
+//	@function:
+//		CCacheTest::SSimpleObject::FOddKey
+//
+//	@doc:
+//		Selects objects with odd keys
+//
+//---------------------------------------------------------------------------
+BOOL
+CCacheTest::SSimpleObject::FOddKey(SSimpleObject *const &pso,
+								   void *  // pvArg
+)
+{
+	return 1 == pso->m_ulKey % 2;
+}
+
+//---------------------------------------------------------------------------
+//	@function:
+//		CCacheTest::EresUnittest_EvictMatching
+//
+//	@doc:
+//		Evict the objects selected by a function, while one of them is
+//		still in use
+//
+//---------------------------------------------------------------------------
+GPOS_RESULT
+CCacheTest::EresUnittest_EvictMatching()
+{
+	CAutoP<CCache<SSimpleObject *, ULONG *> > apcache;
+	apcache = CCacheFactory::CreateCache<SSimpleObject *, ULONG *>(
+		fUnique, UNLIMITED_CACHE_QUOTA, SSimpleObject::UlMyHash,
+		SSimpleObject::FMyEqual);
+
+	CCache<SSimpleObject *, ULONG *> *pcache = apcache.Value();
+
+	for (ULONG i = 0; i < GPOS_CACHE_ELEMENTS; i++)
+	{
+		(void) InsertOneElement(pcache, i);
+	}
+
+	// scope for accessor keeping an odd key in use
+	{
+		CSimpleObjectCacheAccessor caInUse(pcache);
+		ULONG ulKeyInUse = 1;
+		caInUse.Lookup(&ulKeyInUse);
+		SSimpleObject *psoInUse = caInUse.Val();
+		GPOS_ASSERT(nullptr != psoInUse);
+
+		// release object since there is no customer to release it after lookup and before CCache's cleanup
+		psoInUse->Release();
+
+		ULONG ulEvicted GPOS_ASSERTS_ONLY =
+			pcache->EvictMatchingEntries(SSimpleObject::FOddKey, nullptr);
+		GPOS_ASSERT(GPOS_CACHE_ELEMENTS / 2 == ulEvicted);
+
+		// the entry in use is only marked for deletion
+		GPOS_ASSERT(GPOS_CACHE_ELEMENTS / 2 + 1 == pcache->Size());
+
+		for (ULONG i = 0; i < GPOS_CACHE_ELEMENTS; i++)
+		{
+			CSimpleObjectCacheAccessor ca(pcache);
+			ca.Lookup(&i);
+			SSimpleObject *pso = ca.Val();
+			GPOS_ASSERT_IMP(0 == i % 2, nullptr != pso && i == pso->m_ulValue);
+			GPOS_ASSERT_IMP(1 == i % 2, nullptr == pso);
+
+			if (nullptr != pso)
+			{
+				pso->Release();
+			}
+		}
+	}
+
+	GPOS_ASSERT(GPOS_CACHE_ELEMENTS / 2 == pcache->Size());
+
+	return GPOS_OK;
+}
+
 // EOF
@@ -41,7 +41,8 @@
 #include "utils/lsyscache.h"
 
 /* GPORCA entry point */
-extern PlannedStmt * GPOPTOptimizedPlan(Query *parse, bool *had_unexpected_failure);
+extern PlannedStmt * GPOPTOptimizedPlan(Query *parse, bool is_parallel_cursor,
+										 bool *had_unexpected_failure);
 
 static Plan *remove_redundant_results(PlannerInfo *root, Plan *plan);
 static Node *remove_redundant_results_mutator(Node *node, void *);
@@ -152,8 +153,13 @@ optimize_query(Query *parse, int cursorOptions, ParamListInfo boundParams)
 	 */
 	pqueryCopy = (Query *) transformGroupedWindows((Node *) pqueryCopy, NULL);
 
-	/* Ok, invoke ORCA. */
-	result = GPOPTOptimizedPlan(pqueryCopy, &fUnexpectedFailure);
+	/*
+	 * Ok, invoke ORCA. For a PARALLEL RETRIEVE CURSOR, the translator leaves
+	 * out the final Gather Motion, so that the endpoints run on the segments.
+	 */
+	result = GPOPTOptimizedPlan(pqueryCopy,
+								(cursorOptions & CURSOR_OPT_PARALLEL_RETRIEVE) != 0,
+								&fUnexpectedFailure);
 
 	log_optimizer(result, fUnexpectedFailure);
 
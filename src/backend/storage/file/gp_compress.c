@@ -16,6 +16,9 @@
 
 #include "postgres.h"
 
+#include <pthread.h>
+#include <signal.h>
+
 #include "catalog/pg_compression.h"
 #include "cdb/cdbappendonlystoragelayer.h"
 #include "storage/gp_compress.h"
@@ -116,6 +119,162 @@ void gp_decompress(
 			 bufferCount);
 }
 
+/*
+ * Helper threads for gp_decompress_parallel().
+ *
+ * The threads only ever call CompressionState->decompress_threadsafe, which
+ * does not touch any backend state. They are started on first use, up to
+ * gp_aocs_decompress_threads, and live as long as the backend does.
+ */
+#define MAX_DECOMPRESS_THREADS		64
+
+static struct
+{
+	pthread_mutex_t lock;
+	pthread_cond_t work_cv;		/* signalled when jobs are posted */
+	pthread_cond_t done_cv;		/* signalled when the last job is done */
+	int			nthreads;		/* number of threads started */
+	bool		failed;			/* could not start a thread, don't retry */
+
+	GpDecompressJob *jobs;		/* jobs being run, or NULL */
+	int			njobs;
+	int			nextjob;		/* next job to claim */
+	int			pending;		/* jobs not done yet */
+} decompress_pool = {
+	PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER
+};
+
+static void
+gp_decompress_job(GpDecompressJob *job)
+{
+	CompressionState *cs = job->compressionState;
+	int32		resultingUncompressedLen = 0;
+
+	if (job->compressed == NULL)
+		return;
+
+	job->ok = cs->decompress_threadsafe(cs,
+										job->compressed,
+										job->compressedLen,
+										job->uncompressed,
+										job->uncompressedLen,
+										&resultingUncompressedLen) &&
+		resultingUncompressedLen == job->uncompressedLen;
+}
+
+/*
+ * Run the posted jobs until there are none left to claim. Called, and
+ * returns, with the pool lock held.
+ */
+static void
+gp_decompress_run_jobs(void)
+{
+	while (decompress_pool.jobs != NULL &&
+		   decompress_pool.nextjob < decompress_pool.njobs)
+	{
+		GpDecompressJob *job = &decompress_pool.jobs[decompress_pool.nextjob++];
+
+		pthread_mutex_unlock(&decompress_pool.lock);
+		gp_decompress_job(job);
+		pthread_mutex_lock(&decompress_pool.lock);
+
+		if (--decompress_pool.pending == 0)
+			pthread_cond_signal(&decompress_pool.done_cv);
+	}
+}
+
+static void *
+gp_decompress_thread_main(void *arg)
+{
+	pthread_mutex_lock(&decompress_pool.lock);
+	for (;;)
+	{
+		gp_decompress_run_jobs();
+		pthread_cond_wait(&decompress_pool.work_cv, &decompress_pool.lock);
+	}
+
+	return NULL;
+}
+
+static void
+gp_decompress_start_threads(int nthreads)
+{
+	pthread_attr_t t_atts;
+	sigset_t	sigs;
+	sigset_t	old_sigs;
+	int			err = 0;
+
+	pthread_attr_init(&t_atts);
+	pthread_attr_setstacksize(&t_atts, Max(PTHREAD_STACK_MIN, (256 * 1024)));
+	pthread_attr_setdetachstate(&t_atts, PTHREAD_CREATE_DETACHED);
+
+	/* The threads must never run the backend's signal handlers */
+	sigfillset(&sigs);
+	pthread_sigmask(SIG_BLOCK, &sigs, &old_sigs);
+
+	while (decompress_pool.nthreads < nthreads)
+	{
+		pthread_t	thread;
+
+		err = pthread_create(&thread, &t_atts, gp_decompress_thread_main, NULL);
+		if (err != 0)
+			break;
+		decompress_pool.nthreads++;
+	}
+
+	pthread_sigmask(SIG_SETMASK, &old_sigs, NULL);
+	pthread_attr_destroy(&t_atts);
+
+	if (err != 0)
+	{
+		decompress_pool.failed = true;
+		ereport(LOG,
+				(errmsg("could not start decompression thread, using %d",
+						decompress_pool.nthreads),
+				 errdetail("pthread_create() failed with err %d", err)));
+	}
+}
+
+/*
+ * Decompress several blocks concurrently, on the calling thread and the
+ * helper threads. Each job must have a different CompressionState, with a
+ * decompress_threadsafe function.
+ *
+ * Errors are not reported here; see GpDecompressJob.
+ */
+void
+gp_decompress_parallel(GpDecompressJob *jobs, int njobs)
+{
+	int			nthreads = Min(gp_aocs_decompress_threads, MAX_DECOMPRESS_THREADS);
+
+	if (nthreads > decompress_pool.nthreads && !decompress_pool.failed)
+		gp_decompress_start_threads(nthreads);
+
+	if (decompress_pool.nthreads == 0 || njobs < 2)
+	{
+		for (int i = 0; i < njobs; i++)
+			gp_decompress_job(&jobs[i]);
+		return;
+	}
+
+	pthread_mutex_lock(&decompress_pool.lock);
+	Assert(decompress_pool.jobs == NULL);
+	decompress_pool.jobs = jobs;
+	decompress_pool.njobs = njobs;
+	decompress_pool.nextjob = 0;
+	decompress_pool.pending = njobs;
+	pthread_cond_broadcast(&decompress_pool.work_cv);
+
+	gp_decompress_run_jobs();
+	while (decompress_pool.pending > 0)
+		pthread_cond_wait(&decompress_pool.done_cv, &decompress_pool.lock);
+
+	decompress_pool.jobs = NULL;
+	decompress_pool.njobs = 0;
+	decompress_pool.nextjob = 0;
+	pthread_mutex_unlock(&decompress_pool.lock);
+}
+
 /*
  * Support for tracking ZSTD handles with resource owners.
  */
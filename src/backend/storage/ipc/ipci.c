@@ -69,6 +69,7 @@
 #include "utils/workfile_mgr.h"
 #include "utils/session_state.h"
 #include "cdb/cdbendpoint.h"
+#include "cdb/cdbdisp_stats.h"
 #include "replication/gp_replication.h"
 
 /* GUCs */
@@ -227,6 +228,9 @@ CreateSharedMemoryAndSemaphores(int port)
 		/* size of parallel cursor count */
 		size = add_size(size, ParallelCursorCountSize());
 
+		/* size of dispatch latency histograms */
+		size = add_size(size, DispatchStatsShmemSize());
+
 		elog(DEBUG3, "invoking IpcMemoryCreate(size=%zu)", size);
 
 		/*
@@ -397,6 +401,8 @@ CreateSharedMemoryAndSemaphores(int port)
 	if (Gp_role == GP_ROLE_DISPATCH)
 		ParallelCursorCountInit();
 
+	DispatchStatsShmemInit();
+
 	/*
 	 * Now give loadable modules a chance to set up their shmem allocations
 	 */
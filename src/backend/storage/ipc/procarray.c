@@ -430,6 +430,7 @@ ProcArrayEndGxact(TMGXACT *tmGxact)
 	tmGxact->xminDistributedSnapshot = InvalidDistributedTransactionId;
 	tmGxact->includeInCkpt = false;
 	tmGxact->sessionId = 0;
+	tmGxact->commitPending = false;
 
 	/*
 	 * Remeber that the distributed xid is just a plain counter, so we just use the `<` for
@@ -1682,6 +1683,8 @@ SnapshotResetDslm(Snapshot snapshot)
 	dslm->currentLocalXidsCount = 0;
 	dslm->minCachedLocalXid = InvalidTransactionId;
 	dslm->maxCachedLocalXid = InvalidTransactionId;
+	dslm->inProgressBitmapWords = 0;
+	dslm->localXidHashMask = 0;
 	if (dslm->inProgressMappedLocalXids == NULL)
 	{
 		dslm->inProgressMappedLocalXids =
@@ -1691,6 +1694,19 @@ SnapshotResetDslm(Snapshot snapshot)
 					(errcode(ERRCODE_OUT_OF_MEMORY),
 					 errmsg("out of memory")));
 	}
+	if (dslm->inProgressBitmap == NULL)
+	{
+		int			maxcount = GetMaxSnapshotDistributedXidCount();
+
+		dslm->inProgressBitmap = (uint64 *)
+			malloc(DistributedSnapshot_MaxBitmapWords(maxcount) * sizeof(uint64));
+		dslm->localXidHash = (TransactionId *)
+			malloc(DistributedSnapshot_LocalXidHashSlots(maxcount) * sizeof(TransactionId));
+		if (dslm->inProgressBitmap == NULL || dslm->localXidHash == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory")));
+	}
 
 	DistributedSnapshot_Reset(&dslm->ds);
 }
@@ -2250,6 +2266,7 @@ GetSnapshotData(Snapshot snapshot, DtxContext distributedTransactionContext)
 		!Debug_disable_distributed_snapshot)
 	{
 		DistributedSnapshot_Copy(&snapshot->distribSnapshotWithLocalMapping.ds, &QEDtxContextInfo.distributedSnapshot);
+		DistributedSnapshotWithLocalMapping_BuildLookup(&snapshot->distribSnapshotWithLocalMapping);
 		snapshot->haveDistribSnapshot = true;
 	}
 
@@ -3670,6 +3687,35 @@ MinimumActiveBackends(int min)
 	return count >= min;
 }
 
+/*
+ * DistributedCommitsPending --- are other backends about to write a
+ * distributed commit record?
+ *
+ * Like MinimumActiveBackends(), this doesn't take ProcArrayLock, since the
+ * result is only used as a heuristic for group commit.
+ */
+bool
+DistributedCommitsPending(void)
+{
+	ProcArrayStruct *arrayP = procArray;
+	int			index;
+
+	for (index = 0; index < arrayP->numProcs; index++)
+	{
+		int			pgprocno = arrayP->pgprocnos[index];
+		volatile TMGXACT *tmGxact;
+
+		if (pgprocno == -1 || pgprocno == MyProc->pgprocno)
+			continue;
+
+		tmGxact = &allTmGxact[pgprocno];
+		if (tmGxact->commitPending)
+			return true;
+	}
+
+	return false;
+}
+
 /*
  * CountDBBackends --- count backends that are using specified database
  */
@@ -94,6 +94,7 @@
 #include "cdb/cdbtm.h"
 #include "cdb/cdbdtxcontextinfo.h"
 #include "cdb/cdbdisp_query.h"
+#include "cdb/cdbdisp_plancache.h"
 #include "cdb/cdbdispatchresult.h"
 #include "cdb/cdbendpoint.h"
 #include "cdb/cdbgang.h"
@@ -1120,6 +1121,7 @@ pg_plan_queries(List *querytrees, int cursorOptions, ParamListInfo boundParams)
  * query_string -- optional query text (C string).
  * serializedPlantree[len] -- PlannedStmt node, or (NULL,0) if query provided.
  * serializedQueryDispatchDesc[len] -- QueryDispatchDesc node, or (NULL,0) if query provided.
+ * planKey -- if not NULL, the plan is in the QE plan cache under this key.
  *
  * Caller may supply either a Query (representing utility command) or
  * a PlannedStmt (representing a planned DML command), but not both.
@@ -1127,7 +1129,8 @@ pg_plan_queries(List *querytrees, int cursorOptions, ParamListInfo boundParams)
 static void
 exec_mpp_query(const char *query_string,
 			   const char * serializedPlantree, int serializedPlantreelen,
-			   const char * serializedQueryDispatchDesc, int serializedQueryDispatchDesclen)
+			   const char * serializedQueryDispatchDesc, int serializedQueryDispatchDesclen,
+			   const DispatchPlanKey *planKey)
 {
 	CommandDest dest = whereToSendOutput;
 	MemoryContext oldcontext;
@@ -1189,8 +1192,19 @@ exec_mpp_query(const char *query_string,
 
  	/*
      * Deserialize the query execution plan (a PlannedStmt node), if there is one.
+     *
+     * A cached plan is shared with later executions, and the executor
+     * treats the plan tree as read-only, like with a plan from the plancache.
+     * Only the top node and the range table are modified here and by the
+     * executor, so make a copy of the top node here, and of the range table
+     * below, before modifying it.
      */
-	if (serializedPlantree != NULL && serializedPlantreelen > 0)
+	if (planKey != NULL)
+	{
+		plan = palloc(sizeof(PlannedStmt));
+		memcpy(plan, QEPlanCacheGetPlan(planKey), sizeof(PlannedStmt));
+	}
+	else if (serializedPlantree != NULL && serializedPlantreelen > 0)
 	{
 		plan = (PlannedStmt *) deserializeNode(serializedPlantree,serializedPlantreelen);
 		if (!plan || !IsA(plan, PlannedStmt))
@@ -1262,6 +1276,9 @@ exec_mpp_query(const char *query_string,
 			RangeTblEntry  *rte;
 			AclMode         removeperms = ACL_INSERT | ACL_UPDATE | ACL_DELETE | ACL_SELECT_FOR_UPDATE;
 
+			if (planKey != NULL)
+				plan->rtable = copyObject(plan->rtable);
+
 			/* Just reading, so don't check INS/DEL/UPD permissions. */
 			foreach(rtcell, plan->rtable)
 			{
@@ -5400,6 +5417,8 @@ PostgresMain(int argc, char *argv[],
 					int serializedPlantreelen = 0;
 					int serializedQueryDispatchDesclen = 0;
 					int resgroupInfoLen = 0;
+					DispatchPlanKey planKey;
+					int planCacheSize;
 					TimestampTz statementStart;
 					Oid suid;
 					Oid ouid;
@@ -5492,8 +5511,36 @@ PostgresMain(int argc, char *argv[],
 						SetTempNamespaceStateAfterBoot(tempNamespaceId, tempToastNamespaceId);
 					}
 
+					planKey.fingerprint = (uint64) pq_getmsgint64(&input_message);
+					planKey.crc = (uint32) pq_getmsgint(&input_message, 4);
+					planKey.len = pq_getmsgint(&input_message, 4);
+					planCacheSize = pq_getmsgint(&input_message, 4);
+
 					pq_getmsgend(&input_message);
 
+					/*
+					 * Keep the plan cache in step with the QD's idea of it
+					 * before anything else can fail.
+					 */
+					if (planKey.fingerprint != 0)
+					{
+						serializedPlantree = QEPlanCacheReceive(&planKey, planCacheSize,
+																serializedPlantree,
+																&serializedPlantreelen);
+
+						/*
+						 * If we don't have the plan after all, ask the QD to
+						 * send the query again with the plan in full, and go
+						 * wait for it.  What's been done with this message so
+						 * far is just done again then.
+						 */
+						if (serializedPlantree == NULL)
+						{
+							QEPlanCacheRequestPlan(&planKey);
+							break;
+						}
+					}
+
 					elog((Debug_print_full_dtm ? LOG : DEBUG5), "MPP dispatched stmt from QD: %s.",query_string);
 
 					if (IsResGroupActivated() && resgroupInfoLen > 0)
@@ -5546,7 +5593,8 @@ PostgresMain(int argc, char *argv[],
 					else
 						exec_mpp_query(query_string,
 									   serializedPlantree, serializedPlantreelen,
-									   serializedQueryDispatchDesc, serializedQueryDispatchDesclen);
+									   serializedQueryDispatchDesc, serializedQueryDispatchDesclen,
+									   planKey.fingerprint != 0 ? &planKey : NULL);
 
 					SetUserIdAndSecContext(GetOuterUserId(), 0);
 
@@ -2305,12 +2305,14 @@ in_range_numeric_numeric(PG_FUNCTION_ARGS)
 	PG_RETURN_BOOL(result);
 }
 
-Datum
-hash_numeric(PG_FUNCTION_ARGS)
+/*
+ * Hash a numeric value. This is the body of hash_numeric(), for callers
+ * that hash many values and don't want to go through fmgr, like cdbhash().
+ */
+uint32
+numeric_hash_value(Numeric key)
 {
-	Numeric		key = PG_GETARG_NUMERIC(0);
-	Datum		digit_hash;
-	Datum		result;
+	uint32		digit_hash;
 	int			weight;
 	int			start_offset;
 	int			end_offset;
@@ -2320,7 +2322,7 @@ hash_numeric(PG_FUNCTION_ARGS)
 
 	/* If it's NaN, don't try to hash the rest of the fields */
 	if (NUMERIC_IS_NAN(key))
-		PG_RETURN_UINT32(0);
+		return 0;
 
 	weight = NUMERIC_WEIGHT(key);
 	start_offset = 0;
@@ -2352,7 +2354,7 @@ hash_numeric(PG_FUNCTION_ARGS)
 	 * regardless of any other fields.
 	 */
 	if (NUMERIC_NDIGITS(key) == start_offset)
-		PG_RETURN_UINT32(-1);
+		return (uint32) -1;
 
 	for (i = NUMERIC_NDIGITS(key) - 1; i >= 0; i--)
 	{
@@ -2372,13 +2374,19 @@ hash_numeric(PG_FUNCTION_ARGS)
 	 * this shouldn't affect correctness.
 	 */
 	hash_len = NUMERIC_NDIGITS(key) - start_offset - end_offset;
-	digit_hash = hash_any((unsigned char *) (NUMERIC_DIGITS(key) + start_offset),
-						  hash_len * sizeof(NumericDigit));
+	digit_hash = DatumGetUInt32(hash_any((unsigned char *) (NUMERIC_DIGITS(key) + start_offset),
+										 hash_len * sizeof(NumericDigit)));
 
 	/* Mix in the weight, via XOR */
-	result = digit_hash ^ weight;
+	return digit_hash ^ (uint32) weight;
+}
 
-	PG_RETURN_DATUM(result);
+Datum
+hash_numeric(PG_FUNCTION_ARGS)
+{
+	Numeric		key = PG_GETARG_NUMERIC(0);
+
+	PG_RETURN_UINT32(numeric_hash_value(key));
 }
 
 /*
@@ -303,7 +303,17 @@ datumstreamwrite_put(
 					 bool null,
 					 void **toFree)
 {
-	return DatumStreamBlockWrite_Put(&acc->blockWrite, d, null, toFree);
+	int			result;
+
+	result = DatumStreamBlockWrite_Put(&acc->blockWrite, d, null, toFree);
+
+	/* A negative result means the block is full and the datum was not put */
+	if (result >= 0 && OidIsValid(acc->zoneMapTypid))
+		AppendOnlyZoneMap_Add(&acc->zoneMap,
+							  null ? 0 : AppendOnlyZoneMap_DatumToInt64(acc->zoneMapTypid, d),
+							  null);
+
+	return result;
 }
 
 int
@@ -567,6 +577,14 @@ create_datumstreamwrite(
 	acc->ao_write.verifyWriteCompressionState = verifyBlockCompressionState;
 	acc->title = title;
 
+	if (OidIsValid(AppendOnlyZoneMap_TypeDomain(attr->atttypid)))
+	{
+		acc->zoneMapTypid = attr->atttypid;
+		AppendOnlyZoneMap_Reset(&acc->zoneMap);
+	}
+	else
+		acc->zoneMapTypid = InvalidOid;
+
 	/*
 	 * Temporarily set the firstRowNum for the block so that we can
 	 * calculate the correct header length.
@@ -992,13 +1010,17 @@ datumstreamwrite_block(DatumStreamWrite *acc,
 			/* Never reaches here. */
 	}
 
-	/* Insert an entry to the block directory */
-	AppendOnlyBlockDirectory_InsertEntry(
+	/* Insert an entry, with the zone map of the block, to the block directory */
+	AppendOnlyBlockDirectory_InsertEntryWithZoneMap(
 		blockDirectory,
 		columnGroupNo,
 		acc->blockFirstRowNum,
 		AppendOnlyStorageWrite_LogicalBlockStartOffset(&acc->ao_write),
-		itemCount);
+		itemCount,
+		OidIsValid(acc->zoneMapTypid) ? &acc->zoneMap : NULL);
+
+	if (OidIsValid(acc->zoneMapTypid))
+		AppendOnlyZoneMap_Reset(&acc->zoneMap);
 
 	return writesz;
 }
@@ -1158,6 +1180,32 @@ datumstreamread_block_get_ready(DatumStreamRead * acc)
 	}
 }
 
+/*
+ * Make sure large_object_buffer can hold the current block's content.
+ */
+static void
+datumstreamread_alloc_content_buffer(DatumStreamRead * acc)
+{
+	if (acc->large_object_buffer_size < acc->getBlockInfo.contentLen)
+	{
+		MemoryContext oldCtxt;
+
+		oldCtxt = MemoryContextSwitchTo(acc->memctxt);
+
+		if (acc->large_object_buffer)
+		{
+			pfree(acc->large_object_buffer);
+			acc->large_object_buffer = NULL;
+
+			SIMPLE_FAULT_INJECTOR("malloc_failure");
+		}
+
+		acc->large_object_buffer_size = acc->getBlockInfo.contentLen;
+		acc->large_object_buffer = palloc(acc->getBlockInfo.contentLen);
+		MemoryContextSwitchTo(oldCtxt);
+	}
+}
+
 void
 datumstreamread_block_content(DatumStreamRead * acc)
 {
@@ -1180,24 +1228,7 @@ datumstreamread_block_content(DatumStreamRead * acc)
 		if (acc->getBlockInfo.isCompressed)
 		{
 			/* Compressed, need to decompress to our own buffer.  */
-			if (acc->large_object_buffer_size < acc->getBlockInfo.contentLen)
-			{
-				MemoryContext oldCtxt;
-
-				oldCtxt = MemoryContextSwitchTo(acc->memctxt);
-
-				if (acc->large_object_buffer)
-				{
-					pfree(acc->large_object_buffer);
-					acc->large_object_buffer = NULL;
-
-					SIMPLE_FAULT_INJECTOR("malloc_failure");
-				}
-
-				acc->large_object_buffer_size = acc->getBlockInfo.contentLen;
-				acc->large_object_buffer = palloc(acc->getBlockInfo.contentLen);
-				MemoryContextSwitchTo(oldCtxt);
-			}
+			datumstreamread_alloc_content_buffer(acc);
 
 			AppendOnlyStorageRead_Content(
 										  &acc->ao_read,
@@ -1282,10 +1313,11 @@ datumstreamread_block_content(DatumStreamRead * acc)
 }
 
 
-int
-datumstreamread_block(DatumStreamRead * acc,
-					  AppendOnlyBlockDirectory *blockDirectory,
-					  int colGroupNo)
+/*
+ * Read the header of the next block. Returns false at the end of the file.
+ */
+static bool
+datumstreamread_block_header(DatumStreamRead * acc)
 {
 	bool		readOK = false;
 
@@ -1301,7 +1333,7 @@ datumstreamread_block(DatumStreamRead * acc,
 												&acc->getBlockInfo.isLarge,
 											&acc->getBlockInfo.isCompressed);
 	if (!readOK)
-		return -1;
+		return false;
 
 	if (Debug_appendonly_print_datumstream)
 		elog(LOG,
@@ -1343,18 +1375,149 @@ datumstreamread_block(DatumStreamRead * acc,
 			 acc->blockFileOffset,
 			 acc->blockRowCount);
 
+	return true;
+}
+
+/*
+ * Insert the block that was just read into the block directory, for a scan
+ * that builds it, as CREATE INDEX does. For column types that keep zone maps,
+ * the zone map of the block is computed by going through its values once,
+ * and the block is then rewound for the scan. This gives the block the same
+ * zone map as if it had been written with the block directory in place.
+ */
+static void
+datumstreamread_block_insert_entry(DatumStreamRead * acc,
+								   AppendOnlyBlockDirectory *blockDirectory,
+								   int colGroupNo)
+{
+	Oid			typid = (Oid) acc->typeInfo.typid;
+	MinipageZoneMapEntry zone;
+	MinipageZoneMapEntry *zonep = NULL;
+
+	if (acc->getBlockInfo.execBlockKind == AOCSBK_BLOCK &&
+		OidIsValid(AppendOnlyZoneMap_TypeDomain(typid)))
+	{
+		AppendOnlyZoneMap_Reset(&zone);
+		while (datumstreamread_advance(acc))
+		{
+			Datum		d;
+			bool		null;
+
+			datumstreamread_get(acc, &d, &null);
+			AppendOnlyZoneMap_Add(&zone,
+								  null ? 0 : AppendOnlyZoneMap_DatumToInt64(typid, d),
+								  null);
+		}
+		datumstreamread_rewind_block(acc);
+		zonep = &zone;
+	}
+
+	AppendOnlyBlockDirectory_InsertEntryWithZoneMap(blockDirectory,
+													colGroupNo,
+													acc->blockFirstRowNum,
+													acc->blockFileOffset,
+													acc->blockRowCount,
+													zonep);
+}
+
+int
+datumstreamread_block(DatumStreamRead * acc,
+					  AppendOnlyBlockDirectory *blockDirectory,
+					  int colGroupNo)
+{
+	if (!datumstreamread_block_header(acc))
+		return -1;
+
 	datumstreamread_block_content(acc);
 
 	if (blockDirectory)
+		datumstreamread_block_insert_entry(acc, blockDirectory, colGroupNo);
+
+	return 0;
+}
+
+/*
+ * datumstreamread_block(), split in two halves so that the blocks of several
+ * columns can be decompressed concurrently in between.
+ *
+ * datumstreamread_block_begin() reads the header of the next block. If its
+ * content is compressed with a codec that can decompress on a helper thread,
+ * it fills in 'job' and returns 1; the caller then runs the job with
+ * gp_decompress_parallel(). Otherwise it reads the content right away and
+ * returns 0. Returns -1 at the end of the file.
+ *
+ * datumstreamread_block_end() finishes reading the block in both cases.
+ */
+int
+datumstreamread_block_begin(DatumStreamRead * acc, GpDecompressJob *job)
+{
+	CompressionState *cs = acc->ao_read.compressionState;
+
+	job->compressed = NULL;
+
+	if (!datumstreamread_block_header(acc))
+		return -1;
+
+	if (acc->getBlockInfo.execBlockKind != AOCSBK_BLOCK ||
+		!acc->getBlockInfo.isCompressed ||
+		cs == NULL || cs->decompress_threadsafe == NULL)
 	{
-		AppendOnlyBlockDirectory_InsertEntry(blockDirectory,
-											 colGroupNo,
-											 acc->blockFirstRowNum,
-											 acc->blockFileOffset,
-											 acc->blockRowCount);
+		datumstreamread_block_content(acc);
+		return 0;
 	}
 
-	return 0;
+	Assert(!acc->getBlockInfo.isLarge);
+
+	/*
+	 * The helper threads bypass zlib_decompress(), and cannot run fault
+	 * injectors themselves. Hit its fault point here instead, before the job
+	 * is handed out.
+	 */
+	if (strcmp(acc->ao_attr.compressType, "zlib") == 0)
+		SIMPLE_FAULT_INJECTOR("zlib_decompress_after_decompress_fn");
+
+	/* See datumstreamread_block_content() */
+	DatumStreamBlockRead_Reset(&acc->blockRead);
+	acc->largeObjectState = DatumStreamLargeObjectState_None;
+	datumstreamread_alloc_content_buffer(acc);
+
+	job->compressionState = cs;
+	job->compressed = AppendOnlyStorageRead_GetCompressedBuffer(&acc->ao_read,
+																&job->compressedLen);
+	job->uncompressed = (uint8 *) acc->large_object_buffer;
+	job->uncompressedLen = acc->getBlockInfo.contentLen;
+	job->ok = false;
+
+	return 1;
+}
+
+void
+datumstreamread_block_end(DatumStreamRead * acc,
+						  AppendOnlyBlockDirectory *blockDirectory,
+						  int colGroupNo,
+						  GpDecompressJob *job)
+{
+	if (job->compressed != NULL)
+	{
+		/*
+		 * If the job failed, decompress once more on this thread, to report
+		 * the error.
+		 */
+		if (!job->ok)
+			gp_decompress(job->compressed,
+						  job->compressedLen,
+						  job->uncompressed,
+						  job->uncompressedLen,
+						  acc->ao_read.compression_functions[COMPRESSION_DECOMPRESS],
+						  acc->ao_read.compressionState,
+						  acc->ao_read.bufferCount);
+
+		acc->buffer_beginp = acc->large_object_buffer;
+		datumstreamread_block_get_ready(acc);
+	}
+
+	if (blockDirectory)
+		datumstreamread_block_insert_entry(acc, blockDirectory, colGroupNo);
 }
 
 void
@@ -1058,3 +1058,14 @@ bool_t fstream_is_win_pipe(fstream_t *fs)
 	return fs->fd.is_win_pipe;
 }
 
+/* the files of the stream, after expanding wildcards and directories */
+int fstream_get_file_count(fstream_t *fs)
+{
+	return fs->glob.gl_pathc;
+}
+
+const char* fstream_get_file_name(fstream_t *fs, int i)
+{
+	return fs->glob.gl_pathv[i];
+}
+
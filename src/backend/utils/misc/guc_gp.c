@@ -32,6 +32,7 @@
 #include "cdb/cdbsreh.h"
 #include "cdb/cdbvars.h"
 #include "cdb/memquota.h"
+#include "cdb/tupcolbatch.h"
 #include "commands/defrem.h"
 #include "commands/vacuum.h"
 #include "miscadmin.h"
@@ -80,6 +81,7 @@ static bool check_optimizer(bool *newval, void **extra, GucSource source);
 static bool check_verify_gpfdists_cert(bool *newval, void **extra, GucSource source);
 static bool check_dispatch_log_stats(bool *newval, void **extra, GucSource source);
 static bool check_gp_workfile_compression(bool *newval, void **extra, GucSource source);
+static bool check_gp_interconnect_compression(bool *newval, void **extra, GucSource source);
 
 /* Helper function for guc setter */
 bool gpvars_check_gp_resqueue_priority_default_value(char **newval,
@@ -140,7 +142,15 @@ int			gp_max_local_distributed_cache = 1024;
 bool		gp_appendonly_verify_block_checksums = true;
 bool		gp_appendonly_verify_write_block = false;
 bool		gp_appendonly_compaction = true;
+bool		gp_enable_aocs_zonemap_skipping = true;
+bool		gp_aocs_build_zonemaps = false;
+bool		gp_enable_aocs_batch_scan = false;
+bool		gp_enable_runtime_filter_pushdown = false;
+bool		gp_enable_hashagg_passthrough = false;
+double		gp_hashagg_passthrough_ratio = 0.9;
 int			gp_appendonly_compaction_threshold = 0;
+int			gp_appendonly_prefetch_size = 4096;
+int			gp_aocs_decompress_threads = 0;
 bool		gp_heap_require_relhasoids_match = true;
 bool		gp_local_distributed_cache_stats = false;
 bool		debug_xlog_record_read = false;
@@ -156,6 +166,7 @@ bool		gp_create_table_random_default_distribution = true;
 bool		gp_allow_non_uniform_partitioning_ddl = true;
 bool		gp_print_create_gang_time = false;
 int			dtx_phase2_retry_second = 0;
+int			dtx_group_commit_delay = 0;
 
 bool gp_log_suboverflow_statement = false;
 
@@ -274,6 +285,7 @@ int			optimizer_minidump;
 int			optimizer_cost_model;
 bool		optimizer_metadata_caching;
 int			optimizer_mdcache_size;
+bool		optimizer_mdcache_selective_eviction;
 bool		optimizer_use_gpdb_allocators;
 
 /* Optimizer debugging GUCs */
@@ -429,6 +441,7 @@ bool		gp_external_enable_filter_pushdown = true;
 bool		gp_enable_global_deadlock_detector = false;
 
 bool		gp_log_endpoints = false;
+int			gp_endpoint_batch_size = 32;
 
 /* optional reject to  parse ambigous 5-digits date in YYYMMDD format */
 bool		gp_allow_date_field_width_5digits = false;
@@ -644,6 +657,16 @@ struct config_bool ConfigureNamesBool_gp[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"gp_enable_qe_plan_cache", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Let segment workers cache dispatched plans."),
+			gettext_noop("A plan that a segment worker has already seen is dispatched "
+						 "as a fingerprint only, instead of in full.")
+		},
+		&gp_enable_qe_plan_cache,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		{"gp_enable_predicate_propagation", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("When two expressions are equivalent (such as with "
@@ -897,6 +920,74 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_enable_aocs_zonemap_skipping", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Skip append-optimized column-oriented blocks whose zone maps rule out the scan's qual."),
+			gettext_noop("Zone maps are recorded in the block directory, which exists once the table has an index "
+						 "or when it was created with gp_aocs_build_zonemaps on."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_enable_aocs_zonemap_skipping,
+		true,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_aocs_build_zonemaps", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Build the block directory of new append-optimized column-oriented tables, so that they keep zone maps without an index."),
+			gettext_noop("An existing table gets one when it is rewritten with this on, e.g. by ALTER TABLE SET WITH (reorganize=true). "
+						 "A table that is indexed for the first time gets one regardless."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_aocs_build_zonemaps,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_enable_aocs_batch_scan", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Scan append-optimized column-oriented tables a batch of rows at a time."),
+			gettext_noop("Sequential scans decode each column into arrays and evaluate simple quals over them before forming tuples."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_enable_aocs_batch_scan,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_enable_runtime_filter_pushdown", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Push runtime join filters down from hash joins to the scans on their outer side."),
+			gettext_noop("The filters hold a Bloom filter and the key range of the inner rows, and let the scans drop the rows that cannot be joined."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_enable_runtime_filter_pushdown,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_enable_hybrid_hashjoin", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Keep as many hash join batches in memory as fit, and split only the batches that overflow."),
+			gettext_noop("When the hash table outgrows its memory, the largest batches are spilled to workfiles first, and a batch that is still too big is split in two instead of doubling the number of batches."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_enable_hybrid_hashjoin,
+		false,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_enable_hashagg_passthrough", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Let streaming hash aggregates pass rows through when hashing them barely reduces them."),
+			gettext_noop("The rows then go to the next aggregation stage with their own transition states, without a hash table lookup. The planner also makes the first stage of a hashed multi-stage aggregate streaming."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_enable_hashagg_passthrough,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_heap_require_relhasoids_match", PGC_USERSET, DEVELOPER_OPTIONS,
 			gettext_noop("Issue an error on discovery of a mismatch between relhasoids and a tuple header."),
@@ -1026,6 +1117,16 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_interconnect_compression", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Compress interconnect packets before sending them."),
+			NULL
+		},
+		&gp_interconnect_compression,
+		false,
+		check_gp_interconnect_compression, NULL, NULL
+	},
+
 	{
 		{"gp_interconnect_log_stats", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("Emit statistics from the UDP-IC at the end of every statement."),
@@ -1887,6 +1988,16 @@ struct config_bool ConfigureNamesBool_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"optimizer_mdcache_selective_eviction", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("On catalog changes, evict only the affected metadata from the optimizer's metadata cache instead of resetting it."),
+			NULL
+		},
+		&optimizer_mdcache_selective_eviction,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"optimizer_print_missing_stats", PGC_USERSET, LOGGING_WHAT,
 			gettext_noop("Print columns with missing statistics."),
@@ -3120,6 +3231,16 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_qe_plan_cache_size", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the number of dispatched plans each segment worker caches."),
+			gettext_noop("Only used when gp_enable_qe_plan_cache is on.")
+		},
+		&gp_qe_plan_cache_size,
+		64, 1, 1024,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_max_plan_size", PGC_SUSET, RESOURCES_MEM,
 			gettext_noop("Sets the maximum size of a plan to be dispatched."),
@@ -3142,6 +3263,31 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_appendonly_prefetch_size", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Sets how much of an append-only segment file is read ahead during sequential reads."),
+			gettext_noop("The kernel is asked to read this much past the current read position, "
+						 "so that the disk works on it while the current blocks are processed. "
+						 "0 disables read-ahead."),
+			GUC_UNIT_KB | GUC_NOT_IN_SAMPLE
+		},
+		&gp_appendonly_prefetch_size,
+		4096, 0, 1024 * 1024,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_aocs_decompress_threads", PGC_USERSET, APPENDONLY_TABLES,
+			gettext_noop("Sets the number of helper threads that decompress append-optimized column-oriented blocks."),
+			gettext_noop("The blocks of different columns that a scan reads at the same row are decompressed "
+						 "concurrently. Only zlib and zstd compressed blocks are supported. 0 disables it."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_aocs_decompress_threads,
+		0, 0, 64,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_workfile_max_entries", PGC_POSTMASTER, RESOURCES,
 			gettext_noop("Sets the maximum number of entries that can be stored in the workfile directory"),
@@ -3731,6 +3877,29 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_motion_hash_batch_size", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the number of tuples a redistribute motion hashes at a time."),
+			gettext_noop("Batched tuples are copied into buffer slots, unless they are on a heap page. "
+						 "Tuples are hashed one at a time if set to 0 or 1."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_motion_hash_batch_size,
+		0, 0, 1024,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"gp_motion_columnar_batch_size", PGC_USERSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the number of tuples a motion sends at a time, as a columnar batch."),
+			gettext_noop("Tuples are sent one at a time if set to 0."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_motion_columnar_batch_size,
+		0, 0, COLUMNAR_BATCH_MAX_TUPLES,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_reject_percent_threshold", PGC_USERSET, GP_ERROR_HANDLING,
 			gettext_noop("Reject limit in percent starts calculating after this number of rows processed"),
@@ -4132,6 +4301,20 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"dtx_group_commit_delay", PGC_SUSET, GP_ARRAY_TUNING,
+			gettext_noop("Sets the longest time in microseconds a distributed commit "
+						 "waits for other prepared distributed transactions to "
+						 "write their commit records, to flush them all at once."),
+			gettext_noop("Zero disables the wait."),
+			GUC_NOT_IN_SAMPLE | GUC_NO_SHOW_ALL
+			/* we have no microseconds designation, so can't supply units here */
+		},
+		&dtx_group_commit_delay,
+		0, 0, 100000,
+		NULL, NULL, NULL
+	},
+
 
 	{
 		/* Can't be set in postgresql.conf */
@@ -4190,6 +4373,17 @@ struct config_int ConfigureNamesInt_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_endpoint_batch_size", PGC_USERSET, RESOURCES_MEM,
+			gettext_noop("Sets the size of the batches in which a PARALLEL RETRIEVE CURSOR endpoint sends tuples to the retrieve session."),
+			gettext_noop("Zero sends each tuple by itself."),
+			GUC_UNIT_KB | GUC_NOT_IN_SAMPLE
+		},
+		&gp_endpoint_batch_size,
+		32, 0, MAX_ENDPOINT_BATCH_SIZE,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"gp_max_parallel_cursors", PGC_SUSET, RESOURCES,
 			gettext_noop("Parallel cursor concurrency control, -1 means no limit, which is the default"),
@@ -4262,6 +4456,17 @@ struct config_real ConfigureNamesReal_gp[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"gp_hashagg_passthrough_ratio", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Sets the ratio of groups to input rows at which a streaming hash aggregate passes rows through."),
+			gettext_noop("1.0 means only when every input row is a group of its own."),
+			GUC_NOT_IN_SAMPLE
+		},
+		&gp_hashagg_passthrough_ratio,
+		0.9, 0.0, 1.0,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"optimizer_damping_factor_filter", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("select predicate damping factor in optimizer, 1.0 means no damping"),
@@ -5135,6 +5340,19 @@ check_gp_workfile_compression(bool *newval, void **extra, GucSource source)
 	return true;
 }
 
+static bool
+check_gp_interconnect_compression(bool *newval, void **extra, GucSource source)
+{
+#ifndef USE_ZSTD
+	if (*newval)
+	{
+		GUC_check_errmsg("interconnect compression is not supported by this build");
+		return false;
+	}
+#endif
+	return true;
+}
+
 void
 DispatchSyncPGVariable(struct config_generic * gconfig)
 {
@@ -667,6 +667,7 @@ SetTransactionSnapshot(Snapshot sourcesnap, VirtualTransactionId *sourcevxid,
 		CurrentSnapshot->haveDistribSnapshot = true;
 		DistributedSnapshot_Copy(&CurrentSnapshot->distribSnapshotWithLocalMapping.ds,
 								 &sourcesnap->distribSnapshotWithLocalMapping.ds);
+		DistributedSnapshotWithLocalMapping_BuildLookup(&CurrentSnapshot->distribSnapshotWithLocalMapping);
 	}
 	/* NB: curcid should NOT be copied, it's a local matter */
 
@@ -731,6 +732,8 @@ CopySnapshot(Snapshot snapshot)
 	Size		subxipoff;
 	Size		dsoff = 0;
 	Size		dslmoff = 0;
+	Size		bitmapoff = 0;
+	Size		hashoff = 0;
 	Size		size;
 
 	Assert(snapshot != InvalidSnapshot);
@@ -753,6 +756,15 @@ CopySnapshot(Snapshot snapshot)
 		dslmoff = size;
 		size += snapshot->distribSnapshotWithLocalMapping.ds.count *
 			sizeof(TransactionId);
+
+		/* the lookup bitmap and hash, if the snapshot has them */
+		size = bitmapoff = MAXALIGN(size);
+		size += snapshot->distribSnapshotWithLocalMapping.inProgressBitmapWords *
+			sizeof(uint64);
+		hashoff = size;
+		if (snapshot->distribSnapshotWithLocalMapping.localXidHashMask != 0)
+			size += (snapshot->distribSnapshotWithLocalMapping.localXidHashMask + 1) *
+				sizeof(TransactionId);
 	}
 
 	newsnap = (Snapshot) MemoryContextAlloc(TopTransactionContext, size);
@@ -790,6 +802,10 @@ CopySnapshot(Snapshot snapshot)
 
 	newsnap->distribSnapshotWithLocalMapping.ds.inProgressXidArray = NULL;
 	newsnap->distribSnapshotWithLocalMapping.inProgressMappedLocalXids = NULL;
+	newsnap->distribSnapshotWithLocalMapping.inProgressBitmap = NULL;
+	newsnap->distribSnapshotWithLocalMapping.inProgressBitmapWords = 0;
+	newsnap->distribSnapshotWithLocalMapping.localXidHash = NULL;
+	newsnap->distribSnapshotWithLocalMapping.localXidHashMask = 0;
 	if (snapshot->haveDistribSnapshot &&
 		snapshot->distribSnapshotWithLocalMapping.ds.count > 0)
 	{
@@ -813,6 +829,30 @@ CopySnapshot(Snapshot snapshot)
 					snapshot->distribSnapshotWithLocalMapping.currentLocalXidsCount *
 					sizeof(TransactionId));
 		}
+
+		if (snapshot->distribSnapshotWithLocalMapping.inProgressBitmapWords > 0)
+		{
+			newsnap->distribSnapshotWithLocalMapping.inProgressBitmap =
+				(uint64 *) ((char *) newsnap + bitmapoff);
+			newsnap->distribSnapshotWithLocalMapping.inProgressBitmapWords =
+				snapshot->distribSnapshotWithLocalMapping.inProgressBitmapWords;
+			memcpy(newsnap->distribSnapshotWithLocalMapping.inProgressBitmap,
+				   snapshot->distribSnapshotWithLocalMapping.inProgressBitmap,
+				   snapshot->distribSnapshotWithLocalMapping.inProgressBitmapWords *
+				   sizeof(uint64));
+		}
+
+		if (snapshot->distribSnapshotWithLocalMapping.localXidHashMask != 0)
+		{
+			newsnap->distribSnapshotWithLocalMapping.localXidHash =
+				(TransactionId *) ((char *) newsnap + hashoff);
+			newsnap->distribSnapshotWithLocalMapping.localXidHashMask =
+				snapshot->distribSnapshotWithLocalMapping.localXidHashMask;
+			memcpy(newsnap->distribSnapshotWithLocalMapping.localXidHash,
+				   snapshot->distribSnapshotWithLocalMapping.localXidHash,
+				   (snapshot->distribSnapshotWithLocalMapping.localXidHashMask + 1) *
+				   sizeof(TransactionId));
+		}
 	}
 
 	return newsnap;
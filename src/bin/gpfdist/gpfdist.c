@@ -57,6 +57,7 @@
 #include <pg_config.h>
 #include <pg_config_manual.h>
 #include "gpfdist_helper.h"
+#include "gpfdist_split.h"
 #ifdef USE_ZSTD
 #include <zstd.h>
 #endif
@@ -199,7 +200,8 @@ static struct
 	int			w; /* The time used for session timeout in seconds */
 	int			compress; /* The flag to indicate whether comopression transmission is open */
 	int			multi_thread; /* The number of working threads for compression transmission */
-} opt = { 8080, 8080, 0, 0, 0, ".", 0, 0, -1, 5, 0, 32768, 0, 256, 0, 0, 0, 0, 0, 0};
+	int			read_threads; /* The number of threads that split and read input files */
+} opt = { 8080, 8080, 0, 0, 0, ".", 0, 0, -1, 5, 0, 32768, 0, 256, 0, 0, 0, 0, 0, 0, 0};
 
 typedef union address
 {
@@ -244,6 +246,12 @@ struct session_t
 	const char* 	tid;
 	const char* 	path;			/* path requested */
 	fstream_t* 		fstream;
+#ifndef WIN32
+	split_reader_t*	split;			/* reads the files of fstream in parallel, or NULL */
+#endif
+	apr_int64_t		read_bytes;		/* bytes of data read, for GET */
+	apr_int64_t		read_blocks;	/* blocks of data read, for GET */
+	apr_time_t		start_time;		/* time when the session was created */
 	int 			is_error;		/* error flag */
 	int 			nrequest;		/* # requests attached to this session */
 	int				is_get;     	/* true for GET, false for POST */
@@ -388,6 +396,7 @@ static int session_attach(request_t* r);
 static void session_detach(request_t* r);
 static void session_end(session_t* s, int error);
 static void session_free(session_t* s);
+static void session_close_fstream(session_t* session);
 static void session_active_segs_dump(session_t* session);
 static int session_active_segs_isempty(session_t* session);
 static int request_validate(request_t *r);
@@ -613,6 +622,9 @@ static void usage_error(const char* msg, int print_usage)
 #ifdef USE_ZSTD
 						"        --compress : open compression transmission\n"
 						"        --multi_thread num : the max number of working thread for compression transmission\n"
+#endif
+#ifndef WIN32
+						"        --read_threads num : the number of threads that split and read input files\n"
 #endif
 						"        --version  : print version information\n"
 						"        -w timeout : timeout in seconds before close target file\n\n");
@@ -682,6 +694,7 @@ static void parse_command_line(int argc, const char* const argv[],
 	{"compress", 258, 0, "turn on compressed transmission"},
 	{"multi_thread", 259, 1, "turn on multi-thread and compressed transmission"},
 #endif
+	{"read_threads", 260, 1, "number of threads that split and read input files"},
 	{ 0 } };
 
 	status = apr_getopt_init(&os, pool, argc, argv);
@@ -785,6 +798,19 @@ static void parse_command_line(int argc, const char* const argv[],
 		case 259:
 			usage_error("Multi-thread transmission relies on zstd, but zstd is not supported by this build", 0);
 			break;
+#endif
+#ifndef WIN32
+		case 260:
+			if (atoi(arg) <= 0) {
+				usage_error("The number of read threads must be more than zero!", 0);
+				break;
+			}
+			opt.read_threads = atoi(arg);
+			break;
+#else
+		case 260:
+			usage_error("Read threads are not supported on this platform", 0);
+			break;
 #endif
 		}
 	}
@@ -863,6 +889,22 @@ static void parse_command_line(int argc, const char* const argv[],
 
 		sem_init(&THREAD_NUM, 0, num_thread);
 	}
+
+	if (opt.read_threads)
+	{
+		int num_thread = opt.read_threads;
+		if (num_thread > MAX_THREAD_NUM)
+		{
+			gwarning(NULL, "%s", "The read thread number exceeds the restricted number! Gpfdist will use the restricted number.");
+			num_thread = MAX_THREAD_NUM;
+		}
+
+		if (!split_pool_start(num_thread))
+		{
+			gwarning(NULL, "%s", "Could not start read threads. Gpfdist will read files in the main thread.");
+			opt.read_threads = 0;
+		}
+	}
 #endif
 
 	/* validate opt.l */
@@ -1066,9 +1108,20 @@ static void log_gpfdist_status()
 						"\t\tnrequest: %d\r\n"
 						"\t\tis_get: %d\r\n"
 						"\t\tpath: %s\r\n"
+#ifdef WIN32
+						"\t\tread_bytes: %ld\r\n"
+#else
+						"\t\tread_bytes: %"APR_INT64_T_FMT"\r\n"
+#endif
 						"\t\trequest: [\r\n",
 						s->tid, s->nrequest,
-						s->is_get,s->path);
+						s->is_get,s->path,
+#ifdef WIN32
+						(long) s->read_bytes
+#else
+						s->read_bytes
+#endif
+						);
 
 		printf("%s\n",buf);
 
@@ -1601,6 +1654,42 @@ session_get_block(const request_t* r, block_t* retblock, char* line_delim_str, i
 		return 0;
 	}
 
+#ifndef WIN32
+	if (session->split)
+	{
+		/* the read threads have already cut the files into whole data rows */
+		size = split_reader_read(session->split, retblock->data, &fos);
+		delay_watchdog_timer();
+
+		if (size == 0)
+		{
+			gprintln(NULL, "session_get_block: end session due to EOF");
+			session_end(session, 0);
+			return 0;
+		}
+
+		if (size < 0)
+		{
+			/* the error lives in the split reader, which session_end frees */
+			static char ferror[256];
+
+			snprintf(ferror, sizeof(ferror), "%s", split_reader_get_error(session->split));
+			gwarning(NULL, "session_get_block end session due to %s", ferror);
+			session_end(session, 1);
+			return ferror;
+		}
+
+		gcb.read_bytes += size;
+		session->read_bytes += size;
+		session->read_blocks++;
+
+		retblock->top = size;
+		block_fill_header(r, retblock, &fos);
+
+		return 0;
+	}
+#endif
+
 	gcb.read_bytes -= fstream_get_compressed_position(session->fstream);
 
 	/* read data from our filestream as a chunk with whole data rows */
@@ -1626,6 +1715,9 @@ session_get_block(const request_t* r, block_t* retblock, char* line_delim_str, i
 		return ferror;
 	}
 
+	session->read_bytes += size;
+	session->read_blocks++;
+
 	retblock->top = size;
 	/* fill the block header with meta data for the client to parse and use */
 	block_fill_header(r, retblock, &fos);
@@ -1633,6 +1725,39 @@ session_get_block(const request_t* r, block_t* retblock, char* line_delim_str, i
 	return 0;
 }
 
+/*
+ * session_close_fstream
+ *
+ * Stop the read threads of the session, if any, and close its files. Log
+ * how fast the data was read.
+ */
+static void session_close_fstream(session_t* session)
+{
+	apr_int64_t elapsed_usec = apr_time_now() - session->start_time;
+	apr_int64_t busy_usec = 0;
+
+#ifndef WIN32
+	if (session->split)
+	{
+		busy_usec = split_reader_get_busy_usec(session->split);
+		split_reader_close(session->split);
+		session->split = 0;
+	}
+#endif
+
+	if (session->read_blocks > 0)
+	{
+		gprintln(NULL, "session %ld read %.0f bytes in %.0f blocks in %.3f sec (%.1f MB/s), read threads busy %.3f sec",
+				 session->id, (double) session->read_bytes, (double) session->read_blocks,
+				 elapsed_usec / 1000000.0,
+				 elapsed_usec > 0 ? (session->read_bytes / (1024.0 * 1024.0)) / (elapsed_usec / 1000000.0) : 0.0,
+				 busy_usec / 1000000.0);
+	}
+
+	fstream_close(session->fstream);
+	session->fstream = 0;
+}
+
 /* finish the session - close the file */
 static void session_end(session_t* session, int error)
 {
@@ -1644,8 +1769,7 @@ static void session_end(session_t* session, int error)
 	if (session->fstream)
 	{
 		gprintln(NULL, "close fstream");
-		fstream_close(session->fstream);
-		session->fstream = 0;
+		session_close_fstream(session);
 	}
 }
 
@@ -1667,10 +1791,7 @@ static void session_free(session_t* session)
 	gprintln(NULL, "free session %s", session->key);
 
 	if (session->fstream)
-	{
-		fstream_close(session->fstream);
-		session->fstream = 0;
-	}
+		session_close_fstream(session);
 
 	event_del(&session->ev);
 
@@ -1941,11 +2062,23 @@ static int session_attach(request_t* r)
 		session->active_segids[r->segid] = 1; /* mark this segid as active */
 		session->maxsegs = r->totalsegs;
 		session->requests = apr_hash_make(pool);
+		session->start_time = apr_time_now();
 		event_set(&session->ev, 0, 0, 0, 0);
 
 		if (session->tid == 0 || session->path == 0 || session->key == 0)
 			gfatal(r, "out of memory in session_attach");
 
+#ifndef WIN32
+		/* hand the files over to the read threads when we can split them */
+		if (opt.read_threads && r->is_get)
+		{
+			session->split = split_reader_open(fstream, &fstream_options,
+											   r->line_delim_str, r->line_delim_length);
+			if (session->split)
+				gprintlnif(r, "new session reads its data with %d read threads", opt.read_threads);
+		}
+#endif
+
 		/* insert into hashtable */
 		apr_hash_set(gcb.session.tab, session->key, APR_HASH_KEY_STRING, session);
 
@@ -0,0 +1,749 @@
+/*
+ * gpfdist_split.c
+ *
+ * Parallel reading of input files for gpfdist.
+ *
+ * Normally a session reads its files with fstream, one block at a time, in
+ * the main event loop, finding the last whole record of each block as it
+ * goes.  With --read_threads, a session that reads plain files instead has
+ * them cut into ranges of a few blocks each, and a pool of worker threads
+ * reads the ranges, finds the record boundaries in them and packs the
+ * records into blocks.  The main loop then only has to hand the finished
+ * blocks out to the segments.
+ *
+ * A range owns the records that start in it, so that each record is sent
+ * exactly once: a worker skips the end of the record that started in the
+ * range before, and reads past the end of its range to finish its last
+ * record.  Blocks are made of whole records and are no bigger than with
+ * fstream; a record that doesn't fit in a block is an error, as it is
+ * there.
+ *
+ * In TEXT format a record ends at the first end-of-line delimiter, so a
+ * worker can find the records of its range on its own.  In CSV format, that
+ * depends on whether the range starts inside a quoted field.  When the
+ * escape character is the quote character, as it is by default, it does if
+ * an odd number of quote characters come before it in the file.  So each
+ * worker counts the quotes in its range first, and then waits until the
+ * ranges before it have been counted.
+ *
+ * Compressed files, pipes, transforms and CSV with another escape character
+ * are read with fstream as before.
+ */
+#ifndef WIN32
+
+#include <postgres.h>
+#include <commands/copy.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gpfdist_split.h"
+
+#define SPLIT_RANGE_BLOCKS		4	/* size of a range, in blocks */
+#define SPLIT_SLOTS_PER_THREAD	2	/* ranges read ahead, per thread */
+#define SPLIT_ERROR_SZ			200
+
+typedef enum
+{
+	SLOT_FREE,
+	SLOT_QUEUED,
+	SLOT_RUNNING,
+	SLOT_DONE
+} split_slot_state;
+
+/* A range of a file, and the blocks made of it */
+typedef struct split_slot_t split_slot_t;
+struct split_slot_t
+{
+	split_reader_t*	reader;
+	split_slot_t*	qnext;			/* next in the queue of the pool */
+	split_slot_state state;
+	int				fidx;			/* file of the range */
+	int64_t			start;			/* the range is [start, end) of the file */
+	int64_t			end;
+
+	/* CSV only: quote state, filled in as the ranges before are counted */
+	bool			parity_known;
+	int				parity;			/* odd number of quotes in the range? */
+	bool			in_quote_known;
+	int				in_quote;		/* does the range start in a quoted field? */
+
+	/* result: the blocks are buf[cuts[i] .. cuts[i + 1]) */
+	char*			buf;
+	int64_t			bufoff;			/* file offset of buf[0] */
+	int*			cuts;
+	int				ncuts;
+	int				next;			/* next block to hand out */
+	bool			failed;
+	char			error[SPLIT_ERROR_SZ];
+};
+
+struct split_reader_t
+{
+	struct fstream_options options;
+	char*			line_delim_str;	/* TEXT end-of-line delimiter */
+	int				line_delim_length;
+	int				nfiles;
+	char**			paths;
+	int64_t*		sizes;
+	int64_t			range_size;
+
+	/* the next range to schedule */
+	int				next_fidx;
+	int64_t			next_start;
+
+	/* ranges are put in slots[seq % nslots], in order */
+	int				nslots;
+	split_slot_t*	slots;
+	int64_t			scheduled;		/* # of ranges scheduled */
+	int64_t			consumed;		/* # of ranges all handed out */
+
+	int				nrunning;		/* # of slots workers are reading */
+	bool			closing;
+	pthread_cond_t	cond;			/* signaled when a slot changes */
+
+	int64_t			busy_usec;		/* time spent by workers */
+	char			error[SPLIT_ERROR_SZ];
+};
+
+/* The worker pool, shared by all sessions */
+static struct
+{
+	pthread_mutex_t	lock;			/* protects the pool and all readers */
+	pthread_cond_t	cond;			/* signaled when the queue is not empty */
+	split_slot_t*	qhead;
+	split_slot_t*	qtail;
+	int				nthreads;
+} split_pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, 0 };
+
+#define SLOT(sr, seq)	(&(sr)->slots[(seq) % (sr)->nslots])
+
+static void* split_worker(void *arg);
+static void split_read_range(split_reader_t *sr, split_slot_t *slot);
+static void split_schedule(split_reader_t *sr);
+static void split_propagate(split_reader_t *sr);
+
+/*
+ * Start the worker threads.  Returns false if none could be started.
+ */
+bool
+split_pool_start(int nthreads)
+{
+	int			i;
+
+	for (i = 0; i < nthreads; i++)
+	{
+		pthread_t	thread;
+
+		if (pthread_create(&thread, NULL, split_worker, NULL) != 0)
+			break;
+		pthread_detach(thread);
+		split_pool.nthreads++;
+	}
+
+	return split_pool.nthreads > 0;
+}
+
+/*
+ * Can a file be read with pread() at any offset?  gfile decompresses files
+ * with these extensions.
+ */
+static bool
+split_file_is_plain(const char *path, int64_t *size)
+{
+	static const char *const compressed[] = {".gz", ".bz2", ".zst", ".z", ".zip"};
+	struct stat st;
+	const char *ext = strrchr(path, '.');
+	int			i;
+
+	if (stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+		return false;
+
+	for (i = 0; ext && i < lengthof(compressed); i++)
+	{
+		if (strcasecmp(ext, compressed[i]) == 0)
+			return false;
+	}
+
+	*size = st.st_size;
+	return true;
+}
+
+/*
+ * Set up parallel reading of the files of an fstream just opened.  Returns
+ * NULL if they must be read with the fstream instead.
+ */
+split_reader_t*
+split_reader_open(fstream_t *fs, const struct fstream_options *options,
+				  const char *line_delim_str, int line_delim_length)
+{
+	split_reader_t *sr;
+	int			nfiles = fstream_get_file_count(fs);
+	int			i;
+
+	if (split_pool.nthreads == 0 || options->forwrite || options->transform)
+		return NULL;
+	if (options->is_csv && options->escape != options->quote)
+		return NULL;
+
+	if (!(sr = calloc(1, sizeof(*sr))))
+		return NULL;
+
+	sr->options = *options;
+	if (line_delim_length > 0)
+	{
+		sr->line_delim_str = strdup(line_delim_str);
+		sr->line_delim_length = line_delim_length;
+	}
+	else
+	{
+		sr->line_delim_str = strdup("\n");
+		sr->line_delim_length = 1;
+	}
+	sr->paths = calloc(nfiles, sizeof(char *));
+	sr->sizes = calloc(nfiles, sizeof(int64_t));
+	sr->nslots = Max(split_pool.nthreads * SPLIT_SLOTS_PER_THREAD, 2);
+	sr->slots = calloc(sr->nslots, sizeof(split_slot_t));
+	sr->range_size = (int64_t) options->bufsize * SPLIT_RANGE_BLOCKS;
+	pthread_cond_init(&sr->cond, NULL);
+
+	if (!sr->line_delim_str || !sr->paths || !sr->sizes || !sr->slots)
+	{
+		split_reader_close(sr);
+		return NULL;
+	}
+
+	for (i = 0; i < nfiles; i++)
+	{
+		const char *path = fstream_get_file_name(fs, i);
+
+		if (!split_file_is_plain(path, &sr->sizes[i]) ||
+			!(sr->paths[i] = strdup(path)))
+		{
+			split_reader_close(sr);
+			return NULL;
+		}
+		sr->nfiles++;
+	}
+
+	return sr;
+}
+
+/*
+ * Get the next block of whole records.  Returns its size, 0 at the end of
+ * the files, or -1 on error.
+ */
+int
+split_reader_read(split_reader_t *sr, char *dest,
+				  struct fstream_filename_and_offset *fo)
+{
+	split_slot_t *slot;
+	int			len;
+
+	pthread_mutex_lock(&split_pool.lock);
+	for (;;)
+	{
+		if (sr->error[0])
+		{
+			pthread_mutex_unlock(&split_pool.lock);
+			return -1;
+		}
+
+		split_schedule(sr);
+
+		if (sr->consumed == sr->scheduled)
+		{
+			pthread_mutex_unlock(&split_pool.lock);
+			return 0;
+		}
+
+		slot = SLOT(sr, sr->consumed);
+		while (slot->state != SLOT_DONE)
+			pthread_cond_wait(&sr->cond, &split_pool.lock);
+
+		if (slot->failed)
+		{
+			memcpy(sr->error, slot->error, sizeof(sr->error));
+			pthread_mutex_unlock(&split_pool.lock);
+			return -1;
+		}
+
+		if (slot->next < slot->ncuts - 1)
+			break;
+
+		/* all handed out, move on to the next range */
+		free(slot->buf);
+		slot->buf = NULL;
+		slot->state = SLOT_FREE;
+		sr->consumed++;
+	}
+	pthread_mutex_unlock(&split_pool.lock);
+
+	/* only we touch a slot that is done */
+	len = slot->cuts[slot->next + 1] - slot->cuts[slot->next];
+	memcpy(dest, slot->buf + slot->cuts[slot->next], len);
+
+	strncpy(fo->fname, sr->paths[slot->fidx], sizeof fo->fname);
+	fo->fname[sizeof fo->fname - 1] = 0;
+	fo->foff = slot->bufoff + slot->cuts[slot->next];
+	fo->line_number = 0;
+
+	slot->next++;
+
+	return len;
+}
+
+const char*
+split_reader_get_error(split_reader_t *sr)
+{
+	return sr->error[0] ? sr->error : NULL;
+}
+
+int64_t
+split_reader_get_busy_usec(split_reader_t *sr)
+{
+	int64_t		usec;
+
+	pthread_mutex_lock(&split_pool.lock);
+	usec = sr->busy_usec;
+	pthread_mutex_unlock(&split_pool.lock);
+
+	return usec;
+}
+
+/*
+ * Stop reading, waiting for the workers to be done with the reader, and
+ * free it.
+ */
+void
+split_reader_close(split_reader_t *sr)
+{
+	split_slot_t **p;
+	int			i;
+
+	pthread_mutex_lock(&split_pool.lock);
+
+	sr->closing = true;
+
+	/* take our ranges off the queue, and wait for those being read */
+	split_pool.qtail = NULL;
+	for (p = &split_pool.qhead; *p;)
+	{
+		if ((*p)->reader == sr)
+			*p = (*p)->qnext;
+		else
+		{
+			split_pool.qtail = *p;
+			p = &(*p)->qnext;
+		}
+	}
+
+	pthread_cond_broadcast(&sr->cond);
+	while (sr->nrunning > 0)
+		pthread_cond_wait(&sr->cond, &split_pool.lock);
+
+	pthread_mutex_unlock(&split_pool.lock);
+
+	for (i = 0; sr->slots && i < sr->nslots; i++)
+	{
+		free(sr->slots[i].buf);
+		free(sr->slots[i].cuts);
+	}
+	for (i = 0; i < sr->nfiles; i++)
+		free(sr->paths[i]);
+	free(sr->slots);
+	free(sr->paths);
+	free(sr->sizes);
+	free(sr->line_delim_str);
+	pthread_cond_destroy(&sr->cond);
+	free(sr);
+}
+
+/*
+ * Queue ranges for the workers, until the slots are full.  Called with the
+ * lock held.
+ */
+static void
+split_schedule(split_reader_t *sr)
+{
+	while (sr->scheduled - sr->consumed < sr->nslots)
+	{
+		split_slot_t *slot;
+
+		/* skip to the next file with data left */
+		while (sr->next_fidx < sr->nfiles &&
+			   sr->next_start >= sr->sizes[sr->next_fidx])
+		{
+			sr->next_fidx++;
+			sr->next_start = 0;
+		}
+		if (sr->next_fidx == sr->nfiles)
+			return;
+
+		slot = SLOT(sr, sr->scheduled);
+
+		slot->reader = sr;
+		slot->qnext = NULL;
+		slot->state = SLOT_QUEUED;
+		slot->fidx = sr->next_fidx;
+		slot->start = sr->next_start;
+		slot->end = Min(slot->start + sr->range_size, sr->sizes[slot->fidx]);
+		slot->parity_known = false;
+		slot->in_quote_known = (slot->start == 0);
+		slot->in_quote = 0;
+		if (!slot->in_quote_known)
+		{
+			/* the previous range is of the same file, and may be consumed */
+			split_slot_t *prev = SLOT(sr, sr->scheduled - 1);
+
+			if (prev->parity_known && prev->in_quote_known)
+			{
+				slot->in_quote = prev->in_quote ^ prev->parity;
+				slot->in_quote_known = true;
+			}
+		}
+		slot->ncuts = 0;
+		slot->next = 0;
+		slot->failed = false;
+		slot->error[0] = 0;
+
+		sr->next_start = slot->end;
+		sr->scheduled++;
+
+		if (split_pool.qtail)
+			split_pool.qtail->qnext = slot;
+		else
+			split_pool.qhead = slot;
+		split_pool.qtail = slot;
+		pthread_cond_signal(&split_pool.cond);
+	}
+}
+
+/*
+ * Work out whether the ranges start in a quoted field, as far as the quotes
+ * have been counted.  Called with the lock held.
+ */
+static void
+split_propagate(split_reader_t *sr)
+{
+	int64_t		seq;
+
+	for (seq = sr->consumed; seq + 1 < sr->scheduled; seq++)
+	{
+		split_slot_t *cur = SLOT(sr, seq);
+		split_slot_t *next = SLOT(sr, seq + 1);
+
+		if (!next->in_quote_known && cur->parity_known && cur->in_quote_known)
+		{
+			next->in_quote = cur->in_quote ^ cur->parity;
+			next->in_quote_known = true;
+			pthread_cond_broadcast(&sr->cond);
+		}
+	}
+}
+
+static void*
+split_worker(void *arg)
+{
+	pthread_mutex_lock(&split_pool.lock);
+	for (;;)
+	{
+		split_slot_t *slot;
+		split_reader_t *sr;
+		struct timespec start;
+		struct timespec finish;
+
+		while (!split_pool.qhead)
+			pthread_cond_wait(&split_pool.cond, &split_pool.lock);
+
+		slot = split_pool.qhead;
+		split_pool.qhead = slot->qnext;
+		if (!split_pool.qhead)
+			split_pool.qtail = NULL;
+
+		sr = slot->reader;
+		slot->state = SLOT_RUNNING;
+		sr->nrunning++;
+		pthread_mutex_unlock(&split_pool.lock);
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		split_read_range(sr, slot);
+		clock_gettime(CLOCK_MONOTONIC, &finish);
+
+		pthread_mutex_lock(&split_pool.lock);
+		slot->state = SLOT_DONE;
+		sr->nrunning--;
+		sr->busy_usec += (int64_t) (finish.tv_sec - start.tv_sec) * 1000000 +
+			(finish.tv_nsec - start.tv_nsec) / 1000;
+		pthread_cond_broadcast(&sr->cond);
+	}
+
+	return NULL;
+}
+
+/*
+ * State of a scan for record boundaries, i.e. the offsets just past each
+ * end-of-line that isn't in a quoted field.
+ */
+typedef struct
+{
+	const char*	buf;
+	int64_t		bufoff;			/* file offset of buf[0] */
+	int64_t		pos;			/* file offset to scan from */
+	int64_t		lim;			/* file offset to stop at */
+	int			in_quote;		/* CSV: is pos in a quoted field? */
+	int			lastch;			/* CSV: the byte before pos, if scanned */
+} split_scan_t;
+
+/*
+ * Find the next record boundary, or return -1 if there's none before the
+ * end of the data.  This has to agree with the way fstream_read() finds
+ * them.
+ */
+static int64_t
+split_next_boundary(const split_reader_t *sr, split_scan_t *ss)
+{
+	const char *p = ss->buf + (ss->pos - ss->bufoff);
+	const char *q = ss->buf + (ss->lim - ss->bufoff);
+
+	if (!sr->options.is_csv)
+	{
+		const char *delim = sr->line_delim_str;
+		int			len = sr->line_delim_length;
+
+		if (len == 1)
+			p = memchr(p, delim[0], q - p);
+		else
+		{
+			for (; p && p + len <= q; p++)
+			{
+				p = memchr(p, delim[0], q - p);
+				if (!p || p + len > q || memcmp(p, delim, len) == 0)
+					break;
+			}
+			if (p && p + len > q)
+				p = NULL;
+		}
+
+		if (!p)
+		{
+			ss->pos = ss->lim;
+			return -1;
+		}
+		ss->pos = (p - ss->buf) + ss->bufoff + len;
+		return ss->pos;
+	}
+
+	while (p < q)
+	{
+		int			ch = (unsigned char) *p++;
+		int			lastch = ss->lastch;
+
+		ss->lastch = ch;
+
+		if (ss->in_quote)
+		{
+			if (ch == sr->options.quote)
+				ss->in_quote = 0;
+		}
+		else if (ch == sr->options.quote)
+			ss->in_quote = 1;
+		else if ((sr->options.eol_type == EOL_CRNL && ch == '\n' && lastch == '\r') ||
+				 (sr->options.eol_type == EOL_CR && ch == '\r') ||
+				 (sr->options.eol_type != EOL_CRNL && sr->options.eol_type != EOL_CR &&
+				  ch == '\n'))
+		{
+			ss->pos = (p - ss->buf) + ss->bufoff;
+			return ss->pos;
+		}
+	}
+
+	ss->pos = ss->lim;
+	return -1;
+}
+
+static int
+split_count_quotes(const char *p, const char *q, char quote)
+{
+	int			n = 0;
+
+	while ((p = memchr(p, quote, q - p)) != NULL)
+	{
+		n++;
+		p++;
+	}
+	return n;
+}
+
+static bool
+split_add_cut(split_slot_t *slot, int cut, int *maxcuts)
+{
+	if (slot->ncuts == *maxcuts)
+	{
+		int		   *cuts = realloc(slot->cuts, *maxcuts * 2 * sizeof(int));
+
+		if (!cuts)
+			return false;
+		slot->cuts = cuts;
+		*maxcuts *= 2;
+	}
+	slot->cuts[slot->ncuts++] = cut;
+	return true;
+}
+
+/*
+ * Read a range and cut its records into blocks.  Called by a worker without
+ * the lock.
+ */
+static void
+split_read_range(split_reader_t *sr, split_slot_t *slot)
+{
+	const char *path = sr->paths[slot->fidx];
+	int64_t		fsize = sr->sizes[slot->fidx];
+	int			blocksize = sr->options.bufsize;
+	int			lookback = sr->options.is_csv ? 2 : sr->line_delim_length;
+	int64_t		rstart = Max(slot->start - lookback, 0);
+	int64_t		rend = Min(slot->end + blocksize, fsize);
+	int			maxcuts = 2 * SPLIT_RANGE_BLOCKS + 4;
+	int			fd;
+	int64_t		done;
+	split_scan_t ss;
+	int64_t		first;
+	int64_t		blockstart;
+	int64_t		last;
+
+	slot->bufoff = rstart;
+	slot->buf = malloc(rend - rstart);
+	if (!slot->cuts)
+		slot->cuts = malloc(maxcuts * sizeof(int));
+	else
+		slot->cuts = realloc(slot->cuts, maxcuts * sizeof(int));
+	if (!slot->buf || !slot->cuts)
+	{
+		snprintf(slot->error, sizeof(slot->error), "out of memory reading file %s", path);
+		slot->failed = true;
+		return;
+	}
+
+	if ((fd = open(path, O_RDONLY)) < 0)
+	{
+		snprintf(slot->error, sizeof(slot->error), "cannot open file - %s", path);
+		slot->failed = true;
+		return;
+	}
+	for (done = 0; done < rend - rstart;)
+	{
+		ssize_t		n = pread(fd, slot->buf + done, rend - rstart - done, rstart + done);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+		{
+			snprintf(slot->error, sizeof(slot->error), "cannot read file - %s", path);
+			slot->failed = true;
+			close(fd);
+			return;
+		}
+		done += n;
+	}
+	close(fd);
+
+	memset(&ss, 0, sizeof(ss));
+	ss.buf = slot->buf;
+	ss.bufoff = rstart;
+	ss.pos = rstart;
+	ss.lim = rend;
+
+	if (sr->options.is_csv)
+	{
+		const char *base = slot->buf - rstart;
+		int			parity = split_count_quotes(base + slot->start, base + slot->end,
+												sr->options.quote) & 1;
+		bool		closing;
+
+		pthread_mutex_lock(&split_pool.lock);
+		slot->parity = parity;
+		slot->parity_known = true;
+		split_propagate(sr);
+		while (!slot->in_quote_known && !sr->closing)
+			pthread_cond_wait(&sr->cond, &split_pool.lock);
+		ss.in_quote = slot->in_quote;
+		closing = sr->closing;
+		pthread_mutex_unlock(&split_pool.lock);
+
+		if (closing)
+			return;
+
+		/* back up to where we start scanning */
+		ss.in_quote ^= split_count_quotes(base + rstart, base + slot->start,
+										  sr->options.quote) & 1;
+	}
+
+	/* find the first record that starts in the range */
+	if (slot->start == 0 && !sr->options.header)
+		first = 0;
+	else
+	{
+		do
+		{
+			first = split_next_boundary(sr, &ss);
+		} while (first >= 0 && first < slot->start);
+	}
+	if (first < 0 || first >= slot->end)
+	{
+		/* no record starts here */
+		return;
+	}
+
+	/* pack the records into blocks, up to the end of the last one */
+	ss.pos = first;
+	blockstart = first;
+	last = first;
+	if (!split_add_cut(slot, blockstart - rstart, &maxcuts))
+		goto oom;
+	while (last < slot->end)
+	{
+		int64_t		next = split_next_boundary(sr, &ss);
+
+		if (next < 0)
+		{
+			if (rend < fsize)
+				goto too_long;
+			next = fsize;		/* the last record has no end-of-line */
+		}
+
+		if (next - blockstart > blocksize)
+		{
+			if (last == blockstart)
+				goto too_long;
+			if (!split_add_cut(slot, last - rstart, &maxcuts))
+				goto oom;
+			blockstart = last;
+			if (next - blockstart > blocksize)
+				goto too_long;
+		}
+		last = next;
+	}
+	if (last > blockstart && !split_add_cut(slot, last - rstart, &maxcuts))
+		goto oom;
+	return;
+
+too_long:
+	snprintf(slot->error, sizeof(slot->error), "line too long in file %s near (%lld bytes)",
+			 path, (long long) last);
+	slot->failed = true;
+	return;
+
+oom:
+	snprintf(slot->error, sizeof(slot->error), "out of memory reading file %s", path);
+	slot->failed = true;
+}
+
+#endif   /* WIN32 */
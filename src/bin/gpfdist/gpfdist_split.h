@@ -0,0 +1,25 @@
+#ifndef GPFDIST_SPLIT_H
+#define GPFDIST_SPLIT_H
+
+#include <stdbool.h>
+#include <fstream/fstream.h>
+
+/*
+ * Parallel reading of the input files of a session, see gpfdist_split.c.
+ * Not available on Windows.
+ */
+typedef struct split_reader_t split_reader_t;
+
+bool split_pool_start(int nthreads);
+
+split_reader_t* split_reader_open(fstream_t *fs,
+								  const struct fstream_options *options,
+								  const char *line_delim_str,
+								  int line_delim_length);
+int split_reader_read(split_reader_t *sr, char *dest,
+					  struct fstream_filename_and_offset *fo);
+const char* split_reader_get_error(split_reader_t *sr);
+int64_t split_reader_get_busy_usec(split_reader_t *sr);
+void split_reader_close(split_reader_t *sr);
+
+#endif
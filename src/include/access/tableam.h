@@ -140,6 +140,30 @@ typedef struct TM_FailureData
 #define TUPLE_LOCK_FLAG_FIND_LAST_VERSION		(1 << 1)
 
 
+/*
+ * GPDB: A batch of tuples returned by table_scan_getnextbatch().
+ *
+ * The attributes fetched by the scan are decoded into one array of datums and
+ * one array of null flags per attribute, indexed by row, instead of one slot
+ * per tuple. 'selected' lists the rows that are visible and still qualify;
+ * callers may remove entries from it while evaluating quals over the arrays.
+ * Pass-by-reference datums stay valid until the next call on the scan.
+ */
+typedef struct TableScanBatchData
+{
+	MemoryContext mcxt;			/* context the arrays are allocated in */
+	TupleDesc	tupdesc;		/* descriptor of the scanned relation */
+	int			maxrows;		/* capacity of the per-row arrays */
+	int			nrows;			/* number of rows decoded into the arrays */
+	Datum	  **values;			/* per attribute, NULL if not fetched */
+	bool	  **isnull;			/* per attribute, NULL if not fetched */
+	ItemPointerData *tids;		/* per row */
+	int			nselected;		/* number of entries in 'selected' */
+	int		   *selected;		/* indexes of qualifying rows, ascending */
+} TableScanBatchData;
+
+typedef struct TableScanBatchData *TableScanBatch;
+
 /* Typedef for callback function for table_index_build_scan */
 /* GPDB: This takes an ItemPointer, rather than HeapTuple, because this is also
  * used with AO/AOCO tables */
@@ -276,6 +300,15 @@ typedef struct TableAmRoutine
 									 ScanDirection direction,
 									 TupleTableSlot *slot);
 
+	/*
+	 * GPDB: Return the next batch of tuples from `scan`, see
+	 * TableScanBatchData. This callback is optional; callers use
+	 * scan_getnextslot for AMs that do not provide it.
+	 */
+	bool		(*scan_getnextbatch) (TableScanDesc scan,
+									  ScanDirection direction,
+									  TableScanBatch batch);
+
 
 	/* ------------------------------------------------------------------------
 	 * Parallel table scan related functions.
@@ -1034,6 +1067,30 @@ table_scan_getnextslot(TableScanDesc sscan, ScanDirection direction, TupleTableS
 	return sscan->rs_rd->rd_tableam->scan_getnextslot(sscan, direction, slot);
 }
 
+/*
+ * GPDB: Does the table AM of `rel` support table_scan_getnextbatch()?
+ */
+static inline bool
+table_scan_supports_batch(Relation rel)
+{
+	return rel->rd_tableam != NULL &&
+		rel->rd_tableam->scan_getnextbatch != NULL;
+}
+
+/*
+ * GPDB: Return the next batch of tuples from `scan`. Returns false, with an
+ * empty batch, at the end of the scan.
+ */
+static inline bool
+table_scan_getnextbatch(TableScanDesc sscan, ScanDirection direction,
+						TableScanBatch batch)
+{
+	return sscan->rs_rd->rd_tableam->scan_getnextbatch(sscan, direction, batch);
+}
+
+extern TableScanBatch table_scan_batch_create(TupleDesc tupdesc, int maxrows);
+extern void table_scan_batch_free(TableScanBatch batch);
+
 
 /* ----------------------------------------------------------------------------
  * Parallel table scan related functions.
@@ -19,11 +19,19 @@
  * Macros to the attribute number for each attribute
  * in the block directory relation.
  */
-#define Natts_pg_aoblkdir              4
+#define Natts_pg_aoblkdir              5
 #define Anum_pg_aoblkdir_segno         1
 #define Anum_pg_aoblkdir_columngroupno 2
 #define Anum_pg_aoblkdir_firstrownum   3
 #define Anum_pg_aoblkdir_minipage      4
+#define Anum_pg_aoblkdir_zonemap       5
+
+/*
+ * Block directory relations created before the 'zonemap' column was added
+ * only have the first four attributes.
+ */
+#define AOBlkDirHasZoneMap(tupdesc) \
+	((tupdesc)->natts >= Anum_pg_aoblkdir_zonemap)
 
 extern void AlterTableCreateAoBlkdirTable(Oid relOid);
 
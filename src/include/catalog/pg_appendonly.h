@@ -31,6 +31,8 @@ CATALOG(pg_appendonly,6105,AppendOnlyRelationId)
     Oid             blkdirrelid;        /* OID of aoblkdir table; 0 if none */
 	Oid             visimaprelid;		/* OID of the aovisimap table */
 	int16			version;			/* AO relation version */
+	int64			analyzemodcount;	/* sum of segfile modcounts when last
+										 * analyzed incrementally; -1 if never */
 } FormData_pg_appendonly;
 
 /* GPDB added foreign key definitions for gpcheckcat. */
@@ -152,6 +154,9 @@ UpdateAppendOnlyEntryAuxOids(Oid relid,
 							 Oid newBlkdirrelid,
 							 Oid newVisimaprelid);
 
+extern void
+UpdateAppendOnlyEntryAnalyzeModCount(Oid relid, int64 modcount);
+
 extern void
 RemoveAppendonlyEntry(Oid relid);
 
@@ -71,6 +71,16 @@ typedef struct CompressionState
 	 */
 	size_t (*desired_sz)(size_t input);
 
+	/*
+	 * Optional. Decompress without calling back into the backend (no palloc,
+	 * elog or fmgr), so that it can run on a helper thread, see
+	 * gp_decompress_parallel(). Returns false on failure, the caller then
+	 * uses the regular decompressor to report the error.
+	 */
+	bool (*decompress_threadsafe)(struct CompressionState *cs,
+								  const void *src, int32 src_sz,
+								  void *dst, int32 dst_sz, int32 *dst_used);
+
 	void *opaque; /* algorithm specific stuff opaque to the caller */
 } CompressionState;
 
@@ -146,6 +146,29 @@ typedef struct AOCSFetchDescData
 
 typedef AOCSFetchDescData *AOCSFetchDesc;
 
+/*
+ * A condition of a scan's qual that can be checked against the zone maps
+ * recorded in the block directory. It is either "column <strategy> value",
+ * with a btree strategy and the value converted with
+ * AppendOnlyZoneMap_DatumToInt64(), or a NULL test on the column.
+ */
+typedef struct AOCSZoneMapPredicate
+{
+	AttrNumber		attno;			/* zero based column number */
+	StrategyNumber	strategy;		/* InvalidStrategy for a NULL test */
+	NullTestType	nulltesttype;	/* used only for a NULL test */
+	int64			value;
+} AOCSZoneMapPredicate;
+
+/*
+ * An inclusive range of row numbers in a segment file.
+ */
+typedef struct AOCSRowRange
+{
+	int64			firstRowNum;
+	int64			lastRowNum;
+} AOCSRowRange;
+
 /*
  * Used for scan of appendoptimized column oriented relations, should be used in
  * the tableam api related code and under it.
@@ -252,6 +275,30 @@ typedef struct AOCSScanDescData
 	AppendOnlyBlockDirectory *blockDirectory;
 	AppendOnlyVisimap visibilityMap;
 
+	/*
+	 * Zone map based block skipping. zonemapPreds are the conditions of the
+	 * scan's qual that can be checked against the zone maps, and
+	 * zonemapSkipRanges the sorted, disjoint row ranges of the current
+	 * segment file that the zone maps prove not to satisfy them. Blocks of
+	 * the projected columns that lie entirely in such a range are skipped
+	 * without being read, and counted in zonemapBlocksSkipped.
+	 */
+	AOCSZoneMapPredicate *zonemapPreds;
+	int			numZonemapPreds;
+	AOCSRowRange *zonemapSkipRanges;
+	int			numZonemapSkipRanges;
+	int			curZonemapSkipRange;
+	int64		zonemapBlocksSkipped;
+
+	/*
+	 * When gp_aocs_decompress_threads is set, the blocks that the projected
+	 * columns need next are decompressed concurrently. decompressJobs holds
+	 * one job for each projected column, and decompressCols the indexes into
+	 * proj_atts of the columns that are reading a new block.
+	 */
+	GpDecompressJob *decompressJobs;
+	int		   *decompressCols;
+
 	/*
 	 * The total number of bytes read, compressed, across all segment files, and
 	 * across all columns projected, so far. It is used for scan progress reporting.
@@ -378,10 +425,13 @@ aocs_beginrangescan(Relation relation,
 					int segfile_count,
 					bool *proj);
 
+extern void aocs_zonemap_init(AOCSScanDesc scan, List *qual);
+extern int64 aocs_zonemap_blocks_skipped(TableScanDesc scan);
 extern void aocs_rescan(AOCSScanDesc scan);
 extern void aocs_endscan(AOCSScanDesc scan);
 
 extern bool aocs_getnext(AOCSScanDesc scan, ScanDirection direction, TupleTableSlot *slot);
+extern bool aocs_getnextbatch(AOCSScanDesc scan, ScanDirection direction, TableScanBatch batch);
 extern AOCSInsertDesc aocs_insert_init(Relation rel, int segno, int64 num_rows);
 extern void aocs_insert_values(AOCSInsertDesc idesc, Datum *d, bool *null, AOTupleId *aoTupleId);
 static inline void aocs_insert(AOCSInsertDesc idesc, TupleTableSlot *slot)
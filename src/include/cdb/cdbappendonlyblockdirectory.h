@@ -19,6 +19,7 @@
 #include "access/appendonlytid.h"
 #include "access/skey.h"
 #include "catalog/indexing.h"
+#include "catalog/pg_type.h"
 
 extern int gp_blockdirectory_entry_min_range;
 extern int gp_blockdirectory_minipage_size;
@@ -74,6 +75,51 @@ typedef struct Minipage
 	MinipageEntry entry[1];
 } Minipage;
 
+/*
+ * Zone map of the rows covered by one minipage entry: the minimum and
+ * maximum non-null value, and the number of NULLs. It is only maintained
+ * for column types whose values order the same way as their int64
+ * representation (see AppendOnlyZoneMap_TypeDomain()).
+ */
+typedef struct MinipageZoneMapEntry
+{
+	int64 minValue;
+	int64 maxValue;
+	int32 nullCount;
+	uint32 flags;
+} MinipageZoneMapEntry;
+
+/* MinipageZoneMapEntry flags */
+#define ZONEMAP_VALID		0x01	/* entry carries zone map information */
+#define ZONEMAP_HAS_VALUES	0x02	/* minValue/maxValue are set */
+
+/*
+ * Define a varlena type for the zone maps of a minipage. It is stored in
+ * the 'zonemap' column of the block directory, and entry[i] describes
+ * the rows of minipage entry[i].
+ */
+typedef struct MinipageZoneMap
+{
+	/* Total length. Must be the first. */
+	int32 _len;
+	int32 version;
+	uint32 nEntry;
+
+	/* Varlena array */
+	MinipageZoneMapEntry entry[1];
+} MinipageZoneMap;
+
+/*
+ * Zone map of a range of rows in a segment file, as returned by
+ * AppendOnlyBlockDirectory_GetZoneMaps().
+ */
+typedef struct AppendOnlyBlockDirectoryZoneMap
+{
+	int64 firstRowNum;
+	int64 rowCount;
+	MinipageZoneMapEntry zone;
+} AppendOnlyBlockDirectoryZoneMap;
+
 /*
  * Define the relevant info for a minipage for each
  * column group.
@@ -81,6 +127,7 @@ typedef struct Minipage
 typedef struct MinipagePerColumnGroup
 {
 	Minipage *minipage;
+	MinipageZoneMap *zonemap;
 	uint32 numMinipageEntries;
 	ItemPointerData tupleTid;
 } MinipagePerColumnGroup;
@@ -260,6 +307,19 @@ AppendOnlyBlockDirectory_InsertEntry(AppendOnlyBlockDirectory *blockDirectory,
 									 int64 firstRowNum,
 									 int64 fileOffset,
 									 int64 rowCount);
+extern bool
+AppendOnlyBlockDirectory_InsertEntryWithZoneMap(AppendOnlyBlockDirectory *blockDirectory,
+												int columnGroupNo,
+												int64 firstRowNum,
+												int64 fileOffset,
+												int64 rowCount,
+												MinipageZoneMapEntry *zone);
+extern AppendOnlyBlockDirectoryZoneMap *
+AppendOnlyBlockDirectory_GetZoneMaps(Relation aoRel,
+									 Snapshot appendOnlyMetaDataSnapshot,
+									 int segno,
+									 int columnGroupNo,
+									 int *numZoneMaps);
 extern void
 AppendOnlyBlockDirectory_DeleteSegmentFile(AppendOnlyBlockDirectory *blockDirectory,
 										   int columnGroupNo,
@@ -331,6 +391,80 @@ minipage_size(uint32 nEntry)
 	return offsetof(Minipage, entry) + sizeof(MinipageEntry) * nEntry;
 }
 
+static inline uint32
+zonemap_size(uint32 nEntry)
+{
+	return offsetof(MinipageZoneMap, entry) + sizeof(MinipageZoneMapEntry) * nEntry;
+}
+
+/*
+ * AppendOnlyZoneMap_TypeDomain
+ *
+ * Returns the "domain" that values of the given type are compared in when
+ * converted to int64 by AppendOnlyZoneMap_DatumToInt64(), or InvalidOid if
+ * zone maps are not maintained for the type. Two types can only be compared
+ * through their zone maps if they map to the same domain.
+ */
+static inline Oid
+AppendOnlyZoneMap_TypeDomain(Oid typid)
+{
+	switch (typid)
+	{
+		case INT2OID:
+		case INT4OID:
+		case INT8OID:
+			return INT8OID;
+		case DATEOID:
+		case TIMEOID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			return typid;
+		default:
+			return InvalidOid;
+	}
+}
+
+static inline int64
+AppendOnlyZoneMap_DatumToInt64(Oid typid, Datum datum)
+{
+	switch (typid)
+	{
+		case INT2OID:
+			return (int64) DatumGetInt16(datum);
+		case INT4OID:
+		case DATEOID:
+			return (int64) DatumGetInt32(datum);
+		default:
+			return DatumGetInt64(datum);
+	}
+}
+
+static inline void
+AppendOnlyZoneMap_Reset(MinipageZoneMapEntry *zone)
+{
+	zone->minValue = 0;
+	zone->maxValue = 0;
+	zone->nullCount = 0;
+	zone->flags = ZONEMAP_VALID;
+}
+
+static inline void
+AppendOnlyZoneMap_Add(MinipageZoneMapEntry *zone, int64 value, bool isnull)
+{
+	if (isnull)
+		zone->nullCount++;
+	else if ((zone->flags & ZONEMAP_HAS_VALUES) == 0)
+	{
+		zone->minValue = value;
+		zone->maxValue = value;
+		zone->flags |= ZONEMAP_HAS_VALUES;
+	}
+	else if (value < zone->minValue)
+		zone->minValue = value;
+	else if (value > zone->maxValue)
+		zone->maxValue = value;
+}
+
 /*
  * copy_out_minipage
  *
@@ -73,6 +73,12 @@ typedef struct BufferedRead
 	/* current read position */
 	off_t				 fileOff;
 
+	/*
+	 * The file has been prefetched up to this position, see
+	 * BufferedReadPrefetch().
+	 */
+	int64				 prefetchPosition;
+
 	/*
 	 * Temporary limit support for random reading.
 	 */
@@ -55,6 +55,14 @@ typedef struct SegmentDatabaseDescriptor
 	int						identifier;		/* unique identifier in the cdbcomponent segment pool */
 	double					establishConnTime; /* the time of establish connection to the segment,
 												* -1 means this connection is cached */
+
+	/*
+	 * Keys of the plans this QE has cached, most recently dispatched first.
+	 * See cdbdisp_plancache.c.
+	 */
+	struct DispatchPlanKey *planCache;
+	int						planCacheLen;
+	int						planCacheSize;
 } SegmentDatabaseDescriptor;
 
 SegmentDatabaseDescriptor *
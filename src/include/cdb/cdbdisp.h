@@ -16,6 +16,7 @@
 #ifndef CDBDISP_H
 #define CDBDISP_H
 
+#include "cdb/cdbdisp_plancache.h"
 #include "cdb/cdbtm.h"
 #include "utils/resowner.h"
 
@@ -23,6 +24,7 @@
 
 struct CdbDispatchResults; /* #include "cdb/cdbdispatchresult.h" */
 struct CdbPgResults;
+struct DispatchCommandQueryParms;
 struct Gang; /* #include "cdb/cdbgang.h" */
 struct ResourceOwnerData;
 enum GangType;
@@ -51,6 +53,17 @@ typedef struct CdbDispatcherState
 	bool isGangDestroying;
 #endif
 	bool destroyIdleReaderGang;
+
+	/*
+	 * For plans dispatched with the QE plan cache: the plan's key, the query
+	 * text to send to the QEs that have it cached already, and what's needed
+	 * to build the full query text for a QE that asks for the plan.
+	 */
+	DispatchPlanKey planKey;
+	int planCacheSize;
+	char *cachedQueryText;
+	int cachedQueryTextLen;
+	struct DispatchCommandQueryParms *planQueryParms;
 } CdbDispatcherState;
 
 typedef struct DispatcherInternalFuncs
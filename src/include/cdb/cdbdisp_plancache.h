@@ -0,0 +1,59 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbdisp_plancache.h
+ *	  Caching of dispatched plans on the qExec processes.
+ *
+ * Portions Copyright (c) 2012-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/cdb/cdbdisp_plancache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef CDBDISP_PLANCACHE_H
+#define CDBDISP_PLANCACHE_H
+
+#include "nodes/plannodes.h"
+
+struct SegmentDatabaseDescriptor;
+
+/*
+ * The key a plan is cached under.  All three fields are computed from the
+ * uncompressed, serialized plan, and all three must match for a cached plan
+ * to be used.  A zero fingerprint means "no key" on the wire.
+ */
+typedef struct DispatchPlanKey
+{
+	uint64		fingerprint;	/* hash_bytes_extended() of the plan */
+	uint32		crc;			/* CRC-32C of the plan */
+	int32		len;			/* length of the plan */
+} DispatchPlanKey;
+
+#define DispatchPlanKeyEquals(a, b) \
+	((a)->fingerprint == (b)->fingerprint && \
+	 (a)->crc == (b)->crc && \
+	 (a)->len == (b)->len)
+
+/*
+ * Plans bigger than this (uncompressed) are always dispatched in full, to
+ * bound the memory the cache takes on the QEs.
+ */
+#define PLAN_CACHE_MAX_PLAN_SIZE	(1024 * 1024)
+
+/* QD side */
+extern void DispatchPlanFingerprint(const char *splan, int splan_len,
+									DispatchPlanKey *key);
+extern bool DispatchPlanCacheContains(struct SegmentDatabaseDescriptor *segdbDesc,
+									  const DispatchPlanKey *key, int cacheSize);
+extern bool DispatchPlanCacheLookup(struct SegmentDatabaseDescriptor *segdbDesc,
+									const DispatchPlanKey *key, int cacheSize);
+extern void DispatchPlanCacheReset(struct SegmentDatabaseDescriptor *segdbDesc);
+
+/* QE side */
+extern const char *QEPlanCacheReceive(const DispatchPlanKey *key, int cacheSize,
+									  const char *splan, int *splan_len);
+extern void QEPlanCacheRequestPlan(const DispatchPlanKey *key);
+extern PlannedStmt *QEPlanCacheGetPlan(const DispatchPlanKey *key);
+
+#endif   /* CDBDISP_PLANCACHE_H */
@@ -114,4 +114,6 @@ extern void CdbDispatchCopyEnd(struct CdbCopy *cdbCopy);
 
 extern ParamListInfo deserializeExternParams(struct SerializedParams *sparams);
 
+extern char *cdbdisp_buildFullPlanQueryText(struct CdbDispatcherState *ds, int *len);
+
 #endif   /* CDBDISP_QUERY_H */
@@ -0,0 +1,41 @@
+/*-------------------------------------------------------------------------
+ *
+ * cdbdisp_stats.h
+ *	  Latency histograms of the phases of dispatching a command.
+ *
+ * Portions Copyright (c) 2012-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/cdb/cdbdisp_stats.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef CDBDISP_STATS_H
+#define CDBDISP_STATS_H
+
+#include "portability/instr_time.h"
+
+typedef enum DispatchPhase
+{
+	DISPATCH_PHASE_SERIALIZE,	/* serializing the plan and the message */
+	DISPATCH_PHASE_COMPRESS,	/* compressing the plan */
+	DISPATCH_PHASE_SEND,		/* sending to all the QEs */
+	DISPATCH_PHASE_FIRST_ACK,	/* from end of send to first QE response */
+
+	NUM_DISPATCH_PHASES
+} DispatchPhase;
+
+/*
+ * Bucket 0 counts durations under 1 microsecond, bucket i durations of
+ * [2^(i-1), 2^i) microseconds, and the last bucket everything longer.
+ */
+#define DISPATCH_STATS_NUM_BUCKETS	24
+
+extern Size DispatchStatsShmemSize(void);
+extern void DispatchStatsShmemInit(void);
+
+extern void DispatchStatsRecord(DispatchPhase phase, instr_time elapsed);
+extern void DispatchStatsRecordSince(DispatchPhase phase, instr_time start);
+
+#endif   /* CDBDISP_STATS_H */
@@ -55,6 +55,22 @@ typedef struct DistributedSnapshotWithLocalMapping
 	TransactionId maxCachedLocalXid;
 	int32 currentLocalXidsCount;
 	TransactionId *inProgressMappedLocalXids;
+
+	/*
+	 * Constant-time lookups for the QE's visibility checks, built by
+	 * DistributedSnapshotWithLocalMapping_BuildLookup().  When
+	 * inProgressBitmapWords is 0, inProgressXidArray is searched instead;
+	 * when localXidHashMask is 0, inProgressMappedLocalXids is.
+	 *
+	 * Bit (dxid - ds.xmin) of inProgressBitmap is set for each in-progress
+	 * distributed xid.  localXidHash is an open-addressing set of the
+	 * local xids in inProgressMappedLocalXids, with localXidHashMask + 1
+	 * slots.
+	 */
+	uint64 *inProgressBitmap;
+	int32 inProgressBitmapWords;
+	TransactionId *localXidHash;
+	uint32 localXidHashMask;
 } DistributedSnapshotWithLocalMapping;
 
 typedef enum
@@ -67,6 +83,11 @@ typedef enum
 } DistributedSnapshotCommitted;
 
 extern int GetMaxSnapshotDistributedXidCount(void);
+extern int DistributedSnapshot_MaxBitmapWords(int count);
+extern uint32 DistributedSnapshot_LocalXidHashSlots(int count);
+
+extern void DistributedSnapshotWithLocalMapping_BuildLookup(
+	DistributedSnapshotWithLocalMapping		*dslm);
 
 extern DistributedSnapshotCommitted DistributedSnapshotWithLocalMapping_CommittedTest(
 	DistributedSnapshotWithLocalMapping		*dslm,
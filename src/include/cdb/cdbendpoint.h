@@ -31,6 +31,9 @@
 #include "storage/shm_toc.h"
 #include "nodes/execnodes.h"
 
+/* Upper limit of gp_endpoint_batch_size, in kB */
+#define MAX_ENDPOINT_BATCH_SIZE			64
+
 /*
  * Endpoint allocate positions.
  */
@@ -30,6 +30,19 @@ typedef enum
 	REDUCE_JUMP_HASH
 } CdbHashReduce;
 
+/*
+ * Hash functions of common distribution key types that cdbhash() computes
+ * inline, rather than calling them through fmgr.
+ */
+typedef enum
+{
+	CDBHASH_KERNEL_FMGR = 0,	/* call hashfuncs[attno] */
+	CDBHASH_KERNEL_INT4,		/* hashint4() */
+	CDBHASH_KERNEL_INT8,		/* hashint8() */
+	CDBHASH_KERNEL_TEXT,		/* hashtext(), default collation */
+	CDBHASH_KERNEL_NUMERIC		/* hash_numeric() */
+} CdbHashKernel;
+
 /*
  * Structure that holds Greenplum Database hashing information.
  */
@@ -43,6 +56,7 @@ typedef struct CdbHash
 
 	int			natts;
 	FmgrInfo   *hashfuncs;
+	CdbHashKernel *kernels;		/* how to compute each hash function */
 } CdbHash;
 
 /*
@@ -66,6 +80,17 @@ extern void cdbhash(CdbHash *h, int attno, Datum datum, bool isnull);
  */
 extern unsigned int cdbhashreduce(CdbHash *h);
 
+/*
+ * Batch versions of cdbhashinit(), cdbhash() and cdbhashreduce(), that
+ * compute the hashes of nrows tuples at once, in hashes[]. cdbhashbatch()
+ * is called for each attribute, in order, like cdbhash().
+ * cdbhashreducebatch() replaces each hash with its segment number.
+ */
+extern void cdbhashinitbatch(CdbHash *h, uint32 *hashes, int nrows);
+extern void cdbhashbatch(CdbHash *h, int attno, Datum *datums, bool *isnulls,
+						 int nrows, uint32 *hashes);
+extern void cdbhashreducebatch(CdbHash *h, uint32 *hashes, int nrows);
+
 /*
  * Return a random segment number, for a randomly distributed policy.
  */
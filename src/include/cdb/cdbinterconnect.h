@@ -291,6 +291,25 @@ struct MotionConn
 	uint64 stat_max_resent;
 	uint64 stat_count_dropped;
 
+	/*
+	 * used by the receiver.
+	 *
+	 * packet payload bytes received, as they were before compression and
+	 * as they came over the wire.
+	 */
+	uint64 stat_payload_bytes_recvd;
+	uint64 stat_wire_bytes_recvd;
+
+	/*
+	 * used by the sender, with gp_interconnect_compression.
+	 *
+	 * the number of upcoming packets not to try to compress, because
+	 * compression didn't pay off for the last ones, and how many were
+	 * skipped the last time.
+	 */
+	int			compressSkip;
+	int			compressBackoff;
+
 	/*
 	 * used by the sender.
 	 *
@@ -373,6 +392,14 @@ typedef struct ChunkSorterEntry
 	 */
 	TupleChunkListData chunk_list;
 
+	/*
+	 * A regular tuple that spans several chunks is instead copied straight
+	 * into partial_tuple as its chunks arrive. partial_tuple_received is the
+	 * number of bytes of its body received so far.
+	 */
+	MinimalTuple partial_tuple;
+	uint32		partial_tuple_received;
+
 	/*
 	 * A FIFO to hold the tuples that have been completed but not yet
 	 * retrieved.  This will not be initialized until it is actually needed.
@@ -438,6 +465,16 @@ typedef struct MotionNodeEntry
 	bool            moreNetWork;
 	bool            stopped;
 
+	/*
+	 * If columnar_batch_size > 0, tuples are sent in columnar batches of up
+	 * to that many tuples. columnar_batches holds the batch being filled for
+	 * each route, followed by the one for broadcasting; it is allocated when
+	 * the first tuple is sent.
+	 */
+	int             columnar_batch_size;
+	struct ColumnarBatch **columnar_batches;
+	int             num_columnar_batches;
+
 	/*
 	 * PER-MOTION-NODE STATISTICS
 	 */
@@ -12,5 +12,8 @@ extern int PQsendGpQuery_shared(PGconn       *conn,
 								 char         *query,
 								 int          query_len,
 								 bool         nonblock);
+extern int PQresendGpQuery_shared(PGconn       *conn,
+								   char         *query,
+								   int          query_len);
 
 #endif
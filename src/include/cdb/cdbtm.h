@@ -216,6 +216,13 @@ typedef struct TMGXACT
 
 	bool						includeInCkpt;
 	int							sessionId;
+
+	/*
+	 * Set on the QD between a successful prepare broadcast and the insertion
+	 * of the distributed commit record, so that other committers can wait
+	 * for it to join their WAL flush. See dtx_group_commit_delay.
+	 */
+	bool						commitPending;
 }	TMGXACT;
 
 typedef struct TMGXACTLOCAL
@@ -306,6 +313,7 @@ extern void	rollbackDtxTransaction(void);
 
 extern void insertingDistributedCommitted(void);
 extern void insertedDistributedCommitted(void);
+extern void waitForDistributedCommitGroup(void);
 
 extern void redoDtxCheckPoint(TMGXACT_CHECKPOINT *gxact_checkpoint);
 extern void redoDistributedCommitRecord(DistributedTransactionId gxid);
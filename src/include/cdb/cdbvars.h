@@ -368,6 +368,14 @@ extern bool gp_interconnect_aggressive_retry; /* fast-track app-level retry */
  */
 extern bool gp_interconnect_full_crc;
 
+/*
+ * Parameter gp_interconnect_compression
+ *
+ * Compress the payload of interconnect packets with zstd before sending.
+ * Connections whose data doesn't compress well stop trying for a while.
+ */
+extern bool gp_interconnect_compression;
+
 /*
  * Parameter gp_interconnect_log_stats
  *
@@ -429,6 +437,12 @@ extern bool gp_enable_fast_sri;
 /* Enable single-mirror pair dispatch. */
 extern bool gp_enable_direct_dispatch;
 
+/* Let QEs cache dispatched plans, and dispatch only their fingerprints. */
+extern bool gp_enable_qe_plan_cache;
+
+/* Number of plans each QE caches. */
+extern int gp_qe_plan_cache_size;
+
 /* Name of pseudo-function to access any table as if it was randomly distributed. */
 #define GP_DIST_RANDOM_NAME "GP_DIST_RANDOM"
 
@@ -525,6 +539,12 @@ extern bool gp_adjust_selectivity_for_outerjoins;
  */
 extern int gp_hashjoin_tuples_per_bucket;
 
+/*
+ * Keep as many hash join batches in memory as fit, and split only the
+ * batches that overflow, instead of doubling the number of batches (HJ).
+ */
+extern bool gp_enable_hybrid_hashjoin;
+
 /*
  * Damping of selectivities of clauses which pertain to the same base
  * relation; compensates for undetected correlation
@@ -634,6 +654,12 @@ extern bool     gp_eager_two_phase_agg;
 /* Analyze tools */
 extern int gp_motion_slice_noop;
 
+/* Number of tuples a redistribute motion hashes at a time */
+extern int gp_motion_hash_batch_size;
+
+/* Number of tuples a motion sends at a time in a columnar batch */
+extern int gp_motion_columnar_batch_size;
+
 /* Disable setting of hint-bits while reading db pages */
 extern bool gp_disable_tuple_hints;
 
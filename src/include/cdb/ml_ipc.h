@@ -306,6 +306,21 @@ extern ChunkTransportStateEntry *removeChunkTransportState(ChunkTransportState *
 
 extern TupleChunkListItem RecvTupleChunk(MotionConn *conn, ChunkTransportState *transportStates);
 
+/*
+ * Compress the chunks in a packet's payload into a single TC_COMPRESSED
+ * chunk, in place, if gp_interconnect_compression is on and it pays off.
+ * Returns the new payload length; RecvTupleChunk() undoes it.
+ */
+extern int	CompressPacketPayload(MotionConn *conn, uint8 *payload, int len);
+
+/*
+ * Sum up the payload bytes received on the connections of a motion node, as
+ * they were before compression and as they came over the wire.
+ */
+extern void GetMotionCompressionStats(ChunkTransportState *transportStates,
+									  int16 motNodeID,
+									  uint64 *payloadBytes, uint64 *wireBytes);
+
 extern void InitMotionTCP(int *listenerSocketFd, uint16 *listenerPort);
 extern void InitMotionUDPIFC(int *listenerSocketFd, uint16 *listenerPort);
 extern void markUDPConnInactiveIFC(MotionConn *conn);
@@ -0,0 +1,65 @@
+/*-------------------------------------------------------------------------
+ * tupcolbatch.h
+ *	   Columnar batches of tuples, for sending through the Motion layer.
+ *
+ * Portions Copyright (c) 2012-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/cdb/tupcolbatch.h
+ *-------------------------------------------------------------------------
+ */
+#ifndef TUPCOLBATCH_H
+#define TUPCOLBATCH_H
+
+#include "access/htup.h"
+#include "access/tupdesc.h"
+#include "executor/tuptable.h"
+#include "lib/stringinfo.h"
+
+/*
+ * Maximum number of tuples in a batch. Run lengths are sent as uint16.
+ */
+#define COLUMNAR_BATCH_MAX_TUPLES	8192
+
+/*
+ * A batch of tuples being accumulated for one route, until it's encoded
+ * column by column.
+ *
+ * The attribute values are appended to 'data' row by row, in the form they
+ * will have on the wire. 'offsets' and 'lens' give the position and length
+ * of each value in 'data', indexed by (tuple * natts + attribute). The
+ * length of a NULL is -1.
+ */
+typedef struct ColumnarBatch
+{
+	TupleDesc	tupdesc;
+	int			maxtuples;
+	int			alloctuples;	/* tuples 'offsets' and 'lens' have room for */
+	int			ntuples;
+
+	StringInfoData data;
+	uint32	   *offsets;
+	int32	   *lens;
+
+	/* Scratch space for EncodeColumnarBatch() */
+	uint8	   *codes;
+} ColumnarBatch;
+
+/* Can tuples of this descriptor be sent in columnar batches? */
+extern bool ColumnarBatchSupported(TupleDesc tupdesc);
+
+extern ColumnarBatch *CreateColumnarBatch(TupleDesc tupdesc, int maxtuples);
+extern void DestroyColumnarBatch(ColumnarBatch *batch);
+
+/* Add a tuple to the batch. Returns true if the batch is now full. */
+extern bool AppendToColumnarBatch(ColumnarBatch *batch, TupleTableSlot *slot);
+
+/* Encode the tuples of a batch into 'buf', and empty the batch. */
+extern void EncodeColumnarBatch(ColumnarBatch *batch, StringInfo buf);
+
+/* Decode an encoded batch back into an array of tuples. */
+extern MinimalTuple *DecodeColumnarBatch(TupleDesc tupdesc, char *data, int len,
+										 int *ntuples);
+
+#endif   /* TUPCOLBATCH_H */
@@ -60,6 +60,13 @@ typedef struct SerTupInfo
 
 	/* true if tupdesc contains record types */
 	bool		has_record_types;
+
+	/*
+	 * Tuples decoded from a columnar batch by CvtChunksToTup(), not yet
+	 * collected by the caller.
+	 */
+	MinimalTuple *batch_tuples;
+	int			batch_ntuples;
 }	SerTupInfo;
 
 /*
@@ -67,6 +74,17 @@ typedef struct SerTupInfo
  * dependency
  */
 struct directTransportBuffer;
+struct ColumnarBatch;
+struct MotionLayerState;
+struct ChunkTransportState;
+
+/*
+ * Return values of SerializeTuple(), besides the length of a tuple serialized
+ * into the direct transport buffer.
+ */
+#define SERIALIZE_TUPLE_CHUNKED		0	/* tuple is in the chunk list */
+#define SERIALIZE_TUPLE_SCATTERED	(-1)	/* tuple was sent, scattered over packets */
+#define SERIALIZE_TUPLE_STOPPED		(-2)	/* all the receivers have stopped */
 
 /* Populate a SerTupInfo struct with information looked up from the specified
  * tuple-descriptor.
@@ -81,12 +99,29 @@ extern void SerializeRecordCacheIntoChunks(SerTupInfo *pSerInfo,
 										   TupleChunkList tcList,
 										   MotionConn *conn);
 
+/* Convert a columnar batch of tuples into chunks ready to send out */
+extern void SerializeColumnarBatchIntoChunks(SerTupInfo *pSerInfo,
+											 TupleChunkList tcList,
+											 struct ColumnarBatch *batch);
+
 /* Convert a tuple into chunks directly in a set of transport buffers */
-extern int SerializeTuple(TupleTableSlot *tuple, SerTupInfo *pSerInfo, struct directTransportBuffer *b, TupleChunkList tcList, int16 targetRoute);
+extern int SerializeTuple(TupleTableSlot *tuple, SerTupInfo *pSerInfo,
+						  struct MotionLayerState *mlStates,
+						  struct ChunkTransportState *transportStates,
+						  int16 motNodeID,
+						  struct directTransportBuffer *b, TupleChunkList tcList, int16 targetRoute);
 
 /* Convert a sequence of chunks containing serialized tuple data into a
- * MinimalTuple.
+ * MinimalTuple. If the chunks hold a columnar batch, NULL is returned and
+ * the tuples are left in pSerInfo->batch_tuples.
  */
 extern MinimalTuple CvtChunksToTup(TupleChunkList tclist, SerTupInfo *pSerInfo, TupleRemapper *remapper);
 
+/*
+ * Reassemble a tuple that spans several chunks directly into a MinimalTuple,
+ * one chunk at a time, without keeping the chunks.
+ */
+extern MinimalTuple BeginChunkedTuple(TupleChunkListItem tcItem, uint32 *received);
+extern bool AddChunkToTuple(MinimalTuple tup, uint32 *received, TupleChunkListItem tcItem);
+
 #endif   /* TUPSER_H */
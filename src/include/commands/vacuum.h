@@ -161,6 +161,7 @@ typedef enum VacuumOption
 
 	/* Extra GPDB options */
 	VACOPT_AO_AUX_ONLY = 1 << 8,
+	VACOPT_INCREMENTAL = 1 << 9,	/* skip unmodified append-optimized tables */
 	VACOPT_ROOTONLY = 1 << 10,
 	VACOPT_FULLSCAN = 1 << 11,
 
@@ -64,6 +64,20 @@ struct StringInfoData;                  /* #include "lib/stringinfo.h" */
  * inner batch file.  Subsequently, while reading either inner or outer batch
  * files, we might find tuples that no longer belong to the current batch;
  * if so, we just dump them out to the correct batch file.
+ *
+ * In GPDB, when gp_enable_hybrid_hashjoin is on (and the hash table is
+ * neither parallel nor kept for rescans), we do two things differently:
+ *
+ * During the first pass, all the batches start out resident in memory, and
+ * when the hash table gets too big we dump out the largest batches other
+ * than batch 0 until it fits again.  The batches that stay resident are
+ * probed during the first scan of the outer relation, just like batch 0, and
+ * never get written to temp files at all.
+ *
+ * When the only batch in memory is still too big, we split just that batch
+ * in two, instead of doubling nbatch.  The new half gets the next unused
+ * batch number, and we remember which hash bit selects it; see
+ * ExecHashGetBucketAndBatch.  A tuple can still only move to a later batch.
  * ----------------------------------------------------------------
  */
 
@@ -117,6 +131,21 @@ typedef struct HashSkewBucket
 #define SKEW_WORK_MEM_PERCENT  2
 #define SKEW_MIN_OUTER_FRACTION  0.01
 
+/*
+ * When batches are split one at a time, each batch remembers the batches
+ * that were split off from it, in the order they were created.  A tuple
+ * belongs to child batch 'c' if bit 'splitbit' of its rotated hash value is
+ * set, and it did not belong to an earlier child.
+ */
+typedef struct HashBatchSplit
+{
+	int			firstchild;		/* first batch split off this one, or -1 */
+	int			nextsibling;	/* next batch split off our parent, or -1 */
+	uint8		splitbit;		/* hash bit that selects this batch */
+	uint8		nextbit;		/* hash bit to use for our next split */
+	bool		growEnabled;	/* can this batch still be split? */
+} HashBatchSplit;
+
 /*
  * To reduce palloc overhead, the HashJoinTuples for the current batch are
  * packed in 32kB buffers instead of pallocing each tuple individually.
@@ -351,6 +380,18 @@ typedef struct HashJoinTableData
 
 	bool		growEnabled;	/* flag to shut off nbatch increases */
 
+	/*
+	 * Hybrid hash join state, see above.  batchResident and batchSpace are
+	 * only allocated if nbatch_original > 1, batchSplits only once we split
+	 * the first batch.
+	 */
+	bool		hybrid;			/* use hybrid hash join? */
+	bool	   *batchResident;	/* is each original batch in memory? */
+	Size	   *batchSpace;		/* memory used by each resident batch */
+	HashBatchSplit *batchSplits;	/* split tree, nbatch entries */
+	int			nbatch_spilled;	/* original batches dumped out in the first
+								 * pass, for EXPLAIN ANALYZE */
+
 	uint64		totalTuples;	/* # tuples obtained from inner plan */
 	uint64		partialTuples;	/* # tuples obtained from inner plan by me */
 	uint64		skewTuples;		/* # tuples inserted into skew tuples */
@@ -48,6 +48,7 @@ extern void ExecParallelHashTableInsert(HashJoinTable hashtable,
 extern void ExecParallelHashTableInsertCurrentBatch(HashJoinTable hashtable,
 													TupleTableSlot *slot,
 													uint32 hashvalue);
+extern bool ExecRuntimeFilterCheck(RuntimeFilter *rf, Datum *values, bool *isnull);
 extern bool ExecHashGetHashValue(HashState *hashState, HashJoinTable hashtable,
 								 ExprContext *econtext,
 								 List *hashkeys,
@@ -59,6 +60,7 @@ extern void ExecHashGetBucketAndBatch(HashJoinTable hashtable,
 									  uint32 hashvalue,
 									  int *bucketno,
 									  int *batchno);
+extern bool ExecHashBatchInMemory(HashJoinTable hashtable, int batchno);
 extern bool ExecScanHashBucket(HashState *hashState, HashJoinState *hjstate,
                                ExprContext *econtext);
 extern bool ExecParallelScanHashBucket(HashState *hashState, HashJoinState *hjstate,
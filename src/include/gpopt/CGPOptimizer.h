@@ -28,7 +28,7 @@ class CGPOptimizer
 public:
 	// optimize given query using GP optimizer
 	static PlannedStmt *GPOPTOptimizedPlan(
-		Query *query,
+		Query *query, bool is_parallel_cursor,
 		bool *
 			had_unexpected_failure	// output : set to true if optimizer unexpectedly failed to produce plan
 	);
@@ -44,7 +44,7 @@ public:
 
 extern "C" {
 
-extern PlannedStmt *GPOPTOptimizedPlan(Query *query,
+extern PlannedStmt *GPOPTOptimizedPlan(Query *query, bool is_parallel_cursor,
 									   bool *had_unexpected_failure);
 extern char *SerializeDXLPlan(Query *query);
 extern void InitGPOPT();
@@ -611,9 +611,29 @@ FaultInjectorType_e InjectFaultInOptTasks(const char *fault_name);
 #endif
 
 // Does the metadata cache need to be reset (because of a catalog
-// table has been changed?)
+// table has been changed?) If not, the functions below tell which
+// objects in it were affected by the catalog changes.
 bool MDCacheNeedsReset(void);
 
+// the metadata cache has caught up with the catalog changes
+void MDCacheInvalidationsProcessed(void);
+
+// were there any catalog changes since the last planned query?
+bool MDCacheHasInvalidations(void);
+
+// was the relation changed? InvalidOid asks about any relation
+bool MDCacheRelationInvalidated(Oid relid);
+
+// were the statistics of any column of the relation changed?
+bool MDCacheRelationStatsInvalidated(Oid relid);
+
+// was any entry of the catalog cache changed?
+bool MDCacheAnySyscacheInvalidated(int cacheid);
+
+// was the catalog cache entry with the given keys changed?
+bool MDCacheSyscacheInvalidated(int cacheid, Datum key1, Datum key2 = 0,
+								Datum key3 = 0);
+
 // returns true if a query cancel is requested in GPDB
 bool IsAbortRequested(void);
 
@@ -161,7 +161,8 @@ public:
 	// main translation routine for DXL tree -> PlannedStmt
 	PlannedStmt *GetPlannedStmtFromDXL(const CDXLNode *dxlnode,
 									   const Query *orig_query,
-									   bool can_set_tag);
+									   bool can_set_tag,
+									   bool is_parallel_cursor);
 
 	// translate the join types from its DXL representation to the GPDB one
 	static JoinType GetGPDBJoinTypeFromDXLJoinType(EdxlJoinType join_type);
@@ -239,6 +240,22 @@ private:
 			ctxt_translation_prev_siblings	// translation contexts of previous siblings
 	);
 
+	// set the gang of a motion's sending slice from its input segments
+	void SetSendingSliceGang(PlanSlice *sendslice,
+							 const IntPtrArray *input_segids_array) const;
+
+	// is the root of a parallel retrieve cursor plan a gather motion that
+	// can be left out?
+	static BOOL IsGatherMotionToEndpoints(const CDXLNode *dxlnode);
+
+	// translate DXL gather motion at the root of a parallel retrieve cursor
+	// plan into GPDB result node running on the endpoints
+	Plan *TranslateDXLGatherMotionToEndpoints(
+		const CDXLNode *motion_dxlnode, CDXLTranslateContext *output_context,
+		CDXLTranslationContextArray *
+			ctxt_translation_prev_siblings	// translation contexts of previous siblings
+	);
+
 	// translate DXL duplicate sensitive redistribute motion node into
 	// GPDB result node with hash filters
 	Plan *TranslateDXLRedistributeMotionToResultHashFilters(
@@ -35,6 +35,11 @@ namespace gpdxl
 class CDXLNode;
 }
 
+namespace gpmd
+{
+class IMDCacheObject;
+}
+
 namespace gpopt
 {
 class CExpression;
@@ -85,6 +90,9 @@ struct SOptContext
 	// is serializing a plan to DXL required ?
 	BOOL m_should_serialize_plan_dxl{false};
 
+	// is the plan for a PARALLEL RETRIEVE CURSOR ?
+	BOOL m_is_parallel_cursor{false};
+
 	// did the optimizer fail unexpectedly?
 	BOOL m_is_unexpected_failure{false};
 
@@ -126,13 +134,17 @@ private:
 	static COptimizerConfig *CreateOptimizerConfig(CMemoryPool *mp,
 												   ICostModel *cost_model);
 
+	// is the metadata cache object affected by the latest catalog changes?
+	static BOOL IsMDCacheObjectInvalidated(gpmd::IMDCacheObject *const &md_obj,
+										   void *arg);
+
 	// optimize a query to a physical DXL
 	static void *OptimizeTask(void *ptr);
 
 	// translate a DXL tree into a planned statement
 	static PlannedStmt *ConvertToPlanStmtFromDXL(
 		CMemoryPool *mp, CMDAccessor *md_accessor, const Query *orig_query,
-		const CDXLNode *dxlnode, bool can_set_tag,
+		const CDXLNode *dxlnode, bool can_set_tag, bool is_parallel_cursor,
 		DistributionHashOpsKind distribution_hashops);
 
 	// load search strategy from given path
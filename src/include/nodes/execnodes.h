@@ -1503,6 +1503,21 @@ typedef struct SeqScanState
 {
 	ScanState	ss;				/* its first field is NodeTag */
 	Size		pscan_len;		/* size of parallel heap scan descriptor */
+
+	/*
+	 * GPDB: State of the batch scan path, for table AMs that support
+	 * table_scan_getnextbatch(). See nodeSeqscan.c.
+	 */
+	struct TableScanBatchData *batch;	/* NULL if scanning a tuple at a time */
+	int			batchpos;		/* next entry of batch->selected to return */
+	int			nbatchatts;		/* number of attributes the AM fetches */
+	int		   *batchatts;		/* their 0-based attribute numbers */
+	int			nbatchquals;	/* number of quals evaluated over the batch */
+	struct SeqScanBatchQual *batchquals;	/* private to nodeSeqscan.c */
+
+	/* GPDB: runtime filters pushed down by hash joins above, see nodeHash.c */
+	List	   *runtime_filters;	/* list of RuntimeFilter */
+	double		rf_nfiltered;	/* rows they rejected, for EXPLAIN ANALYZE */
 } SeqScanState;
 
 /* ----------------
@@ -2565,6 +2580,19 @@ typedef struct AggState
 
 	/* stream entries when out of memory instead of spilling to disk */
 	bool		streaming;
+
+	/*
+	 * Streaming only: when a round of hashing barely reduces its input, the
+	 * next rows are passed through with their own transition states instead.
+	 */
+	bool		streaming_passthrough;	/* pass rows through after this round? */
+	uint64		streaming_round_ninput;	/* input rows hashed in this round */
+	uint64		streaming_passthrough_left; /* rows to pass through before
+											 * hashing again */
+	AggStatePerGroup streaming_passthrough_pergroup;	/* transition states
+														 * of the current row */
+	double		streaming_passthrough_nrows;	/* rows passed through, for
+												 * EXPLAIN ANALYZE */
 } AggState;
 
 typedef struct TupleSplitState
@@ -2780,6 +2808,12 @@ typedef struct HashInstrumentation
 	int			nbatch;			/* number of batches at end of execution */
 	int			nbatch_original;	/* planned number of batches */
 	size_t		space_peak;		/* speak memory usage in bytes */
+
+	/* GPDB: hybrid hash join only */
+	bool		hybrid;			/* was hybrid hash join used? */
+	int			nbatch_resident;	/* original batches never written out */
+	int			nbatch_spilled; /* original batches dumped out */
+	int			nbatch_split;	/* batches added by splitting one */
 } HashInstrumentation;
 
 /* ----------------
@@ -2796,6 +2830,46 @@ typedef struct SharedHashInfo
  *	 HashState information
  * ----------------
  */
+/* ----------------
+ *	 RuntimeFilter information
+ *
+ *		GPDB: A filter built from the inner side of a hash join while its
+ *		hash table is built, and checked by a scan on the outer side of the
+ *		join in the same slice, to drop the rows that cannot find a join
+ *		partner before they travel up the plan. It holds a Bloom filter of
+ *		the hash values of the inner rows, and for a single integer key,
+ *		the range of the inner key values. See nodeHash.c.
+ * ----------------
+ */
+typedef struct RuntimeFilter
+{
+	bool		ready;			/* built for the current hash table? */
+
+	/* hash join keys, as columns of the scanned relation */
+	int			nkeys;
+	AttrNumber *scanattnos;		/* attribute numbers in the scanned relation */
+	FmgrInfo   *hashfunctions;	/* outer hash functions */
+	Oid		   *collations;
+	bool	   *hashstrict;		/* is each hash operator strict? */
+
+	struct bloom_filter *bloom; /* hash values of the inner rows, or NULL */
+	double		bloom_elems;	/* expected number of inner rows */
+
+	bool		hasrange;		/* keep track of the key range? */
+	Oid			innertype;		/* type of the inner key */
+	Oid			outertype;		/* type of the outer key */
+	bool		rangeempty;		/* no inner key values seen yet */
+	int64		minval;			/* range of the inner key values */
+	int64		maxval;
+
+	/* checks so far, to stop checking if few rows are rejected */
+	uint64		nchecked;
+	uint64		nrejected;
+	bool		disabled;
+
+	MemoryContext tmpcxt;		/* for evaluating the hash functions */
+} RuntimeFilter;
+
 typedef struct HashState
 {
 	PlanState	ps;				/* its first field is NodeTag */
@@ -2806,6 +2880,9 @@ typedef struct HashState
 	bool		hs_hashkeys_null;	/* found an instance wherein hashkeys are all null */
 	/* hashkeys is same as parent's hj_InnerHashKeys */
 
+	/* GPDB: runtime filter to build along with the hash table, or NULL */
+	RuntimeFilter *runtime_filter;
+
 	SharedHashInfo *shared_info;	/* one entry per worker * Greenplum: per QE */
 	HashInstrumentation *hinstrument;	/* this worker's entry */
 
@@ -2956,6 +3033,14 @@ typedef struct MotionState
 	struct CdbHash *cdbhash;	/* hash api object */
 	int			numHashSegments;	/* number of segments to use when calculating hash */
 
+	/* For redistribute motion send, tuples buffered to be hashed in batches */
+	int			sendBatchSize;	/* 0 if tuples are hashed one at a time */
+	int			sendBatchCount;	/* number of tuples in sendBatchSlots */
+	TupleTableSlot **sendBatchSlots;
+	Datum	   *sendBatchKeys;	/* values of one hash key, for each tuple */
+	bool	   *sendBatchKeyNulls;
+	uint32	   *sendBatchHashes;	/* hash, then target segment, of each tuple */
+
 	/* For Motion recv */
 	int			routeIdNext;	/* for a sorted motion node, the routeId to get next (same as
 								 * the routeId last returned ) */
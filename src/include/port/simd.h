@@ -0,0 +1,76 @@
+/*-------------------------------------------------------------------------
+ *
+ * simd.h
+ *	  Support for platform-specific vector operations.
+ *
+ * Only SSE2 is used, since it's part of the x86-64 baseline and so needs
+ * neither a configure test nor a runtime check.  Elsewhere, USE_NO_SIMD is
+ * defined and callers must fall back to plain loops.
+ *
+ * Portions Copyright (c) 2012-Present VMware, Inc. or its affiliates.
+ *
+ *
+ * IDENTIFICATION
+ *	    src/include/port/simd.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SIMD_H
+#define SIMD_H
+
+#if (defined(__x86_64__) || defined(_M_AMD64))
+#include <emmintrin.h>
+#define USE_SSE2
+typedef __m128i Vector8;
+#else
+#define USE_NO_SIMD
+#endif
+
+#ifndef USE_NO_SIMD
+
+/*
+ * Load a chunk of memory into a vector.  No alignment is required.
+ */
+static inline Vector8
+vector8_load(const char *s)
+{
+	return _mm_loadu_si128((const __m128i *) s);
+}
+
+/*
+ * Create a vector with all elements set to the same value.
+ */
+static inline Vector8
+vector8_broadcast(const char c)
+{
+	return _mm_set1_epi8(c);
+}
+
+/*
+ * Compare the elements of two vectors.  Each element of the result is all
+ * ones where they're equal, and zero where they're not.
+ */
+static inline Vector8
+vector8_eq(const Vector8 v1, const Vector8 v2)
+{
+	return _mm_cmpeq_epi8(v1, v2);
+}
+
+static inline Vector8
+vector8_or(const Vector8 v1, const Vector8 v2)
+{
+	return _mm_or_si128(v1, v2);
+}
+
+/*
+ * Return a bitmask with bit i set if the high bit of element i is set.
+ */
+static inline uint32
+vector8_highbit_mask(const Vector8 v)
+{
+	return (uint32) _mm_movemask_epi8(v);
+}
+
+#endif							/* ! USE_NO_SIMD */
+
+#endif							/* SIMD_H */
@@ -46,6 +46,24 @@ extern void gp_decompress(
 		CompressionState *compressionState,
 		int64 bufferCount);
 
+/*
+ * A block to decompress with gp_decompress_parallel(). Jobs with a NULL
+ * 'compressed' pointer are ignored. 'ok' is set if the block was
+ * decompressed to exactly uncompressedLen bytes; otherwise the caller
+ * falls back to gp_decompress(), which reports the error.
+ */
+typedef struct GpDecompressJob
+{
+	CompressionState *compressionState;
+	uint8	   *compressed;
+	int32		compressedLen;
+	uint8	   *uncompressed;
+	int32		uncompressedLen;
+	bool		ok;
+} GpDecompressJob;
+
+extern void gp_decompress_parallel(GpDecompressJob *jobs, int njobs);
+
 /*
  * We use ZStandard compression in a few different places. These functions
  * provide support for tracking ZSTD compression/decompression contexts
@@ -16,6 +16,7 @@
 #define DATUMSTREAM_H
 
 #include "catalog/pg_attribute.h"
+#include "storage/gp_compress.h"
 #include "utils/datumstreamblock.h"
 
 /*
@@ -65,6 +66,13 @@ typedef struct DatumStreamWrite
 
 	DatumStreamBlockWrite blockWrite;
 
+	/*
+	 * Zone map of the values put into the current block. Only maintained
+	 * when zoneMapTypid is valid, see AppendOnlyZoneMap_TypeDomain().
+	 */
+	Oid			zoneMapTypid;
+	MinipageZoneMapEntry zoneMap;
+
 	/*
 	 * EOFs of current segment file.
 	 */
@@ -308,6 +316,12 @@ datumstreamwrite_lob(DatumStreamWrite *acc,
 extern int	datumstreamread_block(DatumStreamRead * ds,
 								  AppendOnlyBlockDirectory *blockDirectory,
 								  int colGroupNo);
+extern int	datumstreamread_block_begin(DatumStreamRead * ds,
+										GpDecompressJob *job);
+extern void datumstreamread_block_end(DatumStreamRead * ds,
+									  AppendOnlyBlockDirectory *blockDirectory,
+									  int colGroupNo,
+									  GpDecompressJob *job);
 extern void datumstreamread_find(DatumStreamRead * datumStream,
 					 int32 rowNumInBlock);
 extern void datumstreamread_rewind_block(DatumStreamRead * datumStream);
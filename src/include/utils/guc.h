@@ -288,6 +288,12 @@ extern bool gp_local_distributed_cache_stats;
 extern bool gp_appendonly_verify_block_checksums;
 extern bool gp_appendonly_verify_write_block;
 extern bool gp_appendonly_compaction;
+extern bool gp_enable_aocs_zonemap_skipping;
+extern bool gp_aocs_build_zonemaps;
+extern bool gp_enable_aocs_batch_scan;
+extern bool gp_enable_runtime_filter_pushdown;
+extern bool gp_enable_hashagg_passthrough;
+extern double gp_hashagg_passthrough_ratio;
 
 /*
  * Threshold of the ratio of dirty data in a segment file
@@ -298,6 +304,18 @@ extern bool gp_appendonly_compaction;
  * 10% of the tuples are hidden.
  */
 extern int  gp_appendonly_compaction_threshold;
+
+/*
+ * Amount of an append-only segment file, in kB, that sequential reads ask
+ * the kernel to read ahead of the current position. 0 disables it.
+ */
+extern int	gp_appendonly_prefetch_size;
+
+/*
+ * Number of helper threads that decompress the blocks of different columns
+ * of an AOCS scan concurrently. 0 disables it.
+ */
+extern int	gp_aocs_decompress_threads;
 extern bool gp_heap_require_relhasoids_match;
 extern bool	debug_xlog_record_read;
 extern bool Debug_cancel_print;
@@ -313,6 +331,7 @@ extern bool Debug_resource_group;
 extern bool gp_create_table_random_default_distribution;
 extern bool gp_allow_non_uniform_partitioning_ddl;
 extern int  dtx_phase2_retry_second;
+extern int  dtx_group_commit_delay;
 extern bool gp_log_suboverflow_statement;
 /* WAL replication debug gucs */
 extern bool debug_walrepl_snd;
@@ -447,6 +466,7 @@ extern int optimizer_minidump;
 extern int  optimizer_cost_model;
 extern bool optimizer_metadata_caching;
 extern int	optimizer_mdcache_size;
+extern bool optimizer_mdcache_selective_eviction;
 
 /* Optimizer debugging GUCs */
 extern bool optimizer_print_query;
@@ -609,6 +629,7 @@ extern bool gp_external_enable_filter_pushdown;
 extern bool gp_enable_global_deadlock_detector;
 
 extern bool gp_log_endpoints;
+extern int	gp_endpoint_batch_size;
 
 extern bool gp_allow_date_field_width_5digits;
 
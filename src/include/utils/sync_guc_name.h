@@ -35,8 +35,11 @@
 		"gin_fuzzy_search_limit",
 		"gin_pending_list_limit",
 		"gp_allow_date_field_width_5digits",
+		"gp_aocs_build_zonemaps",
+		"gp_aocs_decompress_threads",
 		"gp_appendonly_compaction",
 		"gp_appendonly_compaction_threshold",
+		"gp_appendonly_prefetch_size",
 		"gp_appendonly_verify_block_checksums",
 		"gp_appendonly_verify_write_block",
 		"gp_blockdirectory_entry_min_range",
@@ -44,15 +47,23 @@
 		"gp_debug_linger",
 		"gp_default_storage_options",
 		"gp_disable_tuple_hints",
+		"gp_enable_aocs_batch_scan",
+		"gp_enable_aocs_zonemap_skipping",
+		"gp_enable_hashagg_passthrough",
+		"gp_enable_hybrid_hashjoin",
 		"gp_enable_interconnect_aggressive_retry",
+		"gp_enable_runtime_filter_pushdown",
 		"gp_enable_segment_copy_checking",
+		"gp_endpoint_batch_size",
 		"gp_external_enable_filter_pushdown",
+		"gp_hashagg_passthrough_ratio",
 		"gp_hashjoin_tuples_per_bucket",
 		"gp_ignore_error_table",
 		"gp_indexcheck_insert",
 		"gp_initial_bad_row_limit",
 		"gp_interconnect_address_type",
 		"gp_interconnect_cache_future_packets",
+		"gp_interconnect_compression",
 		"gp_interconnect_debug_retry_interval",
 		"gp_interconnect_default_rtt",
 		"gp_interconnect_fc_method",
@@ -76,6 +87,8 @@
 		"gp_log_stack_trace_lines",
 		"gp_log_suboverflow_statement",
 		"gp_max_packet_size",
+		"gp_motion_columnar_batch_size",
+		"gp_motion_hash_batch_size",
 		"gp_motion_slice_noop",
 		"gp_quicklz_fallback",
 		"gp_resgroup_debug_wait_queue",
@@ -88,6 +88,7 @@
 		"default_transaction_read_only",
 		"default_with_oids",
 		"disable_cost",
+		"dtx_group_commit_delay",
 		"dtx_phase2_retry_second",
 		"dynamic_library_path",
 		"dynamic_shared_memory_type",
@@ -168,6 +169,7 @@
 		"gp_enable_multiphase_agg",
 		"gp_enable_predicate_propagation",
 		"gp_enable_preunique",
+		"gp_enable_qe_plan_cache",
 		"gp_enable_query_metrics",
 		"gp_enable_relsize_collection",
 		"gp_enable_slow_writer_testmode",
@@ -205,6 +207,7 @@
 		"gp_print_create_gang_time",
 		"gp_qd_hostname",
 		"gp_qd_port",
+		"gp_qe_plan_cache_size",
 		"gp_recursive_cte",
 		"gp_recursive_cte_prototype",
 		"gp_reject_internal_tcp_connection",
@@ -397,6 +400,7 @@
 		"optimizer_join_order_threshold",
 		"optimizer_log",
 		"optimizer_log_failure",
+		"optimizer_mdcache_selective_eviction",
 		"optimizer_mdcache_size",
 		"optimizer_metadata_caching",
 		"optimizer_minidump",
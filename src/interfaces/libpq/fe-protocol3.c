@@ -189,6 +189,15 @@ pqParseInput3(PGconn *conn)
 			if (pqGetc(&conn->wrote_xlog, conn))
 				return;
 		}
+		else if (id == 'p')
+		{
+			/*
+			 * CDB: the QE doesn't have the plan it was sent the key of in its
+			 * plan cache, and asks for the query again with the plan in full.
+			 */
+			if (pqGetInt64(&conn->plan_cache_miss, conn))
+				return;
+		}
 #endif
 		else if (conn->asyncStatus != PGASYNC_BUSY)
 		{
@@ -513,6 +513,7 @@ struct pg_conn
 	PGresult   *next_result;	/* next result (used in single-row mode) */
 
 	char		wrote_xlog;
+	int64		plan_cache_miss;	/* fingerprint of a plan the QE asked for */
 
 	/* Assorted state for SASL, SSL, GSS, etc */
 	void	   *sasl_state;
@@ -0,0 +1,60 @@
+-- Test the group commit of distributed commit records. With
+-- dtx_group_commit_delay, a committer waits for the other prepared
+-- distributed transactions to write their commit records before it flushes
+-- WAL. All of them must commit, and no committer may wait for longer than
+-- the delay.
+
+-- The wait is skipped when fsync is off, as in the demo cluster. Turn it on
+-- for the coordinator only; ALTER SYSTEM RESET brings back whatever was set
+-- before.
+ALTER SYSTEM SET fsync TO on;
+SELECT pg_reload_conf();
+
+CREATE TABLE dtx_group_commit (a int, b int) DISTRIBUTED BY (a);
+
+SELECT gp_inject_fault_infinite('dtx_group_commit_wait', 'skip', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+
+-- Hold 4 transactions after their prepare, and then let them commit at once.
+SELECT gp_inject_fault_infinite('dtm_broadcast_prepare', 'suspend', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+1: SET dtx_group_commit_delay = 100000;
+2: SET dtx_group_commit_delay = 100000;
+3: SET dtx_group_commit_delay = 100000;
+4: SET dtx_group_commit_delay = 100000;
+1&: INSERT INTO dtx_group_commit SELECT i, 1 FROM generate_series(1, 10) i;
+2&: INSERT INTO dtx_group_commit SELECT i, 2 FROM generate_series(1, 10) i;
+3&: INSERT INTO dtx_group_commit SELECT i, 3 FROM generate_series(1, 10) i;
+4&: INSERT INTO dtx_group_commit SELECT i, 4 FROM generate_series(1, 10) i;
+SELECT gp_wait_until_triggered_fault('dtm_broadcast_prepare', 4, dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+SELECT gp_inject_fault('dtm_broadcast_prepare', 'reset', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+1<:
+2<:
+3<:
+4<:
+SELECT b, count(*) FROM dtx_group_commit GROUP BY b ORDER BY b;
+
+-- A transaction that stays prepared holds up the others only for the
+-- delay. Session 1 is held after its prepare, while sessions 2 and 3 commit
+-- and wait for it.
+SELECT gp_inject_fault('dtm_broadcast_prepare', 'suspend', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+1&: INSERT INTO dtx_group_commit SELECT i, 5 FROM generate_series(1, 10) i;
+SELECT gp_wait_until_triggered_fault('dtm_broadcast_prepare', 1, dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+SELECT gp_inject_fault('dtx_group_commit_wait', 'reset', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+SELECT gp_inject_fault_infinite('dtx_group_commit_wait', 'skip', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+2: INSERT INTO dtx_group_commit SELECT i, 6 FROM generate_series(1, 10) i;
+3: BEGIN;
+3: INSERT INTO dtx_group_commit SELECT i, 7 FROM generate_series(1, 10) i;
+3: COMMIT;
+SELECT gp_wait_until_triggered_fault('dtx_group_commit_wait', 2, dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+SELECT gp_inject_fault('dtm_broadcast_prepare', 'reset', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+1<:
+SELECT b, count(*) FROM dtx_group_commit GROUP BY b ORDER BY b;
+
+SELECT gp_inject_fault('dtx_group_commit_wait', 'reset', dbid) FROM gp_segment_configuration WHERE role = 'p' AND content = -1;
+1q:
+2q:
+3q:
+4q:
+DROP TABLE dtx_group_commit;
+
+ALTER SYSTEM RESET fsync;
+SELECT pg_reload_conf();
@@ -0,0 +1,18 @@
+--
+-- Test that ANALYZE, which deforms the sample rows a batch of columns at a
+-- time, gets the same statistics for every column, with NULLs, varlena
+-- columns, columns added after the rows and columns analyzed out of order.
+--
+CREATE TABLE analyze_columns (a int, b text, c int, d text, e int) DISTRIBUTED BY (a);
+INSERT INTO analyze_columns
+SELECT i, CASE WHEN i % 10 = 0 THEN NULL ELSE 'b' || (i % 5) END, i % 3, repeat('x', i % 7), i
+FROM generate_series(1, 1000) i;
+ALTER TABLE analyze_columns ADD COLUMN f int DEFAULT 7;
+ANALYZE analyze_columns;
+SELECT attname, null_frac, n_distinct FROM pg_stats
+WHERE tablename = 'analyze_columns' ORDER BY attname;
+DELETE FROM pg_statistic WHERE starelid = 'analyze_columns'::regclass;
+ANALYZE analyze_columns (f, d, b);
+SELECT attname, null_frac, n_distinct FROM pg_stats
+WHERE tablename = 'analyze_columns' ORDER BY attname;
+DROP TABLE analyze_columns;
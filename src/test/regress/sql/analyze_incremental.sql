@@ -0,0 +1,64 @@
+--
+-- Test that ANALYZE (INCREMENTAL) skips append-optimized tables that weren't
+-- modified since they were last analyzed. The statistics are overwritten by
+-- hand, to tell whether ANALYZE recomputed them.
+--
+CREATE TABLE analyze_incr_ao (a int, b text) WITH (appendonly=true) DISTRIBUTED BY (a);
+INSERT INTO analyze_incr_ao SELECT i, 'b' || (i % 10) FROM generate_series(1, 1000) i;
+ANALYZE analyze_incr_ao;
+SELECT analyzemodcount FROM pg_appendonly WHERE relid = 'analyze_incr_ao'::regclass;
+ANALYZE (INCREMENTAL) analyze_incr_ao;
+SELECT analyzemodcount > 0 FROM pg_appendonly WHERE relid = 'analyze_incr_ao'::regclass;
+
+UPDATE pg_statistic SET stadistinct = 42 WHERE starelid = 'analyze_incr_ao'::regclass AND staattnum = 2;
+ANALYZE (INCREMENTAL) analyze_incr_ao;
+SELECT stadistinct FROM pg_statistic WHERE starelid = 'analyze_incr_ao'::regclass AND staattnum = 2;
+
+-- Inserts, deletes and updates are all modifications.
+INSERT INTO analyze_incr_ao VALUES (1001, 'b1');
+ANALYZE (INCREMENTAL) analyze_incr_ao;
+SELECT stadistinct FROM pg_statistic WHERE starelid = 'analyze_incr_ao'::regclass AND staattnum = 2;
+UPDATE pg_statistic SET stadistinct = 42 WHERE starelid = 'analyze_incr_ao'::regclass AND staattnum = 2;
+DELETE FROM analyze_incr_ao WHERE a = 1001;
+ANALYZE (INCREMENTAL) analyze_incr_ao;
+SELECT stadistinct FROM pg_statistic WHERE starelid = 'analyze_incr_ao'::regclass AND staattnum = 2;
+UPDATE pg_statistic SET stadistinct = 42 WHERE starelid = 'analyze_incr_ao'::regclass AND staattnum = 2;
+UPDATE analyze_incr_ao SET b = 'b1' WHERE a = 1000;
+ANALYZE (INCREMENTAL) analyze_incr_ao;
+SELECT stadistinct FROM pg_statistic WHERE starelid = 'analyze_incr_ao'::regclass AND staattnum = 2;
+
+-- A new column has no statistics yet, so the table is analyzed again.
+UPDATE pg_statistic SET stadistinct = 42 WHERE starelid = 'analyze_incr_ao'::regclass AND staattnum = 2;
+ALTER TABLE analyze_incr_ao ADD COLUMN c int DEFAULT 7;
+ANALYZE (INCREMENTAL) analyze_incr_ao;
+SELECT stadistinct FROM pg_statistic WHERE starelid = 'analyze_incr_ao'::regclass AND staattnum = 2;
+
+-- TRUNCATE starts the modcounts over.
+TRUNCATE analyze_incr_ao;
+SELECT analyzemodcount FROM pg_appendonly WHERE relid = 'analyze_incr_ao'::regclass;
+DROP TABLE analyze_incr_ao;
+
+CREATE TABLE analyze_incr_aocs (a int, b text) WITH (appendonly=true, orientation=column) DISTRIBUTED BY (a);
+INSERT INTO analyze_incr_aocs SELECT i, 'b' || (i % 10) FROM generate_series(1, 1000) i;
+ANALYZE (INCREMENTAL) analyze_incr_aocs;
+UPDATE pg_statistic SET stadistinct = 42 WHERE starelid = 'analyze_incr_aocs'::regclass AND staattnum = 2;
+ANALYZE (INCREMENTAL) analyze_incr_aocs;
+SELECT stadistinct FROM pg_statistic WHERE starelid = 'analyze_incr_aocs'::regclass AND staattnum = 2;
+INSERT INTO analyze_incr_aocs VALUES (1001, 'b1');
+ANALYZE (INCREMENTAL) analyze_incr_aocs;
+SELECT stadistinct FROM pg_statistic WHERE starelid = 'analyze_incr_aocs'::regclass AND staattnum = 2;
+DROP TABLE analyze_incr_aocs;
+
+-- Only the partitions that were loaded into are analyzed again.
+CREATE TABLE analyze_incr_part (a int, b text) WITH (appendonly=true) DISTRIBUTED BY (a)
+PARTITION BY RANGE (a) (START (0) END (2000) EVERY (1000));
+INSERT INTO analyze_incr_part SELECT i, 'b' || (i % 10) FROM generate_series(0, 1999) i;
+ANALYZE (INCREMENTAL) analyze_incr_part;
+UPDATE pg_statistic SET stadistinct = 42 WHERE starelid = 'analyze_incr_part_1_prt_1'::regclass AND staattnum = 2;
+UPDATE pg_statistic SET stadistinct = 42 WHERE starelid = 'analyze_incr_part_1_prt_2'::regclass AND staattnum = 2;
+INSERT INTO analyze_incr_part VALUES (1500, 'b1');
+ANALYZE (INCREMENTAL) analyze_incr_part;
+SELECT starelid::regclass, stadistinct FROM pg_statistic
+WHERE starelid IN ('analyze_incr_part_1_prt_1'::regclass, 'analyze_incr_part_1_prt_2'::regclass) AND staattnum = 2
+ORDER BY 1;
+DROP TABLE analyze_incr_part;
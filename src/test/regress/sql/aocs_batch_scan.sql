@@ -0,0 +1,38 @@
+--
+-- Test sequential scans of AOCS tables that fetch a batch of rows at a time.
+--
+-- Simple "column op constant" quals are evaluated over the batch, the others
+-- one tuple at a time. The results must not depend on the scan path.
+--
+create table aocs_batch_scan (a int, b int, c text, d numeric)
+  with (appendonly=true, orientation=column) distributed by (a);
+insert into aocs_batch_scan
+  select i, case when i % 5 = 0 then null else i % 100 end, repeat('x', i % 50) || i, i / 3.0
+  from generate_series(1, 20000) i;
+
+set gp_enable_aocs_batch_scan = on;
+select count(*) from aocs_batch_scan where b < 10;
+select count(*) from aocs_batch_scan where 51 = b;
+select count(*) from aocs_batch_scan where b <> 3 and c like '%7';
+select count(*) from aocs_batch_scan where b is null;
+select sum(a) from aocs_batch_scan where b >= 98;
+select count(*) from aocs_batch_scan where d > 6666;
+select a, b, length(c) from aocs_batch_scan where b = 42 and a < 500 order by a;
+
+set gp_enable_aocs_batch_scan = off;
+select count(*) from aocs_batch_scan where b < 10;
+select count(*) from aocs_batch_scan where 51 = b;
+select count(*) from aocs_batch_scan where b <> 3 and c like '%7';
+select count(*) from aocs_batch_scan where b is null;
+select sum(a) from aocs_batch_scan where b >= 98;
+select count(*) from aocs_batch_scan where d > 6666;
+select a, b, length(c) from aocs_batch_scan where b = 42 and a < 500 order by a;
+reset gp_enable_aocs_batch_scan;
+
+-- Deleted rows must not be returned.
+delete from aocs_batch_scan where a % 1000 = 1;
+set gp_enable_aocs_batch_scan = on;
+select count(*) from aocs_batch_scan where b = 1;
+reset gp_enable_aocs_batch_scan;
+
+drop table aocs_batch_scan;
@@ -0,0 +1,48 @@
+--
+-- Test decompressing the blocks of AOCS columns on helper threads.
+--
+-- The results must be the same whatever gp_aocs_decompress_threads is set
+-- to, for both the tuple and the batch scan paths.
+--
+create table aocs_dt (a int encoding (compresstype=zlib, compresslevel=1),
+                      b text encoding (compresstype=zlib, compresslevel=5),
+                      c bigint encoding (compresstype=zstd, compresslevel=1),
+                      d text encoding (compresstype=zstd, compresslevel=3),
+                      e date encoding (compresstype=zlib, compresslevel=1))
+  with (appendonly=true, orientation=column) distributed by (a);
+insert into aocs_dt
+  select i, 'row ' || i, i * 7, repeat(chr(65 + i % 26), i % 50), '2020-01-01'::date + i % 366
+  from generate_series(1, 100000) i;
+
+set gp_aocs_decompress_threads = 4;
+select count(*), sum(a), sum(c), sum(length(b)), sum(length(d)), max(e) - min(e) from aocs_dt;
+select count(*) from (
+  select * from aocs_dt
+  except all
+  select i, 'row ' || i, i * 7, repeat(chr(65 + i % 26), i % 50), '2020-01-01'::date + i % 366
+  from generate_series(1, 100000) i) t;
+set gp_enable_aocs_batch_scan = on;
+select count(*), sum(a), sum(c), sum(length(b)), sum(length(d)), max(e) - min(e) from aocs_dt;
+select count(*) from (
+  select * from aocs_dt
+  except all
+  select i, 'row ' || i, i * 7, repeat(chr(65 + i % 26), i % 50), '2020-01-01'::date + i % 366
+  from generate_series(1, 100000) i) t;
+reset gp_enable_aocs_batch_scan;
+
+set gp_aocs_decompress_threads = 0;
+select count(*), sum(a), sum(c), sum(length(b)), sum(length(d)), max(e) - min(e) from aocs_dt;
+
+-- The zlib fault point is still reached when the helper threads decompress
+-- the blocks.
+set gp_aocs_decompress_threads = 2;
+select gp_inject_fault('zlib_decompress_after_decompress_fn', 'skip', dbid)
+  from gp_segment_configuration where content = 0 and role = 'p';
+select count(*), sum(a), sum(length(b)) from aocs_dt;
+select gp_wait_until_triggered_fault('zlib_decompress_after_decompress_fn', 1, dbid)
+  from gp_segment_configuration where content = 0 and role = 'p';
+select gp_inject_fault('zlib_decompress_after_decompress_fn', 'reset', dbid)
+  from gp_segment_configuration where content = 0 and role = 'p';
+reset gp_aocs_decompress_threads;
+
+drop table aocs_dt;
@@ -0,0 +1,104 @@
+--
+-- Test block skipping with AOCS zone maps.
+--
+-- Zone maps are recorded in the block directory, so the table needs an
+-- index, or to be created or rewritten with gp_aocs_build_zonemaps on, for
+-- them to be maintained. The results must be the same whether or not blocks are
+-- skipped.
+--
+create table aocs_zonemap (a int, d date, b bigint, t text)
+  with (appendonly=true, orientation=column) distributed by (a);
+create index aocs_zonemap_a_idx on aocs_zonemap(a);
+insert into aocs_zonemap
+  select i, '2020-01-01'::date + i / 1000, case when i % 10 = 0 then null else i end, 'row ' || i
+  from generate_series(1, 100000) i;
+
+set gp_enable_aocs_zonemap_skipping = on;
+select count(*) from aocs_zonemap where b < 500;
+select count(*) from aocs_zonemap where b between 50000 and 50999;
+select count(*) from aocs_zonemap where b = 77777;
+select count(*) from aocs_zonemap where 99990 <= b;
+select count(*) from aocs_zonemap where d = '2020-02-01';
+select count(*) from aocs_zonemap where d > '2020-04-01' and b is not null;
+select count(*) from aocs_zonemap where b is null and d < '2020-01-11';
+select count(*), min(t), max(t) from aocs_zonemap where b > 1000000;
+
+set gp_enable_aocs_zonemap_skipping = off;
+select count(*) from aocs_zonemap where b < 500;
+select count(*) from aocs_zonemap where b between 50000 and 50999;
+select count(*) from aocs_zonemap where b = 77777;
+select count(*) from aocs_zonemap where 99990 <= b;
+select count(*) from aocs_zonemap where d = '2020-02-01';
+select count(*) from aocs_zonemap where d > '2020-04-01' and b is not null;
+select count(*) from aocs_zonemap where b is null and d < '2020-01-11';
+select count(*), min(t), max(t) from aocs_zonemap where b > 1000000;
+reset gp_enable_aocs_zonemap_skipping;
+
+-- EXPLAIN ANALYZE shows the column blocks that were not read.
+create function zm_explain(query text) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in
+        execute 'explain (analyze, costs off, timing off, summary off) ' || query
+    loop
+        if ln like '%Blocks Skipped by Zone Map%' then
+            return next trim(regexp_replace(ln, '\d+', 'N'));
+        end if;
+    end loop;
+end;
+$$;
+set gp_enable_aocs_zonemap_skipping = on;
+select * from zm_explain('select count(*) from aocs_zonemap where b = 77777');
+set gp_enable_aocs_zonemap_skipping = off;
+select * from zm_explain('select count(*) from aocs_zonemap where b = 77777');
+reset gp_enable_aocs_zonemap_skipping;
+
+-- With gp_aocs_build_zonemaps, a new table gets its block directory, and
+-- with it zone maps, without an index.
+set gp_aocs_build_zonemaps = on;
+create table aocs_zonemap_noidx (a int, b bigint)
+  with (appendonly=true, orientation=column) distributed by (a);
+reset gp_aocs_build_zonemaps;
+create table aocs_zonemap_plain (a int, b bigint)
+  with (appendonly=true, orientation=column) distributed by (a);
+insert into aocs_zonemap_noidx select i, i from generate_series(1, 100000) i;
+insert into aocs_zonemap_plain select i, i from generate_series(1, 100000) i;
+select c.relname, a.blkdirrelid <> 0 as has_blkdir
+  from pg_appendonly a join pg_class c on a.relid = c.oid
+  where c.relname in ('aocs_zonemap_noidx', 'aocs_zonemap_plain') order by 1;
+select count(*) from aocs_zonemap_noidx where b = 77777;
+select * from zm_explain('select count(*) from aocs_zonemap_noidx where b = 77777');
+select count(*) from aocs_zonemap_plain where b = 77777;
+select * from zm_explain('select count(*) from aocs_zonemap_plain where b = 77777');
+
+-- A block directory built by CREATE INDEX records the zone maps of the
+-- blocks that were already there.
+create table aocs_zonemap_late (a int, b bigint)
+  with (appendonly=true, orientation=column) distributed by (a);
+insert into aocs_zonemap_late select i, i from generate_series(1, 100000) i;
+create index aocs_zonemap_late_a_idx on aocs_zonemap_late(a);
+select count(*) from aocs_zonemap_late where b = 77777;
+select * from zm_explain('select count(*) from aocs_zonemap_late where b = 77777');
+
+-- An existing table without an index gets zone maps when it is rewritten
+-- with gp_aocs_build_zonemaps on.
+set gp_aocs_build_zonemaps = on;
+alter table aocs_zonemap_plain set with (reorganize = true);
+reset gp_aocs_build_zonemaps;
+select blkdirrelid <> 0 as has_blkdir from pg_appendonly
+  where relid = 'aocs_zonemap_plain'::regclass;
+select count(*) from aocs_zonemap_plain where b = 77777;
+select * from zm_explain('select count(*) from aocs_zonemap_plain where b = 77777');
+
+-- Rows deleted after the zone maps were written must stay invisible.
+delete from aocs_zonemap where b between 50000 and 50499;
+select count(*) from aocs_zonemap where b between 50000 and 50999;
+
+drop table aocs_zonemap;
+drop table aocs_zonemap_noidx;
+drop table aocs_zonemap_plain;
+drop table aocs_zonemap_late;
+drop function zm_explain(text);
@@ -0,0 +1,35 @@
+--
+-- Test sequential scans of append-only tables with read-ahead disabled, at
+-- the default window and at a window smaller than one large read.
+--
+create table ao_prefetch_row (a int, b int, c text)
+  with (appendonly=true, compresstype=none) distributed by (a);
+create table ao_prefetch_col (a int, b int, c text)
+  with (appendonly=true, orientation=column, compresstype=none) distributed by (a);
+insert into ao_prefetch_row
+  select i, i % 100, repeat('x', 100) || i from generate_series(1, 100000) i;
+insert into ao_prefetch_col select * from ao_prefetch_row;
+
+set gp_appendonly_prefetch_size = 0;
+select count(*), sum(b), sum(length(c)) from ao_prefetch_row;
+select count(*), sum(b), sum(length(c)) from ao_prefetch_col;
+
+reset gp_appendonly_prefetch_size;
+select count(*), sum(b), sum(length(c)) from ao_prefetch_row;
+select count(*), sum(b), sum(length(c)) from ao_prefetch_col;
+
+set gp_appendonly_prefetch_size = '8kB';
+select count(*), sum(b), sum(length(c)) from ao_prefetch_row;
+select count(*), sum(b), sum(length(c)) from ao_prefetch_col;
+
+-- Index lookups read a temporary range of the segment file, which must not
+-- be confused with a sequential read.
+create index ao_prefetch_row_a on ao_prefetch_row (a);
+set enable_seqscan = off;
+select a, right(c, 6) from ao_prefetch_row where a in (1, 50000, 100000) order by a;
+reset enable_seqscan;
+select count(*), sum(b), sum(length(c)) from ao_prefetch_row;
+reset gp_appendonly_prefetch_size;
+
+drop table ao_prefetch_row;
+drop table ao_prefetch_col;
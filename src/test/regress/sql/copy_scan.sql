@@ -0,0 +1,32 @@
+--
+-- Test the parsing of text and CSV input in COPY FROM, which skips over
+-- runs of plain bytes many at a time, and parses simple integers and
+-- ISO dates without calling the input functions.
+--
+CREATE TABLE copy_scan (a int2, b int4, c int8, d date, t text) DISTRIBUTED BY (b);
+COPY copy_scan FROM stdin;
+1	100	10000000000	2024-02-29	short
+-32768	-2147483648	-9223372036854775808	1999-12-31	a long field well past thirty two bytes, with a \t tab and a \\ backslash in it
++7	0042	123456789012345678	0001-01-01	\\N is not null, but \N is
+ 12	  13	 14	Feb 28, 2023	\N
+\.
+SELECT count(*) FROM copy_scan;
+SELECT count(*) FROM copy_scan WHERE a = 1 AND b = 100 AND c = 10000000000 AND d = '2024-02-29' AND t = 'short';
+SELECT count(*) FROM copy_scan WHERE a = -32768 AND b = -2147483648 AND c = -9223372036854775808 AND d = '1999-12-31';
+SELECT count(*) FROM copy_scan WHERE t = E'a long field well past thirty two bytes, with a \t tab and a \\ backslash in it';
+SELECT count(*) FROM copy_scan WHERE a = 7 AND b = 42 AND c = 123456789012345678 AND d = '0001-01-01' AND t = '\N is not null, but N is';
+SELECT count(*) FROM copy_scan WHERE a = 12 AND b = 13 AND c = 14 AND d = '2023-02-28' AND t IS NULL;
+TRUNCATE copy_scan;
+COPY copy_scan FROM stdin CSV;
+1,1,1,2024-01-01,"quoted, with a comma and a "" quote, long enough to span a vector"
+2,2,2,2024-01-02,"embedded
+newline in a quoted field"
+3,3,3,2024-01-03,naïve café ünïcödé text that is longer than thirty two bytes
+4,4,4,2024-01-04,
+\.
+SELECT count(*) FROM copy_scan;
+SELECT count(*) FROM copy_scan WHERE t = 'quoted, with a comma and a " quote, long enough to span a vector';
+SELECT count(*) FROM copy_scan WHERE t = E'embedded\nnewline in a quoted field';
+SELECT count(*) FROM copy_scan WHERE t = 'naïve café ünïcödé text that is longer than thirty two bytes';
+SELECT count(*) FROM copy_scan WHERE t IS NULL;
+DROP TABLE copy_scan;
@@ -0,0 +1,19 @@
+--
+-- Test the latency histograms of the phases of dispatch.
+--
+select phase, count(*) from gp_dispatch_latency group by phase order by phase;
+
+select gp_dispatch_latency_reset();
+
+create table dispatch_latency_t (a int) distributed by (a);
+insert into dispatch_latency_t select generate_series(1, 100);
+select count(*) from dispatch_latency_t;
+
+select phase, sum(count) > 0 as recorded from gp_dispatch_latency
+  where phase in ('serialize', 'send', 'first_ack') group by phase order by phase;
+
+-- The buckets are contiguous powers of two.
+select count(*) from gp_dispatch_latency
+  where phase = 'send' and upper_us is not null and upper_us <> greatest(lower_us * 2, 1);
+
+drop table dispatch_latency_t;
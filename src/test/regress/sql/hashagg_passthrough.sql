@@ -0,0 +1,77 @@
+--
+-- Test the pass-through mode of streaming hash aggregates, which hand the
+-- rows on to the next aggregation stage without hashing them when hashing
+-- hardly reduces them.
+--
+CREATE TABLE hashagg_passthrough (a int, b int) DISTRIBUTED BY (a);
+INSERT INTO hashagg_passthrough SELECT i, i FROM generate_series(1, 100000) i;
+ANALYZE hashagg_passthrough;
+
+-- Only the Postgres planner is covered here. Plan every aggregate in two
+-- stages, with a HashAgg in each.
+SET optimizer = off;
+SET gp_eager_two_phase_agg = on;
+SET enable_groupagg = off;
+
+SET gp_enable_hashagg_passthrough = on;
+
+-- With pass-through enabled, the first stage is a streaming HashAgg.
+EXPLAIN (COSTS OFF) SELECT b % 50000 AS g, count(*), avg(b) FROM hashagg_passthrough GROUP BY 1;
+
+-- Every (a % 10, b) pair is unique, so the streaming stage that removes the
+-- duplicates below the DISTINCT aggregate passes the rows through.
+SELECT a % 10 AS g, count(DISTINCT b) FROM hashagg_passthrough GROUP BY 1 ORDER BY 1;
+
+-- Mostly unique groups, with serialized transition states.
+SELECT count(*) AS groups, sum(c) AS nrows, sum(s) AS total, sum(av)::bigint AS avgs
+FROM (SELECT b % 50000 AS g, count(*) AS c, sum(b) AS s, avg(b) AS av
+      FROM hashagg_passthrough GROUP BY 1) x;
+
+-- Groups that hashing does reduce.
+SELECT count(*) AS groups, sum(c) AS nrows, sum(s) AS total, sum(av)::bigint AS avgs
+FROM (SELECT b % 100 AS g, count(*) AS c, sum(b) AS s, avg(b) AS av
+      FROM hashagg_passthrough GROUP BY 1) x;
+
+-- EXPLAIN ANALYZE shows how many rows were passed through. Rows whose
+-- groups hashing does reduce are not.
+CREATE FUNCTION hp_explain(query text) RETURNS SETOF text
+LANGUAGE plpgsql AS
+$$
+DECLARE
+    ln text;
+BEGIN
+    FOR ln IN
+        EXECUTE 'EXPLAIN (ANALYZE, COSTS OFF, TIMING OFF, SUMMARY OFF) ' || query
+    LOOP
+        IF ln LIKE '%Rows Passed Through%' THEN
+            RETURN NEXT trim(regexp_replace(ln, '\d+', 'N', 'g'));
+        END IF;
+    END LOOP;
+END;
+$$;
+SELECT * FROM hp_explain('SELECT a % 10 AS g, count(DISTINCT b) FROM hashagg_passthrough GROUP BY 1');
+SELECT * FROM hp_explain('SELECT b % 50000 AS g, count(*), avg(b) FROM hashagg_passthrough GROUP BY 1');
+SELECT * FROM hp_explain('SELECT b % 100 AS g, count(*), avg(b) FROM hashagg_passthrough GROUP BY 1');
+
+-- Pass every row through, then nothing.
+SET gp_hashagg_passthrough_ratio = 0;
+SELECT a % 10 AS g, count(DISTINCT b) FROM hashagg_passthrough GROUP BY 1 ORDER BY 1;
+SELECT count(*) AS groups, sum(c) AS nrows, sum(s) AS total, sum(av)::bigint AS avgs
+FROM (SELECT b % 100 AS g, count(*) AS c, sum(b) AS s, avg(b) AS av
+      FROM hashagg_passthrough GROUP BY 1) x;
+RESET gp_hashagg_passthrough_ratio;
+
+SET gp_enable_hashagg_passthrough = off;
+EXPLAIN (COSTS OFF) SELECT b % 50000 AS g, count(*), avg(b) FROM hashagg_passthrough GROUP BY 1;
+SELECT * FROM hp_explain('SELECT a % 10 AS g, count(DISTINCT b) FROM hashagg_passthrough GROUP BY 1');
+SELECT a % 10 AS g, count(DISTINCT b) FROM hashagg_passthrough GROUP BY 1 ORDER BY 1;
+SELECT count(*) AS groups, sum(c) AS nrows, sum(s) AS total, sum(av)::bigint AS avgs
+FROM (SELECT b % 50000 AS g, count(*) AS c, sum(b) AS s, avg(b) AS av
+      FROM hashagg_passthrough GROUP BY 1) x;
+RESET gp_enable_hashagg_passthrough;
+RESET enable_groupagg;
+RESET gp_eager_two_phase_agg;
+RESET optimizer;
+
+DROP FUNCTION hp_explain(text);
+DROP TABLE hashagg_passthrough;
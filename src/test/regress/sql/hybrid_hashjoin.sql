@@ -0,0 +1,82 @@
+--
+-- Test hybrid hash join, which keeps as many batches in memory as fit and
+-- splits only the batches that overflow. The results must be the same as
+-- with the regular batching.
+--
+create table hhj_outer (id int, k int) distributed by (id);
+insert into hhj_outer select i, i % 30000 + 10000 from generate_series(1, 100000) i;
+create table hhj_inner (id int, k int, pad text) distributed by (id);
+insert into hhj_inner select j, j % 35000, repeat('x', 200) from generate_series(1, 70000) j;
+create table hhj_skew (id int, k int, pad text) distributed by (id);
+insert into hhj_skew select j, 15000, repeat('y', 200) from generate_series(1, 40000) j;
+analyze hhj_outer;
+analyze hhj_inner;
+analyze hhj_skew;
+
+-- The batch counts below depend on the Postgres planner's estimates.
+set optimizer = off;
+set enable_mergejoin = off;
+set enable_nestloop = off;
+set statement_mem = '1000kB';
+
+set gp_enable_hybrid_hashjoin = on;
+select count(*) from hhj_outer o join hhj_inner i on o.k = i.k;
+select count(i.pad) from hhj_outer o join hhj_inner i on o.k = i.k;
+select count(*) from hhj_outer o left join hhj_inner i on o.k = i.k;
+select count(*) from hhj_outer o right join hhj_inner i on o.k = i.k;
+select count(*) from hhj_outer o full join hhj_inner i on o.k = i.k;
+select count(*) from hhj_outer o where exists (select 1 from hhj_inner i where i.k = o.k);
+select count(*) from hhj_outer o where not exists (select 1 from hhj_inner i where i.k = o.k);
+
+-- EXPLAIN ANALYZE shows what became of the batches. The planner thinks that
+-- k % 350 < 1 keeps a third of the rows, but the batches all fit in memory
+-- and are never written out.
+create function hhj_batches(query text, out resident int, out spilled int, out split int)
+returns setof record
+language plpgsql as
+$$
+declare
+    ln text;
+    m text[];
+begin
+    for ln in
+        execute 'explain (analyze, costs off, timing off, summary off) ' || query
+    loop
+        m := regexp_match(ln, 'Hybrid Batches: (\d+) resident, (\d+) spilled, (\d+) split');
+        if m is not null then
+            resident := m[1];
+            spilled := m[2];
+            split := m[3];
+            return next;
+        end if;
+    end loop;
+end;
+$$;
+select resident > 1 as resident, spilled > 0 as spilled, split > 0 as split
+  from hhj_batches('select count(*) from hhj_inner i1 join (select * from hhj_inner where k % 350 < 1) i2 on i1.k = i2.k');
+select count(*) from hhj_inner i1 join (select * from hhj_inner where k % 350 < 1) i2 on i1.k = i2.k;
+-- With the whole table, only the batches that don't fit are dumped out.
+select resident > 0 as resident, spilled > 0 as spilled
+  from hhj_batches('select count(*) from hhj_outer o join hhj_inner i on o.k = i.k');
+-- The planner thinks that k % 1 = 0 keeps few rows, so it plans a single
+-- batch. That batch is then split, rather than doubling the batches.
+select resident, spilled, split > 0 as split
+  from hhj_batches('select count(*) from hhj_outer o join (select * from hhj_inner where k % 1 = 0) i on o.k = i.k');
+select count(*) from hhj_outer o join (select * from hhj_inner where k % 1 = 0) i on o.k = i.k;
+
+-- All the inner rows have the same key, so the batch cannot be split.
+select count(*) from hhj_outer o join hhj_skew s on o.k = s.k;
+reset gp_enable_hybrid_hashjoin;
+
+select count(*) from hhj_outer o join hhj_inner i on o.k = i.k;
+select count(*) from hhj_outer o full join hhj_inner i on o.k = i.k;
+
+reset statement_mem;
+reset enable_nestloop;
+reset enable_mergejoin;
+reset optimizer;
+
+drop function hhj_batches(text);
+drop table hhj_outer;
+drop table hhj_inner;
+drop table hhj_skew;
@@ -0,0 +1,55 @@
+--
+-- Test compressing interconnect packets.
+--
+-- Query results must be the same with gp_interconnect_compression on and
+-- off. EXPLAIN ANALYZE reports the bytes a Motion received before and after
+-- compression, but only if compression saved anything.
+--
+create table ic_comp (a int, b text) distributed by (a);
+insert into ic_comp select i, repeat('abcdefgh', 20) || i from generate_series(1, 10000) i;
+
+-- The payload of these rows is random, and does not compress.
+create table ic_rand (a int, b bytea) distributed by (a);
+insert into ic_rand
+  select i / 64, string_agg(decode(md5(i::text), 'hex'), ''::bytea order by i)
+  from generate_series(0, 127999) i group by i / 64;
+
+create function ic_explain(query text) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in
+        execute 'explain (analyze, costs off, timing off, summary off) ' || query
+    loop
+        if ln like '%Interconnect Compression%' then
+            return next trim(regexp_replace(ln, '\d+', 'N', 'g'));
+        end if;
+    end loop;
+end;
+$$;
+
+set gp_interconnect_compression = on;
+-- Gather
+select md5(string_agg(b, ',' order by a)) from ic_comp;
+select md5(string_agg(b, ''::bytea order by a)) from ic_rand;
+-- Redistribute
+select count(*), sum(length(t1.b)) from ic_comp t1 join ic_comp t2 on t1.b = t2.b;
+select count(*), sum(length(t1.b)) from ic_rand t1 join ic_rand t2 on t1.b = t2.b;
+select distinct * from ic_explain('select * from ic_comp');
+select distinct * from ic_explain('select count(*) from ic_comp t1 join ic_comp t2 on t1.b = t2.b');
+-- Packets that don't compress are sent as they are, and back off.
+select distinct * from ic_explain('select * from ic_rand');
+
+set gp_interconnect_compression = off;
+select md5(string_agg(b, ',' order by a)) from ic_comp;
+select md5(string_agg(b, ''::bytea order by a)) from ic_rand;
+select count(*), sum(length(t1.b)) from ic_comp t1 join ic_comp t2 on t1.b = t2.b;
+select count(*), sum(length(t1.b)) from ic_rand t1 join ic_rand t2 on t1.b = t2.b;
+select distinct * from ic_explain('select * from ic_comp');
+reset gp_interconnect_compression;
+
+drop function ic_explain(text);
+drop table ic_comp;
+drop table ic_rand;
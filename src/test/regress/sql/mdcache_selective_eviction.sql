@@ -0,0 +1,61 @@
+--
+-- Catalog changes must be picked up when the optimizer evicts only the
+-- affected objects from its metadata cache. Each query is run before and
+-- after the change, so that the second run would see any stale metadata.
+-- This is only interesting with optimizer=on.
+--
+create schema mdcache_selective_eviction;
+set search_path to mdcache_selective_eviction;
+set optimizer_mdcache_selective_eviction = on;
+
+create table mdc_t (a int, b int) distributed by (a);
+insert into mdc_t select i, i % 3 from generate_series(1, 6) i;
+
+-- ALTER FUNCTION: strictness
+create function mdc_f(int) returns int as $$
+begin
+  return coalesce($1, -1);
+end
+$$ language plpgsql immutable;
+select mdc_f(null::int);
+alter function mdc_f(int) strict;
+select mdc_f(null::int);
+
+-- ALTER FUNCTION: volatility
+create function mdc_g(int) returns int as $$
+begin
+  return $1 * 10;
+end
+$$ language plpgsql volatile;
+select a, mdc_g(a) from mdc_t where a <= 2 order by a;
+alter function mdc_g(int) immutable;
+select a, mdc_g(a) from mdc_t where a <= 2 order by a;
+
+-- ALTER TABLE ADD COLUMN / DROP COLUMN
+select * from mdc_t where a <= 2 order by a;
+alter table mdc_t add column c text default 'x';
+select * from mdc_t where a <= 2 order by a;
+alter table mdc_t drop column b;
+select * from mdc_t where a <= 2 order by a;
+
+-- ALTER TYPE
+create type mdc_color as enum ('red', 'green');
+create table mdc_e (id int, c mdc_color) distributed by (id);
+insert into mdc_e values (1, 'green'), (2, 'red');
+select * from mdc_e order by c;
+alter type mdc_color add value 'blue' before 'red';
+insert into mdc_e values (3, 'blue');
+select * from mdc_e order by c;
+alter type mdc_color rename value 'green' to 'verde';
+select * from mdc_e order by c;
+
+-- ANALYZE
+select count(*) from mdc_t where a > 3;
+insert into mdc_t select i, 'y' from generate_series(7, 1000) i;
+analyze mdc_t;
+select count(*) from mdc_t where a > 3;
+select count(*) from mdc_t t1 join mdc_t t2 using (a) where t1.c = 'x';
+
+reset optimizer_mdcache_selective_eviction;
+set client_min_messages = warning;
+drop schema mdcache_selective_eviction cascade;
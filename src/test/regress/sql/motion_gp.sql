@@ -98,3 +98,41 @@ $$) order by id;
 CREATE TABLE motion_noatts ();
 INSERT INTO motion_noatts SELECT;
 SELECT * FROM motion_noatts;
+
+-- Redistribute Motions hash the distribution keys of several tuples at a
+-- time. Check that the rows land on the same segments as when they are
+-- hashed one at a time, for the types with inline hash kernels (int4, int8,
+-- text, numeric) and one without (float8).
+CREATE TABLE motion_hash_src (i int4, b int8, t text, n numeric, f float8) DISTRIBUTED RANDOMLY;
+INSERT INTO motion_hash_src
+  SELECT g, g * 1000000007, 'row ' || g, g / 7.0, g / 3.0 FROM generate_series(1, 1000) g;
+INSERT INTO motion_hash_src VALUES (NULL, NULL, NULL, NULL, NULL), (0, NULL, '', 0, 0);
+SET gp_motion_hash_batch_size = 0;
+CREATE TABLE motion_hash_rows AS SELECT * FROM motion_hash_src DISTRIBUTED BY (i, b, t, n, f);
+SET gp_motion_hash_batch_size = 16;
+CREATE TABLE motion_hash_batch AS SELECT * FROM motion_hash_src DISTRIBUTED BY (i, b, t, n, f);
+RESET gp_motion_hash_batch_size;
+SELECT count(*) FROM motion_hash_batch;
+SELECT gp_segment_id, i, b, t, n, f FROM motion_hash_rows
+EXCEPT
+SELECT gp_segment_id, i, b, t, n, f FROM motion_hash_batch;
+
+-- Motions can send tuples in columnar batches. Check that the values of
+-- each encoding survive the trip: a dictionary (c), runs (r), plain values
+-- (p), NULLs (n), long varlenas (l) and fixed-length pass-by-reference
+-- values (u).
+CREATE TABLE motion_colbatch_src (id int, c text, r int8, p float8, n int2, l text, u name, b bool) DISTRIBUTED RANDOMLY;
+INSERT INTO motion_colbatch_src
+  SELECT g, 'color ' || (g % 5), g / 100, g * 1.5,
+         CASE WHEN g % 3 = 0 THEN NULL ELSE g % 7 END,
+         CASE WHEN g % 50 = 0 THEN repeat('x', 200 + g) END,
+         'n' || (g % 2), g % 2 = 0
+  FROM generate_series(1, 3000) g;
+SET gp_motion_columnar_batch_size = 100;
+CREATE TABLE motion_colbatch AS SELECT * FROM motion_colbatch_src DISTRIBUTED BY (c);
+SELECT id, c, r, p, n, u, b FROM motion_colbatch_src ORDER BY id LIMIT 5;
+RESET gp_motion_columnar_batch_size;
+SELECT count(*), count(n), sum(length(l)) FROM motion_colbatch;
+(SELECT * FROM motion_colbatch_src EXCEPT ALL SELECT * FROM motion_colbatch)
+UNION ALL
+(SELECT * FROM motion_colbatch EXCEPT ALL SELECT * FROM motion_colbatch_src);
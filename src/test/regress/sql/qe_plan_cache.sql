@@ -0,0 +1,63 @@
+--
+-- Test caching of dispatched plans on the QEs. Executing the same prepared
+-- statement again dispatches only the plan's key, and the results must be
+-- the same as with the full plan.
+--
+create table qpc_t1 (a int, b int) distributed by (a);
+insert into qpc_t1 select i, i % 100 from generate_series(1, 10000) i;
+create table qpc_t2 (a int, b int) distributed by (a);
+insert into qpc_t2 select i, i % 50 from generate_series(1, 1000) i;
+analyze qpc_t1;
+analyze qpc_t2;
+
+set gp_enable_qe_plan_cache = on;
+prepare qpc_scan(int) as select count(*) from qpc_t1 where b = $1;
+prepare qpc_join as select count(*) from qpc_t1 t1 join qpc_t2 t2 on t1.b = t2.a;
+execute qpc_scan(1);
+execute qpc_scan(1);
+execute qpc_scan(2);
+execute qpc_scan(200);
+execute qpc_join;
+execute qpc_join;
+execute qpc_scan(1);
+
+-- A small cache makes the plans evict each other. Changing the size makes
+-- the QD send the plans in full again.
+set gp_qe_plan_cache_size = 1;
+execute qpc_join;
+execute qpc_scan(3);
+execute qpc_join;
+execute qpc_join;
+reset gp_qe_plan_cache_size;
+execute qpc_join;
+
+-- An error on the QEs must not leave the QD thinking they have the plan.
+prepare qpc_div(int) as select count(*) from qpc_t1 where a / $1 > 0;
+execute qpc_div(1);
+execute qpc_div(0);
+execute qpc_div(1);
+execute qpc_div(1);
+
+-- If a QE has lost the plan it's sent the key of, it asks the QD for the
+-- plan in full instead of failing the query.
+execute qpc_join;
+select gp_inject_fault('qe_plan_cache_lose_plan', 'skip', dbid)
+  from gp_segment_configuration where content = 0 and role = 'p';
+execute qpc_join;
+select gp_wait_until_triggered_fault('qe_plan_cache_lose_plan', 1, dbid)
+  from gp_segment_configuration where content = 0 and role = 'p';
+select gp_inject_fault('qe_plan_cache_lose_plan', 'reset', dbid)
+  from gp_segment_configuration where content = 0 and role = 'p';
+execute qpc_join;
+
+-- A cached plan sees the new rows.
+insert into qpc_t1 select i, i % 100 from generate_series(10001, 10100) i;
+execute qpc_join;
+
+deallocate qpc_scan;
+deallocate qpc_join;
+deallocate qpc_div;
+reset gp_enable_qe_plan_cache;
+
+drop table qpc_t1;
+drop table qpc_t2;
@@ -0,0 +1,104 @@
+--
+-- Test runtime filters, which hash joins push down to the scans on their
+-- outer side. The results must not depend on whether rows are filtered
+-- early.
+--
+create table rf_fact (id int, dkey int, v int) distributed by (id);
+insert into rf_fact
+  select i, case when i % 997 = 0 then null else i % 1000 end, i % 7
+  from generate_series(1, 100000) i;
+create table rf_dim (dkey int, name text, cat int) distributed by (dkey);
+insert into rf_dim select i, 'd' || i, i % 10 from generate_series(1, 1000) i;
+create table rf_dim2 (k int, label text) distributed by (k);
+insert into rf_dim2 select i, 'l' || i from generate_series(0, 6) i;
+create table rf_fact_aocs with (appendonly=true, orientation=column)
+  as select * from rf_fact distributed by (id);
+analyze rf_fact;
+analyze rf_dim;
+analyze rf_dim2;
+analyze rf_fact_aocs;
+
+set gp_enable_runtime_filter_pushdown = on;
+select count(*) from rf_fact f join rf_dim d on f.dkey = d.dkey where d.cat = 3;
+select count(*) from rf_fact f join rf_dim d on f.dkey = d.dkey where d.dkey between 100 and 149;
+select count(*) from rf_fact f join rf_dim d on f.dkey = d.dkey and f.v = d.cat;
+select count(*) from rf_fact f where f.dkey in (select dkey from rf_dim where name like 'd1_');
+select count(*) from rf_fact f join rf_dim d on f.dkey = d.dkey join rf_dim2 d2 on f.v = d2.k
+  where d.cat < 5 and d2.label in ('l0', 'l1');
+select count(*) from rf_fact f join rf_dim d on f.dkey = d.dkey where d.cat = 10;
+
+-- Outer joins must keep the rows without a partner.
+select count(*) from rf_fact f left join rf_dim d on f.dkey = d.dkey and d.cat = 3;
+
+-- Batch scans of AOCS tables.
+select count(*) from rf_fact_aocs f join rf_dim d on f.dkey = d.dkey where d.cat = 3;
+select count(*) from rf_fact_aocs f join rf_dim d on f.dkey = d.dkey and f.v = d.cat;
+select count(*) from rf_fact_aocs f join rf_dim d on f.dkey = d.dkey join rf_dim2 d2 on f.v = d2.k
+  where d.cat < 5 and d2.label in ('l0', 'l1');
+
+-- Join keys of a domain over an integer type.
+create domain rf_dkey as int;
+create table rf_fact_dom (id int, dkey rf_dkey, v int) distributed by (id);
+insert into rf_fact_dom select id, dkey, v from rf_fact;
+analyze rf_fact_dom;
+select count(*) from rf_fact_dom f join rf_dim d on f.dkey = d.dkey where d.cat = 3;
+
+-- A rescan that builds the hash table again, from a different inner side,
+-- must not filter the outer rows with the previous build's filter. The
+-- innermost hash join is rescanned for each row of b, and its inner side
+-- changes with each row of a.
+create table rf_fact_rep (dkey int, v int) distributed replicated;
+insert into rf_fact_rep select i % 100, i % 7 from generate_series(1, 10000) i;
+create table rf_dim_rep (dkey int, cat int) distributed replicated;
+insert into rf_dim_rep select i, i % 10 from generate_series(0, 99) i;
+create table rf_param_a (x int) distributed replicated;
+insert into rf_param_a values (2), (1);
+create table rf_param_b (y int) distributed replicated;
+insert into rf_param_b values (0), (1);
+analyze rf_fact_rep;
+analyze rf_dim_rep;
+analyze rf_param_a;
+analyze rf_param_b;
+select a.x, s1.y, s1.c from rf_param_a a,
+  lateral (select b.y, s2.c from rf_param_b b,
+           lateral (select count(*) as c
+                    from rf_fact_rep f join rf_dim_rep d on f.dkey = d.dkey
+                    where d.cat = a.x and f.v = b.y) s2
+           offset 0) s1
+  order by 1, 2;
+
+-- Show that the filters reach the scans and reject rows there.
+create function rf_explain(query text) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in
+        execute 'explain (analyze, costs off, timing off, summary off) ' || query
+    loop
+        if ln like '%Rows Removed by Runtime Filter%' then
+            return next trim(regexp_replace(ln, '\d+', 'N'));
+        end if;
+    end loop;
+end;
+$$;
+select * from rf_explain('select count(*) from rf_fact f join rf_dim d on f.dkey = d.dkey where d.cat = 3');
+select * from rf_explain('select count(*) from rf_fact_aocs f join rf_dim d on f.dkey = d.dkey where d.cat = 3');
+select * from rf_explain('select count(*) from rf_fact_dom f join rf_dim d on f.dkey = d.dkey where d.cat = 3');
+reset gp_enable_runtime_filter_pushdown;
+select * from rf_explain('select count(*) from rf_fact f join rf_dim d on f.dkey = d.dkey where d.cat = 3');
+
+select count(*) from rf_fact f join rf_dim d on f.dkey = d.dkey where d.cat = 3;
+
+drop table rf_fact;
+drop table rf_fact_aocs;
+drop table rf_dim;
+drop table rf_dim2;
+drop table rf_fact_dom;
+drop domain rf_dkey;
+drop table rf_fact_rep;
+drop table rf_dim_rep;
+drop table rf_param_a;
+drop table rf_param_b;
+drop function rf_explain(text);